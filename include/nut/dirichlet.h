@@ -86,9 +86,11 @@
 /// it is often better to make A larger than B, eg A = x**(2/3) and B = x**(1/3).
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <assert.h>
 
 #include <nut/modular_math.h>
+#include <nut/factorization.h>
 
 /// Wrapper to hold values of some multiplicative function.
 /// Stores all values f(n) for n up to (and including) y, then
@@ -97,6 +99,9 @@ typedef struct{
 	int64_t x;
 	int64_t y, yinv;
 	int64_t *buf;
+	/// If the table is mapped from a file by { @link nut_Diri_mmap}, the address and length of the mapping, otherwise NULL and 0
+	void *mapping;
+	size_t mapping_len;
 } nut_Diri;
 
 /// Compute the sum of the divisor count function d from 1 to max.
@@ -154,6 +159,68 @@ NUT_ATTR_ACCESS(read_only, 4, 1)
 NUT_ATTR_ACCESS(read_write, 5, 1)
 bool nut_euler_sieve_conv(int64_t n, int64_t m, const int64_t f_vals[static n+1], const int64_t g_vals[static n+1], int64_t f_conv_g_vals[restrict static n+1]);
 
+/// Flag set in { @link nut_EulerCtx}::smallest_ppow entries for prime powers
+#define NUT_EULER_CTX_PRIME_POWER (UINT32_C(1) << 31)
+
+/// Largest n a { @link nut_EulerCtx} can be built for, so that every entry fits in 31 bits
+#define NUT_EULER_CTX_MAX_N INT64_C(0x7FFFFFFF)
+
+/// Reusable factorization data for the dense part of Dirichlet convolutions.
+/// Euler's sieve spends most of its time finding the smallest prime power dividing every number, and this does not depend on the
+/// functions being convolved, so when many convolutions are done with the same y (like in { @link nut_Diri_compute_dk}),
+/// it can be done once up front.  With this table, the convolution of multiplicative functions is a single pass
+/// h(i) = h(q)h(i/q) where q is the largest power of the smallest prime dividing i, so only the value arithmetic is left.
+typedef struct{
+	/// inclusive upper bound of the tables
+	int64_t n;
+	/// number of primes in primes
+	uint64_t num_primes;
+	/// all primes up to n, in increasing order
+	uint32_t *primes;
+	/// For 2 <= i <= n, if i is a prime power p**a, this is p | { @link NUT_EULER_CTX_PRIME_POWER}.
+	/// Otherwise, it is the largest power of the smallest prime dividing i, which is coprime to i/smallest_ppow[i].
+	/// Packing the prime into prime power entries means both cases fit in 4 bytes per number.
+	uint32_t *smallest_ppow;
+} nut_EulerCtx;
+
+/// Build the factorization tables for { @link nut_euler_sieve_conv_u_ctx} and friends, using Euler's sieve
+/// @param [out] self: the context to initialize
+/// @param [in] n: inclusive upper bound, at most { @link NUT_EULER_CTX_MAX_N}
+/// @return true on success, false on allocation failure or if n is out of range
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(write_only, 1)
+bool nut_EulerCtx_init(nut_EulerCtx *self, int64_t n);
+
+/// Deallocate the tables of a { @link nut_EulerCtx}
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(read_write, 1)
+void nut_EulerCtx_destroy(nut_EulerCtx *self);
+
+/// Version of { @link nut_euler_sieve_conv_u} using precomputed factorization data, which does not allocate
+/// @param [in] ctx: factorization data from { @link nut_EulerCtx_init}, with ctx->n >= n
+/// @param [in] n, m, f_vals, f_conv_u_vals: see { @link nut_euler_sieve_conv_u}
+/// @return true on success, false if n is larger than ctx->n
+NUT_ATTR_NONNULL(1, 4, 5)
+NUT_ATTR_ACCESS(read_only, 1)
+NUT_ATTR_ACCESS(read_only, 4, 2)
+NUT_ATTR_ACCESS(read_write, 5, 2)
+bool nut_euler_sieve_conv_u_ctx(const nut_EulerCtx *ctx, int64_t n, int64_t m, const int64_t f_vals[restrict static n+1], int64_t f_conv_u_vals[restrict static n+1]);
+
+/// Version of { @link nut_euler_sieve_conv_N} using precomputed factorization data, see { @link nut_euler_sieve_conv_u_ctx}
+NUT_ATTR_NONNULL(1, 4, 5)
+NUT_ATTR_ACCESS(read_only, 1)
+NUT_ATTR_ACCESS(read_only, 4, 2)
+NUT_ATTR_ACCESS(read_write, 5, 2)
+bool nut_euler_sieve_conv_N_ctx(const nut_EulerCtx *ctx, int64_t n, int64_t m, const int64_t f_vals[restrict static n+1], int64_t f_conv_N_vals[restrict static n+1]);
+
+/// Version of { @link nut_euler_sieve_conv} using precomputed factorization data, see { @link nut_euler_sieve_conv_u_ctx}
+NUT_ATTR_NONNULL(1, 4, 5, 6)
+NUT_ATTR_ACCESS(read_only, 1)
+NUT_ATTR_ACCESS(read_only, 4, 2)
+NUT_ATTR_ACCESS(read_only, 5, 2)
+NUT_ATTR_ACCESS(read_write, 6, 2)
+bool nut_euler_sieve_conv_ctx(const nut_EulerCtx *ctx, int64_t n, int64_t m, const int64_t f_vals[static n+1], const int64_t g_vals[static n+1], int64_t f_conv_g_vals[restrict static n+1]);
+
 /// Allocate internal buffers for a diri table
 /// self->buf will have f(0) through f(y) at indicies 0 through y,
 /// and then f(x/1) through f(x/(yinv - 1)) at indicies y + 1 through y + yinv - 1.
@@ -173,11 +240,45 @@ NUT_ATTR_ACCESS(read_write, 1)
 NUT_ATTR_ACCESS(read_only, 2)
 void nut_Diri_copy(nut_Diri *restrict dest, const nut_Diri *restrict src);
 
-/// Deallocate internal buffers for a diri table
+/// Deallocate internal buffers for a diri table, unmapping its values if it was mapped
 NUT_ATTR_NONNULL(1)
 NUT_ATTR_ACCESS(read_write, 1)
 void nut_Diri_destroy(nut_Diri *self);
 
+/// Offset of the values in a file written by { @link nut_Diri_save}.
+/// This is 64K so that it is a multiple of the page size on every common system, including arm64 and ppc64le with 16K or 64K pages
+#define NUT_DIRI_DATA_OFFSET 65536
+
+/// Write a diri table to a file so it can be loaded with { @link nut_Diri_mmap}.
+/// The file has a header with x, y, yinv, the modulus, a tag, and a checksum of the values, followed by the values
+/// in the same layout as buf starting at { @link NUT_DIRI_DATA_OFFSET}, which is page aligned, so that mapping them needs no copying.
+/// The format uses the native byte order.
+/// @param [in] self: table to save
+/// @param [in] path: file to write
+/// @param [in] m: modulus the table was reduced by, or 0, recorded so that loading a table for the wrong modulus fails
+/// @param [in] tag: arbitrary value identifying which function the table is for (eg a few characters packed into an integer), also checked on load
+/// @return true on success, false if the file could not be written
+NUT_ATTR_NONNULL(1, 2)
+NUT_ATTR_ACCESS(read_only, 1)
+NUT_ATTR_ACCESS(read_only, 2)
+bool nut_Diri_save(const nut_Diri *restrict self, const char *restrict path, int64_t m, uint64_t tag);
+
+/// Set up a diri table by mapping a file written by { @link nut_Diri_save}.
+/// The values are mapped read only and shared, so many processes can use one copy of a large table through the page cache,
+/// but the table must never be written to, so it can only be used as an input to other computations (copy it with { @link nut_Diri_copy} first if needed).
+/// On platforms without mmap, the values are read into memory instead.
+/// @param [out] self: the table to initialize.  Must be freed with { @link nut_Diri_destroy}
+/// @param [in] path: file to map
+/// @param [in] m, tag: must match the values the table was saved with
+/// @param [in] verify: if true, check the checksum, which has to read every value.
+/// Otherwise pages are only read when they are first used
+/// @return true on success, false if the file could not be opened or mapped, is not a table file, has the wrong modulus or tag,
+/// fails verification, or on allocation failure
+NUT_ATTR_NONNULL(1, 2)
+NUT_ATTR_ACCESS(write_only, 1)
+NUT_ATTR_ACCESS(read_only, 2)
+bool nut_Diri_mmap(nut_Diri *restrict self, const char *restrict path, int64_t m, uint64_t tag, bool verify);
+
 NUT_ATTR_PURE
 NUT_ATTR_NONNULL(1)
 NUT_ATTR_ACCESS(read_only, 1)
@@ -208,6 +309,103 @@ static inline void nut_Diri_set_sparse(nut_Diri *self, int64_t k, int64_t v){
 	self->buf[self->y + k] = v;
 }
 
+/// Largest x that { @link nut_DiriIndex_quot} divides with floating point reciprocals.
+/// The estimate v*(1/n) has relative error below 2^-51, so it is off by at most 1 whenever the quotient is below 2^51.
+#define NUT_DIRI_INDEX_MAX_X (INT64_C(1) << 51)
+
+/// Precomputed quotient arithmetic for the hyperbola loops over a table with bounds x and y.
+/// Each sparse entry v = x/i of a convolution or the Mertens function needs v/n for every n up to sqrt(v), and Lucy's algorithm needs v/p for every prime,
+/// and both check the quotient against y to pick a dense or sparse lookup.
+/// A 64 bit divide is one of the slowest instructions there is, so instead this stores the sparse quotients x/i,
+/// the reciprocals 1/n as doubles, and the point where lookups switch from sparse to dense.
+/// Then v/n is a multiply and an integer correction, and every loop over n splits into a sparse range with no quotient needed
+/// (the entry is just index i*n) and a dense range, with no branch on each term.
+typedef struct{
+	/// bounds of the table this index is for
+	int64_t x, y, yinv;
+	/// x/k <= y exactly when k >= k_dense
+	int64_t k_dense;
+	/// largest n with a reciprocal, sqrt(x)
+	int64_t n_max;
+	/// v[i] = x/i for 1 <= i < yinv, so Lucy's algorithm, which goes over the sparse entries once per prime, doesn't divide to find them
+	int64_t *v;
+	/// inv[n] = 1/n for 1 <= n <= n_max
+	double *inv;
+} nut_DiriIndex;
+
+/// Build the quotient index for a table
+/// @param [out] self: the index to initialize
+/// @param [in] tbl: initialized table to take x, y, and yinv from.  The index works for any table with the same bounds
+/// @return true on success, false on allocation failure
+NUT_ATTR_NONNULL(1, 2)
+NUT_ATTR_ACCESS(write_only, 1)
+NUT_ATTR_ACCESS(read_only, 2)
+bool nut_DiriIndex_init(nut_DiriIndex *self, const nut_Diri *tbl);
+
+/// Deallocate the tables of a quotient index
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(read_write, 1)
+void nut_DiriIndex_destroy(nut_DiriIndex *self);
+
+/// Find v/n for 0 <= v <= x and 1 <= n <= n_max without a divide
+NUT_ATTR_PURE
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(read_only, 1)
+static inline int64_t nut_DiriIndex_quot(const nut_DiriIndex *self, int64_t v, int64_t n){
+	assert(n >= 1 && n <= self->n_max);
+	if(self->x > NUT_DIRI_INDEX_MAX_X){
+		return v/n;
+	}
+	int64_t q = (int64_t)((double)v*self->inv[n]);
+	int64_t r = v - q*n;
+	return q + (r >= n) - (r < 0);
+}
+
+/// Iterator over the quotients v = x/i for consecutive i (or i in steps of any stride), in either direction,
+/// which keeps floor(sqrt(v)) and optionally floor(cbrt(v)) up to date.
+/// The hyperbola method needs sqrt(v) for every sparse entry, and since neighbouring quotients have neighbouring roots,
+/// updating the previous root with { @link nut_u64_sqrt_from} takes O(1) amortized time instead of a full Newton's method from scratch.
+typedef struct{
+	int64_t x;
+	/// current index, quotient x/i, and its square root
+	int64_t i, v, vr;
+	/// cube root of v, or 0 if the iterator doesn't track it
+	int64_t vc;
+	bool track_cbrt;
+} nut_QuotientIt;
+
+/// Start iterating over the quotients of x at index i
+/// @param [out] self: the iterator to initialize
+/// @param [in] x: numerator of the quotients
+/// @param [in] i: first index.  If it is below 1, the iterator is already past the end of a descending loop
+/// @param [in] track_cbrt: if true, also keep the cube root in vc
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(write_only, 1)
+static inline void nut_QuotientIt_init(nut_QuotientIt *self, int64_t x, int64_t i, bool track_cbrt){
+	*self = (nut_QuotientIt){.x = x, .i = i, .track_cbrt = track_cbrt};
+	if(i >= 1){
+		self->v = x/i;
+		self->vr = nut_u64_nth_root(self->v, 2);
+		self->vc = track_cbrt ? nut_u64_nth_root(self->v, 3) : 0;
+	}
+}
+
+/// Move the iterator to index i + di and update the quotient and its roots.
+/// If the new index is below 1, only i is updated, so loops like `for(...; it.i >= 1; nut_QuotientIt_advance(&it, -1))` are safe
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(read_write, 1)
+static inline void nut_QuotientIt_advance(nut_QuotientIt *self, int64_t di){
+	self->i += di;
+	if(self->i < 1){
+		return;
+	}
+	self->v = self->x/self->i;
+	self->vr = nut_u64_sqrt_from(self->v, self->vr);
+	if(self->track_cbrt){
+		self->vc = nut_u64_cbrt_from(self->v, self->vc);
+	}
+}
+
 /// Compute the value table for the dirichlet convolution identity I(n) = \{1 if n == 0, 0 otherwise\}
 /// Just memset's the dense part, then sets index 1 and y + 1 through y + yinv - 1 to 1 (remember the sparse indicies are sums)
 /// @param [in, out] self: the table to store the result in, and take the bounds from.  Must be initialized
@@ -256,6 +454,18 @@ NUT_ATTR_NONNULL(1, 4, 5)
 NUT_ATTR_ACCESS(read_write, 1, 4, 5)
 bool nut_Diri_compute_dk(nut_Diri *restrict self, uint64_t k, int64_t m, nut_Diri *restrict f_tbl, nut_Diri *restrict g_tbl);
 
+/// Version of { @link nut_Diri_compute_dk} using precomputed factorization data for the dense part.
+/// { @link nut_Diri_compute_dk} builds a temporary context itself, so this is only useful if ctx is shared with other work.
+/// @param [in] ctx: factorization data from { @link nut_EulerCtx_init}, with ctx->n >= self->y, or NULL to sieve the dense part
+/// of every convolution separately with { @link nut_Diri_compute_conv}, which is what { @link nut_Diri_compute_dk} does when y is larger than
+/// { @link NUT_EULER_CTX_MAX_N} or the context can't be allocated
+/// @param [in, out] self, k, m, f_tbl, g_tbl: see { @link nut_Diri_compute_dk}
+/// @return true on success, false if the tables or ctx don't match
+NUT_ATTR_NONNULL(1, 4, 5)
+NUT_ATTR_ACCESS(read_write, 1, 4, 5)
+NUT_ATTR_ACCESS(read_only, 6)
+bool nut_Diri_compute_dk_ctx(nut_Diri *restrict self, uint64_t k, int64_t m, nut_Diri *restrict f_tbl, nut_Diri *restrict g_tbl, const nut_EulerCtx *ctx);
+
 /// Compute the value table for the kth power function N^k(n)
 /// N^k(n) = n^k, so we can find the sums using https://en.wikipedia.org/wiki/Faulhaber%27s_formula
 /// (we actually do this by taking a lower triangular matrix of pascal's triangle and inverting it)
@@ -291,12 +501,55 @@ bool nut_Diri_compute_Chi_balanced(nut_Diri *restrict self, uint64_t n, int64_t
 /// Compute the value table for the prime counting function, aka prime pi
 /// The indicator function for primes is effectively multiplicative,
 /// and the prime counting function is its sum.  But also, Lucy Hedgehog's prime counting
-/// algorithm essentially uses Dirichlet tables already, hence its inclusion in this part of the library
+/// algorithm essentially uses Dirichlet tables already, hence its inclusion in this part of the library.
+/// If only pi(x) itself is needed, { @link nut_u64_pi} is asymptotically faster.
+/// The dense part of Lucy's algorithm costs about y^(3/2)/log(y), so when y is above 2sqrt(x), the sparse entries are found
+/// with Lucy's algorithm on a scratch table with y = 2sqrt(x), and the rest of the dense entries with a segmented sieve.
+/// This makes large y, like the x^(2/3) the convolutions want, cheap for pi.
 /// @param [in, out] self: the table to store the result in, and take the bounds from.  Must be initialized
 NUT_ATTR_NONNULL(1)
 NUT_ATTR_ACCESS(read_write, 1)
 bool nut_Diri_compute_pi(nut_Diri *restrict self);
 
+/// Compute the value table for the prime counting function like { @link nut_Diri_compute_pi}, reusing the dense part of a table with a smaller y.
+/// Since pi(n) doesn't depend on x, the dense entries up to old->y are copied instead of sieved.  Nothing else is reused:
+/// the sparse entries are recomputed exactly as in { @link nut_Diri_compute_pi}, because Lucy's algorithm needs the dense entries in their
+/// partly sieved states, so this only saves the segmented sieve up to old->y, and nothing at all when self->y <= 2sqrt(x) or old->y <= 2sqrt(x).
+/// @param [in, out] self: the table to store the result in, initialized with self->y >= old->y
+/// @param [in] old: table from { @link nut_Diri_compute_pi} or this function, for any x
+/// @return true on success, false on allocation failure or if self->y < old->y
+NUT_ATTR_NONNULL(1, 2)
+NUT_ATTR_ACCESS(read_write, 1)
+NUT_ATTR_ACCESS(read_only, 2)
+bool nut_Diri_compute_pi_extend(nut_Diri *restrict self, const nut_Diri *restrict old);
+
+/// Compute the value tables for the prime power sums sum(p^k, p <= v) for k = 0, ..., kmax at once.
+/// This is Lucy Hedgehog's algorithm like { @link nut_Diri_compute_pi}, where each table starts as the sum of n^k for 2 <= n <= v
+/// and then sieving out each prime p <= sqrt(x) subtracts p^k times the sum over the survivors up to v/p.
+/// The tables are updated together, so the index arithmetic for each (p, v) pair is shared instead of repeated per table.
+/// Like { @link nut_Diri_compute_pi}, the dense entries are also prefix sums (sum(p^k, p <= i)), not values at i.
+/// @param [in, out] self_array: kmax + 1 tables to store the results in, with table k getting the sums of p^k.
+/// Must all be initialized with the same x and y
+/// @param [in] kmax: largest power to compute sums for
+/// @param [in] m: modulus to reduce the results by, or 0 to skip reducing.  If m is not 0, Faulhaber's formula is evaluated mod m,
+/// so m must be a prime greater than kmax + 1 (see { @link nut_Diri_compute_Nk})
+/// @return true on success, false on allocation failure or if Faulhaber's formula can't be evaluated mod m
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(read_write, 1)
+bool nut_Diri_compute_prime_sums(nut_Diri self_array[restrict], uint64_t kmax, int64_t m);
+
+/// Compute the value tables for counting primes in every residue class mod q at once.
+/// Table r gets the number of primes p <= v with p = r mod q.  This is Lucy Hedgehog's algorithm with one table per residue class:
+/// sieving out p moves the survivors up to v/p in class s to class ps mod q, so each (p, v) pair updates all q tables together.
+/// Classes r that share a factor with q only ever contain the primes dividing q.
+/// The dense entries are prefix counts, like { @link nut_Diri_compute_pi}.
+/// @param [in, out] self_array: q tables to store the results in.  Must all be initialized with the same x and y
+/// @param [in] q: the modulus for the residue classes, must be positive
+/// @return true on success, false on allocation failure
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(read_write, 1)
+bool nut_Diri_compute_pi_mod_q(nut_Diri self_array[restrict], uint64_t q);
+
 /// Compute the value table for h = f <*> u, the dirichlet convolution of f and u (the unit function u(n) = 1), given the value table for f
 /// See { @link nut_Diri_compute_conv } for details, this is just that function but with several specializations due to u being very simple.
 /// @param [in, out] self: the table to store the result in, initialized by { @link nut_Diri_init}.
@@ -336,6 +589,31 @@ NUT_ATTR_ACCESS(read_only, 3)
 NUT_ATTR_ACCESS(read_only, 4)
 bool nut_Diri_compute_conv(nut_Diri *restrict self, int64_t m, const nut_Diri *f_tbl, const nut_Diri *g_tbl);
 
+/// Version of { @link nut_Diri_compute_conv_u} using precomputed factorization data for the dense part, see { @link nut_EulerCtx}
+/// @param [in, out] self, m, f_tbl: see { @link nut_Diri_compute_conv_u}
+/// @param [in] ctx: factorization data from { @link nut_EulerCtx_init}, with ctx->n >= self->y
+/// @return true on success, false if the tables or ctx don't match
+NUT_ATTR_NONNULL(1, 3, 4)
+NUT_ATTR_ACCESS(read_write, 1)
+NUT_ATTR_ACCESS(read_only, 3)
+NUT_ATTR_ACCESS(read_only, 4)
+bool nut_Diri_compute_conv_u_ctx(nut_Diri *restrict self, int64_t m, const nut_Diri *restrict f_tbl, const nut_EulerCtx *ctx);
+
+/// Version of { @link nut_Diri_compute_conv_N} using precomputed factorization data, see { @link nut_Diri_compute_conv_u_ctx}
+NUT_ATTR_NONNULL(1, 3, 4)
+NUT_ATTR_ACCESS(read_write, 1)
+NUT_ATTR_ACCESS(read_only, 3)
+NUT_ATTR_ACCESS(read_only, 4)
+bool nut_Diri_compute_conv_N_ctx(nut_Diri *restrict self, int64_t m, const nut_Diri *restrict f_tbl, const nut_EulerCtx *ctx);
+
+/// Version of { @link nut_Diri_compute_conv} using precomputed factorization data, see { @link nut_Diri_compute_conv_u_ctx}
+NUT_ATTR_NONNULL(1, 3, 4, 5)
+NUT_ATTR_ACCESS(read_write, 1)
+NUT_ATTR_ACCESS(read_only, 3)
+NUT_ATTR_ACCESS(read_only, 4)
+NUT_ATTR_ACCESS(read_only, 5)
+bool nut_Diri_compute_conv_ctx(nut_Diri *restrict self, int64_t m, const nut_Diri *f_tbl, const nut_Diri *g_tbl, const nut_EulerCtx *ctx);
+
 
 /// Compute the value table for h such that f = g <*> h, aka h = f </> g where the division is in terms of dirichlet convolution
 /// self must have been initialized using { @link nut_Diri_init }, and in particular the lengths and cutoffs for self, f_tbl, and g_tbl
@@ -354,3 +632,171 @@ NUT_ATTR_NONNULL(1, 3, 4)
 NUT_ATTR_ACCESS(read_write, 1, 3, 4)
 bool nut_Diri_convdiv(nut_Diri *restrict self, int64_t m, const nut_Diri *restrict f_tbl, const nut_Diri *restrict g_tbl);
 
+
+/// Compute (f <*> u)(n) for lo <= n < hi only, with a segmented sieve.
+/// Euler's sieve is inherently serial and reads the output at random strides, which is slow once the dense part of a table
+/// no longer fits in cache.  Instead, [lo, hi) is split into windows of a fixed size, and in each window every prime p up to sqrt(hi)
+/// divides its full power p^e out of every multiple and multiplies in h(p^e), which is found directly from f at powers of p.
+/// Whatever is left of each number after that is 1 or a prime q, contributing h(q) = f(q) + 1.
+/// So each window only reads f at prime powers and at the window itself, and windows are dealt out to threads independently.
+/// @param [in] lo: inclusive lower bound of the window, at least 1
+/// @param [in] hi: exclusive upper bound of the window
+/// @param [in] m: modulus to reduce results by, or 0 to skip reducing
+/// @param [in] f_vals: table of values for f, with entries up to hi - 1
+/// @param [out] out: out[n - lo] is set to (f <*> u)(n)
+/// @param [in] num_threads: number of threads to use, or 0 to use { @link nut_parallel_default_threads}
+/// @return true on success, false on allocation failure or if the bounds are invalid
+NUT_ATTR_NONNULL(4, 5)
+NUT_ATTR_ACCESS(read_only, 4, 2)
+NUT_ATTR_ACCESS(write_only, 5)
+bool nut_euler_sieve_conv_u_window(int64_t lo, int64_t hi, int64_t m, const int64_t f_vals[static hi], int64_t out[restrict static hi - lo], uint64_t num_threads);
+
+/// Compute (f <*> N)(n) for lo <= n < hi only, see { @link nut_euler_sieve_conv_u_window}
+NUT_ATTR_NONNULL(4, 5)
+NUT_ATTR_ACCESS(read_only, 4, 2)
+NUT_ATTR_ACCESS(write_only, 5)
+bool nut_euler_sieve_conv_N_window(int64_t lo, int64_t hi, int64_t m, const int64_t f_vals[static hi], int64_t out[restrict static hi - lo], uint64_t num_threads);
+
+/// Compute (f <*> g)(n) for lo <= n < hi only, see { @link nut_euler_sieve_conv_u_window}
+NUT_ATTR_NONNULL(4, 5, 6)
+NUT_ATTR_ACCESS(read_only, 4, 2)
+NUT_ATTR_ACCESS(read_only, 5, 2)
+NUT_ATTR_ACCESS(write_only, 6)
+bool nut_euler_sieve_conv_window(int64_t lo, int64_t hi, int64_t m, const int64_t f_vals[static hi], const int64_t g_vals[static hi], int64_t out[restrict static hi - lo], uint64_t num_threads);
+
+/// Parallel version of { @link nut_euler_sieve_conv_u}.
+/// This is { @link nut_euler_sieve_conv_u_window} over [1, n + 1], so the windows are segments of a sieve of Eratosthenes
+/// rather than Euler's sieve, and none of them depend on each other.
+/// @param [in] n, m, f_vals: see { @link nut_euler_sieve_conv_u}
+/// @param [out] f_conv_u_vals: table to store values of f <*> u in
+/// @param [in] num_threads: number of threads to use, or 0 to use { @link nut_parallel_default_threads}
+/// @return true on success, false on allocation failure
+NUT_ATTR_NONNULL(3, 4)
+NUT_ATTR_ACCESS(read_only, 3, 1)
+NUT_ATTR_ACCESS(read_write, 4, 1)
+bool nut_euler_sieve_conv_u_parallel(int64_t n, int64_t m, const int64_t f_vals[static n+1], int64_t f_conv_u_vals[restrict static n+1], uint64_t num_threads);
+
+/// Parallel version of { @link nut_euler_sieve_conv_N}, see { @link nut_euler_sieve_conv_u_parallel}
+NUT_ATTR_NONNULL(3, 4)
+NUT_ATTR_ACCESS(read_only, 3, 1)
+NUT_ATTR_ACCESS(read_write, 4, 1)
+bool nut_euler_sieve_conv_N_parallel(int64_t n, int64_t m, const int64_t f_vals[static n+1], int64_t f_conv_N_vals[restrict static n+1], uint64_t num_threads);
+
+/// Parallel version of { @link nut_euler_sieve_conv}, see { @link nut_euler_sieve_conv_u_parallel}
+NUT_ATTR_NONNULL(3, 4, 5)
+NUT_ATTR_ACCESS(read_only, 3, 1)
+NUT_ATTR_ACCESS(read_only, 4, 1)
+NUT_ATTR_ACCESS(read_write, 5, 1)
+bool nut_euler_sieve_conv_parallel(int64_t n, int64_t m, const int64_t f_vals[static n+1], const int64_t g_vals[static n+1], int64_t f_conv_vals[restrict static n+1], uint64_t num_threads);
+
+/// Parallel version of { @link nut_Diri_compute_conv_u}.
+/// The sparse entries H(x/i) are independent, but entry i costs about sqrt(x/i), so the range of i is split
+/// into num_threads parts of equal total cost rather than equal length.  The dense part is computed with
+/// { @link nut_euler_sieve_conv_u_parallel}.  The result is identical to the serial version.
+/// @param [in, out] self, m, f_tbl: see { @link nut_Diri_compute_conv_u}
+/// @param [in] num_threads: number of threads to use, or 0 to use { @link nut_parallel_default_threads}
+/// @return true on success, false if the tables don't match or on allocation failure
+NUT_ATTR_NONNULL(1, 3)
+NUT_ATTR_ACCESS(read_write, 1)
+NUT_ATTR_ACCESS(read_only, 3)
+bool nut_Diri_compute_conv_u_parallel(nut_Diri *restrict self, int64_t m, const nut_Diri *restrict f_tbl, uint64_t num_threads);
+
+/// Parallel version of { @link nut_Diri_compute_conv_N}, see { @link nut_Diri_compute_conv_u_parallel}
+NUT_ATTR_NONNULL(1, 3)
+NUT_ATTR_ACCESS(read_write, 1)
+NUT_ATTR_ACCESS(read_only, 3)
+bool nut_Diri_compute_conv_N_parallel(nut_Diri *restrict self, int64_t m, const nut_Diri *restrict f_tbl, uint64_t num_threads);
+
+/// Parallel version of { @link nut_Diri_compute_conv}, see { @link nut_Diri_compute_conv_u_parallel}.
+/// Both passes over the sparse entries are split between threads, while the O(y) correction pass between them is serial.
+NUT_ATTR_NONNULL(1, 3, 4)
+NUT_ATTR_ACCESS(read_write, 1)
+NUT_ATTR_ACCESS(read_only, 3)
+NUT_ATTR_ACCESS(read_only, 4)
+bool nut_Diri_compute_conv_parallel(nut_Diri *restrict self, int64_t m, const nut_Diri *f_tbl, const nut_Diri *g_tbl, uint64_t num_threads);
+
+/// Compute the value table for f <*> u like { @link nut_Diri_compute_conv_u_parallel}, reusing the table for f <*> u at a smaller x.
+/// This is meant for searches that step x upwards, like x, 2x, 4x, ...
+/// The sparse entry H(x/i) only depends on the final values of f at quotients of x/i, so whenever self->x/i is also a sparse quotient of old,
+/// the old entry is copied instead of recomputed.  When self->x is k*old->x, this is every entry with k | i.
+/// Since (f <*> u)(n) doesn't depend on x, the dense entries up to old->y are copied and only (old->y, self->y] is found with
+/// { @link nut_euler_sieve_conv_u_window}.
+/// @param [in, out] self: the table to store the result in, initialized with self->x >= old->x and self->y >= old->y
+/// @param [in] m: modulus to reduce results by, or 0 to skip reducing.  Must be the same one old was computed with
+/// @param [in] f_tbl: table for f, with the same bounds as self
+/// @param [in] old: table for f <*> u at smaller bounds, from any of the `compute_conv_u` functions
+/// @param [in] num_threads: number of threads to use, or 0 to use { @link nut_parallel_default_threads}
+/// @return true on success, false on allocation failure or if the bounds don't match
+NUT_ATTR_NONNULL(1, 3, 4)
+NUT_ATTR_ACCESS(read_write, 1)
+NUT_ATTR_ACCESS(read_only, 3)
+NUT_ATTR_ACCESS(read_only, 4)
+bool nut_Diri_compute_conv_u_extend(nut_Diri *restrict self, int64_t m, const nut_Diri *restrict f_tbl, const nut_Diri *restrict old, uint64_t num_threads);
+
+/// Compute the value table for f <*> N reusing the table at a smaller x, see { @link nut_Diri_compute_conv_u_extend}
+NUT_ATTR_NONNULL(1, 3, 4)
+NUT_ATTR_ACCESS(read_write, 1)
+NUT_ATTR_ACCESS(read_only, 3)
+NUT_ATTR_ACCESS(read_only, 4)
+bool nut_Diri_compute_conv_N_extend(nut_Diri *restrict self, int64_t m, const nut_Diri *restrict f_tbl, const nut_Diri *restrict old, uint64_t num_threads);
+
+/// Compute the value table for f <*> g reusing the table at a smaller x, see { @link nut_Diri_compute_conv_u_extend}.
+/// Both passes over the sparse entries skip the copied ones.
+NUT_ATTR_NONNULL(1, 3, 4, 5)
+NUT_ATTR_ACCESS(read_write, 1)
+NUT_ATTR_ACCESS(read_only, 3)
+NUT_ATTR_ACCESS(read_only, 4)
+NUT_ATTR_ACCESS(read_only, 5)
+bool nut_Diri_compute_conv_extend(nut_Diri *restrict self, int64_t m, const nut_Diri *f_tbl, const nut_Diri *g_tbl, const nut_Diri *restrict old, uint64_t num_threads);
+
+/// Largest dense cutoff { @link nut_mertens_cutoff} will pick, so the dense part of the table stays within 2 GiB
+#define NUT_MERTENS_MAX_Y (INT64_C(1) << 28)
+
+/// Pick the dense cutoff y for computing the Mertens function up to x.
+/// The sparse entries cost about x/sqrt(y) in total and the dense sieve costs about y log(log(y)), so the balance point is
+/// y = c(x log(log(x)))^(2/3), where c = 1/5 was measured.
+/// @param [in] x: the argument to the Mertens function
+/// @return y, clamped to be at least sqrt(x) and at most { @link NUT_MERTENS_MAX_Y}
+NUT_ATTR_CONST
+int64_t nut_mertens_cutoff(int64_t x);
+
+/// Compute the value table for the mobius function mu(n) (whose sum is the Mertens function M), like { @link nut_Diri_compute_mertens},
+/// but without needing a precomputed mobius table, and using several threads.
+/// The dense part is found with a segmented sieve for mu, where each thread handles a contiguous range and the prefix sums are offset afterwards.
+/// Sparse entries use M(v) = 1 - sum(mu(j)floor(v/j), j <= sqrt(v)) - sum(M(v/j), 2 <= j <= sqrt(v)) + sqrt(v)M(sqrt(v)).
+/// The entry for x/i only needs entries for x/(ij), so all i in [h/2, h) can be done in parallel once every i >= h is done.
+/// With y from { @link nut_mertens_cutoff}, this takes about O(x^(2/3)) time.
+/// @param [in, out] self: the table to store the result in, and take the bounds from.  Must be initialized
+/// @param [in] m: modulus to reduce the sparse results by, or 0 to skip reducing
+/// @param [in] num_threads: number of threads to use, or 0 to use { @link nut_parallel_default_threads}
+/// @return true on success, false on allocation failure
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(read_write, 1)
+bool nut_Diri_compute_mertens_parallel(nut_Diri *self, int64_t m, uint64_t num_threads);
+
+/// Compute the value table for the mobius function like { @link nut_Diri_compute_mertens_parallel}, reusing a table for a smaller x.
+/// This is meant for searches that step x upwards, like x, 2x, 4x, ...
+/// Since mu(n) doesn't depend on x, the dense entries up to old->y are copied and only (old->y, self->y] is sieved.
+/// Any sparse entry whose quotient self->x/i is also a sparse quotient of old is copied instead of recomputed.
+/// When self->x is k*old->x, this is every entry with k | i, so doubling x saves about half of the sparse work.
+/// @param [in, out] self: the table to store the result in, and take the bounds from.  Must be initialized, with self->x >= old->x and self->y >= old->y
+/// @param [in] m: modulus to reduce the sparse results by, or 0 to skip reducing.  Must be the same one old was computed with
+/// @param [in] old: table for the mobius function from { @link nut_Diri_compute_mertens}, { @link nut_Diri_compute_mertens_parallel},
+/// or this function
+/// @param [in] num_threads: number of threads to use, or 0 to use { @link nut_parallel_default_threads}
+/// @return true on success, false on allocation failure or if the bounds of self are smaller than those of old
+NUT_ATTR_NONNULL(1, 3)
+NUT_ATTR_ACCESS(read_write, 1)
+NUT_ATTR_ACCESS(read_only, 3)
+bool nut_Diri_compute_mertens_extend(nut_Diri *restrict self, int64_t m, const nut_Diri *restrict old, uint64_t num_threads);
+
+/// Compute the Mertens function M(x) = sum(mu(n), n <= x).
+/// Makes a temporary table with y from { @link nut_mertens_cutoff} and fills it with { @link nut_Diri_compute_mertens_parallel}.
+/// @param [in] x: the argument to the Mertens function
+/// @param [in] m: modulus to reduce the result by, or 0 to skip reducing
+/// @param [in] num_threads: number of threads to use, or 0 to use { @link nut_parallel_default_threads}
+/// @param [out] out: M(x), reduced mod m if m is not 0
+/// @return true on success, false on allocation failure
+NUT_ATTR_NONNULL(4)
+NUT_ATTR_ACCESS(write_only, 4)
+bool nut_mertens(int64_t x, int64_t m, uint64_t num_threads, int64_t *out);
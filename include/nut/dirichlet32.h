@@ -0,0 +1,156 @@
+#pragma once
+
+/// @file
+/// @author hacatu
+/// @version 0.2.0
+/// @section LICENSE
+/// This Source Code Form is subject to the terms of the Mozilla Public
+/// License, v. 2.0. If a copy of the MPL was not distributed with this
+/// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+/// @section DESCRIPTION
+/// Compact Dirichlet tables for modular computations.
+///
+/// A { @link nut_Diri} stores every entry as an int64_t, but when working mod some m below 2^31 every entry is a residue that fits in
+/// 32 bits, so half of every cache line is wasted.  nut_Diri32 has exactly the same layout with uint32_t entries, so a table takes
+/// (y + yinv)*4 bytes instead of (y + yinv)*8, and y can be about twice as large for the same memory.
+/// The convolutions do the same arithmetic as their 64 bit counterparts, accumulating products of two residues in 128 bits and reducing
+/// once per entry, but they read half as much memory and reduce the 128 bit sums with 64 bit remainders, so they are also faster.
+/// Every function takes the modulus explicitly, and has specialized copies for 10^9+7 and 998244353 like the functions in
+/// { @link mod_kernels.h}.  There is no "m = 0" mode, since without a modulus the values don't fit in 32 bits.
+
+#include <inttypes.h>
+
+#include <nut/modular_math.h>
+#include <nut/dirichlet.h>
+
+/// Largest modulus supported by nut_Diri32: residues are below 2^31, so the sum of two of them fits in a uint32_t
+#define NUT_DIRI32_MAX_MODULUS (INT64_C(1) << 31)
+
+/// Compact version of { @link nut_Diri} holding residues mod some m <= { @link NUT_DIRI32_MAX_MODULUS}.
+/// Stores all values f(n) for n up to (and including) y, then stores values F(x/n) for n less than x/y
+typedef struct{
+	int64_t x;
+	int64_t y, yinv;
+	uint32_t *buf;
+} nut_Diri32;
+
+/// Allocate internal buffers for a compact diri table.
+/// See { @link nut_Diri_init}, the bounds are picked exactly the same way so tables can be converted back and forth
+/// @param [in] x: inclusive upper bound of the domain of interest
+/// @param [in] y: inclusive upper bound of the dense portion of the domain of interest, increased to sqrt(x) if needed
+/// @return true on success, false on allocation failure
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(write_only, 1)
+bool nut_Diri32_init(nut_Diri32 *self, int64_t x, int64_t y);
+
+/// Copy the values from one compact diri table to another, which must be initialized with the same bounds
+NUT_ATTR_NONNULL(1, 2)
+NUT_ATTR_ACCESS(read_write, 1)
+NUT_ATTR_ACCESS(read_only, 2)
+void nut_Diri32_copy(nut_Diri32 *restrict dest, const nut_Diri32 *restrict src);
+
+/// Deallocate internal buffers for a compact diri table
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(read_write, 1)
+void nut_Diri32_destroy(nut_Diri32 *self);
+
+NUT_ATTR_PURE
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(read_only, 1)
+static inline uint32_t nut_Diri32_get_dense(const nut_Diri32 *self, int64_t k){
+	assert(k >= 0 && k <= self->y);
+	return self->buf[k];
+}
+
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(read_write, 1)
+static inline void nut_Diri32_set_dense(nut_Diri32 *self, int64_t k, uint32_t v){
+	assert(k >= 0 && k <= self->y);
+	self->buf[k] = v;
+}
+
+NUT_ATTR_PURE
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(read_only, 1)
+static inline uint32_t nut_Diri32_get_sparse(const nut_Diri32 *self, int64_t k){
+	assert(k > 0 && k <= self->yinv);
+	return self->buf[self->y + k];
+}
+
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(read_write, 1)
+static inline void nut_Diri32_set_sparse(nut_Diri32 *self, int64_t k, uint32_t v){
+	assert(k > 0 && k <= self->yinv);
+	self->buf[self->y + k] = v;
+}
+
+/// Reduce a { @link nut_Diri} mod m into a compact table with the same bounds
+/// @param [in, out] self: the table to store the result in, initialized by { @link nut_Diri32_init} with the same x and y as src
+/// @param [in] m: modulus, between 1 and { @link NUT_DIRI32_MAX_MODULUS}
+/// @param [in] src: the table to reduce, which may have negative entries
+/// @return true on success, false if the bounds or modulus are invalid
+NUT_ATTR_NONNULL(1, 3)
+NUT_ATTR_ACCESS(read_write, 1)
+NUT_ATTR_ACCESS(read_only, 3)
+bool nut_Diri32_from_Diri(nut_Diri32 *restrict self, int64_t m, const nut_Diri *restrict src);
+
+/// Widen a compact table into a { @link nut_Diri} with the same bounds
+/// @param [in, out] self: the table to store the result in, initialized by { @link nut_Diri_init} with the same x and y as src
+/// @param [in] src: the table to widen
+/// @return true on success, false if the bounds don't match
+NUT_ATTR_NONNULL(1, 2)
+NUT_ATTR_ACCESS(read_write, 1)
+NUT_ATTR_ACCESS(read_only, 2)
+bool nut_Diri32_to_Diri(nut_Diri *restrict self, const nut_Diri32 *restrict src);
+
+/// Compute the value table for the dirichlet multiplicative identity, see { @link nut_Diri_compute_I}
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(read_write, 1)
+void nut_Diri32_compute_I(nut_Diri32 *self, int64_t m);
+
+/// Compute the value table for the unit function u(n) = 1 mod m, see { @link nut_Diri_compute_u}
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(read_write, 1)
+void nut_Diri32_compute_u(nut_Diri32 *self, int64_t m);
+
+/// Compute the value table for the identity function N(n) = n mod m, see { @link nut_Diri_compute_N}
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(read_write, 1)
+void nut_Diri32_compute_N(nut_Diri32 *self, int64_t m);
+
+/// Compute the value table for h = f <*> u, see { @link nut_Diri_compute_conv_u}
+/// @param [in, out] self: the table to store the result in, with the same bounds as f_tbl
+/// @param [in] m: modulus, between 1 and { @link NUT_DIRI32_MAX_MODULUS}, which all entries of f_tbl must already be reduced by
+/// @param [in] f_tbl: table for f
+/// @param [in] ctx: factorization data for the dense part from { @link nut_EulerCtx_init} with ctx->n >= self->y,
+/// or NULL to build a temporary one.  If none can be built (past { @link NUT_EULER_CTX_MAX_N}), the dense part is sieved in windows instead
+/// @return true on success, false on allocation failure or if the bounds or modulus are invalid
+NUT_ATTR_NONNULL(1, 3)
+NUT_ATTR_ACCESS(read_write, 1)
+NUT_ATTR_ACCESS(read_only, 3)
+bool nut_Diri32_compute_conv_u(nut_Diri32 *restrict self, int64_t m, const nut_Diri32 *restrict f_tbl, const nut_EulerCtx *ctx);
+
+/// Compute the value table for h = f <*> N, see { @link nut_Diri_compute_conv_N} and { @link nut_Diri32_compute_conv_u}
+NUT_ATTR_NONNULL(1, 3)
+NUT_ATTR_ACCESS(read_write, 1)
+NUT_ATTR_ACCESS(read_only, 3)
+bool nut_Diri32_compute_conv_N(nut_Diri32 *restrict self, int64_t m, const nut_Diri32 *restrict f_tbl, const nut_EulerCtx *ctx);
+
+/// Compute the value table for h = f <*> g, see { @link nut_Diri_compute_conv} and { @link nut_Diri32_compute_conv_u}
+NUT_ATTR_NONNULL(1, 3, 4)
+NUT_ATTR_ACCESS(read_write, 1)
+NUT_ATTR_ACCESS(read_only, 3)
+NUT_ATTR_ACCESS(read_only, 4)
+bool nut_Diri32_compute_conv(nut_Diri32 *restrict self, int64_t m, const nut_Diri32 *f_tbl, const nut_Diri32 *g_tbl, const nut_EulerCtx *ctx);
+
+/// Compute the value table for h such that f = g <*> h, see { @link nut_Diri_convdiv}
+/// @param [in, out] self: the table to store the result in, with the same bounds as f_tbl and g_tbl
+/// @param [in] m: modulus, between 1 and { @link NUT_DIRI32_MAX_MODULUS}, which all entries of f_tbl and g_tbl must already be reduced by
+/// @param [in] f_tbl: table for f
+/// @param [in] g_tbl: table for g
+/// @return true on success, false on allocation failure or if the bounds or modulus are invalid
+NUT_ATTR_NONNULL(1, 3, 4)
+NUT_ATTR_ACCESS(read_write, 1)
+NUT_ATTR_ACCESS(read_only, 3)
+NUT_ATTR_ACCESS(read_only, 4)
+bool nut_Diri32_convdiv(nut_Diri32 *restrict self, int64_t m, const nut_Diri32 *restrict f_tbl, const nut_Diri32 *restrict g_tbl);
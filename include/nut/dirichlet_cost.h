@@ -0,0 +1,121 @@
+#pragma once
+
+/// @file
+/// @author hacatu
+/// @version 0.2.0
+/// @section LICENSE
+/// This Source Code Form is subject to the terms of the Mozilla Public
+/// License, v. 2.0. If a copy of the MPL was not distributed with this
+/// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+/// @section DESCRIPTION
+/// Picking the dense cutoff y of a { @link nut_Diri} table from a cost model.
+///
+/// Every operation on a table splits its time between the dense part, which grows with y, and the sparse part, which shrinks as y grows.
+/// For the convolutions, the dense part is a sieve costing about y (or y log(y) for { @link nut_Diri_convdiv}), and the sparse part costs about sum(sqrt(x/i), i < x/y) = 2x/sqrt(y),
+/// so the best y is around x^(2/3), but the constants depend on the operation, on whether results are reduced by a modulus, and on the machine.
+/// Lucy's algorithm for pi has a dense part costing about y^(3/2)/log(y), so it wants y much closer to sqrt(x);
+/// { @link nut_Diri_compute_pi} only runs it up to 2sqrt(x) and fills the rest of the dense part with a segmented sieve costing about y.
+///
+/// A { @link nut_DiriCostModel} stores two coefficients per operation, one for the dense shape and one for the sparse shape, in seconds per unit.
+/// { @link nut_DiriCostModel_calibrate} fits them by timing each operation at two values of y, and the result can be saved
+/// with { @link nut_DiriCostModel_save} so that it only has to be measured once per machine (the `diri_calibrate` program does this).
+/// Then { @link nut_Diri_auto_y} picks the y minimizing the predicted time for a weighted mix of operations, subject to a memory cap.
+
+#include <inttypes.h>
+#include <stddef.h>
+
+#include <nut/modular_math.h>
+#include <nut/dirichlet.h>
+
+/// Operations the cost model knows about
+typedef enum{
+	/// { @link nut_Diri_compute_conv}
+	NUT_DIRI_OP_CONV,
+	/// { @link nut_Diri_compute_conv_u}, and { @link nut_Diri_compute_conv_N} which costs about the same
+	NUT_DIRI_OP_CONV_U,
+	/// { @link nut_Diri_convdiv}
+	NUT_DIRI_OP_CONVDIV,
+	/// { @link nut_Diri_compute_pi}, which never reduces by a modulus
+	NUT_DIRI_OP_PI,
+	/// { @link nut_Diri_compute_mertens_parallel} with one thread
+	NUT_DIRI_OP_MERTENS,
+	NUT_DIRI_NUM_OPS
+} nut_DiriOp;
+
+/// Coefficients of the cost model, indexed by operation and then by whether the operation reduces by a modulus (m != 0).
+/// The predicted time for an operation is dense[op][mod]*D(y) + sparse[op][mod]*S(x, y) seconds, where D and S are the shapes
+/// described in { @link dirichlet_cost.h}
+typedef struct{
+	double dense[NUT_DIRI_NUM_OPS][2];
+	double sparse[NUT_DIRI_NUM_OPS][2];
+} nut_DiriCostModel;
+
+/// How often each operation will be run on tables with the chosen bounds
+typedef struct{
+	/// Relative weight of each operation, eg 3 for NUT_DIRI_OP_CONV_U when computing d3 one convolution at a time
+	double weight[NUT_DIRI_NUM_OPS];
+	/// Modulus the operations reduce by, or 0
+	int64_t m;
+} nut_DiriOpMix;
+
+/// Name of each operation, as used in files written by { @link nut_DiriCostModel_save}
+extern const char *const nut_diri_op_names[NUT_DIRI_NUM_OPS];
+
+/// Cost model measured with { @link nut_DiriCostModel_calibrate} on an x86_64 machine, used when no calibrated model is given
+extern const nut_DiriCostModel nut_diri_default_cost_model;
+
+/// Predict the time an operation takes on a table with bounds x and y
+/// @param [in] self: cost model
+/// @param [in] op: the operation
+/// @param [in] m: modulus the operation reduces by, or 0
+/// @param [in] x, y: bounds of the table
+/// @return predicted time in seconds
+NUT_ATTR_PURE
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(read_only, 1)
+double nut_DiriCostModel_predict(const nut_DiriCostModel *self, nut_DiriOp op, int64_t m, int64_t x, int64_t y);
+
+/// Fit a cost model by timing every operation, with and without a modulus, at two values of y for the given x.
+/// If a fit comes out negative (for example because the machine was busy), the coefficients from { @link nut_diri_default_cost_model} are kept for that operation.
+/// @param [out] self: cost model to store the coefficients in
+/// @param [in] x: bound to time the operations at, or 0 to use 10^10, which takes a few seconds
+/// @return true on success, false on allocation failure
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(write_only, 1)
+bool nut_DiriCostModel_calibrate(nut_DiriCostModel *self, int64_t x);
+
+/// Write a cost model to a text file
+/// @return true on success, false if the file could not be written
+NUT_ATTR_NONNULL(1, 2)
+NUT_ATTR_ACCESS(read_only, 1)
+NUT_ATTR_ACCESS(read_only, 2)
+bool nut_DiriCostModel_save(const nut_DiriCostModel *restrict self, const char *restrict path);
+
+/// Read a cost model written by { @link nut_DiriCostModel_save}
+/// @return true on success, false if the file could not be read or is not a cost model
+NUT_ATTR_NONNULL(1, 2)
+NUT_ATTR_ACCESS(write_only, 1)
+NUT_ATTR_ACCESS(read_only, 2)
+bool nut_DiriCostModel_load(nut_DiriCostModel *restrict self, const char *restrict path);
+
+/// Pick the dense cutoff y minimizing the predicted time of a mix of operations.
+/// @param [in] x: upper bound of the tables
+/// @param [in] mix: how often each operation will be run
+/// @param [in] mem_budget: largest size in bytes of one table, or 0 for no limit
+/// @param [in] model: cost model, or NULL to use { @link nut_diri_default_cost_model}
+/// @return the best y, which is at least sqrt(x), or 0 if even y = sqrt(x) does not fit in mem_budget
+NUT_ATTR_PURE
+NUT_ATTR_NONNULL(2)
+NUT_ATTR_ACCESS(read_only, 2)
+NUT_ATTR_ACCESS(read_only, 4)
+int64_t nut_Diri_auto_y(int64_t x, const nut_DiriOpMix *mix, size_t mem_budget, const nut_DiriCostModel *model);
+
+/// Initialize a table with y from { @link nut_Diri_auto_y}
+/// @param [out] self: the table to initialize, see { @link nut_Diri_init}
+/// @param [in] x, mix, mem_budget, model: see { @link nut_Diri_auto_y}
+/// @return true on success, false on allocation failure or if no y fits in mem_budget
+NUT_ATTR_NONNULL(1, 3)
+NUT_ATTR_ACCESS(write_only, 1)
+NUT_ATTR_ACCESS(read_only, 3)
+NUT_ATTR_ACCESS(read_only, 5)
+bool nut_Diri_init_auto(nut_Diri *self, int64_t x, const nut_DiriOpMix *mix, size_t mem_budget, const nut_DiriCostModel *model);
@@ -0,0 +1,99 @@
+#pragma once
+
+/// @file
+/// @author hacatu
+/// @version 0.2.0
+/// @section LICENSE
+/// This Source Code Form is subject to the terms of the Mozilla Public
+/// License, v. 2.0. If a copy of the MPL was not distributed with this
+/// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+/// @section DESCRIPTION
+/// Exact Dirichlet tables by the Chinese remainder theorem.
+///
+/// With m = 0, the { @link nut_Diri} functions work with wrapping 64 bit arithmetic, so sums like those of N^k or d_k silently overflow
+/// once they pass 2^63.  Instead, the same computation can be done mod a few primes and the exact values reconstructed with Garner's algorithm.
+/// The kernels in { @link mod_kernels.h} need m^2 to fit in an int64_t, so the primes are the largest ones below
+/// { @link NUT_MOD_KERNELS_MAX_MODULUS}, about 2^31.5 each, and up to { @link NUT_DIRI_CRT_MAX_MODULI} of them give signed results of up to
+/// about 125 bits, stored in a { @link nut_Diri128}.  The computations for the different primes are independent, so they run in parallel.
+
+#include <inttypes.h>
+
+#include <nut/modular_math.h>
+#include <nut/dirichlet.h>
+
+/// Most moduli { @link nut_Diri128_compute_exact} will use, which is as many as fit in an int128_t
+#define NUT_DIRI_CRT_MAX_MODULI 4
+
+/// The primes used by { @link nut_Diri128_compute_exact}, in the order they are used
+extern const int64_t nut_Diri_crt_moduli[NUT_DIRI_CRT_MAX_MODULI];
+
+/// Dirichlet table with 128 bit entries, with the same layout as { @link nut_Diri}
+typedef struct{
+	int64_t x;
+	int64_t y, yinv;
+	int128_t *buf;
+} nut_Diri128;
+
+/// Computation of a table mod m, which { @link nut_Diri128_compute_exact} calls once per modulus.
+/// It can be called from several threads at once, with different out tables.
+/// @param [in, out] out: initialized table to store the result in
+/// @param [in] m: modulus to reduce by
+/// @param [in] data: user data
+/// @return true on success, false on failure
+typedef bool (*nut_Diri_mod_fn)(nut_Diri *restrict out, int64_t m, void *data);
+
+/// Allocate internal buffers for a 128 bit diri table, see { @link nut_Diri_init}
+/// @return true on success, false on allocation failure
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(write_only, 1)
+bool nut_Diri128_init(nut_Diri128 *self, int64_t x, int64_t y);
+
+/// Deallocate internal buffers for a 128 bit diri table
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(read_write, 1)
+void nut_Diri128_destroy(nut_Diri128 *self);
+
+NUT_ATTR_PURE
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(read_only, 1)
+static inline int128_t nut_Diri128_get_dense(const nut_Diri128 *self, int64_t k){
+	assert(k >= 0 && k <= self->y);
+	return self->buf[k];
+}
+
+NUT_ATTR_PURE
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(read_only, 1)
+static inline int128_t nut_Diri128_get_sparse(const nut_Diri128 *self, int64_t k){
+	assert(k > 0 && k <= self->yinv);
+	return self->buf[self->y + k];
+}
+
+/// Find how many moduli are needed to recover values of absolute value up to 2^log2_bound
+/// @param [in] log2_bound: base 2 log of a bound on the absolute value of every entry of the table
+/// @return number of moduli, or 0 if the values could be too large even for { @link NUT_DIRI_CRT_MAX_MODULI} moduli
+NUT_ATTR_CONST
+uint64_t nut_Diri_crt_num_moduli(double log2_bound);
+
+/// Bound for tables of N^k: every entry is at most sum(n^k, n <= x) <= x^(k + 1)
+/// @return base 2 log of the bound, for { @link nut_Diri_crt_num_moduli}
+NUT_ATTR_CONST
+double nut_Diri_log2_bound_Nk(int64_t x, uint64_t k);
+
+/// Bound for tables of d_k: every entry is at most sum(d_k(n), n <= x) <= x(1 + ln(x))^(k - 1)
+/// @return base 2 log of the bound, for { @link nut_Diri_crt_num_moduli}
+NUT_ATTR_CONST
+double nut_Diri_log2_bound_dk(int64_t x, uint64_t k);
+
+/// Compute a table exactly by running a modular computation for several primes and combining the results with Garner's algorithm.
+/// Values are reconstructed in the symmetric range, so negative values (like those of the Mertens function) come out right.
+/// @param [in, out] self: the table to store the result in, initialized by { @link nut_Diri128_init}
+/// @param [in] log2_bound: base 2 log of a bound on the absolute value of every entry, which decides how many moduli are used,
+/// see { @link nut_Diri_log2_bound_Nk} and { @link nut_Diri_log2_bound_dk}
+/// @param [in] fn: computation to run for each modulus, with output tables of the same x and y as self
+/// @param [in] data: passed through to fn
+/// @param [in] num_threads: number of threads to split the moduli between, or 0 to use { @link nut_parallel_default_threads}
+/// @return true on success, false on allocation failure, if fn fails, or if log2_bound is too large
+NUT_ATTR_NONNULL(1, 3)
+NUT_ATTR_ACCESS(read_write, 1)
+bool nut_Diri128_compute_exact(nut_Diri128 *self, double log2_bound, nut_Diri_mod_fn fn, void *data, uint64_t num_threads);
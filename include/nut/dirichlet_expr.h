@@ -0,0 +1,123 @@
+#pragma once
+
+/// @file
+/// @author hacatu
+/// @version 0.2.0
+/// @section LICENSE
+/// This Source Code Form is subject to the terms of the Mozilla Public
+/// License, v. 2.0. If a copy of the MPL was not distributed with this
+/// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+/// @section DESCRIPTION
+/// Lazy expressions over Dirichlet tables.
+///
+/// Many computations need the table for a product like f <*> g <*> mu or d_k <*> chi, and doing this one convolution at a time
+/// means allocating a temporary { @link nut_Diri} for every intermediate result.
+/// Instead, build a small expression tree out of { @link nut_DiriExpr} nodes (which don't allocate anything, so they can live on the stack)
+/// and pass it to { @link nut_DiriExpr_eval}, which
+/// - flattens the tree into a product of leaf factors with integer exponents, cancelling factors that appear on both sides of a division,
+/// - plans the numerator and the denominator products, each as a chain of passes that multiply one factor into a running product:
+///   - a power u^k is either k passes with { @link nut_Diri_compute_conv_u}, or is computed by binary exponentiation with
+///     { @link nut_Diri_compute_dk_ctx} and starts the chain, whichever { @link nut_diri_default_cost_model} predicts is faster,
+///   - otherwise the chain starts from a leaf table if there is one, since that costs nothing, or else from u or N, which have closed forms,
+///   - the remaining passes run in order of predicted cost: u and N with { @link nut_Diri_compute_conv_u} and { @link nut_Diri_compute_conv_N},
+///     which use closed forms for their sums instead of materializing a table, then general convolutions with leaf tables,
+///     then N^k, which has to be materialized first,
+/// - divides the numerator by the denominator with a single { @link nut_Diri_convdiv},
+/// - shares one { @link nut_EulerCtx} between every pass (or, past { @link NUT_EULER_CTX_MAX_N}, lets every pass sieve on its own),
+///   and ping-pongs between the output and a pool of temporary tables.
+///   The pool grows as needed, but since the tree is flattened first, only about five temporaries exist at once no matter how deep it is.
+///
+/// Since the factors are reordered freely, every leaf must be a multiplicative function, which the dense part of the convolutions
+/// assumes anyway.
+
+#include <inttypes.h>
+
+#include <nut/modular_math.h>
+#include <nut/dirichlet.h>
+
+/// Kinds of nodes in a { @link nut_DiriExpr}
+typedef enum{
+	/// A precomputed table, which must have the same bounds as the output
+	NUT_DIRI_EXPR_TABLE,
+	/// The Dirichlet identity I
+	NUT_DIRI_EXPR_I,
+	/// The unit function u(n) = 1
+	NUT_DIRI_EXPR_U,
+	/// The identity function N(n) = n
+	NUT_DIRI_EXPR_N,
+	/// The power function N^k(n) = n^k
+	NUT_DIRI_EXPR_NK,
+	/// The Mobius function, the Dirichlet inverse of u
+	NUT_DIRI_EXPR_MU,
+	/// Dirichlet convolution a <*> b
+	NUT_DIRI_EXPR_CONV,
+	/// Dirichlet division, the h with a = b <*> h
+	NUT_DIRI_EXPR_CONVDIV,
+} nut_DiriExprKind;
+
+/// Node in a lazy Dirichlet expression.
+/// Nodes only point to their children and leaf tables, and never own them, so expressions are usually built on the stack with
+/// { @link nut_DiriExpr_table}, { @link nut_DiriExpr_conv}, and so on.
+typedef struct nut_DiriExpr nut_DiriExpr;
+struct nut_DiriExpr{
+	nut_DiriExprKind kind;
+	/// exponent for NUT_DIRI_EXPR_NK
+	uint64_t k;
+	/// table for NUT_DIRI_EXPR_TABLE
+	const nut_Diri *tbl;
+	/// operands for NUT_DIRI_EXPR_CONV and NUT_DIRI_EXPR_CONVDIV
+	const nut_DiriExpr *a, *b;
+};
+
+/// Leaf node for a precomputed table
+NUT_ATTR_NONNULL(1)
+static inline nut_DiriExpr nut_DiriExpr_table(const nut_Diri *tbl){
+	return (nut_DiriExpr){.kind = NUT_DIRI_EXPR_TABLE, .tbl = tbl};
+}
+
+/// Leaf node for the Dirichlet identity I
+static inline nut_DiriExpr nut_DiriExpr_I(){
+	return (nut_DiriExpr){.kind = NUT_DIRI_EXPR_I};
+}
+
+/// Leaf node for the unit function u
+static inline nut_DiriExpr nut_DiriExpr_u(){
+	return (nut_DiriExpr){.kind = NUT_DIRI_EXPR_U};
+}
+
+/// Leaf node for the identity function N
+static inline nut_DiriExpr nut_DiriExpr_N(){
+	return (nut_DiriExpr){.kind = NUT_DIRI_EXPR_N};
+}
+
+/// Leaf node for the power function N^k, see { @link nut_Diri_compute_Nk}
+static inline nut_DiriExpr nut_DiriExpr_Nk(uint64_t k){
+	return (nut_DiriExpr){.kind = NUT_DIRI_EXPR_NK, .k = k};
+}
+
+/// Leaf node for the Mobius function
+static inline nut_DiriExpr nut_DiriExpr_mu(){
+	return (nut_DiriExpr){.kind = NUT_DIRI_EXPR_MU};
+}
+
+/// Node for a <*> b
+NUT_ATTR_NONNULL(1, 2)
+static inline nut_DiriExpr nut_DiriExpr_conv(const nut_DiriExpr *a, const nut_DiriExpr *b){
+	return (nut_DiriExpr){.kind = NUT_DIRI_EXPR_CONV, .a = a, .b = b};
+}
+
+/// Node for the h with a = b <*> h, see { @link nut_Diri_convdiv}
+NUT_ATTR_NONNULL(1, 2)
+static inline nut_DiriExpr nut_DiriExpr_convdiv(const nut_DiriExpr *a, const nut_DiriExpr *b){
+	return (nut_DiriExpr){.kind = NUT_DIRI_EXPR_CONVDIV, .a = a, .b = b};
+}
+
+/// Evaluate a lazy expression into a table
+/// @param [in, out] self: the table to store the result in, initialized by { @link nut_Diri_init}.  Must not be a leaf of expr
+/// @param [in] m: modulus to reduce the result by, or 0 to skip reducing.  All leaf tables must already be reduced by it
+/// @param [in] expr: root of the expression
+/// @return true on success, false on allocation failure or if some leaf table has different bounds than self
+NUT_ATTR_NONNULL(1, 3)
+NUT_ATTR_ACCESS(read_write, 1)
+NUT_ATTR_ACCESS(read_only, 3)
+bool nut_DiriExpr_eval(nut_Diri *restrict self, int64_t m, const nut_DiriExpr *expr);
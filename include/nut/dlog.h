@@ -0,0 +1,104 @@
+#pragma once
+
+/// @file
+/// @author hacatu
+/// @version 0.2.0
+/// @section LICENSE
+/// This Source Code Form is subject to the terms of the Mozilla Public
+/// License, v. 2.0. If a copy of the MPL was not distributed with this
+/// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+/// @section DESCRIPTION
+/// Discrete logarithms mod 64 bit integers, using Pohlig-Hellman to reduce to subgroups of prime order,
+/// which are solved with baby step giant step or Pollard's rho algorithm for logarithms.
+
+#include <inttypes.h>
+
+#include <nut/modular_math.h>
+#include <nut/factorization.h>
+
+/// Subgroups of prime order at most this large are solved with baby step giant step, which needs
+/// about sqrt(q) table entries.  Larger ones use Pollard's rho algorithm for logarithms, which needs no memory.
+#define NUT_DLOG_BSGS_MAX (UINT64_C(1) << 36)
+
+/// Entry of a baby step table: a power of the subgroup generator and its exponent plus 1 (0 marks an empty slot)
+typedef struct{
+	uint64_t value;
+	uint64_t exponent;
+} nut_DlogEntry;
+
+/// Precomputed data for one prime q dividing the order of the base
+typedef struct{
+	uint64_t prime;
+	uint64_t power;
+	/// g^(order/q^power), which generates the q-part of the group generated by g
+	uint64_t g_q;
+	/// Inverse of g_q
+	uint64_t g_q_inv;
+	/// g^(order/q), which has order q
+	uint64_t gamma;
+	/// gamma^-baby_steps, the giant step
+	uint64_t giant;
+	/// Number of baby steps, ceil(sqrt(q)), or 0 if this subgroup is solved with Pollard's rho
+	uint64_t baby_steps;
+	/// Offset of the baby step hash table in the arena, and its size minus 1 (the size is a power of 2)
+	uint64_t table_offset, table_mask;
+} nut_DlogSubgroup;
+
+/// Precomputed data for taking many logarithms to the same base mod the same n.
+/// All residues are kept in Montgomery form when n is odd.
+/// The baby step tables for all subgroups share one allocation, and once initialized the context is not modified,
+/// so it can be used from many threads at once.
+typedef struct{
+	uint64_t n;
+	/// The base, as passed to { @link nut_DlogCtx_init}
+	uint64_t g;
+	/// The multiplicative order of g mod n
+	uint64_t order;
+	/// Montgomery constants if n is odd.  If n is even, only n and one are set, and plain 128 bit remainders are used
+	nut_Montgomery mont;
+	bool odd;
+	uint64_t num_primes;
+	nut_DlogSubgroup subgroups[NUT_MAX_PRIMES_64];
+	/// Baby step hash tables for all subgroups
+	nut_DlogEntry *arena;
+} nut_DlogCtx;
+
+/// Set up a context for taking discrete logarithms to base g mod n.
+/// n and the Carmichael function of n are factored with { @link nut_u64_factor_heuristic}, the order of g is found
+/// with { @link nut_u64_orders_mod}, and then a baby step table is built for every prime dividing the order
+/// which is at most { @link NUT_DLOG_BSGS_MAX}.
+/// @param [out] self: context to initialize.  Must be freed with { @link nut_DlogCtx_destroy}
+/// @param [in] g: the base, must be a unit mod n
+/// @param [in] n: the modulus, must be positive
+/// @return true on success, false if g is not a unit mod n, n could not be factored, or allocation failed
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(write_only, 1)
+bool nut_DlogCtx_init(nut_DlogCtx *self, uint64_t g, uint64_t n);
+
+/// Free the resources held by a discrete logarithm context
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(read_write, 1)
+void nut_DlogCtx_destroy(nut_DlogCtx *self);
+
+/// Find the discrete logarithm of h to the base of a context.
+/// Pohlig-Hellman splits the problem into one problem per prime q dividing the order of g, each of which is solved one
+/// base q digit at a time with a logarithm in the subgroup of order q.  The results are combined with the Chinese Remainder Theorem.
+/// @param [in] self: context from { @link nut_DlogCtx_init}
+/// @param [in] h: number to find the logarithm of
+/// @param [out] x: the smallest nonnegative x with g^x = h mod n, if there is one
+/// @return true if x was found, false if h is not a power of g mod n
+NUT_ATTR_NONNULL(1, 3)
+NUT_ATTR_ACCESS(read_only, 1)
+NUT_ATTR_ACCESS(write_only, 3)
+bool nut_DlogCtx_log(const nut_DlogCtx *restrict self, uint64_t h, uint64_t *restrict x);
+
+/// Find the discrete logarithm of h to base g mod n.
+/// Sets up a temporary { @link nut_DlogCtx}, so if many logarithms to the same base are needed, use that directly instead.
+/// @param [in] g: the base, must be a unit mod n
+/// @param [in] h: number to find the logarithm of
+/// @param [in] n: the modulus
+/// @param [out] x: the smallest nonnegative x with g^x = h mod n, if there is one
+/// @return true if x was found, false if h is not a power of g mod n or any of the cases where { @link nut_DlogCtx_init} fails
+NUT_ATTR_NONNULL(4)
+NUT_ATTR_ACCESS(write_only, 4)
+bool nut_u64_dlog(uint64_t g, uint64_t h, uint64_t n, uint64_t *x);
@@ -0,0 +1,128 @@
+#pragma once
+
+/// @file
+/// @author hacatu
+/// @version 0.2.0
+/// @section LICENSE
+/// This Source Code Form is subject to the terms of the Mozilla Public
+/// License, v. 2.0. If a copy of the MPL was not distributed with this
+/// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+/// @section DESCRIPTION
+/// An opt-in cache of factorizations to put in front of { @link nut_u64_factor_heuristic }
+/// when the same numbers are factored over and over (eg p-1 and p+1 for primes in overlapping windows).
+/// Repeated lookups cost a hash probe instead of a Pollard-Rho-Brent or Lenstra run.
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include <nut/modular_math.h>
+#include <nut/factorization.h>
+
+/// Most distinct primes below 2^32 a cached factorization can have.
+/// Numbers with more are simply not cached, which only affects n over about 7*10^12.
+#define NUT_FACTOR_CACHE_MAX_PRIMES 11
+
+/// Number of entries in each bucket of a { @link nut_FactorCache }.
+/// Entries are 64 bytes, so a bucket spans 8 cache lines.
+#define NUT_FACTOR_CACHE_WAYS 8
+
+/// A compact factorization taking exactly one cache line.
+/// Since n < 2^64, at most one prime factor of n is at least 2^32, and it can only appear to the first power,
+/// so only the primes below 2^32 are stored and the large prime (if any) is recovered as n divided by the rest.
+typedef struct{
+	/// The number whose factorization this is, or 0 if the entry is empty
+	uint64_t n;
+	/// Prime factors of n below 2^32, in increasing order
+	uint32_t primes[NUT_FACTOR_CACHE_MAX_PRIMES];
+	/// Powers of the primes in primes
+	uint8_t powers[NUT_FACTOR_CACHE_MAX_PRIMES];
+	/// Low 4 bits are the number of primes stored, high bit is the CLOCK reference bit
+	uint8_t info;
+} nut_FactorCacheEntry;
+
+/// One lock stripe of a { @link nut_FactorCache }.
+/// Each shard is an independent set associative table with { @link NUT_FACTOR_CACHE_WAYS } entries per bucket,
+/// evicting within a bucket using the CLOCK (second chance) algorithm.
+typedef struct{
+	pthread_mutex_t lock;
+	/// num_buckets*NUT_FACTOR_CACHE_WAYS entries
+	nut_FactorCacheEntry *entries;
+	/// CLOCK hand for each bucket
+	uint8_t *hands;
+	/// Number of lookups in this shard that found / did not find an entry
+	uint64_t hits, misses;
+} nut_FactorCacheShard;
+
+/// Sharded, lock striped cache of factorizations.
+/// n is hashed to pick a shard and a bucket within it, so threads factoring different numbers rarely contend.
+typedef struct{
+	/// Number of shards, a power of 2
+	uint64_t num_shards;
+	/// Number of buckets per shard, a power of 2
+	uint64_t num_buckets;
+	nut_FactorCacheShard *shards;
+} nut_FactorCache;
+
+/// Set up a factorization cache.
+/// @param [out] self: the cache to initialize.  Must be freed with { @link nut_FactorCache_destroy }
+/// @param [in] max_bytes: memory cap for the entries.  The number of buckets is rounded down to a power of 2
+/// per shard, so the actual size can be up to half this.  At least one bucket per shard is always allocated.
+/// @param [in] num_shards: number of independently locked shards, rounded up to a power of 2.
+/// A few times the number of threads that will use the cache is a good choice.  0 is treated as 1.
+/// @return true on success, false on allocation failure
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(write_only, 1)
+bool nut_FactorCache_init(nut_FactorCache *self, size_t max_bytes, uint64_t num_shards);
+
+/// Free the resources held by a factorization cache.
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(read_write, 1)
+void nut_FactorCache_destroy(nut_FactorCache *self);
+
+/// Look up the factorization of n in the cache.
+/// @param [in,out] self: cache to search.  The reference bit of the entry and the hit/miss counters are updated
+/// @param [in] n: number to look up
+/// @param [out] factors: output, must have room for { @link NUT_MAX_PRIMES_64 } primes
+/// (or fewer if n is known to be smaller).  Not modified if n is not found
+/// @return true if n was found and its factorization was stored in factors, false otherwise
+NUT_ATTR_NONNULL(1, 3)
+NUT_ATTR_ACCESS(read_write, 1)
+NUT_ATTR_ACCESS(read_write, 3)
+bool nut_FactorCache_lookup(nut_FactorCache *restrict self, uint64_t n, nut_Factors *restrict factors);
+
+/// Add the complete factorization of n to the cache, evicting an older entry if its bucket is full.
+/// If n is already present or has more than { @link NUT_FACTOR_CACHE_MAX_PRIMES } distinct primes below 2^32, nothing happens.
+/// @param [in,out] self: cache to add to
+/// @param [in] n: number to add
+/// @param [in] factors: complete factorization of n, sorted by prime
+NUT_ATTR_NONNULL(1, 3)
+NUT_ATTR_ACCESS(read_write, 1)
+NUT_ATTR_ACCESS(read_only, 3)
+void nut_FactorCache_insert(nut_FactorCache *restrict self, uint64_t n, const nut_Factors *restrict factors);
+
+/// Get the total number of hits and misses across all shards
+/// @param [in,out] self: cache to get the counters of (the shard locks are taken)
+/// @param [out] hits, misses: the number of calls to { @link nut_FactorCache_lookup } which found / did not find their argument
+NUT_ATTR_NONNULL(1, 2, 3)
+NUT_ATTR_ACCESS(read_write, 1)
+NUT_ATTR_ACCESS(write_only, 2)
+NUT_ATTR_ACCESS(write_only, 3)
+void nut_FactorCache_stats(nut_FactorCache *restrict self, uint64_t *restrict hits, uint64_t *restrict misses);
+
+/// Factor a number, using a cache to avoid repeating work.
+///
+/// Works exactly like { @link nut_u64_factor_heuristic }, except that the cache is checked first,
+/// and complete factorizations are added to the cache afterwards.
+/// Any number of threads can call this with the same cache at once.
+/// @param [in,out] cache: cache to use
+/// @param [in] n, num_primes, primes, conf: see { @link nut_u64_factor_heuristic }
+/// @param [out] factors: output
+/// @return n with all factors found and stored in factors divided out.  Thus if n factors completely, 1 is returned.
+NUT_ATTR_NODISCARD
+NUT_ATTR_NONNULL(1, 5, 6)
+NUT_ATTR_ACCESS(read_write, 1)
+NUT_ATTR_ACCESS(read_only, 4, 3)
+NUT_ATTR_ACCESS(read_only, 5)
+NUT_ATTR_ACCESS(read_write, 6)
+uint64_t nut_u64_factor_heuristic_cached(nut_FactorCache *restrict cache, uint64_t n, uint64_t num_primes, const uint64_t primes[restrict static num_primes], const nut_FactorConf *restrict conf, nut_Factors *restrict factors);
@@ -55,15 +55,16 @@ typedef struct{
 	uint64_t pollard_stride;
 	/// Use lenstra ecf when factoring numbers at most this large.
 	/// 0 to disable lenstra ecf, UINT64_MAX to always use lenstra above pollard_max.
-	/// Currently this is the fastest method implemented for large numbers so any number larger than this might not
+	/// Numbers larger than this go to the quadratic sieve if they are at most qsieve_max, otherwise they might not
 	/// be fully factored.  Also note that the factoring algorithms provided may fail with overflow for numbers larger
 	/// than 2^30.
 	uint64_t lenstra_max;
 	/// Factorial smoothness bound for Lenstra ecf.
 	/// P <- 2P through P <- kP are computed when searching for a nontrival factor, where k is this bound.
 	uint64_t lenstra_bfac;
-	/// Currently unused.
-	/// Will be the last number for which the quadratic sieve is used, after which the number field sieve is used.
+	/// Use the self initializing quadratic sieve ({ @link nut_u128_factor1_siqs }) when factoring numbers larger than
+	/// lenstra_max and at most this large.
+	/// Since lenstra_max takes priority, lenstra_max must be lowered (eg to 2^60) for this to have any effect.
 	uint64_t qsieve_max;
 } nut_FactorConf;
 
@@ -194,6 +195,43 @@ NUT_ATTR_NONNULL(4)
 NUT_ATTR_ACCESS(read_write, 4)
 uint64_t nut_u64_order_mod(uint64_t a, uint64_t n, uint64_t cn, nut_Factors *cn_factors);
 
+/// Find the multiplicative orders of many numbers mod the same n.
+/// For each prime power q^e exactly dividing cn, a^(cn/q^e) is computed, and then raised to q until it is 1 to get
+/// the q-part of the order.  All of the a^(cn/q^e) are found together with a product tree over the prime powers, which takes
+/// O(log(cn) log(omega)) multiplications instead of O(log(cn) omega).  Odd n use Montgomery multiplication.
+/// Unlike { @link nut_u64_order_mod}, cn_factors is not modified, so it can be shared between calls and threads.
+/// @param [in] n: the modulus
+/// @param [in] cn: a multiple of the order of every unit mod n, typically the carmichael function of n
+/// @param [in] cn_factors: the factorization of cn
+/// @param [in] count: the number of bases
+/// @param [in] as: the bases to find the orders of
+/// @param [out] out: out[i] is set to the order of as[i] mod n, or 0 if as[i] is not a unit mod n
+/// (or its order does not divide cn)
+NUT_ATTR_NONNULL(3, 5, 6)
+NUT_ATTR_ACCESS(read_only, 3)
+NUT_ATTR_ACCESS(read_only, 5, 4)
+NUT_ATTR_ACCESS(write_only, 6, 4)
+void nut_u64_orders_mod(uint64_t n, uint64_t cn, const nut_Factors *restrict cn_factors, uint64_t count, const uint64_t as[restrict static count], uint64_t out[restrict static count]);
+
+/// Find the smallest primitive root mod n, that is, a generator of the multiplicative group mod n.
+/// These only exist if n is 1, 2, 4, p^k, or 2p^k for an odd prime p.
+/// n is factored, then p - 1 is factored, and candidates are tested using the same product tree as
+/// { @link nut_u64_orders_mod}.
+/// @param [in] n: the modulus
+/// @return the smallest primitive root mod n, or 0 if there is none (or n is 1, where 0 is the only residue)
+uint64_t nut_u64_primitive_root(uint64_t n);
+
+/// Find all primitive roots mod n.
+/// After finding one primitive root g with { @link nut_u64_primitive_root}, the rest are g^k for k coprime to phi(n).
+/// This takes O(phi(n)) time and phi(n) bytes of temporary memory, so it is only suitable for moderate n.
+/// @param [in] n: the modulus
+/// @param [out] count: the number of primitive roots (phi(phi(n)) if there are any, otherwise 0)
+/// @return a sorted array of all primitive roots mod n, which must be freed by the caller,
+/// or NULL if there are none or allocation failed
+NUT_ATTR_NONNULL(2)
+NUT_ATTR_ACCESS(write_only, 2)
+uint64_t *nut_u64_primitive_roots(uint64_t n, uint64_t *restrict count);
+
 /// Call { @link forall_divisors} with temporarily allocated dfactors and pfactors structs.
 NUT_ATTR_NONNULL(1, 2)
 NUT_ATTR_ACCESS(read_only, 1)
@@ -237,6 +275,83 @@ NUT_ATTR_ACCESS(read_write, 5)
 NUT_ATTR_ACCESS(read_write, 6)
 int nut_Factor_forall_divs_le(const nut_Factors *restrict factors, uint64_t d_max, int (*f)(const nut_Factors*, uint64_t, void*), void *restrict data, nut_Factors *restrict dfactors, nut_Factors *restrict pfactors);
 
+/// Write all divisors of a number into an array, given its factorization.
+/// Unlike { @link nut_Factor_forall_divs }, there is no callback, so loops over the result can be inlined and vectorized.
+/// The unsorted order is built multiplicatively: starting from [1], for each prime p^e the current list is extended by
+/// p times itself, p^2 times itself, etc.
+/// The sorted order is built the same way, but each extension is merged in place from the back,
+/// taking O(d*e) time for a prime with power e, where d is the number of divisors so far.
+/// No memory is allocated.
+/// @param [in] factors: the factorization of n for which to compute all divisors
+/// @param [out] out: output array, must have room for { @link nut_Factor_divcount }(factors) entries
+/// @param [in] sorted: if true, the divisors are written in increasing order, otherwise in an unspecified order
+/// (which is the same every time for the same factors)
+/// @return the number of divisors written
+NUT_ATTR_NONNULL(1, 2)
+NUT_ATTR_ACCESS(read_only, 1)
+NUT_ATTR_ACCESS(write_only, 2)
+uint64_t nut_Factor_divisors(const nut_Factors *restrict factors, uint64_t out[restrict], bool sorted);
+
+/// Stateful iterator over the divisors of a number, an alternative to { @link nut_Factor_forall_divs_le } that
+/// lets the loop body live in the caller.
+/// Divisors are visited in the same odometer order as { @link nut_Factor_forall_divs_le }, and the exponents of the
+/// current divisor are available in powers, so the factorization of each divisor can be used without a dfactors buffer.
+/// Use as `for(uint64_t d; nut_DivIt_next(&it, &d);){...}` after { @link nut_DivIt_init }.
+typedef struct{
+	uint64_t num_primes;
+	/// Divisor most recently returned by { @link nut_DivIt_next }, or 0 if it hasn't been called yet
+	uint64_t d;
+	/// Divisors larger than this are skipped
+	uint64_t d_max;
+	/// Set once all divisors have been visited
+	bool done;
+	uint64_t primes[NUT_MAX_PRIMES_64];
+	uint64_t max_powers[NUT_MAX_PRIMES_64];
+	/// Exponents of the primes in d
+	uint64_t powers[NUT_MAX_PRIMES_64];
+	/// primes[i]**powers[i]
+	uint64_t ppows[NUT_MAX_PRIMES_64];
+} nut_DivIt;
+
+/// Set up an iterator over the divisors of a number which are at most d_max
+/// @param [out] self: the iterator to initialize.  Holds no resources, so there is no destroy function
+/// @param [in] factors: the factorization of n.  Copied into self, so it can be modified or freed afterwards
+/// @param [in] d_max: max divisor to visit.  Use UINT64_MAX to visit all divisors
+NUT_ATTR_NONNULL(1, 2)
+NUT_ATTR_ACCESS(write_only, 1)
+NUT_ATTR_ACCESS(read_only, 2)
+void nut_DivIt_init(nut_DivIt *restrict self, const nut_Factors *restrict factors, uint64_t d_max);
+
+/// Get the next divisor from an iterator
+/// @param [in,out] self: the iterator
+/// @param [out] d: the next divisor, if there is one
+/// @return true if a divisor was stored in d, false if all divisors at most d_max have been visited
+NUT_ATTR_NONNULL(1, 2)
+NUT_ATTR_ACCESS(read_write, 1)
+NUT_ATTR_ACCESS(write_only, 2)
+static inline bool nut_DivIt_next(nut_DivIt *restrict self, uint64_t *restrict d){
+	if(self->done){
+		return false;
+	}else if(!self->d){
+		*d = self->d = 1;
+		return true;
+	}
+	for(uint64_t i = 0; i < self->num_primes; ++i){
+		uint64_t p = self->primes[i];
+		if(self->powers[i] < self->max_powers[i] && self->d <= self->d_max/p){
+			++self->powers[i];
+			self->ppows[i] *= p;
+			*d = self->d *= p;
+			return true;
+		}
+		self->d /= self->ppows[i];
+		self->powers[i] = 0;
+		self->ppows[i] = 1;
+	}
+	self->done = true;
+	return false;
+}
+
 /// Print a factorization of a number.
 /// @param [in,out] file: pointer to file to print to
 /// @param [in] factors: pointer to factorization struct
@@ -280,18 +395,38 @@ void nut_Factor_combine(nut_Factors *restrict factors, const nut_Factors *restri
 void nut_Factor_divide(nut_Factors *restrict out, const nut_Factors *restrict factors, const nut_Factors *restrict dfactors);
 
 /// Check if n is prime using a deterministic Miller-Rabin test.
-/// 7 partictular bases are used so that no composite number will falsely be reported as prime for the entire 64-bit range
+/// After trial division by the primes up to 37, 7 partictular bases are used so that no composite number will falsely be reported
+/// as prime for the entire 64-bit range.  Montgomery multiplication is used, so there are no 128 bit divisions in the main loop.
 /// @param [in] n: number to check for primality
 /// @return true if n is prime, false otherwise
 NUT_ATTR_CONST
 bool nut_u64_is_prime_dmr(uint64_t n);
 
 /// Find the next prime >= n
-/// @param [in] n: inclusive lower bound for prime
+/// A window of odd numbers starting at n is sieved by the primes below 256, using the residues of n to place
+/// the first multiple of each in the window, and only the survivors are checked with Miller-Rabin.
+/// @param [in] n: inclusive lower bound for prime.  Must be at most 2^64 - 59, the largest 64 bit prime
 /// @return the smallest prime >= n
-NUT_ATTR_CONST
 uint64_t nut_u64_next_prime_ge(uint64_t n);
 
+/// Find the previous prime <= n
+/// Works the same way as { @link nut_u64_next_prime_ge}, sieving windows below n.
+/// @param [in] n: inclusive upper bound for prime
+/// @return the largest prime <= n, or 0 if n < 2
+uint64_t nut_u64_prev_prime_le(uint64_t n);
+
+/// Find all primes in an interval.
+/// The interval is split into windows which are sieved by the primes up to min(sqrt(b), 2^16).
+/// If b < 2^32 this is a complete segmented sieve, otherwise survivors are checked with Miller-Rabin.
+/// This is meant for short intervals of large numbers.  For all primes up to some bound, { @link nut_sieve_primes} is faster.
+/// @param [in] a, b: inclusive bounds of the interval
+/// @param [out] num_primes: how many primes were found in the interval (this pointer cannot be null)
+/// @return an array of all primes from a to b in increasing order, or NULL on allocation failure
+NUT_ATTR_MALLOC
+NUT_ATTR_NONNULL(3)
+NUT_ATTR_ACCESS(write_only, 3)
+uint64_t *nut_u64_primes_in(uint64_t a, uint64_t b, uint64_t *restrict num_primes);
+
 /// Factor out all powers of a given array of primes.
 ///
 /// Primesieve is a good general source for primes, but the api for this function is designed
@@ -313,8 +448,8 @@ uint64_t nut_u64_factor_trial_div(uint64_t n, uint64_t num_primes, const uint64_
 ///
 /// If conf->pollard_max is greater than 3, the primes array should include at least 2 and 5 to
 /// avoid an infinite loop since {@link nut_u64_factor1_pollard_rho} can't factor 4 or 25.
-/// Currently a configuration struct must be passed.  Kraitcheck methods (quadratic sieve and number field sieve) are not implemented
-/// because they are useless on 64 bit integers.  Parameters to Pollard-Rho-Brent with gcd aggregation and Lenstra ecf are not tuned
+/// Currently a configuration struct must be passed.  The quadratic sieve is used above conf->lenstra_max, but the number field sieve
+/// is not implemented because it is useless on 64 bit integers.  Parameters to Pollard-Rho-Brent with gcd aggregation and Lenstra ecf are not tuned
 /// by this function.
 /// @param [in] n: the number to factor
 /// @param [in] num_primes: the number of primes in the array to try trial division on (use 25 if using {@link nut_small_primes})
@@ -338,6 +473,57 @@ uint64_t nut_u64_factor_heuristic(uint64_t n, uint64_t num_primes, const uint64_
 NUT_ATTR_CONST
 uint64_t nut_u64_nth_root(uint64_t a, uint64_t n);
 
+/// Get the floor of the square root of a, given a guess r close to it.
+///
+/// When r is within 1 of the answer this needs no divisions at all, and otherwise Newton's method is started from r,
+/// which converges quickly when r is close.  Use this when taking square roots of a slowly changing sequence,
+/// like in { @link nut_QuotientIt}.
+/// @param [in] a: the number to take the square root of, at most 2^63
+/// @param [in] r: guess, at most 2^32.  If r or a is 0, falls back to { @link nut_u64_nth_root}
+/// @return floor(sqrt(a))
+NUT_ATTR_CONST
+static inline uint64_t nut_u64_sqrt_from(uint64_t a, uint64_t r){
+	if(!r || !a){
+		return nut_u64_nth_root(a, 2);
+	}else if(r*r <= a){
+		if((r + 1)*(r + 1) > a){
+			return r;
+		}
+		// one Newton step from below lands at or above the root
+		r = (r + a/r)/2;
+	}else if((r - 1)*(r - 1) <= a){
+		return r - 1;
+	}
+	// from above, Newton's method decreases until it reaches the root
+	for(uint64_t s = (r + a/r)/2; s < r; s = (r + a/r)/2){
+		r = s;
+	}
+	return r;
+}
+
+/// Get the floor of the cube root of a, given a guess r close to it, like { @link nut_u64_sqrt_from}
+/// @param [in] a: the number to take the cube root of
+/// @param [in] r: guess, at most 2^21.  If r or a is 0, falls back to { @link nut_u64_nth_root}
+/// @return floor(cbrt(a))
+NUT_ATTR_CONST
+static inline uint64_t nut_u64_cbrt_from(uint64_t a, uint64_t r){
+	if(!r || !a){
+		return nut_u64_nth_root(a, 3);
+	}else if(r*r*r <= a){
+		if((r + 1)*(r + 1)*(r + 1) > a){
+			return r;
+		}
+		// a Newton step from far below could overshoot enough to overflow r*r, so start over instead
+		return nut_u64_nth_root(a, 3);
+	}else if((r - 1)*(r - 1)*(r - 1) <= a){
+		return r - 1;
+	}
+	for(uint64_t s = (2*r + a/(r*r))/3; s < r; s = (2*r + a/(r*r))/3){
+		r = s;
+	}
+	return r;
+}
+
 /// Check if a is a perfect power of some integer.
 ///
 /// Used in {@link nut_u64_factor_heuristic}.
@@ -0,0 +1,99 @@
+#pragma once
+
+/// @file
+/// @author hacatu
+/// @version 0.2.0
+/// @section LICENSE
+/// This Source Code Form is subject to the terms of the Mozilla Public
+/// License, v. 2.0. If a copy of the MPL was not distributed with this
+/// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+/// @section DESCRIPTION
+/// A factorization front end that answers queries from a smallest factor table when
+/// they are in range, and falls back to trial division and { @link nut_u64_factor_heuristic }
+/// when they are not, so callers don't have to pick a method by hand
+
+#include <inttypes.h>
+#include <stddef.h>
+
+#include <nut/modular_math.h>
+#include <nut/factorization.h>
+
+/// Owns everything needed to factor any uint64_t: an optional smallest factor table from
+/// { @link nut_sieve_smallest_factors_wheel6 } (built in memory or mapped from a file),
+/// a list of primes for trial division, and a copy of the heuristic configuration.
+/// Once initialized it is never modified, so any number of threads can call { @link nut_Factorizer_factor }
+/// on the same instance concurrently.
+typedef struct{
+	/// Numbers up to this are factored using the table alone.  0 if there is no table
+	uint64_t table_max;
+	/// Number of entries in smallest_factors
+	uint64_t table_len;
+	/// Table from { @link nut_sieve_smallest_factors_wheel6 }, or NULL
+	uint32_t *smallest_factors;
+	/// If the table is mapped from a file, the address and length of the mapping, otherwise NULL and 0
+	void *mapping;
+	size_t mapping_len;
+	/// Primes used for trial division when n is above table_max
+	uint64_t num_primes;
+	uint64_t *primes;
+	/// Configuration passed to { @link nut_u64_factor_heuristic }
+	nut_FactorConf conf;
+} nut_Factorizer;
+
+/// Set up a factorizer, building its smallest factor table in memory.
+/// @param [out] self: the factorizer to initialize.  Must be freed with { @link nut_Factorizer_destroy }
+/// @param [in] table_max: inclusive upper bound of the smallest factor table, or 0 for no table.
+/// The table takes about 4/3 bytes per number, so 1e9 needs about 1.3 GB.
+/// @param [in] trial_max: inclusive upper bound on primes used for trial division of numbers above table_max.
+/// Raised to at least 100 so that { @link nut_u64_factor_heuristic } never sees multiples of 4 or 25.
+/// @param [in] conf: configuration for the heuristic factorization of large cofactors (can use { @link nut_default_factor_conf }).
+/// Copied into self.
+/// @return true on success, false on allocation failure
+NUT_ATTR_NONNULL(1, 4)
+NUT_ATTR_ACCESS(write_only, 1)
+NUT_ATTR_ACCESS(read_only, 4)
+bool nut_Factorizer_init(nut_Factorizer *restrict self, uint64_t table_max, uint64_t trial_max, const nut_FactorConf *restrict conf);
+
+/// Set up a factorizer, mapping its smallest factor table from a file written by { @link nut_Factorizer_save }.
+/// The table is mapped read only, so many processes can share one copy of a large table.
+/// On platforms without mmap, the table is read into memory instead.
+/// @param [out] self: the factorizer to initialize.  Must be freed with { @link nut_Factorizer_destroy }
+/// @param [in] path: file to map
+/// @param [in] trial_max, conf: see { @link nut_Factorizer_init }
+/// @return true on success, false if the file could not be opened or mapped, is not a table file, or on allocation failure
+NUT_ATTR_NONNULL(1, 2, 4)
+NUT_ATTR_ACCESS(write_only, 1)
+NUT_ATTR_ACCESS(read_only, 2)
+NUT_ATTR_ACCESS(read_only, 4)
+bool nut_Factorizer_init_mmap(nut_Factorizer *restrict self, const char *restrict path, uint64_t trial_max, const nut_FactorConf *restrict conf);
+
+/// Write the smallest factor table of a factorizer to a file so it can be loaded with { @link nut_Factorizer_init_mmap }.
+/// @param [in] self: factorizer whose table to save.  Must have a table
+/// @param [in] path: file to write
+/// @return true on success, false if self has no table or the file could not be written
+NUT_ATTR_NONNULL(1, 2)
+NUT_ATTR_ACCESS(read_only, 1)
+NUT_ATTR_ACCESS(read_only, 2)
+bool nut_Factorizer_save(const nut_Factorizer *restrict self, const char *restrict path);
+
+/// Free the resources held by a factorizer, unmapping its table if it was mapped.
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(read_write, 1)
+void nut_Factorizer_destroy(nut_Factorizer *self);
+
+/// Factor a number.
+/// If n is at most self->table_max, this takes O(omega(n)) table lookups.
+/// Otherwise, small primes are trial divided out, and then the cofactor is finished with the table if it
+/// has fallen into its range, or { @link nut_u64_factor_heuristic } if not.
+/// Safe to call from multiple threads at once on the same factorizer.
+/// @param [in] self: factorizer to use
+/// @param [in] n: number to factor, must be nonzero
+/// @param [out] factors: output, must have room for { @link NUT_MAX_PRIMES_64 } primes
+/// (or fewer if n is known to be smaller)
+/// @return n with all factors found divided out, so 1 if n was factored completely.
+/// This can only be greater than 1 if the heuristic configuration cannot handle the cofactor.
+NUT_ATTR_NODISCARD
+NUT_ATTR_NONNULL(1, 3)
+NUT_ATTR_ACCESS(read_only, 1)
+NUT_ATTR_ACCESS(read_write, 3)
+uint64_t nut_Factorizer_factor(const nut_Factorizer *restrict self, uint64_t n, nut_Factors *restrict factors);
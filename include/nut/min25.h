@@ -0,0 +1,63 @@
+#pragma once
+
+/// @file
+/// @author hacatu
+/// @version 0.2.0
+/// @section LICENSE
+/// This Source Code Form is subject to the terms of the Mozilla Public
+/// License, v. 2.0. If a copy of the MPL was not distributed with this
+/// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+/// @section DESCRIPTION
+/// The min_25 sieve, for summing a multiplicative function f whose values at primes are a polynomial in p,
+/// without needing a Dirichlet factorization of f into simpler functions.
+///
+/// Phase 1 finds G(v) = sum(f(p), p <= v) at every v = floor(x/n) from the prime power sum tables of
+/// { @link nut_Diri_compute_prime_sums}, as sum(c_k sum(p^k, p <= v)).
+/// Phase 2 adds in the composites.  Let S(v, j) be the sum of f(n) over 1 < n <= v whose smallest prime factor is at least p_j.
+/// Then S(v, j) = G(v) - G(p_j - 1) + sum(f(p^e)S(v/p^e, p's index + 1) + f(p^(e + 1)), p >= p_j, p^(e + 1) <= v),
+/// and F(x) = 1 + S(x, 1).  The recursion only ever visits v of the form floor(x/n), and takes about O(x^(3/4)/log(x)) time in total.
+/// The top level terms (one per prime p <= sqrt(x)) are independent, so they are split between threads.
+/// To get F(x/n) for every n, the same recurrence is run iteratively over primes in decreasing order, updating a whole table per prime like
+/// Lucy's algorithm, which is done on one thread.
+
+#include <inttypes.h>
+
+#include <nut/modular_math.h>
+#include <nut/dirichlet.h>
+
+/// Compute the sum of a multiplicative function f from 1 to x with the min_25 sieve, where f at prime powers is given by a callback.
+/// @param [in] x: upper bound of the sum (inclusive)
+/// @param [in] m: modulus to reduce the result by, or 0 to skip reducing.  If m is not 0, it must be a prime greater than kmax + 1,
+/// see { @link nut_Diri_compute_prime_sums}
+/// @param [in] kmax: degree of the polynomial giving f at primes
+/// @param [in] prime_poly_coeffs: f(p) = sum(prime_poly_coeffs[k]p^k, k <= kmax), reduced mod m
+/// @param [in] f_fn: callback to compute f at a prime power.  Arguments are p: prime, pp: prime power (p^e), e: exponent, m: modulus,
+/// the same as the callbacks for { @link nut_PfIt_init_fn}.  It is only called for e >= 2 and must be safe to call from several threads at once
+/// @param [in, out] out_table: if not NULL, a table initialized with { @link nut_Diri_init} for this x, which gets f in its dense part
+/// and F(x/n) in its sparse part.  Filling the table is done on one thread.  out_table->x must be x
+/// @param [out] out: F(x)
+/// @param [in] num_threads: number of threads for phase 2, or 0 to use { @link nut_parallel_default_threads}
+/// @return true on success, false on allocation failure, if Faulhaber's formula can't be evaluated mod m, or if out_table->x is not x
+NUT_ATTR_NONNULL(4, 5, 7)
+NUT_ATTR_ACCESS(read_only, 4, 3)
+NUT_ATTR_ACCESS(write_only, 7)
+bool nut_min25_sum_fn(int64_t x, int64_t m, uint64_t kmax, const int64_t prime_poly_coeffs[restrict static kmax + 1],
+	int64_t (*f_fn)(uint64_t p, uint64_t pp, uint64_t e, uint64_t m), nut_Diri *restrict out_table, int64_t *restrict out, uint64_t num_threads);
+
+/// Compute the sum of a multiplicative function f from 1 to x with the min_25 sieve, where f(p^e) depends only on e.
+/// See { @link nut_min25_sum_fn}.
+/// @param [in] f_vals: table of f(p^e) indexed by e, reduced mod m.  It must have an entry for every e with 2^e <= x
+NUT_ATTR_NONNULL(4, 5, 7)
+NUT_ATTR_ACCESS(read_only, 4, 3)
+NUT_ATTR_ACCESS(read_only, 5)
+NUT_ATTR_ACCESS(write_only, 7)
+bool nut_min25_sum_vals(int64_t x, int64_t m, uint64_t kmax, const int64_t prime_poly_coeffs[restrict static kmax + 1],
+	const int64_t *restrict f_vals, nut_Diri *restrict out_table, int64_t *restrict out, uint64_t num_threads);
+
+/// Macro to call either { @link nut_min25_sum_fn} or { @link nut_min25_sum_vals} depending on the type of f,
+/// like { @link NUT_PfIt_INIT}
+/// @param f: Either a function `int64_t (*f_fn)(uint64_t p, uint64_t pp, uint64_t e, uint64_t m)` or a table `const int64_t *f_vals`
+#define NUT_MIN25_SUM(x, m, kmax, prime_poly_coeffs, f, out_table, out, num_threads) _Generic((f),\
+	int64_t (*)(uint64_t, uint64_t, uint64_t, uint64_t): nut_min25_sum_fn,\
+	int64_t*: nut_min25_sum_vals, const int64_t*: nut_min25_sum_vals\
+)((x), (m), (kmax), (prime_poly_coeffs), (f), (out_table), (out), (num_threads))
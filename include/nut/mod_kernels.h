@@ -0,0 +1,672 @@
+#pragma once
+
+/// @file
+/// @author hacatu
+/// @version 0.2.0
+/// @section LICENSE
+/// This Source Code Form is subject to the terms of the Mozilla Public
+/// License, v. 2.0. If a copy of the MPL was not distributed with this
+/// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+/// @section DESCRIPTION
+/// Inline kernels for the hot modular loops (Dirichlet hyperbola convolutions, Euler's sieve, polynomial multiplication)
+/// so that they can be specialized for a fixed modulus.
+///
+/// Every kernel takes the modulus as an ordinary argument, with 0 meaning no reduction like the public functions,
+/// and is forced inline.  When a kernel is called with a compile time constant modulus, the compiler removes
+/// the `if(m)` branches and turns every `%` into a multiply and shift, which is several times cheaper than a hardware divide.
+/// The library entry points (eg { @link nut_Diri_compute_conv}) call the same kernels with a runtime modulus,
+/// and dispatch to specialized copies for the common moduli 10^9+7 and 998244353.
+/// To get specialized copies for some other modulus, use { @link NUT_DEFINE_MOD_KERNELS} at file scope.
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <nut/debug.h>
+#include <nut/modular_math.h>
+#include <nut/sieves.h>
+#include <nut/dirichlet.h>
+#include <nut/polynomial.h>
+
+/// Largest modulus the kernels support: reduced values are multiplied as int64_t, so m^2 must not overflow
+#define NUT_MOD_KERNELS_MAX_MODULUS INT64_C(3037000499)
+
+/// Euclidean remainder like { @link nut_i64_mod}, except that m == 0 means no reduction.
+/// This is inline so that a constant m turns into a multiply and shift instead of a divide.
+/// @param [in] a: dividend
+/// @param [in] m: modulus, or 0
+/// @return a mod m, or a if m is 0
+NUT_ATTR_CONST
+NUT_ATTR_ALWAYS_INLINE
+static inline int64_t nut_kernel_mod(int64_t a, int64_t m){
+	if(!m){
+		return a;
+	}
+	int64_t r = a%m;
+	return r < 0 ? r + m : r;
+}
+
+/// Reduce a lazily accumulated 128 bit sum, like { @link nut_kernel_mod}.
+/// The hyperbola loops add up products of reduced values without reducing them, which can't overflow for any
+/// realistic table since each product is below 2^95, and then reduce once per output entry.
+/// If m is 0, the result is truncated to 64 bits, which matches the wrapping 64 bit arithmetic used without a modulus.
+/// @param [in] a: accumulated sum
+/// @param [in] m: modulus, or 0
+/// @return a mod m, or a truncated to 64 bits if m is 0
+NUT_ATTR_CONST
+NUT_ATTR_ALWAYS_INLINE
+static inline int64_t nut_kernel_mod128(int128_t a, int64_t m){
+	if(!m){
+		return (int64_t)a;
+	}
+	int64_t r = a%m;
+	return r < 0 ? r + m : r;
+}
+
+/// Triangular number k(k + 1)/2, reduced mod m unless m is 0.
+/// For k up to 2^63 the product is up to 2^125, so the factors are reduced before multiplying
+/// @param [in] k: nonnegative argument
+/// @param [in] m: modulus, or 0
+/// @return k(k + 1)/2 mod m, or k(k + 1)/2 with wrapping 64 bit arithmetic if m is 0
+NUT_ATTR_CONST
+NUT_ATTR_ALWAYS_INLINE
+static inline int64_t nut_kernel_tri(int64_t k, int64_t m){
+	if(!m){
+		return (k&1) ? k*((k + 1)>>1) : (k>>1)*(k + 1);
+	}
+	return (k&1) ? k%m*(((k + 1)>>1)%m)%m : (k>>1)%m*((k + 1)%m)%m;
+}
+
+/// Define an inline function `T name(const T *f_vals, const T *g_vals, int64_t p, int64_t pa, int64_t m)` computing
+/// (f <*> g)(p**a) = f(1)*g(p**a) + f(p)*g(p**(a-1)) + ... + f(p**a)*g(1) for a prime power pa = p**a, where f(1) = g(1) = 1.
+/// The products are summed lazily in ACC and reduced once at the end with REDUCE(sum, m), so the same loop serves tables of any width:
+/// this header defines { @link nut_kernel_conv_prime_power} for int64_t tables, and { @link nut_Diri32} uses a 32 bit reduction.
+/// @param [in] name: name of the function to define
+/// @param [in] T: type of the table entries
+/// @param [in] ACC: type to accumulate products of entries in, wide enough for about 64 of them
+/// @param [in] REDUCE: modular kernel taking an ACC sum and the modulus, like { @link nut_kernel_mod128}
+#define NUT_DEFINE_CONV_PRIME_POWER(name, T, ACC, REDUCE) \
+	NUT_ATTR_ALWAYS_INLINE \
+	static inline T name(const T *f_vals, const T *g_vals, int64_t p, int64_t pa, int64_t m){ \
+		ACC c = (ACC)f_vals[pa] + g_vals[pa]; \
+		for(int64_t A = p, B = pa/p; A < pa; A *= p, B /= p){ \
+			c += (ACC)f_vals[A]*g_vals[B]; \
+		} \
+		return REDUCE(c, m); \
+	}
+
+/// (f <*> g)(p**a) for int64_t tables reduced by m (or not reduced if m is 0), see { @link NUT_DEFINE_CONV_PRIME_POWER}
+NUT_DEFINE_CONV_PRIME_POWER(nut_kernel_conv_prime_power, int64_t, int128_t, nut_kernel_mod128)
+
+/// Kernel for { @link nut_euler_sieve_conv_u}
+NUT_ATTR_ALWAYS_INLINE
+static inline bool nut_euler_sieve_conv_u_kernel(int64_t n, int64_t modulus, const int64_t f_vals[restrict static n+1], int64_t f_conv_u_vals[restrict static n+1]){
+	int64_t *smallest_ppow [[gnu::cleanup(cleanup_free)]] = malloc((n+1)*sizeof(int64_t));
+	uint8_t *is_c_buf [[gnu::cleanup(cleanup_free)]] = calloc(n/8 + 1, sizeof(uint8_t));
+	int64_t *primes [[gnu::cleanup(cleanup_free)]] = malloc(nut_max_primes_le(n)*sizeof(int64_t));
+	uint64_t num_primes = 0;
+	if(!smallest_ppow || !is_c_buf || !primes){
+		return false;
+	}
+	f_conv_u_vals[1] = 1;
+	for(int64_t i = 2; i <= n; ++i){
+		// if i is prime, add it to the list of primes
+		if(!nut_Bitarray_get(is_c_buf, i)){
+			primes[num_primes++] = i;
+			f_conv_u_vals[i] = nut_kernel_mod(f_vals[i] + 1, modulus);
+			smallest_ppow[i] = i;
+		}
+		// see the comment on nut_euler_sieve_conv_u in dirichlet.c for how this works
+		for(uint64_t j = 0; j < num_primes; ++j){
+			int64_t p = primes[j], m;
+			if(__builtin_mul_overflow(p, i, &m) || m > n){
+				break;
+			}
+			nut_Bitarray_set(is_c_buf, m, true);
+			if(i%p == 0){// i is a multiple of p, and p is the smallest prime divisor of i
+				int64_t ppow = smallest_ppow[i];
+				int64_t B = ppow*p;
+				smallest_ppow[m] = B;
+				int64_t v = i/ppow;
+				if(v != 1){// i is not a perfect power of p, that is, i = v*p**a with v != 1
+					f_conv_u_vals[m] = nut_kernel_mod(f_conv_u_vals[v]*f_conv_u_vals[B], modulus);
+				}else{// i is a perfect power of p (and so is m)
+					// (f <*> u)(p**a) = f(1) + f(p) + ... + f(p**a) = (f <*> u)(p**(a-1)) + f(p**a)
+					f_conv_u_vals[m] = nut_kernel_mod(f_conv_u_vals[i] + f_vals[m], modulus);
+				}
+				break;
+			}// otherwise, i and p are coprime, so (f <*> u)(i*p) = (f <*> u)(i)*(f <*> u)(p)
+			f_conv_u_vals[m] = nut_kernel_mod(f_conv_u_vals[i]*f_conv_u_vals[p], modulus);
+			smallest_ppow[m] = p;
+		}
+	}
+	return true;
+}
+
+/// Kernel for { @link nut_euler_sieve_conv_N}
+NUT_ATTR_ALWAYS_INLINE
+static inline bool nut_euler_sieve_conv_N_kernel(int64_t n, int64_t modulus, const int64_t f_vals[restrict static n+1], int64_t f_conv_N_vals[restrict static n+1]){
+	int64_t *smallest_ppow [[gnu::cleanup(cleanup_free)]] = malloc((n+1)*sizeof(int64_t));
+	uint8_t *is_c_buf [[gnu::cleanup(cleanup_free)]] = calloc(n/8 + 1, sizeof(uint8_t));
+	int64_t *primes [[gnu::cleanup(cleanup_free)]] = malloc(nut_max_primes_le(n)*sizeof(int64_t));
+	uint64_t num_primes = 0;
+	if(!smallest_ppow || !is_c_buf || !primes){
+		return false;
+	}
+	f_conv_N_vals[1] = 1;
+	for(int64_t i = 2; i <= n; ++i){
+		if(!nut_Bitarray_get(is_c_buf, i)){
+			primes[num_primes++] = i;
+			f_conv_N_vals[i] = nut_kernel_mod(f_vals[i] + i, modulus);
+			smallest_ppow[i] = i;
+		}
+		for(uint64_t j = 0; j < num_primes; ++j){
+			int64_t p = primes[j], m;
+			if(__builtin_mul_overflow(p, i, &m) || m > n){
+				break;
+			}
+			nut_Bitarray_set(is_c_buf, m, true);
+			if(i%p == 0){
+				int64_t ppow = smallest_ppow[i];
+				int64_t B = ppow*p;
+				smallest_ppow[m] = B;
+				int64_t v = i/ppow;
+				if(v != 1){
+					f_conv_N_vals[m] = nut_kernel_mod(f_conv_N_vals[v]*f_conv_N_vals[B], modulus);
+				}else{
+					// (f <*> N)(p**a) = f(1)*p**a + f(p)*p**(a-1) + ... + f(p**a)*1 = p*(f <*> N)(p**(a-1)) + f(p**a)
+					int64_t pm = modulus ? p%modulus : p;
+					f_conv_N_vals[m] = nut_kernel_mod(pm*f_conv_N_vals[i] + f_vals[m], modulus);
+				}
+				break;
+			}
+			f_conv_N_vals[m] = nut_kernel_mod(f_conv_N_vals[i]*f_conv_N_vals[p], modulus);
+			smallest_ppow[m] = p;
+		}
+	}
+	return true;
+}
+
+/// Kernel for { @link nut_euler_sieve_conv}
+NUT_ATTR_ALWAYS_INLINE
+static inline bool nut_euler_sieve_conv_kernel(int64_t n, int64_t modulus, const int64_t f_vals[static n+1], const int64_t g_vals[static n+1], int64_t f_conv_vals[restrict static n+1]){
+	int64_t *smallest_ppow [[gnu::cleanup(cleanup_free)]] = malloc((n+1)*sizeof(int64_t));
+	uint8_t *is_c_buf [[gnu::cleanup(cleanup_free)]] = calloc(n/8 + 1, sizeof(uint8_t));
+	int64_t *primes [[gnu::cleanup(cleanup_free)]] = malloc(nut_max_primes_le(n)*sizeof(int64_t));
+	uint64_t num_primes = 0;
+	if(!smallest_ppow || !is_c_buf || !primes){
+		return false;
+	}
+	f_conv_vals[1] = 1;
+	for(int64_t i = 2; i <= n; ++i){
+		if(!nut_Bitarray_get(is_c_buf, i)){
+			primes[num_primes++] = i;
+			f_conv_vals[i] = nut_kernel_mod(f_vals[i] + g_vals[i], modulus);
+			smallest_ppow[i] = i;
+		}
+		for(uint64_t j = 0; j < num_primes; ++j){
+			int64_t p = primes[j], m;
+			if(__builtin_mul_overflow(p, i, &m) || m > n){
+				break;
+			}
+			nut_Bitarray_set(is_c_buf, m, true);
+			if(i%p == 0){
+				int64_t ppow = smallest_ppow[i];
+				int64_t B = ppow*p;
+				smallest_ppow[m] = B;
+				int64_t v = i/ppow;
+				if(v != 1){
+					f_conv_vals[m] = nut_kernel_mod(f_conv_vals[v]*f_conv_vals[B], modulus);
+				}else{
+					f_conv_vals[m] = nut_kernel_conv_prime_power(f_vals, g_vals, p, m, modulus);
+				}
+				break;
+			}
+			f_conv_vals[m] = nut_kernel_mod(f_conv_vals[i]*f_conv_vals[p], modulus);
+			smallest_ppow[m] = p;
+		}
+	}
+	return true;
+}
+
+/// Kernel for { @link nut_euler_sieve_conv_u_ctx}.
+/// Every entry only depends on entries at smaller indices, so with the factorization precomputed this is one pass with no branches on the primes.
+NUT_ATTR_ALWAYS_INLINE
+static inline void nut_euler_sieve_conv_u_ctx_kernel(const nut_EulerCtx *ctx, int64_t n, int64_t modulus, const int64_t f_vals[restrict static n+1], int64_t f_conv_u_vals[restrict static n+1]){
+	f_conv_u_vals[1] = 1;
+	for(int64_t i = 2; i <= n; ++i){
+		uint32_t q = ctx->smallest_ppow[i];
+		if(q & NUT_EULER_CTX_PRIME_POWER){// i = p**a, so (f <*> u)(i) = (f <*> u)(p**(a-1)) + f(p**a)
+			uint32_t p = q & ~NUT_EULER_CTX_PRIME_POWER;
+			f_conv_u_vals[i] = nut_kernel_mod(f_conv_u_vals[(uint32_t)i/p] + f_vals[i], modulus);
+		}else{// q and i/q are coprime
+			f_conv_u_vals[i] = nut_kernel_mod(f_conv_u_vals[q]*f_conv_u_vals[(uint32_t)i/q], modulus);
+		}
+	}
+}
+
+/// Kernel for { @link nut_euler_sieve_conv_N_ctx}
+NUT_ATTR_ALWAYS_INLINE
+static inline void nut_euler_sieve_conv_N_ctx_kernel(const nut_EulerCtx *ctx, int64_t n, int64_t modulus, const int64_t f_vals[restrict static n+1], int64_t f_conv_N_vals[restrict static n+1]){
+	f_conv_N_vals[1] = 1;
+	for(int64_t i = 2; i <= n; ++i){
+		uint32_t q = ctx->smallest_ppow[i];
+		if(q & NUT_EULER_CTX_PRIME_POWER){// (f <*> N)(p**a) = p*(f <*> N)(p**(a-1)) + f(p**a)
+			int64_t p = q & ~NUT_EULER_CTX_PRIME_POWER;
+			int64_t pm = modulus ? p%modulus : p;
+			f_conv_N_vals[i] = nut_kernel_mod(pm*f_conv_N_vals[(uint32_t)i/(uint32_t)p] + f_vals[i], modulus);
+		}else{
+			f_conv_N_vals[i] = nut_kernel_mod(f_conv_N_vals[q]*f_conv_N_vals[(uint32_t)i/q], modulus);
+		}
+	}
+}
+
+/// Kernel for { @link nut_euler_sieve_conv_ctx}
+NUT_ATTR_ALWAYS_INLINE
+static inline void nut_euler_sieve_conv_ctx_kernel(const nut_EulerCtx *ctx, int64_t n, int64_t modulus, const int64_t f_vals[static n+1], const int64_t g_vals[static n+1], int64_t f_conv_vals[restrict static n+1]){
+	f_conv_vals[1] = 1;
+	for(int64_t i = 2; i <= n; ++i){
+		uint32_t q = ctx->smallest_ppow[i];
+		if(!(q & NUT_EULER_CTX_PRIME_POWER)){
+			f_conv_vals[i] = nut_kernel_mod(f_conv_vals[q]*f_conv_vals[(uint32_t)i/q], modulus);
+			continue;
+		}
+		f_conv_vals[i] = nut_kernel_conv_prime_power(f_vals, g_vals, q & ~NUT_EULER_CTX_PRIME_POWER, i, modulus);
+	}
+}
+
+/// Store the partial sums of the dense part of f_tbl in the dense part of self.
+/// The first step of all the hyperbola convolutions.
+NUT_ATTR_ALWAYS_INLINE
+static inline void nut_Diri_prefix_sums_kernel(nut_Diri *restrict self, int64_t m, const nut_Diri *restrict f_tbl){
+	self->buf[0] = 0;
+	for(int64_t i = 1; i <= self->y; ++i){
+		self->buf[i] = nut_kernel_mod(self->buf[i-1] + f_tbl->buf[i], m);
+	}
+}
+
+/// Compute the sparse entries i_lo <= i < i_hi of f <*> u, given the sums of f in the dense part of self.
+/// Every entry depends only on the inputs, so disjoint ranges can be computed concurrently.
+NUT_ATTR_ALWAYS_INLINE
+static inline void nut_Diri_conv_u_sparse_kernel(nut_Diri *restrict self, int64_t m, const nut_Diri *restrict f_tbl, const nut_DiriIndex *idx, int64_t i_lo, int64_t i_hi){
+	nut_QuotientIt it;
+	for(nut_QuotientIt_init(&it, self->x, i_lo, false); it.i < i_hi; nut_QuotientIt_advance(&it, 1)){
+		int64_t i = it.i, v = it.v, vr = it.vr;
+		// v/n = x/(i*n) is in the sparse part of the tables for n < n_split, and in the dense part after that
+		int64_t n_split = (idx->k_dense + i - 1)/i;
+		if(n_split > vr + 1){
+			n_split = vr + 1;
+		}
+		int128_t h = 0;
+		int64_t n = 1;
+		for(; n < n_split; ++n){
+			h += nut_Diri_get_sparse(f_tbl, i*n);
+			h += (int128_t)nut_Diri_get_dense(f_tbl, n)*nut_DiriIndex_quot(idx, v, n);
+		}
+		for(; n <= vr; ++n){
+			int64_t q = nut_DiriIndex_quot(idx, v, n);
+			h += nut_Diri_get_dense(self, q);
+			h += (int128_t)nut_Diri_get_dense(f_tbl, n)*q;
+		}
+		h -= (int128_t)nut_Diri_get_dense(self, vr)*vr;
+		nut_Diri_set_sparse(self, i, nut_kernel_mod128(h, m));
+	}
+}
+
+/// Kernel for { @link nut_Diri_compute_conv_u}
+NUT_ATTR_ALWAYS_INLINE
+static inline bool nut_Diri_compute_conv_u_kernel(nut_Diri *restrict self, int64_t m, const nut_Diri *restrict f_tbl){
+	if(self->y != f_tbl->y || self->x != f_tbl->x){
+		return false;
+	}
+	nut_DiriIndex idx;
+	if(!nut_DiriIndex_init(&idx, self)){
+		return false;
+	}
+	// use the dense part of self to temporarily store the sums of f for small n up to y
+	nut_Diri_prefix_sums_kernel(self, m, f_tbl);
+	nut_Diri_conv_u_sparse_kernel(self, m, f_tbl, &idx, 1, self->yinv);
+	nut_DiriIndex_destroy(&idx);
+	return nut_euler_sieve_conv_u_kernel(self->y, m, f_tbl->buf, self->buf);
+}
+
+/// Compute the sparse entries i_lo <= i < i_hi of f <*> N, given the sums of f in the dense part of self.
+NUT_ATTR_ALWAYS_INLINE
+static inline void nut_Diri_conv_N_sparse_kernel(nut_Diri *restrict self, int64_t m, const nut_Diri *restrict f_tbl, const nut_DiriIndex *idx, int64_t i_lo, int64_t i_hi){
+	nut_QuotientIt it;
+	for(nut_QuotientIt_init(&it, self->x, i_lo, false); it.i < i_hi; nut_QuotientIt_advance(&it, 1)){
+		int64_t i = it.i, v = it.v, vr = it.vr;
+		int64_t n_split = (idx->k_dense + i - 1)/i;
+		if(n_split > vr + 1){
+			n_split = vr + 1;
+		}
+		int128_t h = 0;
+		// by hyperbola formula:
+		// (f <*> N)(v) = sum(n = 1 ... vr, f(n)*(v/n)*((v/n) + 1)/2) + sum(n = 1 ... vr, F(v/n)*n) - F(vr)*vr*(vr + 1)/2
+		// both sums are folded together into the following loops, which are split at the point where v/n moves into the dense part
+		int64_t n = 1;
+		for(; n < n_split; ++n){
+			h += (int128_t)nut_Diri_get_sparse(f_tbl, i*n)*n;
+			h += (int128_t)nut_Diri_get_dense(f_tbl, n)*nut_kernel_tri(nut_DiriIndex_quot(idx, v, n), m);
+		}
+		for(; n <= vr; ++n){
+			int64_t k = nut_DiriIndex_quot(idx, v, n);
+			h += (int128_t)nut_Diri_get_dense(self, k)*n;
+			h += (int128_t)nut_Diri_get_dense(f_tbl, n)*nut_kernel_tri(k, m);
+		}
+		// finally we apply the corrective term (remove double counted values)
+		int64_t Gvr = (vr&1) ? vr*((vr + 1) >> 1) : (vr >> 1)*(vr + 1);
+		h -= (int128_t)nut_Diri_get_dense(self, vr)*Gvr;
+		nut_Diri_set_sparse(self, i, nut_kernel_mod128(h, m));
+	}
+}
+
+/// Kernel for { @link nut_Diri_compute_conv_N}
+NUT_ATTR_ALWAYS_INLINE
+static inline bool nut_Diri_compute_conv_N_kernel(nut_Diri *restrict self, int64_t m, const nut_Diri *restrict f_tbl){
+	if(self->y != f_tbl->y || self->x != f_tbl->x){
+		return false;
+	}
+	nut_DiriIndex idx;
+	if(!nut_DiriIndex_init(&idx, self)){
+		return false;
+	}
+	// use the dense part of self to temporarily store the sums of f for small n up to y
+	nut_Diri_prefix_sums_kernel(self, m, f_tbl);
+	nut_Diri_conv_N_sparse_kernel(self, m, f_tbl, &idx, 1, self->yinv);
+	nut_DiriIndex_destroy(&idx);
+	return nut_euler_sieve_conv_N_kernel(self->y, m, f_tbl->buf, self->buf);
+}
+
+/// First pass over the sparse entries i_lo <= i < i_hi of f <*> g: store sum(n = 1 ... vr, F(v/n)g(n)),
+/// given the sums of f in the dense part of self.
+NUT_ATTR_ALWAYS_INLINE
+static inline void nut_Diri_conv_Fg_sparse_kernel(nut_Diri *restrict self, int64_t m, const nut_Diri *f_tbl, const nut_Diri *g_tbl, const nut_DiriIndex *idx, int64_t i_lo, int64_t i_hi){
+	nut_QuotientIt it;
+	for(nut_QuotientIt_init(&it, self->x, i_lo, false); it.i < i_hi; nut_QuotientIt_advance(&it, 1)){
+		int64_t i = it.i, v = it.v, vr = it.vr;
+		int64_t n_split = (idx->k_dense + i - 1)/i;
+		if(n_split > vr + 1){
+			n_split = vr + 1;
+		}
+		int128_t h = 0;
+		int64_t n = 1;
+		for(; n < n_split; ++n){
+			h += (int128_t)nut_Diri_get_sparse(f_tbl, i*n)*nut_Diri_get_dense(g_tbl, n);
+		}
+		for(; n <= vr; ++n){
+			h += (int128_t)nut_Diri_get_dense(self, nut_DiriIndex_quot(idx, v, n))*nut_Diri_get_dense(g_tbl, n);
+		}
+		nut_Diri_set_sparse(self, i, nut_kernel_mod128(h, m));
+	}
+}
+
+/// Replace the sums of f in the dense part of self with the sums of g, subtracting the F(vr)G(vr) correction terms
+/// from the sparse entries along the way.  This is O(y) and touches every sparse entry, so it is not split up.
+NUT_ATTR_ALWAYS_INLINE
+static inline void nut_Diri_conv_adjust_kernel(nut_Diri *restrict self, int64_t m, const nut_Diri *g_tbl){
+	// use the dense part of self to temporarily store the sums of g for small n up to y
+	// simultaniously, apply the adjustments to the h values.
+	// H(x/j) has an adjustment of F(i)G(i) where i = sqrt(x/j)
+	// so for every i = sqrt(x/j) value, we need to adjust all H(x/j) values
+	// for j in the range (x/(i + 1)**2, x/i**2] && [1, yinv)
+	// So we can ignore some small i values where this intersection is empty, that is, yinv <= x/(i + 1)**2
+	// (i + 1)**2 <= x/yinv <=> i + 1 <= sqrt(x/yinv)
+	// that is, for i <= sqrt(x/yinv) - 1, there are no corresponding j to adjust
+	// note that x/yinv = y and i <= sqrt(y) - 1 <=> i < sqrt(y)
+	int64_t i_ub = nut_u64_nth_root(self->y, 2);
+	for(int64_t i = 1; i < i_ub; ++i){
+		self->buf[i] = nut_kernel_mod(self->buf[i-1] + g_tbl->buf[i], m);
+	}
+	for(int64_t i = i_ub; i <= self->y; ++i){
+		int64_t F = self->buf[i];
+		int64_t G = nut_kernel_mod(self->buf[i-1] + g_tbl->buf[i], m);
+		self->buf[i] = G;
+		int64_t j_ub = self->x/(i*i) + 1;
+		if(j_ub > self->yinv){
+			j_ub = self->yinv;
+		}
+		for(int64_t j = self->x/((i + 1)*(i + 1)) + 1; j < j_ub; ++j){
+			nut_Diri_set_sparse(self, j, nut_kernel_mod(nut_Diri_get_sparse(self, j) - F*G, m));
+		}
+	}
+}
+
+/// Second pass over the sparse entries i_lo <= i < i_hi of f <*> g: add sum(n = 1 ... vr, f(n)G(v/n)),
+/// given the sums of g in the dense part of self.
+NUT_ATTR_ALWAYS_INLINE
+static inline void nut_Diri_conv_fG_sparse_kernel(nut_Diri *restrict self, int64_t m, const nut_Diri *f_tbl, const nut_Diri *g_tbl, const nut_DiriIndex *idx, int64_t i_lo, int64_t i_hi){
+	nut_QuotientIt it;
+	for(nut_QuotientIt_init(&it, self->x, i_lo, false); it.i < i_hi; nut_QuotientIt_advance(&it, 1)){
+		int64_t i = it.i, v = it.v, vr = it.vr;
+		int64_t n_split = (idx->k_dense + i - 1)/i;
+		if(n_split > vr + 1){
+			n_split = vr + 1;
+		}
+		int128_t h = nut_Diri_get_sparse(self, i);
+		int64_t n = 1;
+		for(; n < n_split; ++n){
+			h += (int128_t)nut_Diri_get_dense(f_tbl, n)*nut_Diri_get_sparse(g_tbl, i*n);
+		}
+		for(; n <= vr; ++n){
+			h += (int128_t)nut_Diri_get_dense(f_tbl, n)*nut_Diri_get_dense(self, nut_DiriIndex_quot(idx, v, n));
+		}
+		nut_Diri_set_sparse(self, i, nut_kernel_mod128(h, m));
+	}
+}
+
+/// Kernel for { @link nut_Diri_compute_conv}
+NUT_ATTR_ALWAYS_INLINE
+static inline bool nut_Diri_compute_conv_kernel(nut_Diri *restrict self, int64_t m, const nut_Diri *f_tbl, const nut_Diri *g_tbl){
+	if(self->y != f_tbl->y || self->x != f_tbl->x || self->y != g_tbl->y || self->x != g_tbl->x){
+		return false;
+	}
+	nut_DiriIndex idx;
+	if(!nut_DiriIndex_init(&idx, self)){
+		return false;
+	}
+	// use the dense part of self to temporarily store the sums of f for small n up to y
+	nut_Diri_prefix_sums_kernel(self, m, f_tbl);
+	nut_Diri_conv_Fg_sparse_kernel(self, m, f_tbl, g_tbl, &idx, 1, self->yinv);
+	nut_Diri_conv_adjust_kernel(self, m, g_tbl);
+	nut_Diri_conv_fG_sparse_kernel(self, m, f_tbl, g_tbl, &idx, 1, self->yinv);
+	nut_DiriIndex_destroy(&idx);
+	return nut_euler_sieve_conv_kernel(self->y, m, f_tbl->buf, g_tbl->buf, self->buf);
+}
+
+/// Kernel for { @link nut_Diri_compute_conv_u_ctx}
+NUT_ATTR_ALWAYS_INLINE
+static inline bool nut_Diri_compute_conv_u_ctx_kernel(nut_Diri *restrict self, int64_t m, const nut_Diri *restrict f_tbl, const nut_EulerCtx *ctx){
+	if(self->y != f_tbl->y || self->x != f_tbl->x || ctx->n < self->y){
+		return false;
+	}
+	nut_DiriIndex idx;
+	if(!nut_DiriIndex_init(&idx, self)){
+		return false;
+	}
+	nut_Diri_prefix_sums_kernel(self, m, f_tbl);
+	nut_Diri_conv_u_sparse_kernel(self, m, f_tbl, &idx, 1, self->yinv);
+	nut_DiriIndex_destroy(&idx);
+	nut_euler_sieve_conv_u_ctx_kernel(ctx, self->y, m, f_tbl->buf, self->buf);
+	return true;
+}
+
+/// Kernel for { @link nut_Diri_compute_conv_N_ctx}
+NUT_ATTR_ALWAYS_INLINE
+static inline bool nut_Diri_compute_conv_N_ctx_kernel(nut_Diri *restrict self, int64_t m, const nut_Diri *restrict f_tbl, const nut_EulerCtx *ctx){
+	if(self->y != f_tbl->y || self->x != f_tbl->x || ctx->n < self->y){
+		return false;
+	}
+	nut_DiriIndex idx;
+	if(!nut_DiriIndex_init(&idx, self)){
+		return false;
+	}
+	nut_Diri_prefix_sums_kernel(self, m, f_tbl);
+	nut_Diri_conv_N_sparse_kernel(self, m, f_tbl, &idx, 1, self->yinv);
+	nut_DiriIndex_destroy(&idx);
+	nut_euler_sieve_conv_N_ctx_kernel(ctx, self->y, m, f_tbl->buf, self->buf);
+	return true;
+}
+
+/// Kernel for { @link nut_Diri_compute_conv_ctx}
+NUT_ATTR_ALWAYS_INLINE
+static inline bool nut_Diri_compute_conv_ctx_kernel(nut_Diri *restrict self, int64_t m, const nut_Diri *f_tbl, const nut_Diri *g_tbl, const nut_EulerCtx *ctx){
+	if(self->y != f_tbl->y || self->x != f_tbl->x || self->y != g_tbl->y || self->x != g_tbl->x || ctx->n < self->y){
+		return false;
+	}
+	nut_DiriIndex idx;
+	if(!nut_DiriIndex_init(&idx, self)){
+		return false;
+	}
+	nut_Diri_prefix_sums_kernel(self, m, f_tbl);
+	nut_Diri_conv_Fg_sparse_kernel(self, m, f_tbl, g_tbl, &idx, 1, self->yinv);
+	nut_Diri_conv_adjust_kernel(self, m, g_tbl);
+	nut_Diri_conv_fG_sparse_kernel(self, m, f_tbl, g_tbl, &idx, 1, self->yinv);
+	nut_DiriIndex_destroy(&idx);
+	nut_euler_sieve_conv_ctx_kernel(ctx, self->y, m, f_tbl->buf, g_tbl->buf, self->buf);
+	return true;
+}
+
+/// Kernel for { @link nut_Diri_convdiv}
+NUT_ATTR_ALWAYS_INLINE
+static inline bool nut_Diri_convdiv_kernel(nut_Diri *restrict self, int64_t m, const nut_Diri *restrict f_tbl, const nut_Diri *restrict g_tbl){
+	// see the comments on nut_Diri_convdiv in dirichlet.c for the derivation
+	if(self->y != f_tbl->y || self->x != f_tbl->x || self->y != g_tbl->y || self->x != g_tbl->x){
+		return false;
+	}
+	int64_t *H_dense [[gnu::cleanup(cleanup_free)]] = malloc((self->y + 1)*sizeof(int64_t));
+	int64_t *G_dense [[gnu::cleanup(cleanup_free)]] = malloc((self->y + 1)*sizeof(int64_t));
+	nut_DiriIndex idx;
+	if(!H_dense || !G_dense || !nut_DiriIndex_init(&idx, self)){
+		return false;
+	}
+	memset(self->buf, 0, (self->y + 1)*sizeof(int64_t));
+	H_dense[0] = G_dense[0] = 0;
+	// First, we "sieve" the values of h into the dense part of the output
+	for(int64_t i = 1; i <= self->y; ++i){
+		self->buf[i] = nut_kernel_mod(self->buf[i] + f_tbl->buf[i], m);
+		if(!self->buf[i]){
+			continue;
+		}
+		for(int64_t j = 2; j <= self->y/i; ++j){
+			self->buf[i*j] = nut_kernel_mod(self->buf[i*j] - self->buf[i]*g_tbl->buf[j], m);
+		}
+	}
+	// Now, accumulate the sums of dense h values into H_dense and the sums of dense g values into G_dense
+	for(int64_t i = 1; i <= self->y; ++i){
+		H_dense[i] = nut_kernel_mod(self->buf[i] + H_dense[i - 1], m);
+	}
+	for(int64_t i = 1; i <= self->y; ++i){
+		G_dense[i] = nut_kernel_mod(g_tbl->buf[i] + G_dense[i - 1], m);
+	}
+	// Now we populate the sparse H values in order of increasing v using the formula
+	// H(v) = F(v) + G(vr)H(vr) - sum(n = 2 ... vr, g(n)H(v/n)) - sum(n = 1 ... vr, G(v/n)h(n))
+	nut_QuotientIt it;
+	for(nut_QuotientIt_init(&it, self->x, self->yinv - 1, false); it.i >= 1; nut_QuotientIt_advance(&it, -1)){
+		int64_t i = it.i, v = it.v, vr = it.vr;
+		int64_t n_split = (idx.k_dense + i - 1)/i;
+		if(n_split > vr + 1){
+			n_split = vr + 1;
+		}
+		int128_t H = 0;
+		if(1 <= vr){ // do the extra term of G(v/n)h(n) where n = 1, which is always in the sparse part
+			assert(v >= self->y);
+			H = nut_Diri_get_sparse(g_tbl, i);
+		}
+		int64_t n = 2;
+		for(; n < n_split; ++n){
+			H += (int128_t)nut_Diri_get_dense(g_tbl, n)*nut_Diri_get_sparse(self, i*n);
+			H += (int128_t)nut_Diri_get_dense(self, n)*nut_Diri_get_sparse(g_tbl, i*n);
+		}
+		for(; n <= vr; ++n){
+			int64_t q = nut_DiriIndex_quot(&idx, v, n);
+			H += (int128_t)nut_Diri_get_dense(g_tbl, n)*H_dense[q];
+			H += (int128_t)nut_Diri_get_dense(self, n)*G_dense[q];
+		}
+		// Now H consists of all the sums, so we have to take it and subtract it from F(v) + G(vr)H(vr)
+		assert(v >= self->y);
+		H = nut_Diri_get_sparse(f_tbl, i) + (int128_t)G_dense[vr]*H_dense[vr] - H;
+		nut_Diri_set_sparse(self, i, nut_kernel_mod128(H, m));
+	}
+	nut_DiriIndex_destroy(&idx);
+	return true;
+}
+
+/// Kernel for { @link nut_Poly_mul_modn}
+NUT_ATTR_ALWAYS_INLINE
+static inline bool nut_Poly_mul_modn_kernel(nut_Poly *restrict h, const nut_Poly *f, const nut_Poly *g, int64_t n){
+	if(f->len == 1){
+		return nut_Poly_scale_modn(h, g, f->coeffs[0], n);
+	}else if(g->len == 1){
+		return nut_Poly_scale_modn(h, f, g->coeffs[0], n);
+	}
+	if(!nut_Poly_ensure_cap(h, f->len + g->len - 1)){
+		return false;
+	}
+	for(uint64_t k = 0; k < f->len + g->len - 1; ++k){
+		int64_t c = 0;
+		for(uint64_t i = k >= g->len ? k - g->len + 1 : 0; i < f->len && i <= k; ++i){
+			c = nut_kernel_mod(c + f->coeffs[i]*g->coeffs[k - i], n);
+		}
+		h->coeffs[k] = c;
+	}
+	h->len = f->len + g->len - 1;
+	nut_Poly_normalize(h);
+	return true;
+}
+
+/// Define static functions specialized for a fixed modulus.
+/// For example, `NUT_DEFINE_MOD_KERNELS(p7, 1000000007)` at file scope defines
+/// `p7_euler_sieve_conv_u`, `p7_euler_sieve_conv_N`, `p7_euler_sieve_conv`, `p7_Diri_compute_conv_u`,
+/// `p7_Diri_compute_conv_N`, `p7_Diri_compute_conv`, `p7_Diri_convdiv`, and `p7_Poly_mul`,
+/// as well as `_ctx` versions of the first six taking a { @link nut_EulerCtx}.
+/// These take the same arguments as the library functions they are named after, minus the modulus,
+/// and give the same results as calling those functions with MODULUS.
+/// Unused definitions are discarded by the compiler.
+/// @param [in] name: prefix for the generated functions
+/// @param [in] MODULUS: integer constant expression, at least 1 and at most { @link NUT_MOD_KERNELS_MAX_MODULUS}
+#define NUT_DEFINE_MOD_KERNELS(name, MODULUS) \
+	static_assert((MODULUS) >= 1 && (MODULUS) <= NUT_MOD_KERNELS_MAX_MODULUS, "modulus out of range for " #name); \
+	[[maybe_unused]] static bool name##_euler_sieve_conv_u(int64_t n, const int64_t f_vals[restrict static n+1], int64_t f_conv_u_vals[restrict static n+1]){ \
+		return nut_euler_sieve_conv_u_kernel(n, (MODULUS), f_vals, f_conv_u_vals); \
+	} \
+	[[maybe_unused]] static bool name##_euler_sieve_conv_N(int64_t n, const int64_t f_vals[restrict static n+1], int64_t f_conv_N_vals[restrict static n+1]){ \
+		return nut_euler_sieve_conv_N_kernel(n, (MODULUS), f_vals, f_conv_N_vals); \
+	} \
+	[[maybe_unused]] static bool name##_euler_sieve_conv(int64_t n, const int64_t f_vals[static n+1], const int64_t g_vals[static n+1], int64_t f_conv_vals[restrict static n+1]){ \
+		return nut_euler_sieve_conv_kernel(n, (MODULUS), f_vals, g_vals, f_conv_vals); \
+	} \
+	[[maybe_unused]] static bool name##_Diri_compute_conv_u(nut_Diri *restrict self, const nut_Diri *restrict f_tbl){ \
+		return nut_Diri_compute_conv_u_kernel(self, (MODULUS), f_tbl); \
+	} \
+	[[maybe_unused]] static bool name##_Diri_compute_conv_N(nut_Diri *restrict self, const nut_Diri *restrict f_tbl){ \
+		return nut_Diri_compute_conv_N_kernel(self, (MODULUS), f_tbl); \
+	} \
+	[[maybe_unused]] static bool name##_Diri_compute_conv(nut_Diri *restrict self, const nut_Diri *f_tbl, const nut_Diri *g_tbl){ \
+		return nut_Diri_compute_conv_kernel(self, (MODULUS), f_tbl, g_tbl); \
+	} \
+	[[maybe_unused]] static void name##_euler_sieve_conv_u_ctx(const nut_EulerCtx *ctx, int64_t n, const int64_t f_vals[restrict static n+1], int64_t f_conv_u_vals[restrict static n+1]){ \
+		nut_euler_sieve_conv_u_ctx_kernel(ctx, n, (MODULUS), f_vals, f_conv_u_vals); \
+	} \
+	[[maybe_unused]] static void name##_euler_sieve_conv_N_ctx(const nut_EulerCtx *ctx, int64_t n, const int64_t f_vals[restrict static n+1], int64_t f_conv_N_vals[restrict static n+1]){ \
+		nut_euler_sieve_conv_N_ctx_kernel(ctx, n, (MODULUS), f_vals, f_conv_N_vals); \
+	} \
+	[[maybe_unused]] static void name##_euler_sieve_conv_ctx(const nut_EulerCtx *ctx, int64_t n, const int64_t f_vals[static n+1], const int64_t g_vals[static n+1], int64_t f_conv_vals[restrict static n+1]){ \
+		nut_euler_sieve_conv_ctx_kernel(ctx, n, (MODULUS), f_vals, g_vals, f_conv_vals); \
+	} \
+	[[maybe_unused]] static bool name##_Diri_compute_conv_u_ctx(nut_Diri *restrict self, const nut_Diri *restrict f_tbl, const nut_EulerCtx *ctx){ \
+		return nut_Diri_compute_conv_u_ctx_kernel(self, (MODULUS), f_tbl, ctx); \
+	} \
+	[[maybe_unused]] static bool name##_Diri_compute_conv_N_ctx(nut_Diri *restrict self, const nut_Diri *restrict f_tbl, const nut_EulerCtx *ctx){ \
+		return nut_Diri_compute_conv_N_ctx_kernel(self, (MODULUS), f_tbl, ctx); \
+	} \
+	[[maybe_unused]] static bool name##_Diri_compute_conv_ctx(nut_Diri *restrict self, const nut_Diri *f_tbl, const nut_Diri *g_tbl, const nut_EulerCtx *ctx){ \
+		return nut_Diri_compute_conv_ctx_kernel(self, (MODULUS), f_tbl, g_tbl, ctx); \
+	} \
+	[[maybe_unused]] static bool name##_Diri_convdiv(nut_Diri *restrict self, const nut_Diri *restrict f_tbl, const nut_Diri *restrict g_tbl){ \
+		return nut_Diri_convdiv_kernel(self, (MODULUS), f_tbl, g_tbl); \
+	} \
+	[[maybe_unused]] static bool name##_Poly_mul(nut_Poly *restrict h, const nut_Poly *f, const nut_Poly *g){ \
+		return nut_Poly_mul_modn_kernel(h, f, g, (MODULUS)); \
+	}
+
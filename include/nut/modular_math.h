@@ -96,6 +96,13 @@ typedef struct{
 #define NUT_ATTR_ARTIFICIAL
 #endif
 
+/// Wrapper for gnu::always_inline attr - used for kernels that should be specialized at each call site, see { @link mod_kernels.h}
+#if !defined(DOXYGEN)
+#define NUT_ATTR_ALWAYS_INLINE [[gnu::always_inline]]
+#else
+#define NUT_ATTR_ALWAYS_INLINE
+#endif
+
 /// Compute nonnegative integral power of integer using binary exponentiation.
 /// @param [in] b, e: base and exponent
 /// @return b^e, not checked for overflow
@@ -135,9 +142,8 @@ uint64_t nut_u64_binom_next(uint64_t n, uint64_t k, uint64_t prev);
 
 /// Generate a (pseudo)random integer uniformly from [a, b).
 ///
-/// Currently calls { @link nut_u64_rand} so this number is generated from /dev/random
-/// but this function exists to provide a weaker, pseudorandom number source
-/// if this turns out to be a bottleneck.
+/// Uses a per thread xoshiro256** generator seeded from { @link nut_u64_rand} on the first call in each thread,
+/// so after that no syscalls are made.  This is fast enough to fill large tables but is NOT cryptographically secure.
 /// @param [in] a, b: bounds of the interval [a, b)
 /// @return (pseudo)random integer uniformly chosen from [a, b)
 uint64_t nut_u64_prand(uint64_t a, uint64_t b);
@@ -198,6 +204,33 @@ int64_t nut_i64_crt(int64_t a, int64_t p, int64_t b, int64_t q);
 NUT_ATTR_CONST
 int128_t nut_i128_crt(int64_t a, int64_t p, int64_t b, int64_t q);
 
+/// Find the multiplicative inverses of many numbers mod the same n.
+/// Uses Montgomery's simultaneous inversion trick: the prefix products are inverted with a single extended Euclidean algorithm,
+/// and then unwound, for a total of 3(count - 1) modular multiplications.
+/// Unlike { @link nut_i64_modinv}, n can be any uint64_t.
+/// @param [in] n: the modulus
+/// @param [in] count: the number of values to invert
+/// @param [in] in: the values to invert
+/// @param [out] out: out[i] is set to the inverse of in[i] mod n.  Must not overlap with in.
+/// @return true on success, false if some in[i] is not invertible mod n, in which case the contents of out are unspecified
+NUT_ATTR_ACCESS(read_only, 3, 2)
+NUT_ATTR_ACCESS(write_only, 4, 2)
+bool nut_u64_modinv_batch(uint64_t n, uint64_t count, const uint64_t in[restrict static count], uint64_t out[restrict static count]);
+
+/// Compute the x < m[0]*...*m[k-1] st x = a[i] mod m[i] for all i, where the moduli are pairwise coprime.
+/// Uses Garner's algorithm: the mixed radix digits of x are found one at a time, working only with single word residues,
+/// and then x is assembled in place with Horner's rule on multiword integers, so no bignum library is needed.
+/// This takes O(k^2) modular multiplications and k modular inverses.
+/// @param [in] k: the number of congruences
+/// @param [in] a: the residues, which should be reduced
+/// @param [in] m: the moduli, which should be pairwise coprime and positive
+/// @param [out] out: x as k little endian 64 bit words (for k = 2, this is the same layout as a uint128_t on little endian platforms)
+/// @return true on success, false if the moduli are not pairwise coprime
+NUT_ATTR_ACCESS(read_only, 2, 1)
+NUT_ATTR_ACCESS(read_only, 3, 1)
+NUT_ATTR_ACCESS(write_only, 4, 1)
+bool nut_u64_crt_multi(uint64_t k, const uint64_t a[restrict static k], const uint64_t m[restrict static k], uint64_t out[restrict static k]);
+
 /// Compute the least common multiple of a and b
 /// Divides the product by the gcd so can overflow for large arguments
 /// @param [in] a, b: numbers to find nut_i64_lcm of
@@ -366,3 +399,82 @@ int64_t nut_i64_fastmod_floor(int64_t n, uint64_t pd, uint128_t c);
 NUT_ATTR_CONST
 uint64_t nut_u64_fastmod(uint64_t n, uint64_t d, uint128_t c);
 
+
+/// Precomputed constants for Montgomery multiplication modulo an odd n, with R = 2^64.
+/// Numbers in Montgomery form are stored as aR mod n, so that multiplying two of them and reducing
+/// with { @link nut_Montgomery_redc} gives abR mod n without any division.
+/// Any odd n < 2^64 works, because the reduction subtracts the high words instead of adding them.
+typedef struct{
+	/// The modulus, must be odd
+	uint64_t n;
+	/// n^-1 mod 2^64
+	uint64_t ninv;
+	/// R^2 mod n, used to convert into Montgomery form
+	uint64_t r2;
+	/// R mod n, ie 1 in Montgomery form
+	uint64_t one;
+} nut_Montgomery;
+
+/// Set up Montgomery multiplication for a given modulus
+/// @param [out] self: constants to initialize
+/// @param [in] n: modulus, must be odd
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(write_only, 1)
+void nut_Montgomery_init(nut_Montgomery *self, uint64_t n);
+
+/// Montgomery reduction: compute tR^-1 mod n
+/// @param [in] self: constants from { @link nut_Montgomery_init}
+/// @param [in] t: number to reduce, must be less than nR
+/// @return tR^-1 mod n, in [0, n)
+NUT_ATTR_PURE
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(read_only, 1)
+static inline uint64_t nut_Montgomery_redc(const nut_Montgomery *self, uint128_t t){
+	uint64_t m = (uint64_t)t*self->ninv;
+	uint64_t t_hi = t >> 64, mn_hi = ((uint128_t)m*self->n) >> 64;
+	// the low words of t and mn are equal, so (t - mn)/R is just the difference of the high words
+	return t_hi >= mn_hi ? t_hi - mn_hi : t_hi - mn_hi + self->n;
+}
+
+/// Multiply two numbers in Montgomery form
+/// @param [in] self: constants from { @link nut_Montgomery_init}
+/// @param [in] a, b: factors in Montgomery form
+/// @return ab in Montgomery form
+NUT_ATTR_PURE
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(read_only, 1)
+static inline uint64_t nut_Montgomery_mul(const nut_Montgomery *self, uint64_t a, uint64_t b){
+	return nut_Montgomery_redc(self, (uint128_t)a*b);
+}
+
+/// Convert a number into Montgomery form
+/// @param [in] self: constants from { @link nut_Montgomery_init}
+/// @param [in] a: number to convert, any value (it is reduced mod n first)
+/// @return aR mod n
+NUT_ATTR_PURE
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(read_only, 1)
+static inline uint64_t nut_Montgomery_to(const nut_Montgomery *self, uint64_t a){
+	return nut_Montgomery_mul(self, a%self->n, self->r2);
+}
+
+/// Convert a number out of Montgomery form
+/// @param [in] self: constants from { @link nut_Montgomery_init}
+/// @param [in] a: number in Montgomery form
+/// @return aR^-1 mod n
+NUT_ATTR_PURE
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(read_only, 1)
+static inline uint64_t nut_Montgomery_from(const nut_Montgomery *self, uint64_t a){
+	return nut_Montgomery_redc(self, a);
+}
+
+/// Raise a number in Montgomery form to a power using binary exponentiation
+/// @param [in] self: constants from { @link nut_Montgomery_init}
+/// @param [in] b: base in Montgomery form
+/// @param [in] e: exponent
+/// @return b^e in Montgomery form
+NUT_ATTR_PURE
+NUT_ATTR_NONNULL(1)
+NUT_ATTR_ACCESS(read_only, 1)
+uint64_t nut_Montgomery_pow(const nut_Montgomery *self, uint64_t b, uint64_t e);
@@ -0,0 +1,32 @@
+#pragma once
+
+/// @file
+/// @author hacatu
+/// @version 0.2.0
+/// @section LICENSE
+/// This Source Code Form is subject to the terms of the Mozilla Public
+/// License, v. 2.0. If a copy of the MPL was not distributed with this
+/// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+/// @section DESCRIPTION
+/// Minimal fork/join helpers on top of pthreads, used by the parallel versions of the
+/// Dirichlet hyperbola functions.  There is no persistent pool: each call starts its workers and joins them,
+/// which costs a few tens of microseconds and is negligible next to the convolutions this is used for.
+
+#include <inttypes.h>
+#include <stddef.h>
+
+#include <nut/modular_math.h>
+
+/// Get the number of threads to use when a function taking a thread count is passed 0.
+/// @return the number of online processors, or 1 if that can't be determined
+uint64_t nut_parallel_default_threads();
+
+/// Run fn on each of num_tasks argument structs concurrently and wait for all of them to finish.
+/// The first task runs on the calling thread.  If a thread can't be started, its task runs on the calling thread
+/// instead, so this never fails, it just gets less parallel.
+/// @param [in] num_tasks: number of tasks
+/// @param [in] fn: worker function.  Its return value is ignored
+/// @param [in,out] args: array of num_tasks argument structs, each arg_size bytes.  Task i gets args + i*arg_size
+/// @param [in] arg_size: size of each argument struct
+NUT_ATTR_NONNULL(2, 3)
+void nut_parallel_run(uint64_t num_tasks, void *(*fn)(void*), void *args, size_t arg_size);
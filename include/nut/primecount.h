@@ -0,0 +1,64 @@
+#pragma once
+
+/// @file
+/// @author hacatu
+/// @version 0.2.0
+/// @section LICENSE
+/// This Source Code Form is subject to the terms of the Mozilla Public
+/// License, v. 2.0. If a copy of the MPL was not distributed with this
+/// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+/// @section DESCRIPTION
+/// Combinatorial prime counting in about O(x^(2/3)/log(x)) time and O(x^(1/3)log(x)) space per thread.
+/// { @link nut_Diri_compute_pi} is simpler and gives pi(x/n) for every n, but takes O(x^(3/4)/log(x)) time
+/// and O(sqrt(x)) space, so when only pi(x) itself is needed this is much faster for large x.
+///
+/// This is the Lagarias-Miller-Odlyzko method with the Deleglise-Rivat refinements that matter most in practice.
+/// We pick y with x^(1/3) <= y <= sqrt(x), let a = pi(y), and write phi(v, b) for the number of integers in [1, v]
+/// with no prime factor among the first b primes.  Then
+/// pi(x) = phi(x, a) + a - 1 - P2(x, a), where P2 counts the numbers up to x with exactly two prime factors greater than y,
+/// and phi(x, a) = S1 + S2 is split into ordinary leaves S1 = sum(mu(m)floor(x/m), m <= y) and special leaves
+/// S2 = -sum(mu(m)phi(x/(m p_(b+1)), b)) over squarefree m <= y < m p_(b+1) whose prime factors all exceed p_(b+1).
+///
+/// Special leaves with x/(m p_(b+1)) < min(y, p_(b+1)^2) are "easy": phi of them is 1 + max(0, pi(v) - b), read from a table.
+/// When m is prime, runs of consecutive m with the same pi(v), including all the leaves with phi = 1, are counted at once.
+/// The rest are "hard", and are found by sieving [1, x/y] in segments, removing one prime at a time and keeping a Fenwick tree
+/// over the segment so that phi(v, b) is available at every level b in O(log) time.  P2 needs pi(v) for v in [sqrt(x), x/y],
+/// which is exactly phi(v, a) + a - 1, so it is computed from the same sieve once all a primes have been removed.
+/// The sieve interval is split into one contiguous chunk per thread.  Each chunk only knows phi relative to its own start,
+/// so it records the total weight of the leaves it saw at every level, and the offsets are applied when the chunks are combined in order.
+/// Within a segment, only the levels with a prime below sqrt(hi) (which still remove something) or with leaves left are visited,
+/// so the work per segment is about pi(sqrt(hi)) + pi(sqrt(x/lo)) rather than pi(y).
+
+#include <inttypes.h>
+
+#include <nut/modular_math.h>
+
+/// Below this, { @link nut_u64_pi} just sieves all primes up to x
+#define NUT_PI_SIEVE_MAX (UINT64_C(1) << 20)
+
+/// Shortest length of the segments the hard leaves are sieved in.
+/// The segment needs one byte per number for the sieve and four for the Fenwick tree, so this keeps both in L2 cache.
+/// For larger x, the length grows like sqrt(x/y), up to { @link NUT_PI_SEGMENT_MAX_LEN}
+#define NUT_PI_SEGMENT_LEN (UINT64_C(1) << 16)
+
+/// Longest length of the segments the hard leaves are sieved in
+#define NUT_PI_SEGMENT_MAX_LEN (UINT64_C(1) << 18)
+
+/// Pick the cutoff y for { @link nut_u64_pi}.
+/// y trades the number of special leaves (which grows with y) against the length of the sieve interval x/y.
+/// @param [in] x: the argument to pi
+/// @return y = alpha*cbrt(x) with alpha = log(x)^2/100, clamped to [cbrt(x), sqrt(x)] and below 2^31
+NUT_ATTR_CONST
+uint64_t nut_u64_pi_cutoff(uint64_t x);
+
+/// Count the primes up to x.
+/// See the file description for the algorithm.  All arithmetic on partial sums is done in 128 bits, so every 64 bit x is supported,
+/// but the running time grows like x^(2/3)/log(x), so on one core 1e14 takes seconds and 1e19 takes many hours.
+/// On one x86_64 core, 1e13 takes about 1.5s, 1e14 about 6s, and 1e15 about 27s.
+/// @param [in] x: upper bound (inclusive)
+/// @param [in] num_threads: number of threads to sieve with, or 0 to use { @link nut_parallel_default_threads}
+/// @param [out] out: pi(x)
+/// @return true on success, false on allocation failure
+NUT_ATTR_NONNULL(3)
+NUT_ATTR_ACCESS(write_only, 3)
+bool nut_u64_pi(uint64_t x, uint64_t num_threads, uint64_t *out);
@@ -0,0 +1,34 @@
+#pragma once
+
+/// @file
+/// @author hacatu
+/// @version 0.2.0
+/// @section LICENSE
+/// This Source Code Form is subject to the terms of the Mozilla Public
+/// License, v. 2.0. If a copy of the MPL was not distributed with this
+/// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+/// @section DESCRIPTION
+/// Self initializing quadratic sieve, for splitting composites which are too large
+/// for Pollard-Rho-Brent and Lenstra ecf to handle quickly (roughly 2^60 up to 2^128).
+
+#include <inttypes.h>
+
+#include <nut/modular_math.h>
+
+/// Find a nontrivial factor of n using the self initializing quadratic sieve (SIQS).
+///
+/// A Knuth-Schroeppel multiplier is picked, then relations are collected by sieving polynomials
+/// (Ax+B)^2 - kn over an interval split into L1 sized blocks, where A is a product of factor base primes
+/// so that 2^(s-1) values of B can be switched between cheaply (the "self initializing" part).
+/// Partial relations with one large prime are kept and paired up when their large primes match.
+/// Finally, dependencies are found with Gaussian elimination over GF(2) and tried until one gives a factor.
+///
+/// The sieving is split between num_threads threads, each working on its own A values and sharing a relation store.
+/// This is only worthwhile for n over about 2^60; smaller numbers should go to { @link nut_u64_factor1_lenstra } etc.
+/// n should be odd, composite, and not a perfect power.  Even numbers, perfect squares, and numbers with a
+/// factor in the factor base are handled, but other perfect powers will just fail.
+/// @param [in] n: number to find a factor of
+/// @param [in] num_threads: number of threads to sieve on, including the calling thread.  0 is treated as 1.
+/// @return a nontrivial factor of n, or 1 if none could be found (eg n is prime, or allocation failed)
+NUT_ATTR_NODISCARD
+uint128_t nut_u128_factor1_siqs(uint128_t n, uint64_t num_threads);
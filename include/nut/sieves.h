@@ -97,6 +97,7 @@ static inline uint8_t nut_Bitfield2_arr_get(const uint8_t *buf, uint64_t i){
 }
 
 /// Calculate factorials and inverse factorials for a given upper bound and modulus
+/// Only the largest inverse factorial is found with the extended Euclidean algorithm, the rest are found by multiplying back down.
 /// @param [in] k: factorials[bits + k - 1] is the last factorial that will be computed
 /// @param [in] modulus: modulus to reduce result by.  Must be large enough that all inv factorials are actually invertable
 /// @param [in] bits: used with k to find the last factorial to compute
@@ -0,0 +1,36 @@
+#include <stdio.h>
+#include <inttypes.h>
+#include <stdlib.h>
+
+#include <nut/dirichlet.h>
+#include <nut/dirichlet_cost.h>
+
+int main(int argc, char **argv){
+	if(argc < 2 || argc > 3){
+		fprintf(stderr, "\e[1;31mNo output file specified.  Please use like\e[0m\n\e[1;31m%s <FILE> [X]\e[0m\n", argv[0]);
+		exit(EXIT_FAILURE);
+	}
+	int64_t x = 0;
+	if(argc == 3){
+		char *str_end = NULL;
+		x = strtoll(argv[2], &str_end, 10);
+		if(!str_end || str_end == argv[2] || x < 1000000){
+			fprintf(stderr, "\e[1;31mCould not parse X, or it is less than 10^6\e[0m\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+	fprintf(stderr, "\e[1;34mTiming Dirichlet table operations...\e[0m\n");
+	nut_DiriCostModel model;
+	if(!nut_DiriCostModel_calibrate(&model, x)){
+		fprintf(stderr, "\e[1;31mCould not allocate memory!\e[0m\n");
+		exit(EXIT_FAILURE);
+	}
+	if(!nut_DiriCostModel_save(&model, argv[1])){
+		fprintf(stderr, "\e[1;31mCould not write %s\e[0m\n", argv[1]);
+		exit(EXIT_FAILURE);
+	}
+	printf("%-8s %12s %12s %12s %12s\n", "op", "dense", "sparse", "dense mod", "sparse mod");
+	for(uint64_t op = 0; op < NUT_DIRI_NUM_OPS; ++op){
+		printf("%-8s %12.4g %12.4g %12.4g %12.4g\n", nut_diri_op_names[op], model.dense[op][0], model.sparse[op][0], model.dense[op][1], model.sparse[op][1]);
+	}
+}
@@ -1,12 +1,28 @@
 #include "nut/debug.h"
 #include <stdlib.h>
+#include <stdio.h>
 #include <string.h>
+#include <math.h>
+
+#if __has_include(<sys/mman.h>)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define NUT_DIRI_MMAP 1
+#endif
 
 #include <nut/matrix.h>
 #include <nut/modular_math.h>
 #include <nut/factorization.h>
 #include <nut/dirichlet.h>
 #include <nut/sieves.h>
+#include <nut/mod_kernels.h>
+#include <nut/parallel.h>
+
+// specialized copies of the hot loops for the most common moduli, see mod_kernels.h
+NUT_DEFINE_MOD_KERNELS(p1e9_7, 1000000007)
+NUT_DEFINE_MOD_KERNELS(p998244353, 998244353)
 
 uint64_t nut_dirichlet_D(uint64_t max, uint64_t m){
 	uint64_t y = nut_u64_nth_root(max, 2);
@@ -37,14 +53,6 @@ uint64_t nut_dirichlet_Sigma(uint64_t max, uint64_t m){
 	}
 }
 
-static inline bool is_composite_unpacked(uint64_t n, const uint8_t buf[static n/8 + 1]){
-	return buf[n/8] & (1 << (n%8));
-}
-
-static inline void mark_composite_unpacked(uint64_t n, uint8_t buf[static n/8 + 1]){
-	buf[n/8] |= (1 << (n%8));
-}
-
 // Implemented based on (https://gbroxey.github.io/blog/2023/04/30/mult-sum-1.html)
 // in turn based on (https://codeforces.com/blog/entry/54090)
 // which is just euler's sieve (https://en.wikipedia.org/wiki/Sieve_of_Eratosthenes#Euler's_sieve)
@@ -73,7 +81,9 @@ static inline void mark_composite_unpacked(uint64_t n, uint8_t buf[static n/8 +
 // 17.      And smallest_ppow[i*p] = p
 // Notice that we don't really need the smallest_ppow array, since we only use it when we know p the smallest prime divisor of i,
 // we could just use a while loop to count how many times p divides i or find the largest power of p which divides i, but this is a space/time tradeoff.
-// Also notice that we can cache smallest_ppow, primes, and is_c_buf, although the current implementation does not do that.
+// Also notice that smallest_ppow and primes don't depend on f or g at all, so they can be computed once and reused for many convolutions.
+// nut_EulerCtx does this, and packs smallest_ppow into 32 bits by storing p instead of i for prime powers i = p**a, so that
+// nut_euler_sieve_conv_ctx can compute h(i) in order of increasing i from h(smallest_ppow[i]) and h(i/smallest_ppow[i]) alone.
 // On the other hand, the sieve of Eratosthenes generally works as follows:
 // 1. Initialize result[1, ..., n] = 1
 // 2. For i = 2, ..., n:
@@ -87,203 +97,110 @@ static inline void mark_composite_unpacked(uint64_t n, uint8_t buf[static n/8 +
 // HOWEVER, when (f <*> g)(n) can be 1 for composite values of n, this is a problem because result[i] = 1 no longer means i is prime.
 // For convolutions which can be 1 for composite inputs, we would need to allocate a separate array to store whether or not each i is prime.
 bool nut_euler_sieve_conv_u(int64_t n, int64_t modulus, const int64_t f_vals[restrict static n+1], int64_t f_conv_u_vals[restrict static n+1]){
-	int64_t *smallest_ppow = malloc((n+1)*sizeof(int64_t));
-	uint8_t *is_c_buf = calloc(n/8 + 1, sizeof(uint8_t));
-	uint64_t num_primes = 0;
-	int64_t *primes = malloc(nut_max_primes_le(n)*sizeof(int64_t));
-	if(!smallest_ppow || !is_c_buf || !primes){
-		free(smallest_ppow);
-		free(is_c_buf);
-		free(primes);
+	switch(modulus){
+		case 1000000007: return p1e9_7_euler_sieve_conv_u(n, f_vals, f_conv_u_vals);
+		case 998244353: return p998244353_euler_sieve_conv_u(n, f_vals, f_conv_u_vals);
+		default: return nut_euler_sieve_conv_u_kernel(n, modulus, f_vals, f_conv_u_vals);
+	}
+}
+
+bool nut_euler_sieve_conv_N(int64_t n, int64_t modulus, const int64_t f_vals[restrict static n+1], int64_t f_conv_N_vals[restrict static n+1]){
+	switch(modulus){
+		case 1000000007: return p1e9_7_euler_sieve_conv_N(n, f_vals, f_conv_N_vals);
+		case 998244353: return p998244353_euler_sieve_conv_N(n, f_vals, f_conv_N_vals);
+		default: return nut_euler_sieve_conv_N_kernel(n, modulus, f_vals, f_conv_N_vals);
+	}
+}
+
+bool nut_euler_sieve_conv(int64_t n, int64_t modulus, const int64_t f_vals[static n+1], const int64_t g_vals[static n+1], int64_t f_conv_vals[restrict static n+1]){
+	switch(modulus){
+		case 1000000007: return p1e9_7_euler_sieve_conv(n, f_vals, g_vals, f_conv_vals);
+		case 998244353: return p998244353_euler_sieve_conv(n, f_vals, g_vals, f_conv_vals);
+		default: return nut_euler_sieve_conv_kernel(n, modulus, f_vals, g_vals, f_conv_vals);
+	}
+}
+
+bool nut_EulerCtx_init(nut_EulerCtx *self, int64_t n){
+	if(n < 1 || n > NUT_EULER_CTX_MAX_N){
+		return false;
+	}
+	// 0 marks numbers that have not been crossed off yet, ie primes
+	self->smallest_ppow = calloc(n + 1, sizeof(uint32_t));
+	self->primes = malloc(nut_max_primes_le(n)*sizeof(uint32_t));
+	if(!self->smallest_ppow || !self->primes){
+		nut_EulerCtx_destroy(self);
 		return false;
 	}
-	f_conv_u_vals[1] = 1;
+	self->n = n;
+	self->num_primes = 0;
 	for(int64_t i = 2; i <= n; ++i){
-		// if i is prime, add it to the list of primes
-		if(!is_composite_unpacked(i, is_c_buf)){
-			primes[num_primes++] = i;
-			int64_t term = f_vals[i] + 1;
-			f_conv_u_vals[i] = modulus ? nut_i64_mod(term, modulus) : term;
-			smallest_ppow[i] = i;
-		}
-		// the key feature of euler's sieve is that it ONLY marks off multiples
-		// of each number i times primes <= i.  This requires storing an array of
-		// primes and reading it A LOT of times, but ensures that each composite number
-		// is visited only once
-		for(uint64_t j = 0; j < num_primes; ++j){
-			int64_t p = primes[j], m;
-			if(__builtin_mul_overflow(p, i, &m) || m > n){
+		uint32_t q = self->smallest_ppow[i];
+		if(!q){
+			self->primes[self->num_primes++] = i;
+			self->smallest_ppow[i] = q = NUT_EULER_CTX_PRIME_POWER | i;
+		}
+		// find the smallest prime p0 dividing i and the largest power of it dividing i
+		int64_t p0, ppow;
+		if(q & NUT_EULER_CTX_PRIME_POWER){
+			p0 = q & ~NUT_EULER_CTX_PRIME_POWER;
+			ppow = i;
+		}else{
+			p0 = self->smallest_ppow[q] & ~NUT_EULER_CTX_PRIME_POWER;
+			ppow = q;
+		}
+		for(uint64_t j = 0; j < self->num_primes; ++j){
+			int64_t p = self->primes[j];
+			if(p > p0 || p*i > n){
 				break;
+			}else if(p < p0){
+				self->smallest_ppow[p*i] = p;
+			}else{
+				self->smallest_ppow[p*i] = ppow == i ? NUT_EULER_CTX_PRIME_POWER | p : ppow*p;
 			}
-			mark_composite_unpacked(m, is_c_buf);
-			if(i%p == 0){// i is a multiple of p, so in particular i and p are not coprime
-				// also notice that because we break out of this loop at the bottom of this if statement,
-				// p is in fact the smallest prime divisor of i
-				int64_t ppow = smallest_ppow[i];
-				int64_t B = ppow*p;
-				smallest_ppow[m] = B;
-				int64_t v = i/ppow;
-				if(v != 1){// i is not a perfect power of p, that is, i = v*p**a with v != 1
-					int64_t term = f_conv_u_vals[v]*f_conv_u_vals[B];
-					f_conv_u_vals[m] = modulus ? nut_i64_mod(term, modulus) : term;
-				}else{// i is a perfect power of p (and so is m)
-					// from the definition, (f <*> u)(p**a) = f(1)*u(p**a) + f(p)*u(p**(a-1)) + ... + f(p**a)*u(1)
-					// = f(1) + f(p) + ... + f(p**a) = (f <*> u)(p**(a-1)) + f(p**a)
-					int64_t term = f_conv_u_vals[i] + f_vals[m];
-					f_conv_u_vals[m] = modulus ? nut_i64_mod(term, modulus) : term;
-				}
-				break;
-			}// otherwise, i and p are coprime, so (f <*> u)(i*p) = (f <*> u)(i)*(f <*> u)(p)
-			int64_t term = f_conv_u_vals[i]*f_conv_u_vals[p];
-			f_conv_u_vals[m] = modulus ? nut_i64_mod(term, modulus) : term;
-			smallest_ppow[m] = p;
 		}
 	}
-	free(smallest_ppow);
-	free(primes);
-	free(is_c_buf);
 	return true;
 }
 
-bool nut_euler_sieve_conv_N(int64_t n, int64_t modulus, const int64_t f_vals[restrict static n+1], int64_t f_conv_N_vals[restrict static n+1]){
-	int64_t *smallest_ppow = malloc((n+1)*sizeof(int64_t));
-	uint8_t *is_c_buf = calloc(n/8 + 1, sizeof(uint8_t));
-	uint64_t num_primes = 0;
-	int64_t *primes = malloc(nut_max_primes_le(n)*sizeof(int64_t));
-	if(!smallest_ppow || !is_c_buf || !primes){
-		free(smallest_ppow);
-		free(is_c_buf);
-		free(primes);
+void nut_EulerCtx_destroy(nut_EulerCtx *self){
+	free(self->smallest_ppow);
+	free(self->primes);
+	*self = (nut_EulerCtx){};
+}
+
+bool nut_euler_sieve_conv_u_ctx(const nut_EulerCtx *ctx, int64_t n, int64_t modulus, const int64_t f_vals[restrict static n+1], int64_t f_conv_u_vals[restrict static n+1]){
+	if(n > ctx->n){
 		return false;
 	}
-	f_conv_N_vals[1] = 1;
-	for(int64_t i = 2; i <= n; ++i){
-		// if i is prime, add it to the list of primes
-		if(!is_composite_unpacked(i, is_c_buf)){
-			primes[num_primes++] = i;
-			int64_t term = f_vals[i] + i;
-			f_conv_N_vals[i] = modulus ? nut_i64_mod(term, modulus) : term;
-			smallest_ppow[i] = i;
-		}
-		// the key feature of euler's sieve is that it ONLY marks off multiples
-		// of each number i times primes <= i.  This requires storing an array of
-		// primes and reading it A LOT of times, but ensures that each composite number
-		// is visited only once
-		for(uint64_t j = 0; j < num_primes; ++j){
-			int64_t p = primes[j], m;
-			if(__builtin_mul_overflow(p, i, &m) || m > n){
-				break;
-			}
-			mark_composite_unpacked(m, is_c_buf);
-			if(i%p == 0){// i is a multiple of p, so in particular i and p are not coprime
-				// also notice that because we break out of this loop at the bottom of this if statement,
-				// p is in fact the smallest prime divisor of i
-				int64_t ppow = smallest_ppow[i];
-				int64_t B = ppow*p;
-				smallest_ppow[m] = B;
-				int64_t v = i/ppow;
-				if(v != 1){// i is not a perfect power of p, that is, i = v*p**a with v != 1
-					int64_t term = f_conv_N_vals[v]*f_conv_N_vals[B];
-					f_conv_N_vals[m] = modulus ? nut_i64_mod(term, modulus) : term;
-				}else{// i is a perfect power of p (and so is m)
-					// from the definition, (f <*> N)(p**a) = f(1)*N(p**a) + f(p)*N(p**(a-1)) + ... + f(p**a)*N(1)
-					// = f(1)*p**a + f(p)*p**(a-1) + ... + f(p**a)*1 = p*(f <*> N)(p**(a-1)) + f(p**a)
-					if(modulus){
-						int64_t term = (p%modulus)*f_conv_N_vals[i] + f_vals[m];
-						f_conv_N_vals[m] = nut_i64_mod(term, modulus);
-					}else{
-						f_conv_N_vals[m] = p*f_conv_N_vals[i] + f_vals[m];
-					}
-				}
-				break;
-			}// otherwise, i and p are coprime, so (f <*> u)(i*p) = (f <*> u)(i)*(f <*> u)(p)
-			int64_t term = f_conv_N_vals[i]*f_conv_N_vals[p];
-			f_conv_N_vals[m] = modulus ? nut_i64_mod(term, modulus) : term;
-			smallest_ppow[m] = p;
-		}
+	switch(modulus){
+		case 1000000007: p1e9_7_euler_sieve_conv_u_ctx(ctx, n, f_vals, f_conv_u_vals); break;
+		case 998244353: p998244353_euler_sieve_conv_u_ctx(ctx, n, f_vals, f_conv_u_vals); break;
+		default: nut_euler_sieve_conv_u_ctx_kernel(ctx, n, modulus, f_vals, f_conv_u_vals);
 	}
-	free(smallest_ppow);
-	free(primes);
-	free(is_c_buf);
 	return true;
 }
 
-bool nut_euler_sieve_conv(int64_t n, int64_t modulus, const int64_t f_vals[static n+1], const int64_t g_vals[static n+1], int64_t f_conv_vals[restrict static n+1]){
-	int64_t *smallest_ppow = malloc((n+1)*sizeof(int64_t));
-	uint8_t *is_c_buf = calloc(n/8 + 1, sizeof(uint8_t));
-	uint64_t num_primes = 0;
-	int64_t *primes = malloc(nut_max_primes_le(n)*sizeof(int64_t));
-	if(!smallest_ppow || !is_c_buf || !primes){
-		free(smallest_ppow);
-		free(is_c_buf);
-		free(primes);
+bool nut_euler_sieve_conv_N_ctx(const nut_EulerCtx *ctx, int64_t n, int64_t modulus, const int64_t f_vals[restrict static n+1], int64_t f_conv_N_vals[restrict static n+1]){
+	if(n > ctx->n){
 		return false;
 	}
-	f_conv_vals[1] = 1;
-	for(int64_t i = 2; i <= n; ++i){
-		// if i is prime, add it to the list of primes
-		if(!is_composite_unpacked(i, is_c_buf)){
-			primes[num_primes++] = i;
-			int64_t term = f_vals[i] + g_vals[i];
-			f_conv_vals[i] = modulus ? nut_i64_mod(term, modulus) : term;
-			smallest_ppow[i] = i;
-		}
-		// the key feature of euler's sieve is that it ONLY marks off multiples
-		// of each number i times primes <= i.  This requires storing an array of
-		// primes and reading it A LOT of times, but ensures that each composite number
-		// is visited only once
-		for(uint64_t j = 0; j < num_primes; ++j){
-			int64_t p = primes[j], m;
-			if(__builtin_mul_overflow(p, i, &m) || m > n){
-				break;
-			}
-			mark_composite_unpacked(m, is_c_buf);
-			if(i%p == 0){// i is a multiple of p, so in particular i and p are not coprime
-				// also notice that because we break out of this loop at the bottom of this if statement,
-				// p is in fact the smallest prime divisor of i
-				int64_t ppow = smallest_ppow[i];
-				int64_t B = ppow*p;
-				smallest_ppow[m] = B;
-				int64_t v = i/ppow;
-				if(v != 1){// i is not a perfect power of p, that is, i = v*p**a with v != 1
-					int64_t term = f_conv_vals[v]*f_conv_vals[B];
-					f_conv_vals[m] = modulus ? nut_i64_mod(term, modulus) : term;
-				}else{// i is a perfect power of p (and so is m)
-					// from the definition, (f <*> g)(p**a) = f(1)*g(p**a) + f(p)*g(p**(a-1)) + ... + f(p**a)*g(1)
-					int64_t c = f_vals[m] + g_vals[m];
-					if(modulus){
-						c = nut_i64_mod(c, modulus);
-					}
-					int64_t A = p;
-					while(A < ppow){
-						if(modulus){
-							c = nut_i64_mod(c + f_vals[A]*g_vals[ppow], modulus);
-							c = nut_i64_mod(c + f_vals[ppow]*g_vals[A], modulus);
-						}else{
-							c += f_vals[A]*g_vals[ppow] + f_vals[ppow]*g_vals[A];
-						}
-						A *= p;
-						ppow /= p;
-					}
-					if(A == ppow){
-						if(modulus){
-							c = nut_i64_mod(c + f_vals[A]*g_vals[A], modulus);
-						}else{
-							c += f_vals[A]*g_vals[A];
-						}
-					}
-					f_conv_vals[m] = c;
-				}
-				break;
-			}// otherwise, i and p are coprime, so (f <*> u)(i*p) = (f <*> u)(i)*(f <*> u)(p)
-			int64_t term = f_conv_vals[i]*f_conv_vals[p];
-			f_conv_vals[m] = modulus ? nut_i64_mod(term, modulus) : term;
-			smallest_ppow[m] = p;
-		}
+	switch(modulus){
+		case 1000000007: p1e9_7_euler_sieve_conv_N_ctx(ctx, n, f_vals, f_conv_N_vals); break;
+		case 998244353: p998244353_euler_sieve_conv_N_ctx(ctx, n, f_vals, f_conv_N_vals); break;
+		default: nut_euler_sieve_conv_N_ctx_kernel(ctx, n, modulus, f_vals, f_conv_N_vals);
+	}
+	return true;
+}
+
+bool nut_euler_sieve_conv_ctx(const nut_EulerCtx *ctx, int64_t n, int64_t modulus, const int64_t f_vals[static n+1], const int64_t g_vals[static n+1], int64_t f_conv_vals[restrict static n+1]){
+	if(n > ctx->n){
+		return false;
+	}
+	switch(modulus){
+		case 1000000007: p1e9_7_euler_sieve_conv_ctx(ctx, n, f_vals, g_vals, f_conv_vals); break;
+		case 998244353: p998244353_euler_sieve_conv_ctx(ctx, n, f_vals, g_vals, f_conv_vals); break;
+		default: nut_euler_sieve_conv_ctx_kernel(ctx, n, modulus, f_vals, g_vals, f_conv_vals);
 	}
-	free(smallest_ppow);
-	free(primes);
-	free(is_c_buf);
 	return true;
 }
 
@@ -293,6 +210,8 @@ bool nut_Diri_init(nut_Diri *self, int64_t x, int64_t y){
 		y = ymin;
 	}
 	int64_t yinv = x/y + 1;
+	self->mapping = NULL;
+	self->mapping_len = 0;
 	if(!(self->buf = malloc((y + yinv)*sizeof(int64_t)))){
 		return false;
 	}
@@ -302,11 +221,143 @@ bool nut_Diri_init(nut_Diri *self, int64_t x, int64_t y){
 	return true;
 }
 
+bool nut_DiriIndex_init(nut_DiriIndex *self, const nut_Diri *tbl){
+	int64_t n_max = nut_u64_nth_root(tbl->x, 2);
+	self->v = malloc(tbl->yinv*sizeof(int64_t));
+	self->inv = malloc((n_max + 1)*sizeof(double));
+	if(!self->v || !self->inv){
+		nut_DiriIndex_destroy(self);
+		return false;
+	}
+	self->x = tbl->x;
+	self->y = tbl->y;
+	self->yinv = tbl->yinv;
+	self->k_dense = tbl->x/(tbl->y + 1) + 1;
+	self->n_max = n_max;
+	self->v[0] = tbl->x;
+	for(int64_t i = 1; i < tbl->yinv; ++i){
+		self->v[i] = tbl->x/i;
+	}
+	self->inv[0] = 0;
+	for(int64_t n = 1; n <= n_max; ++n){
+		self->inv[n] = 1./n;
+	}
+	return true;
+}
+
+void nut_DiriIndex_destroy(nut_DiriIndex *self){
+	free(self->v);
+	free(self->inv);
+	*self = (nut_DiriIndex){};
+}
+
 void nut_Diri_destroy(nut_Diri *self){
+#ifdef NUT_DIRI_MMAP
+	if(self->mapping){
+		munmap(self->mapping, self->mapping_len);
+	}else
+#endif
 	free(self->buf);
 	*self = (nut_Diri){};
 }
 
+/// Header of a saved diri table.  The values start at offset { @link NUT_DIRI_DATA_OFFSET}
+typedef struct{
+	char magic[8];
+	uint64_t version;
+	int64_t x, y, yinv;
+	int64_t m;
+	uint64_t tag;
+	uint64_t checksum;
+} nut_DiriHeader;
+
+static const char nut_diri_magic[8] = "NUTDIRI";
+// version 1 put the values at offset 4096, which is not page aligned on systems with 16K or 64K pages
+#define NUT_DIRI_VERSION 2
+
+static uint64_t diri_checksum(const int64_t *buf, int64_t len){
+	uint64_t h = len;
+	for(int64_t i = 0; i < len; ++i){
+		h = ((h << 5 | h >> 59) ^ (uint64_t)buf[i])*0x9E3779B97F4A7C15ull;
+	}
+	return h;
+}
+
+bool nut_Diri_save(const nut_Diri *restrict self, const char *restrict path, int64_t m, uint64_t tag){
+	FILE *file = fopen(path, "wb");
+	if(!file){
+		return false;
+	}
+	int64_t len = self->y + self->yinv;
+	char *buf [[gnu::cleanup(cleanup_free)]] = calloc(NUT_DIRI_DATA_OFFSET, 1);
+	if(!buf){
+		fclose(file);
+		return false;
+	}
+	nut_DiriHeader header = {.version = NUT_DIRI_VERSION, .x = self->x, .y = self->y, .yinv = self->yinv, .m = m, .tag = tag,
+		.checksum = diri_checksum(self->buf, len)};
+	memcpy(header.magic, nut_diri_magic, 8);
+	memcpy(buf, &header, sizeof(header));
+	bool res = fwrite(buf, 1, NUT_DIRI_DATA_OFFSET, file) == NUT_DIRI_DATA_OFFSET &&
+		fwrite(self->buf, sizeof(int64_t), len, file) == (size_t)len;
+	return !fclose(file) && res;
+}
+
+bool nut_Diri_mmap(nut_Diri *restrict self, const char *restrict path, int64_t m, uint64_t tag, bool verify){
+	*self = (nut_Diri){};
+	FILE *file = fopen(path, "rb");
+	if(!file){
+		return false;
+	}
+	nut_DiriHeader header;
+	// check that y and yinv are what nut_Diri_init would pick, so the functions using the table can trust them,
+	// and that the size of the values can't overflow, so a corrupt y can't make the size check below pass for a mapping that is too short
+	if(fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, nut_diri_magic, 8) ||
+		header.version != NUT_DIRI_VERSION || header.m != m || header.tag != tag || header.x < 1 ||
+		header.y < (int64_t)nut_u64_nth_root(header.x, 2) || header.yinv != header.x/header.y + 1 ||
+		(uint64_t)header.yinv >= (SIZE_MAX - NUT_DIRI_DATA_OFFSET)/sizeof(int64_t) ||
+		(uint64_t)header.y >= (SIZE_MAX - NUT_DIRI_DATA_OFFSET)/sizeof(int64_t) - (uint64_t)header.yinv){
+		fclose(file);
+		return false;
+	}
+	int64_t len = header.y + header.yinv;
+	size_t data_len = len*sizeof(int64_t);
+#ifdef NUT_DIRI_MMAP
+	struct stat info;
+	if(fstat(fileno(file), &info) || info.st_size < 0 || (uint64_t)info.st_size < NUT_DIRI_DATA_OFFSET + data_len){
+		fclose(file);
+		return false;
+	}
+	size_t mapping_len = NUT_DIRI_DATA_OFFSET + data_len;
+	void *mapping = mmap(NULL, mapping_len, PROT_READ, MAP_SHARED, fileno(file), 0);
+	fclose(file);
+	if(mapping == MAP_FAILED){
+		return false;
+	}
+	self->mapping = mapping;
+	self->mapping_len = mapping_len;
+	self->buf = (int64_t*)((char*)mapping + NUT_DIRI_DATA_OFFSET);
+#else
+	self->buf = malloc(data_len);
+	if(!self->buf || fseek(file, NUT_DIRI_DATA_OFFSET, SEEK_SET) ||
+		fread(self->buf, sizeof(int64_t), len, file) != (size_t)len){
+		free(self->buf);
+		self->buf = NULL;
+		fclose(file);
+		return false;
+	}
+	fclose(file);
+#endif
+	self->x = header.x;
+	self->y = header.y;
+	self->yinv = header.yinv;
+	if(verify && diri_checksum(self->buf, len) != header.checksum){
+		nut_Diri_destroy(self);
+		return false;
+	}
+	return true;
+}
+
 void nut_Diri_copy(nut_Diri *restrict dest, const nut_Diri *restrict src){
 	memcpy(dest->buf, src->buf, (src->y + src->yinv)*sizeof(int64_t));
 }
@@ -406,6 +457,11 @@ bool nut_Diri_compute_Nk(nut_Diri *restrict self, uint64_t k, int64_t m){
 	}
 }
 
+// v/n using the index if there is one, or dividing if not
+static inline int64_t diri_quot(const nut_DiriIndex *idx, int64_t v, int64_t n){
+	return idx ? nut_DiriIndex_quot(idx, v, n) : v/n;
+}
+
 void nut_Diri_compute_mertens(nut_Diri *restrict self, int64_t m, const uint8_t mobius[restrict static self->y/4 + 1]){
 	nut_Diri_set_dense(self, 0, 0);
 	nut_Diri_set_dense(self, 1, 1);
@@ -415,24 +471,33 @@ void nut_Diri_compute_mertens(nut_Diri *restrict self, int64_t m, const uint8_t
 		}
 		nut_Diri_set_dense(self, i, acc += v);
 	}
-	for(int64_t i = self->yinv - 1; i; --i){
-		int64_t v = self->x/i;
+	// the index only saves divisions, so if it can't be allocated, fall back to dividing
+	nut_DiriIndex idx [[gnu::cleanup(nut_DiriIndex_destroy)]] = {};
+	const nut_DiriIndex *idxp = nut_DiriIndex_init(&idx, self) ? &idx : NULL;
+	nut_QuotientIt it;
+	for(nut_QuotientIt_init(&it, self->x, self->yinv - 1, false); it.i >= 1; nut_QuotientIt_advance(&it, -1)){
+		int64_t i = it.i, v = it.v, vr = it.vr;
 		int64_t M = 1;
-		int64_t vr = nut_u64_nth_root(v, 2);
 		for(int64_t j = 1; j <= vr; ++j){
-			int64_t term = (nut_Diri_get_dense(self, j) - nut_Diri_get_dense(self, j - 1))*(v/j);
+			int64_t term = (nut_Diri_get_dense(self, j) - nut_Diri_get_dense(self, j - 1))*diri_quot(idxp, v, j);
 			if(m){
 				M = nut_i64_mod(M - term, m);
 			}else{
 				M -= term;
 			}
 		}
-		for(int64_t j = 2, term; j <= vr; ++j){
-			if(i*j >= self->yinv){
-				term = nut_Diri_get_dense(self, v/j);
+		// v/j = x/(ij) has a sparse entry exactly when ij < yinv
+		int64_t j_dense = (self->yinv + i - 1)/i;
+		for(int64_t j = 2; j <= vr && j < j_dense; ++j){
+			int64_t term = nut_Diri_get_sparse(self, i*j);
+			if(m){
+				M = nut_i64_mod(M - term, m);
 			}else{
-				term = nut_Diri_get_sparse(self, i*j);
+				M -= term;
 			}
+		}
+		for(int64_t j = j_dense > 2 ? j_dense : 2; j <= vr; ++j){
+			int64_t term = nut_Diri_get_dense(self, diri_quot(idxp, v, j));
 			if(m){
 				M = nut_i64_mod(M - term, m);
 			}else{
@@ -470,10 +535,30 @@ bool nut_Diri_compute_dk(nut_Diri *restrict self, uint64_t k, int64_t m, nut_Dir
 		nut_Diri_compute_u(self, m);
 		return true;
 	}
+	// every convolution below has the same y, so the factorization for the dense parts is only sieved once.
+	// If y is too large for a context or it can't be allocated, fall back to sieving separately for every convolution
+	nut_EulerCtx ctx [[gnu::cleanup(nut_EulerCtx_destroy)]] = {};
+	return nut_Diri_compute_dk_ctx(self, k, m, f_tbl, g_tbl, nut_EulerCtx_init(&ctx, self->y) ? &ctx : NULL);
+}
+
+static inline bool dk_conv(nut_Diri *restrict self, int64_t m, const nut_Diri *f_tbl, const nut_Diri *g_tbl, const nut_EulerCtx *ctx){
+	return ctx ? nut_Diri_compute_conv_ctx(self, m, f_tbl, g_tbl, ctx) : nut_Diri_compute_conv(self, m, f_tbl, g_tbl);
+}
+
+bool nut_Diri_compute_dk_ctx(nut_Diri *restrict self, uint64_t k, int64_t m, nut_Diri *restrict f_tbl, nut_Diri *restrict g_tbl, const nut_EulerCtx *ctx){
+	if(self->y != f_tbl->y || self->y != g_tbl->y || self->x != f_tbl->x || self->x != g_tbl->x || (ctx && ctx->n < self->y)){
+		return false;
+	}else if(!k){
+		nut_Diri_compute_I(self);
+		return true;
+	}else if(k == 1){
+		nut_Diri_compute_u(self, m);
+		return true;
+	}
 	nut_Diri_compute_u(f_tbl, m);
 	nut_Diri *t = self, *s = f_tbl, *r = g_tbl;
 	while(k%2 == 0){
-		if(!nut_Diri_compute_conv(t, m, s, s)){
+		if(!dk_conv(t, m, s, s, ctx)){
 			return false;
 		}else{
 			void *tmp = t;
@@ -484,7 +569,7 @@ bool nut_Diri_compute_dk(nut_Diri *restrict self, uint64_t k, int64_t m, nut_Dir
 	}
 	nut_Diri_copy(r, s);
 	while((k >>= 1)){
-		if(!nut_Diri_compute_conv(t, m, s, s)){
+		if(!dk_conv(t, m, s, s, ctx)){
 			return false;
 		}else{
 			void *tmp = t;
@@ -492,7 +577,7 @@ bool nut_Diri_compute_dk(nut_Diri *restrict self, uint64_t k, int64_t m, nut_Dir
 			s = tmp;
 		}//s = s*s
 		if(k%2){
-			if(!nut_Diri_compute_conv(t, m, r, s)){
+			if(!dk_conv(t, m, r, s, ctx)){
 				return false;
 			}else{
 				void *tmp = t;
@@ -553,218 +638,287 @@ bool nut_Diri_compute_Chi_balanced(nut_Diri *restrict self, uint64_t n, int64_t
 	return true;
 }
 
-bool nut_Diri_compute_pi(nut_Diri *restrict self){
+// Lucy's algorithm only touches the sparse entries x/i >= p^2, and (x/i)/p = x/(ip) is itself a sparse entry
+// while ip < k_dense, so the loop over i splits into a range with no quotient at all and a range needing one
+static inline void lucy_sparse_range(const nut_DiriIndex *idx, int64_t p, int64_t *i_sparse, int64_t *i_end){
+	int64_t e = idx->x/(p*p) + 1;
+	*i_end = e < idx->yinv ? e : idx->yinv;
+	int64_t s = (idx->k_dense + p - 1)/p;
+	*i_sparse = s < *i_end ? s : *i_end;
+}
+
+// buffer index of the entry for (x/i)/p, for i < i_end from lucy_sparse_range
+static inline int64_t lucy_slot(const nut_DiriIndex *idx, int64_t i, int64_t p, int64_t i_sparse){
+	return i < i_sparse ? idx->y + i*p : nut_DiriIndex_quot(idx, idx->v[i], p);
+}
+
+// Lucy's algorithm over the whole table
+static bool pi_lucy(nut_Diri *restrict self){
+	nut_DiriIndex idx [[gnu::cleanup(nut_DiriIndex_destroy)]] = {};
+	if(!nut_DiriIndex_init(&idx, self)){
+		return false;
+	}
 	self->buf[0] = 0;
 	for(int64_t i = 1; i <= self->y; ++i){
 		self->buf[i] = i - 1;
 	}
 	for(int64_t i = 1; i < self->yinv; ++i){
-		int64_t term = self->x/i;
-		self->buf[self->y + i] = term - 1;
+		self->buf[self->y + i] = idx.v[i] - 1;
 	}
 	for(int64_t p = 2; p <= self->y; ++p){
 		int64_t c = self->buf[p - 1];
 		if(self->buf[p] == c){
 			continue;
+		}else if(p*p > self->x){
+			break;
 		}
-		for(int64_t i = 1; i < self->yinv; ++i){
-			int64_t v = self->x/i;
-			if(v < p*p){
-				goto CONTINUE_PRIMELOOP;
-			}
-			int64_t j = v/p;
-			int64_t m = j <= self->y ? self->buf[j] : self->buf[self->y + self->x/j];
-			self->buf[self->y + i] -= m - c;
+		int64_t i_sparse, i_end;
+		lucy_sparse_range(&idx, p, &i_sparse, &i_end);
+		for(int64_t i = 1; i < i_sparse; ++i){
+			self->buf[self->y + i] -= self->buf[self->y + i*p] - c;
 		}
-		for(int64_t v = self->y; v >= 0; --v){
-			if(v < p*p){
-				break;
+		for(int64_t i = i_sparse; i < i_end; ++i){
+			self->buf[self->y + i] -= self->buf[nut_DiriIndex_quot(&idx, idx.v[i], p)] - c;
+		}
+		// every v in [qp, qp + p) has v/p = q, so go over the blocks instead of dividing each v
+		for(int64_t q = self->y/p; q >= p; --q){
+			int64_t d = self->buf[q] - c;
+			for(int64_t v = q*p + p - 1 < self->y ? q*p + p - 1 : self->y; v >= q*p; --v){
+				self->buf[v] -= d;
 			}
-			self->buf[v] -= (self->buf[v/p] - c);
 		}
-		CONTINUE_PRIMELOOP:;
 	}
 	return true;
 }
 
-bool nut_Diri_compute_conv_u(nut_Diri *restrict self, int64_t m, const nut_Diri *restrict f_tbl){
-	if(self->y != f_tbl->y || self->x != f_tbl->x){
+#define PI_SEGMENT_LEN 262144
+
+// pi(n) doesn't depend on x, so the counts in buf[0, lo) are continued over [lo, self->y] with a segmented sieve
+static bool pi_dense_sieve(nut_Diri *restrict self, int64_t lo){
+	uint64_t num_primes;
+	uint64_t *primes [[gnu::cleanup(cleanup_free)]] = nut_sieve_primes(nut_u64_nth_root(self->y, 2), &num_primes);
+	uint8_t *composite [[gnu::cleanup(cleanup_free)]] = malloc(PI_SEGMENT_LEN*sizeof(uint8_t));
+	if(!primes || !composite){
 		return false;
 	}
-	// use the dense part of self to temporarily store the sums of f for small n up to y
-	self->buf[0] = 0;
-	for(int64_t i = 1; i <= self->y; ++i){
-		int64_t term = self->buf[i-1] + f_tbl->buf[i];
-		self->buf[i] = m ? nut_i64_mod(term, m) : term;
-	}
-	for(int64_t i = 1; i < self->yinv; ++i){
-		int64_t v = self->x/i;
-		int64_t vr = nut_u64_nth_root(v, 2);// TODO: v is close to the previous v, so only one newton step should be needed here
-		int64_t h = 0;
-		for(int64_t n = 1, term; n <= vr; ++n){
-			if(v/n <= self->y){
-				term = nut_Diri_get_dense(self, v/n);
-			}else{
-				term = nut_Diri_get_sparse(f_tbl, i*n);
-			}
-			if(m){
-				h = nut_i64_mod(h + term, m);
-			}else{
-				h += term;
+	int64_t acc = self->buf[lo - 1];
+	for(; lo <= self->y; lo += PI_SEGMENT_LEN){
+		int64_t hi = self->y + 1 - lo > PI_SEGMENT_LEN ? lo + PI_SEGMENT_LEN : self->y + 1;
+		memset(composite, 0, (hi - lo)*sizeof(uint8_t));
+		for(uint64_t j = 0; j < num_primes; ++j){
+			int64_t p = primes[j];
+			if(p > (hi - 1)/p){
+				break;
 			}
-			if(m){
-				term = (v/n)%m*nut_Diri_get_dense(f_tbl, n);
-				h = nut_i64_mod(h + term, m);
-			}else{
-				h += nut_Diri_get_dense(f_tbl, n)*(v/n);
+			int64_t start = (lo + p - 1)/p*p;
+			for(int64_t n = start > p*p ? start : p*p; n < hi; n += p){
+				composite[n - lo] = 1;
 			}
 		}
-		int64_t term = nut_Diri_get_dense(self, vr)*vr;
-		if(m){
-			h = nut_i64_mod(h - term, m);
-		}else{
-			h -= term;
+		for(int64_t n = lo; n < hi; ++n){
+			self->buf[n] = acc += !composite[n - lo];
 		}
-		nut_Diri_set_sparse(self, i, h);
 	}
-	return nut_euler_sieve_conv_u(self->y, m, f_tbl->buf, self->buf);
+	return true;
 }
 
-bool nut_Diri_compute_conv_N(nut_Diri *restrict self, int64_t m, const nut_Diri *restrict f_tbl){
-	if(self->y != f_tbl->y || self->x != f_tbl->x){
+// The dense part of Lucy's algorithm costs about y^(3/2)/log(y), so past y = 2sqrt(x), where it costs about as much as the sparse part,
+// the sparse entries are taken from a scratch table with that y, whose sparse quotients include all of those of self.
+// The scratch table's dense entries are final counts, and the rest are sieved, or copied from old when it is not NULL
+static bool pi_split(nut_Diri *restrict self, const nut_Diri *restrict old){
+	int64_t y_lucy = 2*nut_u64_nth_root(self->x, 2);
+	if(y_lucy >= self->y){
+		return pi_lucy(self);
+	}
+	nut_Diri lucy [[gnu::cleanup(nut_Diri_destroy)]] = {};
+	if(!nut_Diri_init(&lucy, self->x, y_lucy) || !pi_lucy(&lucy)){
 		return false;
 	}
-	// use the dense part of self to temporarily store the sums of f for small n up to y
-	self->buf[0] = 0;
-	for(int64_t i = 1; i <= self->y; ++i){
-		int64_t term = self->buf[i-1] + f_tbl->buf[i];
-		self->buf[i] = m ? nut_i64_mod(term, m) : term;
+	memcpy(self->buf + self->y + 1, lucy.buf + lucy.y + 1, (self->yinv - 1)*sizeof(int64_t));
+	if(!old || old->y <= y_lucy){
+		old = &lucy;
 	}
-	for(int64_t i = 1; i < self->yinv; ++i){
-		int64_t v = self->x/i;
-		int64_t vr = nut_u64_nth_root(v, 2);
-		int64_t h = 0;
-		// by hyperbola formula:
-		// (f <*> N)(v) = sum(n = 1 ... vr, f(n)*(v/n)*((v/n) + 1)/2) + sum(n = 1 ... vr, F(v/n)*n) - F(vr)*vr*(vr + 1)/2
-		// both sums are folded together into the following loop
-		for(int64_t n = 1, term; n <= vr; ++n){
-			if(v/n <= self->y){
-				term = nut_Diri_get_dense(self, v/n)*n;
-			}else{
-				term = nut_Diri_get_sparse(f_tbl, i*n)*n;
-			}
-			if(m){
-				h = nut_i64_mod(h + term, m);
-			}else{
-				h += term;
+	memcpy(self->buf, old->buf, (old->y + 1)*sizeof(int64_t));
+	return pi_dense_sieve(self, old->y + 1);
+}
+
+bool nut_Diri_compute_pi(nut_Diri *restrict self){
+	return pi_split(self, NULL);
+}
+
+bool nut_Diri_compute_pi_extend(nut_Diri *restrict self, const nut_Diri *restrict old){
+	return self->y >= old->y && pi_split(self, old);
+}
+
+// s - w*d (mod m), where s and w are reduced and d is the difference of two reduced values
+static inline int64_t lucy_sub(int64_t s, int64_t w, int64_t d, int64_t m){
+	if(!m){
+		return s - (int64_t)((uint64_t)w*(uint64_t)d);
+	}
+	if(d < 0){
+		d += m;
+	}
+	int64_t res = (s - (int128_t)w*d)%m;
+	return res < 0 ? res + m : res;
+}
+
+bool nut_Diri_compute_prime_sums(nut_Diri self_array[restrict], uint64_t kmax, int64_t m){
+	const nut_Diri *self = self_array;
+	for(uint64_t k = 0; k <= kmax; ++k){
+		nut_Diri *tbl = self_array + k;
+		// Faulhaber's formula for k = 0 counts n = 0 as well, so use u directly
+		if(!k){
+			nut_Diri_compute_u(tbl, m);
+		}else if(!nut_Diri_compute_Nk(tbl, k, m)){
+			return false;
+		}
+		// turn the dense values n^k into sums over 2 <= n <= i, and remove n = 1 from the sparse sums
+		tbl->buf[0] = tbl->buf[1] = 0;
+		for(int64_t i = 2; i <= tbl->y; ++i){
+			tbl->buf[i] += tbl->buf[i - 1];
+			if(m && tbl->buf[i] >= m){
+				tbl->buf[i] -= m;
 			}
-			term = nut_Diri_get_dense(f_tbl, n);
-			int64_t k = v/n;
-			if(m){
-				int64_t Gvn = (k&1) ? k%m*(((k + 1)>>1)%m) : (k>>1)%m*((k + 1)%m);
-				Gvn %= m;
-				h = nut_i64_mod(h + term*Gvn, m);
-			}else{
-				int64_t Gvn = (k&1) ? k*((k + 1)>>1) : (k>>1)*(k + 1);
-				h += term*Gvn;
+		}
+		for(int64_t i = 1; i < tbl->yinv; ++i){
+			tbl->buf[tbl->y + i] = m ? nut_i64_mod(tbl->buf[tbl->y + i] - 1, m) : tbl->buf[tbl->y + i] - 1;
+		}
+	}
+	uint64_t num_primes;
+	uint64_t *primes [[gnu::cleanup(cleanup_free)]] = nut_sieve_primes(nut_u64_nth_root(self->x, 2), &num_primes);
+	int64_t *ppows [[gnu::cleanup(cleanup_free)]] = malloc((kmax + 1)*sizeof(int64_t));
+	nut_DiriIndex idx [[gnu::cleanup(nut_DiriIndex_destroy)]] = {};
+	if(!primes || !ppows || !nut_DiriIndex_init(&idx, self)){
+		return false;
+	}
+	for(uint64_t pi = 0; pi < num_primes; ++pi){
+		int64_t p = primes[pi];
+		ppows[0] = m == 1 ? 0 : 1;
+		for(uint64_t k = 1; k <= kmax; ++k){
+			ppows[k] = m ? (int128_t)ppows[k - 1]*p%m : ppows[k - 1]*p;
+		}
+		// every table holds sums over primes at p - 1 already, since p - 1 < p^2
+		int64_t i_sparse, i_end;
+		lucy_sparse_range(&idx, p, &i_sparse, &i_end);
+		for(int64_t i = 1; i < i_end; ++i){
+			int64_t j = lucy_slot(&idx, i, p, i_sparse);
+			for(uint64_t k = 0; k <= kmax; ++k){
+				nut_Diri *tbl = self_array + k;
+				tbl->buf[tbl->y + i] = lucy_sub(tbl->buf[tbl->y + i], ppows[k], tbl->buf[j] - tbl->buf[p - 1], m);
 			}
 		}
-		// finally we apply the corrective term (remove double counted values)
-		int64_t term = nut_Diri_get_dense(self, vr);
-		int64_t Gvr = (vr&1) ? vr*((vr + 1) >> 1) : (vr >> 1)*(vr + 1);
-		if(m){
-			Gvr %= m;
-			h = nut_i64_mod(h - term*Gvr, m);
-		}else{
-			h -= term*Gvr;
+		for(int64_t v = self->y; v >= p*p; --v){
+			int64_t j = nut_DiriIndex_quot(&idx, v, p);
+			for(uint64_t k = 0; k <= kmax; ++k){
+				nut_Diri *tbl = self_array + k;
+				tbl->buf[v] = lucy_sub(tbl->buf[v], ppows[k], tbl->buf[j] - tbl->buf[p - 1], m);
+			}
 		}
-		nut_Diri_set_sparse(self, i, h);
 	}
-	return nut_euler_sieve_conv_N(self->y, m, f_tbl->buf, self->buf);
+	return true;
 }
 
-bool nut_Diri_compute_conv(nut_Diri *restrict self, int64_t m, const nut_Diri *f_tbl, const nut_Diri *g_tbl){
-	if(self->y != f_tbl->y || self->x != f_tbl->x || self->y != g_tbl->y || self->x != g_tbl->x){
-		return false;
+// number of n in [1, v] with n = r mod q
+static inline int64_t count_in_class(int64_t v, int64_t r, int64_t q){
+	if(!r){
+		r = q;
 	}
-	// use the dense part of self to temporarily store the sums of f for small n up to y
-	self->buf[0] = 0;
-	for(int64_t i = 1; i <= self->y; ++i){
-		int64_t term = self->buf[i-1] + f_tbl->buf[i];
-		self->buf[i] = m ? nut_i64_mod(term, m) : term;
+	return v < r ? 0 : (v - r)/q + 1;
+}
+
+bool nut_Diri_compute_pi_mod_q(nut_Diri self_array[restrict], uint64_t q){
+	const nut_Diri *self = self_array;
+	// the survivors in class s up to v/p move to class ps mod q when multiplied by p
+	uint64_t *targets [[gnu::cleanup(cleanup_free)]] = malloc(q*sizeof(uint64_t));
+	uint64_t num_primes;
+	uint64_t *primes [[gnu::cleanup(cleanup_free)]] = nut_sieve_primes(nut_u64_nth_root(self->x, 2), &num_primes);
+	nut_DiriIndex idx [[gnu::cleanup(nut_DiriIndex_destroy)]] = {};
+	if(!targets || !primes || !nut_DiriIndex_init(&idx, self)){
+		return false;
 	}
-	for(int64_t i = 1; i < self->yinv; ++i){
-		int64_t v = self->x/i;
-		int64_t vr = nut_u64_nth_root(v, 2);
-		int64_t h = 0;
-		for(int64_t n = 1, term; n <= vr; ++n){
-			if(v/n <= self->y){
-				term = nut_Diri_get_dense(self, v/n)*nut_Diri_get_dense(g_tbl, n);
-			}else{
-				term = nut_Diri_get_sparse(f_tbl, i*n)*nut_Diri_get_dense(g_tbl, n);
-			}
-			if(m){
-				h = nut_i64_mod(h + term, m);
-			}else{
-				h += term;
-			}
+	for(uint64_t r = 0; r < q; ++r){
+		nut_Diri *tbl = self_array + r;
+		// start from all 2 <= n <= v in the class
+		int64_t one = r == 1%q;
+		for(int64_t i = 0; i <= tbl->y; ++i){
+			tbl->buf[i] = i ? count_in_class(i, r, q) - one : 0;
 		}
-		nut_Diri_set_sparse(self, i, h);
-	}
-	// use the dense part of self to temporarily store the sums of g for small n up to y
-	// simultaniously, apply the adjustments to the h values.
-	// H(x/j) has an adjustment of F(i)G(i) where i = sqrt(x/j)
-	// so for every i = sqrt(x/j) value, we need to adjust all H(x/j) values
-	// for j in the range (x/(i + 1)**2, x/i**2] && [1, yinv)
-	// So we can ignore some small i values where this intersection is empty, that is, yinv <= x/(i + 1)**2
-	// (i + 1)**2 <= x/yinv <=> i + 1 <= sqrt(x/yinv)
-	// that is, for i <= sqrt(x/yinv) - 1, there are no corresponding j to adjust
-	// note that x/yinv = y and i <= sqrt(y) - 1 <=> i < sqrt(y)
-	int64_t i_ub = nut_u64_nth_root(self->y, 2);
-	for(int64_t i = 1; i < i_ub; ++i){
-		int64_t term = self->buf[i-1] + g_tbl->buf[i];
-		self->buf[i] = m ? nut_i64_mod(term, m) : term;
-	}
-	for(int64_t i = i_ub; i <= self->y; ++i){
-		int64_t F = self->buf[i];
-		int64_t G = self->buf[i-1] + g_tbl->buf[i];
-		if(m){
-			G = nut_i64_mod(G, m);
+		for(int64_t i = 1; i < tbl->yinv; ++i){
+			tbl->buf[tbl->y + i] = count_in_class(tbl->x/i, r, q) - one;
 		}
-		self->buf[i] = G;
-		int64_t j_ub = self->x/(i*i) + 1;
-		if(j_ub > self->yinv){
-			j_ub = self->yinv;
+	}
+	for(uint64_t pi = 0; pi < num_primes; ++pi){
+		int64_t p = primes[pi];
+		for(uint64_t s = 0; s < q; ++s){
+			targets[s] = p*s%q;
 		}
-		for(int64_t j = self->x/((i + 1)*(i + 1)) + 1; j < j_ub; ++j){
-			int64_t h = nut_Diri_get_sparse(self, j);
-			if(m){
-				h = nut_i64_mod(h - F*G, m);
-			}else{
-				h -= F*G;
+		int64_t i_sparse, i_end;
+		lucy_sparse_range(&idx, p, &i_sparse, &i_end);
+		for(int64_t i = 1; i < i_end; ++i){
+			int64_t j = lucy_slot(&idx, i, p, i_sparse);
+			for(uint64_t s = 0; s < q; ++s){
+				const nut_Diri *src = self_array + s;
+				nut_Diri *dst = self_array + targets[s];
+				dst->buf[dst->y + i] -= src->buf[j] - src->buf[p - 1];
 			}
-			nut_Diri_set_sparse(self, j, h);
 		}
-	}
-	for(int64_t i = 1; i < self->yinv; ++i){
-		int64_t v = self->x/i;
-		int64_t vr = nut_u64_nth_root(v, 2);
-		int64_t h = nut_Diri_get_sparse(self, i);
-		for(int64_t n = 1, term; n <= vr; ++n){
-			if(v/n <= self->y){
-				term = nut_Diri_get_dense(f_tbl, n)*nut_Diri_get_dense(self, v/n);
-			}else{
-				term = nut_Diri_get_dense(f_tbl, n)*nut_Diri_get_sparse(g_tbl, i*n);
-			}
-			if(m){
-				h = nut_i64_mod(h + term, m);
-			}else{
-				h += term;
+		for(int64_t v = self->y; v >= p*p; --v){
+			int64_t j = nut_DiriIndex_quot(&idx, v, p);
+			for(uint64_t s = 0; s < q; ++s){
+				const nut_Diri *src = self_array + s;
+				self_array[targets[s]].buf[v] -= src->buf[j] - src->buf[p - 1];
 			}
 		}
-		nut_Diri_set_sparse(self, i, h);
 	}
-	return nut_euler_sieve_conv(self->y, m, f_tbl->buf, g_tbl->buf, self->buf);
+	return true;
+}
+
+bool nut_Diri_compute_conv_u(nut_Diri *restrict self, int64_t m, const nut_Diri *restrict f_tbl){
+	switch(m){
+		case 1000000007: return p1e9_7_Diri_compute_conv_u(self, f_tbl);
+		case 998244353: return p998244353_Diri_compute_conv_u(self, f_tbl);
+		default: return nut_Diri_compute_conv_u_kernel(self, m, f_tbl);
+	}
+}
+
+bool nut_Diri_compute_conv_N(nut_Diri *restrict self, int64_t m, const nut_Diri *restrict f_tbl){
+	switch(m){
+		case 1000000007: return p1e9_7_Diri_compute_conv_N(self, f_tbl);
+		case 998244353: return p998244353_Diri_compute_conv_N(self, f_tbl);
+		default: return nut_Diri_compute_conv_N_kernel(self, m, f_tbl);
+	}
+}
+
+bool nut_Diri_compute_conv(nut_Diri *restrict self, int64_t m, const nut_Diri *f_tbl, const nut_Diri *g_tbl){
+	switch(m){
+		case 1000000007: return p1e9_7_Diri_compute_conv(self, f_tbl, g_tbl);
+		case 998244353: return p998244353_Diri_compute_conv(self, f_tbl, g_tbl);
+		default: return nut_Diri_compute_conv_kernel(self, m, f_tbl, g_tbl);
+	}
+}
+
+bool nut_Diri_compute_conv_u_ctx(nut_Diri *restrict self, int64_t m, const nut_Diri *restrict f_tbl, const nut_EulerCtx *ctx){
+	switch(m){
+		case 1000000007: return p1e9_7_Diri_compute_conv_u_ctx(self, f_tbl, ctx);
+		case 998244353: return p998244353_Diri_compute_conv_u_ctx(self, f_tbl, ctx);
+		default: return nut_Diri_compute_conv_u_ctx_kernel(self, m, f_tbl, ctx);
+	}
+}
+
+bool nut_Diri_compute_conv_N_ctx(nut_Diri *restrict self, int64_t m, const nut_Diri *restrict f_tbl, const nut_EulerCtx *ctx){
+	switch(m){
+		case 1000000007: return p1e9_7_Diri_compute_conv_N_ctx(self, f_tbl, ctx);
+		case 998244353: return p998244353_Diri_compute_conv_N_ctx(self, f_tbl, ctx);
+		default: return nut_Diri_compute_conv_N_ctx_kernel(self, m, f_tbl, ctx);
+	}
+}
+
+bool nut_Diri_compute_conv_ctx(nut_Diri *restrict self, int64_t m, const nut_Diri *f_tbl, const nut_Diri *g_tbl, const nut_EulerCtx *ctx){
+	switch(m){
+		case 1000000007: return p1e9_7_Diri_compute_conv_ctx(self, f_tbl, g_tbl, ctx);
+		case 998244353: return p998244353_Diri_compute_conv_ctx(self, f_tbl, g_tbl, ctx);
+		default: return nut_Diri_compute_conv_ctx_kernel(self, m, f_tbl, g_tbl, ctx);
+	}
 }
 
 bool nut_Diri_convdiv(nut_Diri *restrict self, int64_t m, const nut_Diri *restrict f_tbl, const nut_Diri *restrict g_tbl){
@@ -776,74 +930,592 @@ bool nut_Diri_convdiv(nut_Diri *restrict self, int64_t m, const nut_Diri *restri
 	// In the Diri_compute_conv* functions, the two sums and the correction term all depend only on the input functions,
 	// so we can store partial sums of the input functions for low "dense" values in the dense part of the output.
 	// Here, that isn't possible, due to the dependence of H(v) on smaller H(v).  So we must use a temporary array.
-	if(self->y != f_tbl->y || self->x != f_tbl->x || self->y != g_tbl->y || self->x != g_tbl->x){
+	switch(m){
+		case 1000000007: return p1e9_7_Diri_convdiv(self, f_tbl, g_tbl);
+		case 998244353: return p998244353_Diri_convdiv(self, f_tbl, g_tbl);
+		default: return nut_Diri_convdiv_kernel(self, m, f_tbl, g_tbl);
+	}
+}
+
+/// Which convolution a parallel worker is computing.  The hyperbola method for f <*> g needs two passes over the sparse entries
+typedef enum{
+	CONV_U,
+	CONV_N,
+	CONV_FG,
+	CONV_FG_SECOND
+} ConvKind;
+
+/// Numbers per window of the segmented dense convolution.
+/// Each window needs 16 bytes per number (the output and the unfactored part of each number), so this keeps a window in L2 cache.
+#define EULER_SEGMENT_BLOCK 32768
+
+typedef struct{
+	ConvKind kind;
+	int64_t m;
+	/// Range of n being filled in, lo <= n < hi.  This worker does windows thread_idx, thread_idx + num_threads, and so on
+	int64_t lo, hi;
+	uint64_t thread_idx, num_threads;
+	/// All primes up to sqrt(hi - 1), and for the odd ones, their inverses mod 2^64
+	uint64_t num_primes;
+	const uint64_t *primes, *prime_invs;
+	/// h(p**e) for the jth prime p is at h_pows[h_pow_offsets[j] + e], for all p**e < hi
+	const int64_t *h_pows;
+	const uint64_t *h_pow_offsets;
+	const int64_t *f_vals, *g_vals;
+	/// out[n - lo] = h(n)
+	int64_t *out;
+	bool ok;
+} DenseArgs;
+
+typedef struct{
+	ConvKind kind;
+	int64_t m;
+	/// Range of sparse indices this worker fills in, i_lo <= i < i_hi
+	int64_t i_lo, i_hi;
+	nut_Diri *self;
+	const nut_Diri *f_tbl, *g_tbl;
+	const nut_DiriIndex *idx;
+	/// Sparse entries marked here (if it is not NULL) are already filled in and are skipped
+	const uint8_t *seeded;
+} SparseArgs;
+
+/// Find h(p**e) for all e with p**e < hi, and return the largest such e
+static uint64_t conv_prime_powers(ConvKind kind, int64_t m, const int64_t *f_vals, const int64_t *g_vals, int64_t p, int64_t hi, int64_t h_pows[static 64]){
+	uint64_t e_max = 0;
+	h_pows[0] = 1;
+	for(int64_t pe = p; ; pe *= p){
+		++e_max;
+		switch(kind){
+			case CONV_U:
+				// (f <*> u)(p**a) = (f <*> u)(p**(a-1)) + f(p**a)
+				h_pows[e_max] = nut_kernel_mod(h_pows[e_max - 1] + f_vals[pe], m);
+				break;
+			case CONV_N:
+				// (f <*> N)(p**a) = p*(f <*> N)(p**(a-1)) + f(p**a)
+				h_pows[e_max] = nut_kernel_mod((m ? p%m : p)*h_pows[e_max - 1] + f_vals[pe], m);
+				break;
+			default:
+				h_pows[e_max] = nut_kernel_conv_prime_power(f_vals, g_vals, p, pe, m);
+		}
+		if(pe > (hi - 1)/p){
+			return e_max;
+		}
+	}
+}
+
+/// Value of the convolution at a prime q, where f(1) = g(1) = 1
+NUT_ATTR_ALWAYS_INLINE
+static inline int64_t conv_prime(const DenseArgs *a, int64_t m, int64_t q){
+	switch(a->kind){
+		case CONV_U: return nut_kernel_mod(a->f_vals[q] + 1, m);
+		case CONV_N: return nut_kernel_mod(a->f_vals[q] + (m ? q%m : q), m);
+		default: return nut_kernel_mod(a->f_vals[q] + a->g_vals[q], m);
+	}
+}
+
+/// Fill in h(n) for lo <= n < hi, which must span at most EULER_SEGMENT_BLOCK numbers.
+/// This is a segmented sieve of Eratosthenes: rem starts as n and every prime p <= sqrt(n) divides its full power p**e out of rem
+/// and multiplies h(p**e) into the output, so whatever is left in rem at the end is 1 or a prime.
+/// Only f and g at prime powers are read, so windows are completely independent of each other and of the rest of the output.
+NUT_ATTR_ALWAYS_INLINE
+static inline void fill_dense_window(const DenseArgs *a, int64_t m, int64_t lo, int64_t hi, int64_t *out, uint64_t rem[static EULER_SEGMENT_BLOCK]){
+	for(int64_t n = lo; n < hi; ++n){
+		out[n - lo] = 1;
+		rem[n - lo] = n;
+	}
+	if(a->num_primes && hi > 4){
+		const int64_t *h_pows = a->h_pows + a->h_pow_offsets[0];
+		for(int64_t k = (lo + 1)&~INT64_C(1); k < hi; k += 2){
+			uint64_t e = __builtin_ctzll(k);
+			rem[k - lo] = k >> e;
+			out[k - lo] = h_pows[e];
+		}
+	}
+	for(uint64_t j = 1; j < a->num_primes; ++j){
+		int64_t p = a->primes[j];
+		if(p > (hi - 1)/p){
+			break;
+		}
+		const int64_t *h_pows = a->h_pows + a->h_pow_offsets[j];
+		// p is odd, so dividing by it is multiplying by its inverse when the division is exact,
+		// and r is divisible by p exactly when r*p_inv is at most (2^64 - 1)/p, see (https://gmplib.org/~tege/divcnst-pldi94.pdf)
+		uint64_t p_inv = a->prime_invs[j], p_lim = UINT64_MAX/p;
+		for(int64_t k = (lo + p - 1)/p*p; k < hi; k += p){
+			uint64_t r = rem[k - lo]*p_inv, e = 1;
+			for(uint64_t q; (q = r*p_inv) <= p_lim; r = q){
+				++e;
+			}
+			rem[k - lo] = r;
+			out[k - lo] = nut_kernel_mod(out[k - lo]*h_pows[e], m);
+		}
+	}
+	for(int64_t n = lo; n < hi; ++n){
+		if(rem[n - lo] != 1){
+			out[n - lo] = nut_kernel_mod(out[n - lo]*conv_prime(a, m, rem[n - lo]), m);
+		}
+	}
+}
+
+NUT_ATTR_ALWAYS_INLINE
+static inline void fill_dense_windows(DenseArgs *a, int64_t m, uint64_t rem[static EULER_SEGMENT_BLOCK]){
+	for(int64_t lo = a->lo + (int64_t)a->thread_idx*EULER_SEGMENT_BLOCK; lo < a->hi; lo += (int64_t)a->num_threads*EULER_SEGMENT_BLOCK){
+		int64_t hi = a->hi - lo < EULER_SEGMENT_BLOCK ? a->hi : lo + EULER_SEGMENT_BLOCK;
+		fill_dense_window(a, m, lo, hi, a->out + (lo - a->lo), rem);
+	}
+}
+
+static void *dense_worker(void *_args){
+	DenseArgs *a = _args;
+	uint64_t *rem [[gnu::cleanup(cleanup_free)]] = malloc(EULER_SEGMENT_BLOCK*sizeof(uint64_t));
+	if(!(a->ok = rem)){
+		return NULL;
+	}
+	switch(a->m){
+		case 1000000007: fill_dense_windows(a, 1000000007, rem); break;
+		case 998244353: fill_dense_windows(a, 998244353, rem); break;
+		default: fill_dense_windows(a, a->m, rem);
+	}
+	return NULL;
+}
+
+static bool euler_sieve_window(ConvKind kind, int64_t lo, int64_t hi, int64_t m, const int64_t *f_vals, const int64_t *g_vals, int64_t *out, uint64_t num_threads){
+	if(lo < 1 || hi < lo){
 		return false;
+	}else if(lo == hi){
+		return true;
 	}
-	int64_t *H_dense [[gnu::cleanup(cleanup_free)]] = malloc((self->y + 1)*sizeof(int64_t));
-	int64_t *G_dense [[gnu::cleanup(cleanup_free)]] = malloc((self->y + 1)*sizeof(int64_t));
-	if(!H_dense || !G_dense){
+	num_threads = num_threads ?: nut_parallel_default_threads();
+	uint64_t num_windows = (hi - lo + EULER_SEGMENT_BLOCK - 1)/EULER_SEGMENT_BLOCK;
+	if(num_threads > num_windows){
+		num_threads = num_windows;
+	}
+	uint64_t num_primes;
+	uint64_t *primes [[gnu::cleanup(cleanup_free)]] = nut_sieve_primes(nut_u64_nth_root(hi - 1, 2), &num_primes);
+	uint64_t *prime_invs [[gnu::cleanup(cleanup_free)]] = primes ? malloc(2*(num_primes + 1)*sizeof(uint64_t)) : NULL;
+	// every prime has at most log2(hi) powers below hi, and only 2 has that many
+	int64_t *h_pows [[gnu::cleanup(cleanup_free)]] = prime_invs ? malloc((num_primes*(64 - __builtin_clzll(hi)) + 64)*sizeof(int64_t)) : NULL;
+	DenseArgs *args [[gnu::cleanup(cleanup_free)]] = malloc(num_threads*sizeof(DenseArgs));
+	if(!h_pows || !args){
 		return false;
 	}
-	memset(self->buf, 0, (self->y + 1)*sizeof(int64_t));
-	H_dense[0] = G_dense[0] = 0;
-	// First, we "sieve" the values of h into the dense part of the output
-	for(int64_t i = 1; i <= self->y; ++i){
-		int64_t term = self->buf[i] + f_tbl->buf[i];
-		self->buf[i] = m ? nut_i64_mod(term, m) : term;
-		if(!self->buf[i]){
+	uint64_t *h_pow_offsets = prime_invs + num_primes + 1;
+	h_pow_offsets[0] = 0;
+	for(uint64_t j = 0; j < num_primes; ++j){
+		// newton's method doubles the number of correct low bits each step, and p*p == 1 mod 8 gives 3 to start
+		uint64_t p = primes[j], p_inv = p;
+		for(uint64_t i = 0; i < 5; ++i){
+			p_inv *= 2 - p*p_inv;
+		}
+		prime_invs[j] = p_inv;
+		h_pow_offsets[j + 1] = h_pow_offsets[j] + conv_prime_powers(kind, m, f_vals, g_vals, p, hi, h_pows + h_pow_offsets[j]) + 1;
+	}
+	// windows near the start of the range have slightly fewer primes to sieve by, so dealing them out round robin balances the threads
+	for(uint64_t t = 0; t < num_threads; ++t){
+		args[t] = (DenseArgs){
+			.kind = kind, .m = m, .lo = lo, .hi = hi,
+			.thread_idx = t, .num_threads = num_threads,
+			.num_primes = num_primes, .primes = primes, .prime_invs = prime_invs,
+			.h_pows = h_pows, .h_pow_offsets = h_pow_offsets,
+			.f_vals = f_vals, .g_vals = g_vals, .out = out
+		};
+	}
+	nut_parallel_run(num_threads, dense_worker, args, sizeof(DenseArgs));
+	for(uint64_t t = 0; t < num_threads; ++t){
+		if(!args[t].ok){
+			return false;
+		}
+	}
+	return true;
+}
+
+bool nut_euler_sieve_conv_u_window(int64_t lo, int64_t hi, int64_t m, const int64_t f_vals[static hi], int64_t out[restrict static hi - lo], uint64_t num_threads){
+	return euler_sieve_window(CONV_U, lo, hi, m, f_vals, NULL, out, num_threads);
+}
+
+bool nut_euler_sieve_conv_N_window(int64_t lo, int64_t hi, int64_t m, const int64_t f_vals[static hi], int64_t out[restrict static hi - lo], uint64_t num_threads){
+	return euler_sieve_window(CONV_N, lo, hi, m, f_vals, NULL, out, num_threads);
+}
+
+bool nut_euler_sieve_conv_window(int64_t lo, int64_t hi, int64_t m, const int64_t f_vals[static hi], const int64_t g_vals[static hi], int64_t out[restrict static hi - lo], uint64_t num_threads){
+	return euler_sieve_window(CONV_FG, lo, hi, m, f_vals, g_vals, out, num_threads);
+}
+
+bool nut_euler_sieve_conv_u_parallel(int64_t n, int64_t m, const int64_t f_vals[static n+1], int64_t f_conv_u_vals[restrict static n+1], uint64_t num_threads){
+	return euler_sieve_window(CONV_U, 1, n + 1, m, f_vals, NULL, f_conv_u_vals + 1, num_threads);
+}
+
+bool nut_euler_sieve_conv_N_parallel(int64_t n, int64_t m, const int64_t f_vals[static n+1], int64_t f_conv_N_vals[restrict static n+1], uint64_t num_threads){
+	return euler_sieve_window(CONV_N, 1, n + 1, m, f_vals, NULL, f_conv_N_vals + 1, num_threads);
+}
+
+bool nut_euler_sieve_conv_parallel(int64_t n, int64_t m, const int64_t f_vals[static n+1], const int64_t g_vals[static n+1], int64_t f_conv_vals[restrict static n+1], uint64_t num_threads){
+	return euler_sieve_window(CONV_FG, 1, n + 1, m, f_vals, g_vals, f_conv_vals + 1, num_threads);
+}
+
+NUT_ATTR_ALWAYS_INLINE
+static inline void fill_sparse_run(SparseArgs *a, int64_t m, int64_t i_lo, int64_t i_hi){
+	switch(a->kind){
+		case CONV_U: nut_Diri_conv_u_sparse_kernel(a->self, m, a->f_tbl, a->idx, i_lo, i_hi); break;
+		case CONV_N: nut_Diri_conv_N_sparse_kernel(a->self, m, a->f_tbl, a->idx, i_lo, i_hi); break;
+		case CONV_FG: nut_Diri_conv_Fg_sparse_kernel(a->self, m, a->f_tbl, a->g_tbl, a->idx, i_lo, i_hi); break;
+		case CONV_FG_SECOND: nut_Diri_conv_fG_sparse_kernel(a->self, m, a->f_tbl, a->g_tbl, a->idx, i_lo, i_hi); break;
+	}
+}
+
+NUT_ATTR_ALWAYS_INLINE
+static inline void fill_sparse_range(SparseArgs *a, int64_t m){
+	if(!a->seeded){
+		fill_sparse_run(a, m, a->i_lo, a->i_hi);
+		return;
+	}
+	// every entry only depends on the inputs, so the kernels can be run on each maximal run of entries that aren't seeded
+	for(int64_t i = a->i_lo; i < a->i_hi;){
+		if(a->seeded[i]){
+			++i;
 			continue;
 		}
-		for(int64_t j = 2; j <= self->y/i; ++j){
-			int64_t term = self->buf[i*j] - self->buf[i]*g_tbl->buf[j];
-			self->buf[i*j] = m ? nut_i64_mod(term, m) : term;
+		int64_t j = i + 1;
+		while(j < a->i_hi && !a->seeded[j]){
+			++j;
 		}
+		fill_sparse_run(a, m, i, j);
+		i = j;
 	}
-	// Now, accumulate the sums of dense h values into H_dense
-	for(int64_t i = 1; i <= self->y; ++i){
-		int64_t term = self->buf[i] + H_dense[i - 1];
-		H_dense[i] = m ? nut_i64_mod(term, m) : term;
+}
+
+static void *sparse_worker(void *_args){
+	SparseArgs *a = _args;
+	switch(a->m){
+		case 1000000007: fill_sparse_range(a, 1000000007); break;
+		case 998244353: fill_sparse_range(a, 998244353); break;
+		default: fill_sparse_range(a, a->m);
 	}
-	// And accumulate the sums of dense g values into G_dense
-	for(int64_t i = 1; i <= self->y; ++i){
-		int64_t term = g_tbl->buf[i] + G_dense[i - 1];
-		G_dense[i] = m ? nut_i64_mod(term, m) : term;
+	return NULL;
+}
+
+static bool sparse_parallel(ConvKind kind, nut_Diri *self, int64_t m, const nut_Diri *f_tbl, const nut_Diri *g_tbl, const nut_DiriIndex *idx, const uint8_t *seeded, uint64_t num_threads){
+	SparseArgs *args [[gnu::cleanup(cleanup_free)]] = malloc(num_threads*sizeof(SparseArgs));
+	if(!args){
+		return false;
 	}
-	// Now we populate the sparse H values using the formula
-	// H(v) = F(v) + G(vr)H(vr) - sum(n = 2 ... vr, g(n)H(v/n)) - sum(n = 1 ... vr, G(v/n)h(n))
-	// We will do the sums first for each v, because when doing a modulus, subtraction is more expensive than addition
-	// This requires H(v/2), ..., H(vr) to have been computed before, which we can accomplish by computing
-	// H in terms of increasing values of v...
-	// So i is decreasing in this loop...
-	for(int64_t i = self->yinv - 1; i >= 1; --i){
-		// so that v will be increasing here
+	// computing entry i takes about sqrt(x/i) steps, so the total cost of entries below i is proportional to sqrt(i),
+	// and splitting [1, yinv) at the points where sqrt(i) is evenly spaced gives every thread the same amount of work
+	double r_lo = 1, r_hi = sqrt((double)self->yinv);
+	int64_t i_lo = 1;
+	for(uint64_t t = 0; t < num_threads; ++t){
+		double r = r_lo + (r_hi - r_lo)*(t + 1)/num_threads;
+		int64_t i_hi = t + 1 == num_threads ? self->yinv : (int64_t)(r*r);
+		if(i_hi < i_lo){
+			i_hi = i_lo;
+		}else if(i_hi > self->yinv){
+			i_hi = self->yinv;
+		}
+		args[t] = (SparseArgs){.kind = kind, .m = m, .i_lo = i_lo, .i_hi = i_hi, .self = self, .f_tbl = f_tbl, .g_tbl = g_tbl, .idx = idx, .seeded = seeded};
+		i_lo = i_hi;
+	}
+	nut_parallel_run(num_threads, sparse_worker, args, sizeof(SparseArgs));
+	return true;
+}
+
+bool nut_Diri_compute_conv_u_parallel(nut_Diri *restrict self, int64_t m, const nut_Diri *restrict f_tbl, uint64_t num_threads){
+	if(self->y != f_tbl->y || self->x != f_tbl->x){
+		return false;
+	}
+	nut_DiriIndex idx;
+	if(!nut_DiriIndex_init(&idx, self)){
+		return false;
+	}
+	num_threads = num_threads ?: nut_parallel_default_threads();
+	nut_Diri_prefix_sums_kernel(self, m, f_tbl);
+	bool ok = sparse_parallel(CONV_U, self, m, f_tbl, NULL, &idx, NULL, num_threads);
+	nut_DiriIndex_destroy(&idx);
+	return ok && nut_euler_sieve_conv_u_parallel(self->y, m, f_tbl->buf, self->buf, num_threads);
+}
+
+bool nut_Diri_compute_conv_N_parallel(nut_Diri *restrict self, int64_t m, const nut_Diri *restrict f_tbl, uint64_t num_threads){
+	if(self->y != f_tbl->y || self->x != f_tbl->x){
+		return false;
+	}
+	nut_DiriIndex idx;
+	if(!nut_DiriIndex_init(&idx, self)){
+		return false;
+	}
+	num_threads = num_threads ?: nut_parallel_default_threads();
+	nut_Diri_prefix_sums_kernel(self, m, f_tbl);
+	bool ok = sparse_parallel(CONV_N, self, m, f_tbl, NULL, &idx, NULL, num_threads);
+	nut_DiriIndex_destroy(&idx);
+	return ok && nut_euler_sieve_conv_N_parallel(self->y, m, f_tbl->buf, self->buf, num_threads);
+}
+
+bool nut_Diri_compute_conv_parallel(nut_Diri *restrict self, int64_t m, const nut_Diri *f_tbl, const nut_Diri *g_tbl, uint64_t num_threads){
+	if(self->y != f_tbl->y || self->x != f_tbl->x || self->y != g_tbl->y || self->x != g_tbl->x){
+		return false;
+	}
+	nut_DiriIndex idx;
+	if(!nut_DiriIndex_init(&idx, self)){
+		return false;
+	}
+	num_threads = num_threads ?: nut_parallel_default_threads();
+	nut_Diri_prefix_sums_kernel(self, m, f_tbl);
+	bool ok = sparse_parallel(CONV_FG, self, m, f_tbl, g_tbl, &idx, NULL, num_threads);
+	if(ok){
+		nut_Diri_conv_adjust_kernel(self, m, g_tbl);
+		ok = sparse_parallel(CONV_FG_SECOND, self, m, f_tbl, g_tbl, &idx, NULL, num_threads);
+	}
+	nut_DiriIndex_destroy(&idx);
+	return ok && nut_euler_sieve_conv_parallel(self->y, m, f_tbl->buf, g_tbl->buf, self->buf, num_threads);
+}
+
+// copy every sparse entry of self whose quotient self->x/i is also a sparse quotient of old, like every x/(ki) when x = k*old->x,
+// and mark it in seeded.  Both quotient sequences are decreasing, so walk them together
+static void copy_old_sparse(nut_Diri *restrict self, const nut_Diri *restrict old, uint8_t *seeded){
+	for(int64_t i = 1, j = 1; i < self->yinv && j < old->yinv; ++i){
 		int64_t v = self->x/i;
-		int64_t vr = nut_u64_nth_root(v, 2);
-		int64_t H = 0; // H starts at 0 because we add the sums first
-		if(1 <= vr){ // do the extra term of G(v/n)h(n) where n = 1
-			// Because i < self->yinv, v >= self->y by definition of self->yinv,
-			// So it is only possible for v to be <= self->y at most once (if it equals self->y when i is self->yinv - 1).
-			// But if self->y == self->yinv - 1, we store both h(self->y) in the dense part and H(self->yinv - 1) in the sparse part.
-			// Therefore, the value we want always exists in the sparse part here
-			assert(v >= self->y);
-			H = nut_Diri_get_sparse(g_tbl, i);
-		}
-		for(int64_t n = 2, gH_term, Gh_term; n <= vr; ++n){
-			if(v/n <= self->y){
-				gH_term = nut_Diri_get_dense(g_tbl, n)*H_dense[v/n];
-				Gh_term = nut_Diri_get_dense(self, n)*G_dense[v/n];
-			}else{
-				gH_term = nut_Diri_get_dense(g_tbl, n)*nut_Diri_get_sparse(self, i*n);
-				Gh_term = nut_Diri_get_dense(self, n)*nut_Diri_get_sparse(g_tbl, i*n);
+		while(j < old->yinv && old->x/j > v){
+			++j;
+		}
+		if(j < old->yinv && old->x/j == v){
+			self->buf[self->y + i] = old->buf[old->y + j];
+			seeded[i] = 1;
+		}
+	}
+}
+
+// H(x/i) only depends on the final values of f and g at quotients of x/i, so an old sparse entry with the same quotient is the same value,
+// and h(n) doesn't depend on x at all, so the old dense entries carry over and the rest are found with the segmented sieve
+static bool conv_extend(ConvKind kind, nut_Diri *restrict self, int64_t m, const nut_Diri *f_tbl, const nut_Diri *g_tbl, const nut_Diri *restrict old, uint64_t num_threads){
+	if(self->y != f_tbl->y || self->x != f_tbl->x || (g_tbl && (self->y != g_tbl->y || self->x != g_tbl->x)) ||
+		self->x < old->x || self->y < old->y){
+		return false;
+	}
+	uint8_t *seeded [[gnu::cleanup(cleanup_free)]] = calloc(self->yinv, sizeof(uint8_t));
+	if(!seeded){
+		return false;
+	}
+	nut_DiriIndex idx;
+	if(!nut_DiriIndex_init(&idx, self)){
+		return false;
+	}
+	num_threads = num_threads ?: nut_parallel_default_threads();
+	copy_old_sparse(self, old, seeded);
+	nut_Diri_prefix_sums_kernel(self, m, f_tbl);
+	bool ok = sparse_parallel(kind, self, m, f_tbl, g_tbl, &idx, seeded, num_threads);
+	if(ok && kind == CONV_FG){
+		// the correction pass subtracts F(vr)G(vr) from every sparse entry, including the copied ones, so they are copied again at the end
+		nut_Diri_conv_adjust_kernel(self, m, g_tbl);
+		ok = sparse_parallel(CONV_FG_SECOND, self, m, f_tbl, g_tbl, &idx, seeded, num_threads);
+		copy_old_sparse(self, old, seeded);
+	}
+	nut_DiriIndex_destroy(&idx);
+	if(!ok){
+		return false;
+	}
+	memcpy(self->buf + 1, old->buf + 1, old->y*sizeof(int64_t));
+	return euler_sieve_window(kind, old->y + 1, self->y + 1, m, f_tbl->buf, g_tbl ? g_tbl->buf : NULL, self->buf + old->y + 1, num_threads);
+}
+
+bool nut_Diri_compute_conv_u_extend(nut_Diri *restrict self, int64_t m, const nut_Diri *restrict f_tbl, const nut_Diri *restrict old, uint64_t num_threads){
+	return conv_extend(CONV_U, self, m, f_tbl, NULL, old, num_threads);
+}
+
+bool nut_Diri_compute_conv_N_extend(nut_Diri *restrict self, int64_t m, const nut_Diri *restrict f_tbl, const nut_Diri *restrict old, uint64_t num_threads){
+	return conv_extend(CONV_N, self, m, f_tbl, NULL, old, num_threads);
+}
+
+bool nut_Diri_compute_conv_extend(nut_Diri *restrict self, int64_t m, const nut_Diri *f_tbl, const nut_Diri *g_tbl, const nut_Diri *restrict old, uint64_t num_threads){
+	return conv_extend(CONV_FG, self, m, f_tbl, g_tbl, old, num_threads);
+}
+
+#define MERTENS_SEGMENT_LEN 262144
+
+typedef struct{
+	int64_t *buf;
+	const uint64_t *primes;
+	uint64_t num_primes;
+	int64_t lo, hi;
+	int64_t total, offset;
+	bool ok;
+} MertensDenseArgs;
+
+typedef struct{
+	nut_Diri *self;
+	int64_t m;
+	int64_t i_lo, i_hi, stride;
+	/// entries that are already known, or NULL
+	const uint8_t *seeded;
+	const nut_DiriIndex *idx;
+} MertensSparseArgs;
+
+// Write the prefix sums of mu over [a->lo, a->hi) into a->buf, starting from 0.
+// mu(n) is found by flipping the sign once per prime p <= sqrt(n) dividing n, zeroing multiples of p^2, and multiplying those primes together
+// so that if their product is less than n, there is one more prime factor above sqrt(n) to flip the sign for.
+static void *mertens_dense_worker(void *_args){
+	MertensDenseArgs *a = _args;
+	int8_t *mu [[gnu::cleanup(cleanup_free)]] = malloc(MERTENS_SEGMENT_LEN*sizeof(int8_t));
+	uint64_t *prod [[gnu::cleanup(cleanup_free)]] = malloc(MERTENS_SEGMENT_LEN*sizeof(uint64_t));
+	if(!mu || !prod){
+		return NULL;
+	}
+	int64_t acc = 0;
+	for(int64_t lo = a->lo; lo < a->hi; lo += MERTENS_SEGMENT_LEN){
+		int64_t hi = a->hi - lo > MERTENS_SEGMENT_LEN ? lo + MERTENS_SEGMENT_LEN : a->hi;
+		memset(mu, 1, (hi - lo)*sizeof(int8_t));
+		for(int64_t n = lo; n < hi; ++n){
+			prod[n - lo] = 1;
+		}
+		for(uint64_t i = 0; i < a->num_primes; ++i){
+			int64_t p = a->primes[i];
+			if(p*p >= hi){
+				break;
 			}
-			H = m ? nut_i64_mod(H + gH_term%m + Gh_term%m, m) : H + gH_term + Gh_term;
+			for(int64_t n = (lo + p - 1)/p*p; n < hi; n += p){
+				mu[n - lo] = -mu[n - lo];
+				prod[n - lo] *= p;
+			}
+			for(int64_t n = (lo + p*p - 1)/(p*p)*(p*p); n < hi; n += p*p){
+				mu[n - lo] = 0;
+			}
+		}
+		for(int64_t n = lo; n < hi; ++n){
+			int64_t v = mu[n - lo];
+			if(v && prod[n - lo] != (uint64_t)n){
+				v = -v;
+			}
+			a->buf[n] = acc += v;
 		}
-		// Now H consists of all the sums, so we have to take it and subtract it from F(v) + G(vr)H(vr)
-		int64_t term = G_dense[vr]*H_dense[vr];
-		assert(v >= self->y); // see above comment about i < self->yinv
-		term = m ? nut_Diri_get_sparse(f_tbl, i) + term%m : nut_Diri_get_sparse(f_tbl, i) + term;
-		H = m ? nut_i64_mod(term - H, m) : term - H;
-		nut_Diri_set_sparse(self, i, H);
+	}
+	a->total = acc;
+	a->ok = true;
+	return NULL;
+}
+
+static void *mertens_offset_worker(void *_args){
+	MertensDenseArgs *a = _args;
+	for(int64_t n = a->lo; n < a->hi; ++n){
+		a->buf[n] += a->offset;
+	}
+	return NULL;
+}
+
+static inline int64_t mertens_get_dense(const nut_Diri *self, int64_t v, int64_t m){
+	return m ? nut_i64_mod(self->buf[v], m) : self->buf[v];
+}
+
+static void *mertens_sparse_worker(void *_args){
+	MertensSparseArgs *a = _args;
+	nut_Diri *self = a->self;
+	int64_t m = a->m;
+	nut_QuotientIt it;
+	for(nut_QuotientIt_init(&it, self->x, a->i_lo, false); it.i < a->i_hi; nut_QuotientIt_advance(&it, a->stride)){
+		int64_t i = it.i, v = it.v, vr = it.vr;
+		if(a->seeded && a->seeded[i]){
+			continue;
+		}
+		// vr <= y, since y >= sqrt(x)
+		int128_t acc = 1 + (int128_t)mertens_get_dense(self, vr, m)*vr - v;
+		// v/j = x/(ij) has a sparse entry exactly when ij < k_dense
+		int64_t j_dense = (a->idx->k_dense + i - 1)/i, j = 2;
+		for(; j <= vr && j < j_dense; ++j){
+			acc -= (self->buf[j] - self->buf[j - 1])*nut_DiriIndex_quot(a->idx, v, j) + self->buf[self->y + i*j];
+		}
+		for(; j <= vr; ++j){
+			int64_t q = nut_DiriIndex_quot(a->idx, v, j);
+			acc -= (self->buf[j] - self->buf[j - 1])*q + mertens_get_dense(self, q, m);
+		}
+		self->buf[self->y + i] = m ? (int64_t)nut_i64_mod(acc%m, m) : (int64_t)acc;
+	}
+	return NULL;
+}
+
+int64_t nut_mertens_cutoff(int64_t x){
+	double lx = log((double)x + 16);
+	// a dense entry costs several times more than a term of a sparse sum, so the constant is well below 1
+	int64_t y = pow((double)x*log(lx), 2./3)/5;
+	int64_t ymin = nut_u64_nth_root(x, 2);
+	if(y > NUT_MERTENS_MAX_Y){
+		y = NUT_MERTENS_MAX_Y;
+	}
+	return y < ymin ? ymin : y;
+}
+
+// Fill in the Mertens table self.  The dense entries up to y0 must already be prefix sums, and only (y0, self->y] is sieved.
+// Sparse entries marked in seeded (if it is not NULL) must already be filled in, and are skipped.
+static bool mertens_parallel(nut_Diri *self, int64_t m, int64_t y0, const uint8_t *seeded, uint64_t num_threads){
+	if(!num_threads){
+		num_threads = nut_parallel_default_threads();
+	}
+	uint64_t num_primes;
+	uint64_t *primes [[gnu::cleanup(cleanup_free)]] = nut_sieve_primes(nut_u64_nth_root(self->y, 2) + 1, &num_primes);
+	MertensDenseArgs *dense_args [[gnu::cleanup(cleanup_free)]] = calloc(num_threads, sizeof(MertensDenseArgs));
+	MertensSparseArgs *sparse_args [[gnu::cleanup(cleanup_free)]] = calloc(num_threads, sizeof(MertensSparseArgs));
+	nut_DiriIndex idx [[gnu::cleanup(nut_DiriIndex_destroy)]] = {};
+	if(!primes || !dense_args || !sparse_args || !nut_DiriIndex_init(&idx, self)){
+		return false;
+	}
+	int64_t dense_len = self->y - y0;
+	for(uint64_t t = 0; t < num_threads; ++t){
+		dense_args[t] = (MertensDenseArgs){
+			.buf = self->buf, .primes = primes, .num_primes = num_primes,
+			.lo = y0 + 1 + dense_len*t/num_threads, .hi = y0 + 1 + dense_len*(t + 1)/num_threads
+		};
+	}
+	nut_parallel_run(num_threads, mertens_dense_worker, dense_args, sizeof(MertensDenseArgs));
+	int64_t offset = self->buf[y0];
+	for(uint64_t t = 0; t < num_threads; ++t){
+		if(!dense_args[t].ok){
+			return false;
+		}
+		dense_args[t].offset = offset;
+		offset += dense_args[t].total;
+	}
+	nut_parallel_run(num_threads - !y0, mertens_offset_worker, dense_args + !y0, sizeof(MertensDenseArgs));
+	// the entry for x/i depends on the entries for x/(ij), j >= 2, so each block [h/2, h) only depends on entries above it
+	for(int64_t hi = self->yinv; hi > 1;){
+		int64_t lo = (hi + 1)/2;
+		uint64_t tasks = (uint64_t)(hi - lo) < num_threads ? (uint64_t)(hi - lo) : num_threads;
+		for(uint64_t t = 0; t < tasks; ++t){
+			sparse_args[t] = (MertensSparseArgs){.self = self, .m = m, .i_lo = lo + t, .i_hi = hi, .stride = tasks, .seeded = seeded, .idx = &idx};
+		}
+		nut_parallel_run(tasks, mertens_sparse_worker, sparse_args, sizeof(MertensSparseArgs));
+		hi = lo;
+	}
+	for(int64_t i = self->y; i >= 1; --i){
+		self->buf[i] -= self->buf[i - 1];
 	}
 	return true;
 }
 
+bool nut_Diri_compute_mertens_parallel(nut_Diri *self, int64_t m, uint64_t num_threads){
+	self->buf[0] = 0;
+	return mertens_parallel(self, m, 0, NULL, num_threads);
+}
+
+bool nut_Diri_compute_mertens_extend(nut_Diri *restrict self, int64_t m, const nut_Diri *restrict old, uint64_t num_threads){
+	if(self->x < old->x || self->y < old->y){
+		return false;
+	}
+	uint8_t *seeded [[gnu::cleanup(cleanup_free)]] = calloc(self->yinv, sizeof(uint8_t));
+	if(!seeded){
+		return false;
+	}
+	// mu(n) doesn't depend on x, so the old dense entries carry over and only need to be turned back into prefix sums
+	self->buf[0] = 0;
+	for(int64_t n = 1; n <= old->y; ++n){
+		self->buf[n] = self->buf[n - 1] + old->buf[n];
+	}
+	copy_old_sparse(self, old, seeded);
+	return mertens_parallel(self, m, old->y, seeded, num_threads);
+}
+
+bool nut_mertens(int64_t x, int64_t m, uint64_t num_threads, int64_t *out){
+	if(x < 1){
+		*out = 0;
+		return true;
+	}
+	nut_Diri self [[gnu::cleanup(nut_Diri_destroy)]] = {};
+	if(!nut_Diri_init(&self, x, nut_mertens_cutoff(x)) || !nut_Diri_compute_mertens_parallel(&self, m, num_threads)){
+		return false;
+	}
+	*out = nut_Diri_get_sparse(&self, 1);
+	return true;
+}
@@ -0,0 +1,458 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <nut/debug.h>
+#include <nut/modular_math.h>
+#include <nut/factorization.h>
+#include <nut/dirichlet.h>
+#include <nut/mod_kernels.h>
+#include <nut/dirichlet32.h>
+
+// All of the kernels here are forced inline and called with a constant modulus for the common moduli,
+// the same way as in mod_kernels.h, so that every % below turns into a multiply and shift.
+
+NUT_ATTR_ALWAYS_INLINE
+static inline uint32_t add32(uint32_t a, uint32_t b, uint64_t m){
+	uint32_t r = a + b;
+	return r >= m ? r - m : r;
+}
+
+NUT_ATTR_ALWAYS_INLINE
+static inline uint32_t sub32(uint32_t a, uint32_t b, uint64_t m){
+	return a >= b ? a - b : a + (uint32_t)(m - b);
+}
+
+NUT_ATTR_ALWAYS_INLINE
+static inline uint32_t mul32(uint32_t a, uint32_t b, uint64_t m){
+	return (uint64_t)a*b%m;
+}
+
+/// Reduce a 128 bit accumulator using only 64 bit remainders, since a 128 bit remainder is a library call even for constant m
+NUT_ATTR_ALWAYS_INLINE
+static inline uint32_t reduce128(uint128_t a, uint64_t m){
+	uint64_t pow64 = (UINT64_MAX%m + 1)%m;
+	return ((uint64_t)(a >> 64)%m*pow64 + (uint64_t)a%m)%m;
+}
+
+/// Triangular number k(k + 1)/2 mod m, for any k
+NUT_ATTR_ALWAYS_INLINE
+static inline uint32_t tri32(uint64_t k, uint64_t m){
+	return (k&1) ? k%m*(((k + 1)>>1)%m)%m : (k>>1)%m*((k + 1)%m)%m;
+}
+
+/// (f <*> g)(p**a) for 32 bit tables, see { @link NUT_DEFINE_CONV_PRIME_POWER}
+NUT_DEFINE_CONV_PRIME_POWER(conv_prime_power32, uint32_t, uint128_t, reduce128)
+
+static bool check_tbls(const nut_Diri32 *self, int64_t m, const nut_Diri32 *f_tbl, const nut_Diri32 *g_tbl){
+	return m >= 1 && m <= NUT_DIRI32_MAX_MODULUS &&
+		self->x == f_tbl->x && self->y == f_tbl->y && self->x == g_tbl->x && self->y == g_tbl->y;
+}
+
+// the quotient index only looks at the bounds of the table, so build it from a header with the same bounds
+static bool index32(nut_DiriIndex *idx, const nut_Diri32 *tbl){
+	return nut_DiriIndex_init(idx, &(nut_Diri){.x = tbl->x, .y = tbl->y, .yinv = tbl->yinv});
+}
+
+NUT_ATTR_ALWAYS_INLINE
+static inline void prefix_sums32(nut_Diri32 *restrict self, uint64_t m, const nut_Diri32 *restrict f_tbl){
+	self->buf[0] = 0;
+	for(int64_t i = 1; i <= self->y; ++i){
+		self->buf[i] = add32(self->buf[i-1], f_tbl->buf[i], m);
+	}
+}
+
+/// Which convolution the dense part is computing
+typedef enum{
+	CONV32_U,
+	CONV32_N,
+	CONV32_FG
+} Conv32Kind;
+
+/// Numbers per window of the dense part when there is no nut_EulerCtx, see fill_dense_window in dirichlet.c
+#define DENSE_WINDOW32 32768
+
+/// h(p**a) for a prime power pa = p**a, given h(p**(a-1))
+NUT_ATTR_ALWAYS_INLINE
+static inline uint32_t conv_ppow32(Conv32Kind kind, uint64_t m, const nut_Diri32 *f_tbl, const nut_Diri32 *g_tbl, int64_t p, int64_t pa, uint32_t h_prev){
+	switch(kind){
+		case CONV32_U: return add32(h_prev, f_tbl->buf[pa], m);
+		case CONV32_N: return add32(mul32(p%m, h_prev, m), f_tbl->buf[pa], m);
+		default: return conv_prime_power32(f_tbl->buf, g_tbl->buf, p, pa, m);
+	}
+}
+
+/// Fill in the dense part h(n) for 1 <= n <= y, after the sparse part is done with the sums of f or g stored there.
+/// With a nut_EulerCtx this is one pass in order.  Without one (past NUT_EULER_CTX_MAX_N or if it couldn't be allocated),
+/// this is a segmented sieve like nut_euler_sieve_conv_u_window: every prime p <= sqrt(y) divides its full power p**e out of each multiple
+/// and multiplies in h(p**e), and whatever is left of each number is 1 or a prime q, contributing h(q) = h(p**1) with p = q
+NUT_ATTR_ALWAYS_INLINE
+static inline bool dense32(Conv32Kind kind, nut_Diri32 *restrict self, uint64_t m, const nut_Diri32 *f_tbl, const nut_Diri32 *g_tbl, const nut_EulerCtx *ctx){
+	uint32_t one = 1%m;
+	if(ctx){
+		self->buf[1] = one;
+		for(int64_t i = 2; i <= self->y; ++i){
+			uint32_t q = ctx->smallest_ppow[i];
+			if(q & NUT_EULER_CTX_PRIME_POWER){
+				uint32_t p = q & ~NUT_EULER_CTX_PRIME_POWER;
+				self->buf[i] = conv_ppow32(kind, m, f_tbl, g_tbl, p, i, self->buf[(uint32_t)i/p]);
+			}else{
+				self->buf[i] = mul32(self->buf[q], self->buf[(uint32_t)i/q], m);
+			}
+		}
+		return true;
+	}
+	// every prime has at most log2(y) powers up to y
+	uint64_t num_primes, e_max = 64 - __builtin_clzll(self->y);
+	uint64_t *primes [[gnu::cleanup(cleanup_free)]] = nut_sieve_primes(nut_u64_nth_root(self->y, 2), &num_primes);
+	uint32_t *h_pows [[gnu::cleanup(cleanup_free)]] = primes ? malloc(num_primes*(e_max + 1)*sizeof(uint32_t)) : NULL;
+	uint64_t *rem [[gnu::cleanup(cleanup_free)]] = malloc(DENSE_WINDOW32*sizeof(uint64_t));
+	if(!h_pows || !rem){
+		return false;
+	}
+	for(uint64_t j = 0; j < num_primes; ++j){
+		int64_t p = primes[j];
+		uint32_t *h_p = h_pows + j*(e_max + 1);
+		h_p[0] = one;
+		for(int64_t pe = p, e = 1; ; pe *= p, ++e){
+			h_p[e] = conv_ppow32(kind, m, f_tbl, g_tbl, p, pe, h_p[e - 1]);
+			if(pe > self->y/p){
+				break;
+			}
+		}
+	}
+	for(int64_t lo = 1; lo <= self->y; lo += DENSE_WINDOW32){
+		int64_t hi = self->y + 1 - lo > DENSE_WINDOW32 ? lo + DENSE_WINDOW32 : self->y + 1;
+		for(int64_t n = lo; n < hi; ++n){
+			self->buf[n] = one;
+			rem[n - lo] = n;
+		}
+		for(uint64_t j = 0; j < num_primes; ++j){
+			uint64_t p = primes[j];
+			if(p > (uint64_t)(hi - 1)/p){
+				break;
+			}
+			const uint32_t *h_p = h_pows + j*(e_max + 1);
+			for(int64_t k = (lo + p - 1)/p*p; k < hi; k += p){
+				uint64_t r = rem[k - lo]/p, e = 1;
+				for(; r%p == 0; r /= p){
+					++e;
+				}
+				rem[k - lo] = r;
+				self->buf[k] = mul32(self->buf[k], h_p[e], m);
+			}
+		}
+		for(int64_t n = lo; n < hi; ++n){
+			uint64_t q = rem[n - lo];
+			if(q != 1){
+				self->buf[n] = mul32(self->buf[n], conv_ppow32(kind, m, f_tbl, g_tbl, q, q, one), m);
+			}
+		}
+	}
+	return true;
+}
+
+NUT_ATTR_ALWAYS_INLINE
+static inline bool conv_u_kernel32(nut_Diri32 *restrict self, uint64_t m, const nut_Diri32 *restrict f_tbl, const nut_EulerCtx *ctx, const nut_DiriIndex *idx){
+	prefix_sums32(self, m, f_tbl);
+	// see nut_Diri_conv_u_sparse_kernel
+	nut_QuotientIt it;
+	for(nut_QuotientIt_init(&it, self->x, 1, false); it.i < self->yinv; nut_QuotientIt_advance(&it, 1)){
+		int64_t i = it.i, v = it.v, vr = it.vr;
+		int64_t n_split = (idx->k_dense + i - 1)/i;
+		if(n_split > vr + 1){
+			n_split = vr + 1;
+		}
+		uint128_t h = 0;
+		int64_t n = 1;
+		for(; n < n_split; ++n){
+			h += nut_Diri32_get_sparse(f_tbl, i*n);
+			h += (uint128_t)nut_Diri32_get_dense(f_tbl, n)*(uint64_t)nut_DiriIndex_quot(idx, v, n);
+		}
+		for(; n <= vr; ++n){
+			uint64_t q = nut_DiriIndex_quot(idx, v, n);
+			h += nut_Diri32_get_dense(self, q);
+			h += (uint128_t)nut_Diri32_get_dense(f_tbl, n)*q;
+		}
+		nut_Diri32_set_sparse(self, i, sub32(reduce128(h, m), mul32(nut_Diri32_get_dense(self, vr), vr%m, m), m));
+	}
+	return dense32(CONV32_U, self, m, f_tbl, NULL, ctx);
+}
+
+NUT_ATTR_ALWAYS_INLINE
+static inline bool conv_N_kernel32(nut_Diri32 *restrict self, uint64_t m, const nut_Diri32 *restrict f_tbl, const nut_EulerCtx *ctx, const nut_DiriIndex *idx){
+	prefix_sums32(self, m, f_tbl);
+	// see nut_Diri_conv_N_sparse_kernel
+	nut_QuotientIt it;
+	for(nut_QuotientIt_init(&it, self->x, 1, false); it.i < self->yinv; nut_QuotientIt_advance(&it, 1)){
+		int64_t i = it.i, v = it.v, vr = it.vr;
+		int64_t n_split = (idx->k_dense + i - 1)/i;
+		if(n_split > vr + 1){
+			n_split = vr + 1;
+		}
+		uint128_t h = 0;
+		for(int64_t n = 1; n <= vr; ++n){
+			int64_t q = nut_DiriIndex_quot(idx, v, n);
+			uint64_t F = n < n_split ? nut_Diri32_get_sparse(f_tbl, i*n) : nut_Diri32_get_dense(self, q);
+			h += F*n;
+			h += (uint64_t)nut_Diri32_get_dense(f_tbl, n)*tri32(q, m);
+		}
+		nut_Diri32_set_sparse(self, i, sub32(reduce128(h, m), mul32(nut_Diri32_get_dense(self, vr), tri32(vr, m), m), m));
+	}
+	return dense32(CONV32_N, self, m, f_tbl, NULL, ctx);
+}
+
+NUT_ATTR_ALWAYS_INLINE
+static inline bool conv_kernel32(nut_Diri32 *restrict self, uint64_t m, const nut_Diri32 *f_tbl, const nut_Diri32 *g_tbl, const nut_EulerCtx *ctx, const nut_DiriIndex *idx){
+	prefix_sums32(self, m, f_tbl);
+	// first pass, see nut_Diri_conv_Fg_sparse_kernel
+	nut_QuotientIt it;
+	for(nut_QuotientIt_init(&it, self->x, 1, false); it.i < self->yinv; nut_QuotientIt_advance(&it, 1)){
+		int64_t i = it.i, v = it.v, vr = it.vr;
+		int64_t n_split = (idx->k_dense + i - 1)/i;
+		if(n_split > vr + 1){
+			n_split = vr + 1;
+		}
+		uint128_t h = 0;
+		int64_t n = 1;
+		for(; n < n_split; ++n){
+			h += (uint64_t)nut_Diri32_get_sparse(f_tbl, i*n)*nut_Diri32_get_dense(g_tbl, n);
+		}
+		for(; n <= vr; ++n){
+			h += (uint64_t)nut_Diri32_get_dense(self, nut_DiriIndex_quot(idx, v, n))*nut_Diri32_get_dense(g_tbl, n);
+		}
+		nut_Diri32_set_sparse(self, i, reduce128(h, m));
+	}
+	// replace the sums of f with the sums of g and subtract F(vr)G(vr), see nut_Diri_conv_adjust_kernel
+	int64_t i_ub = nut_u64_nth_root(self->y, 2);
+	for(int64_t i = 1; i < i_ub; ++i){
+		self->buf[i] = add32(self->buf[i-1], g_tbl->buf[i], m);
+	}
+	for(int64_t i = i_ub; i <= self->y; ++i){
+		uint32_t F = self->buf[i];
+		uint32_t G = add32(self->buf[i-1], g_tbl->buf[i], m);
+		self->buf[i] = G;
+		uint32_t FG = mul32(F, G, m);
+		int64_t j_ub = self->x/(i*i) + 1;
+		if(j_ub > self->yinv){
+			j_ub = self->yinv;
+		}
+		for(int64_t j = self->x/((i + 1)*(i + 1)) + 1; j < j_ub; ++j){
+			nut_Diri32_set_sparse(self, j, sub32(nut_Diri32_get_sparse(self, j), FG, m));
+		}
+	}
+	// second pass, see nut_Diri_conv_fG_sparse_kernel
+	for(nut_QuotientIt_init(&it, self->x, 1, false); it.i < self->yinv; nut_QuotientIt_advance(&it, 1)){
+		int64_t i = it.i, v = it.v, vr = it.vr;
+		int64_t n_split = (idx->k_dense + i - 1)/i;
+		if(n_split > vr + 1){
+			n_split = vr + 1;
+		}
+		uint128_t h = nut_Diri32_get_sparse(self, i);
+		int64_t n = 1;
+		for(; n < n_split; ++n){
+			h += (uint64_t)nut_Diri32_get_sparse(g_tbl, i*n)*nut_Diri32_get_dense(f_tbl, n);
+		}
+		for(; n <= vr; ++n){
+			h += (uint64_t)nut_Diri32_get_dense(self, nut_DiriIndex_quot(idx, v, n))*nut_Diri32_get_dense(f_tbl, n);
+		}
+		nut_Diri32_set_sparse(self, i, reduce128(h, m));
+	}
+	return dense32(CONV32_FG, self, m, f_tbl, g_tbl, ctx);
+}
+
+NUT_ATTR_ALWAYS_INLINE
+static inline void convdiv_kernel32(nut_Diri32 *restrict self, uint64_t m, const nut_Diri32 *restrict f_tbl, const nut_Diri32 *restrict g_tbl, uint32_t *restrict H_dense, uint32_t *restrict G_dense, const nut_DiriIndex *idx){
+	// see nut_Diri_convdiv in dirichlet.c for the derivation
+	memset(self->buf, 0, (self->y + 1)*sizeof(uint32_t));
+	for(int64_t i = 1; i <= self->y; ++i){
+		uint32_t h = self->buf[i] = add32(self->buf[i], f_tbl->buf[i], m);
+		if(!h){
+			continue;
+		}
+		for(int64_t j = 2; j <= self->y/i; ++j){
+			self->buf[i*j] = sub32(self->buf[i*j], mul32(h, g_tbl->buf[j], m), m);
+		}
+	}
+	H_dense[0] = G_dense[0] = 0;
+	for(int64_t i = 1; i <= self->y; ++i){
+		H_dense[i] = add32(H_dense[i - 1], self->buf[i], m);
+		G_dense[i] = add32(G_dense[i - 1], g_tbl->buf[i], m);
+	}
+	// H(v) = F(v) + G(vr)H(vr) - sum(n = 2 ... vr, g(n)H(v/n)) - sum(n = 1 ... vr, G(v/n)h(n))
+	nut_QuotientIt it;
+	for(nut_QuotientIt_init(&it, self->x, self->yinv - 1, false); it.i >= 1; nut_QuotientIt_advance(&it, -1)){
+		int64_t i = it.i, v = it.v, vr = it.vr;
+		int64_t n_split = (idx->k_dense + i - 1)/i;
+		if(n_split > vr + 1){
+			n_split = vr + 1;
+		}
+		uint128_t H = nut_Diri32_get_sparse(g_tbl, i);
+		int64_t n = 2;
+		for(; n < n_split; ++n){
+			uint64_t g = nut_Diri32_get_dense(g_tbl, n), h = nut_Diri32_get_dense(self, n);
+			H += g*nut_Diri32_get_sparse(self, i*n);
+			H += h*nut_Diri32_get_sparse(g_tbl, i*n);
+		}
+		for(; n <= vr; ++n){
+			uint64_t g = nut_Diri32_get_dense(g_tbl, n), h = nut_Diri32_get_dense(self, n);
+			int64_t q = nut_DiriIndex_quot(idx, v, n);
+			H += g*H_dense[q];
+			H += h*G_dense[q];
+		}
+		uint32_t res = add32(nut_Diri32_get_sparse(f_tbl, i), mul32(G_dense[vr], H_dense[vr], m), m);
+		nut_Diri32_set_sparse(self, i, sub32(res, reduce128(H, m), m));
+	}
+}
+
+bool nut_Diri32_init(nut_Diri32 *self, int64_t x, int64_t y){
+	int64_t ymin = nut_u64_nth_root(x, 2);
+	if(y < ymin){
+		y = ymin;
+	}
+	int64_t yinv = x/y + 1;
+	if(!(self->buf = malloc((y + yinv)*sizeof(uint32_t)))){
+		return false;
+	}
+	self->x = x;
+	self->y = y;
+	self->yinv = yinv;
+	return true;
+}
+
+void nut_Diri32_copy(nut_Diri32 *restrict dest, const nut_Diri32 *restrict src){
+	memcpy(dest->buf, src->buf, (src->y + src->yinv)*sizeof(uint32_t));
+}
+
+void nut_Diri32_destroy(nut_Diri32 *self){
+	free(self->buf);
+	*self = (nut_Diri32){};
+}
+
+bool nut_Diri32_from_Diri(nut_Diri32 *restrict self, int64_t m, const nut_Diri *restrict src){
+	if(m < 1 || m > NUT_DIRI32_MAX_MODULUS || self->x != src->x || self->y != src->y){
+		return false;
+	}
+	for(int64_t i = 0; i < self->y + self->yinv; ++i){
+		self->buf[i] = nut_i64_mod(src->buf[i], m);
+	}
+	return true;
+}
+
+bool nut_Diri32_to_Diri(nut_Diri *restrict self, const nut_Diri32 *restrict src){
+	if(self->x != src->x || self->y != src->y){
+		return false;
+	}
+	for(int64_t i = 0; i < self->y + self->yinv; ++i){
+		self->buf[i] = src->buf[i];
+	}
+	return true;
+}
+
+void nut_Diri32_compute_I(nut_Diri32 *self, int64_t m){
+	uint32_t one = 1%m;
+	memset(self->buf, 0, (self->y + 1)*sizeof(uint32_t));
+	self->buf[1] = one;
+	for(int64_t i = 1; i < self->yinv; ++i){
+		self->buf[self->y + i] = one;
+	}
+}
+
+void nut_Diri32_compute_u(nut_Diri32 *self, int64_t m){
+	uint32_t one = 1%m;
+	for(int64_t i = 0; i <= self->y; ++i){
+		self->buf[i] = one;
+	}
+	for(int64_t i = 1; i < self->yinv; ++i){
+		self->buf[self->y + i] = (self->x/i)%m;
+	}
+}
+
+void nut_Diri32_compute_N(nut_Diri32 *self, int64_t m){
+	for(int64_t i = 0; i <= self->y; ++i){
+		self->buf[i] = i%m;
+	}
+	for(int64_t i = 1; i < self->yinv; ++i){
+		self->buf[self->y + i] = tri32(self->x/i, m);
+	}
+}
+
+bool nut_Diri32_compute_conv_u(nut_Diri32 *restrict self, int64_t m, const nut_Diri32 *restrict f_tbl, const nut_EulerCtx *ctx){
+	nut_EulerCtx tmp_ctx [[gnu::cleanup(nut_EulerCtx_destroy)]] = {};
+	if(!check_tbls(self, m, f_tbl, f_tbl)){
+		return false;
+	}else if(!ctx){
+		// without a ctx (past NUT_EULER_CTX_MAX_N, or if it can't be allocated) the dense part is sieved in windows instead
+		ctx = nut_EulerCtx_init(&tmp_ctx, self->y) ? &tmp_ctx : NULL;
+	}else if(ctx->n < self->y){
+		return false;
+	}
+	nut_DiriIndex idx [[gnu::cleanup(nut_DiriIndex_destroy)]] = {};
+	if(!index32(&idx, self)){
+		return false;
+	}
+	switch(m){
+		case 1000000007: return conv_u_kernel32(self, 1000000007, f_tbl, ctx, &idx);
+		case 998244353: return conv_u_kernel32(self, 998244353, f_tbl, ctx, &idx);
+		default: return conv_u_kernel32(self, m, f_tbl, ctx, &idx);
+	}
+}
+
+bool nut_Diri32_compute_conv_N(nut_Diri32 *restrict self, int64_t m, const nut_Diri32 *restrict f_tbl, const nut_EulerCtx *ctx){
+	nut_EulerCtx tmp_ctx [[gnu::cleanup(nut_EulerCtx_destroy)]] = {};
+	if(!check_tbls(self, m, f_tbl, f_tbl)){
+		return false;
+	}else if(!ctx){
+		// without a ctx (past NUT_EULER_CTX_MAX_N, or if it can't be allocated) the dense part is sieved in windows instead
+		ctx = nut_EulerCtx_init(&tmp_ctx, self->y) ? &tmp_ctx : NULL;
+	}else if(ctx->n < self->y){
+		return false;
+	}
+	nut_DiriIndex idx [[gnu::cleanup(nut_DiriIndex_destroy)]] = {};
+	if(!index32(&idx, self)){
+		return false;
+	}
+	switch(m){
+		case 1000000007: return conv_N_kernel32(self, 1000000007, f_tbl, ctx, &idx);
+		case 998244353: return conv_N_kernel32(self, 998244353, f_tbl, ctx, &idx);
+		default: return conv_N_kernel32(self, m, f_tbl, ctx, &idx);
+	}
+}
+
+bool nut_Diri32_compute_conv(nut_Diri32 *restrict self, int64_t m, const nut_Diri32 *f_tbl, const nut_Diri32 *g_tbl, const nut_EulerCtx *ctx){
+	nut_EulerCtx tmp_ctx [[gnu::cleanup(nut_EulerCtx_destroy)]] = {};
+	if(!check_tbls(self, m, f_tbl, g_tbl)){
+		return false;
+	}else if(!ctx){
+		// without a ctx (past NUT_EULER_CTX_MAX_N, or if it can't be allocated) the dense part is sieved in windows instead
+		ctx = nut_EulerCtx_init(&tmp_ctx, self->y) ? &tmp_ctx : NULL;
+	}else if(ctx->n < self->y){
+		return false;
+	}
+	nut_DiriIndex idx [[gnu::cleanup(nut_DiriIndex_destroy)]] = {};
+	if(!index32(&idx, self)){
+		return false;
+	}
+	switch(m){
+		case 1000000007: return conv_kernel32(self, 1000000007, f_tbl, g_tbl, ctx, &idx);
+		case 998244353: return conv_kernel32(self, 998244353, f_tbl, g_tbl, ctx, &idx);
+		default: return conv_kernel32(self, m, f_tbl, g_tbl, ctx, &idx);
+	}
+}
+
+bool nut_Diri32_convdiv(nut_Diri32 *restrict self, int64_t m, const nut_Diri32 *restrict f_tbl, const nut_Diri32 *restrict g_tbl){
+	if(!check_tbls(self, m, f_tbl, g_tbl)){
+		return false;
+	}
+	uint32_t *H_dense [[gnu::cleanup(cleanup_free)]] = malloc((self->y + 1)*sizeof(uint32_t));
+	uint32_t *G_dense [[gnu::cleanup(cleanup_free)]] = malloc((self->y + 1)*sizeof(uint32_t));
+	nut_DiriIndex idx [[gnu::cleanup(nut_DiriIndex_destroy)]] = {};
+	if(!H_dense || !G_dense || !index32(&idx, self)){
+		return false;
+	}
+	switch(m){
+		case 1000000007: convdiv_kernel32(self, 1000000007, f_tbl, g_tbl, H_dense, G_dense, &idx); break;
+		case 998244353: convdiv_kernel32(self, 998244353, f_tbl, g_tbl, H_dense, G_dense, &idx); break;
+		default: convdiv_kernel32(self, m, f_tbl, g_tbl, H_dense, G_dense, &idx);
+	}
+	return true;
+}
@@ -0,0 +1,221 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <nut/debug.h>
+#include <nut/modular_math.h>
+#include <nut/factorization.h>
+#include <nut/dirichlet.h>
+#include <nut/dirichlet_cost.h>
+
+// from nut_DiriCostModel_calibrate at x = 10^10, averaged over a few runs
+const nut_DiriCostModel nut_diri_default_cost_model = {
+	.dense = {
+		[NUT_DIRI_OP_CONV] = {5.5e-8, 6.0e-8},
+		[NUT_DIRI_OP_CONV_U] = {4.5e-8, 5.1e-8},
+		[NUT_DIRI_OP_CONVDIV] = {1.7e-8, 2.4e-8},
+		[NUT_DIRI_OP_PI] = {8.3e-9, 8.3e-9},
+		[NUT_DIRI_OP_MERTENS] = {8.5e-9, 8.1e-9},
+	},
+	.sparse = {
+		[NUT_DIRI_OP_CONV] = {1.0e-8, 1.2e-8},
+		[NUT_DIRI_OP_CONV_U] = {6.5e-9, 6.2e-9},
+		[NUT_DIRI_OP_CONVDIV] = {7.5e-9, 6.9e-9},
+		[NUT_DIRI_OP_PI] = {8.5e-9, 8.5e-9},
+		[NUT_DIRI_OP_MERTENS] = {4.7e-9, 1.06e-8},
+	},
+};
+
+const char *const nut_diri_op_names[NUT_DIRI_NUM_OPS] = {"conv", "conv_u", "convdiv", "pi", "mertens"};
+
+static const int64_t calibration_modulus = 1000000007;
+
+// nut_Diri_compute_pi only runs Lucy's algorithm up to y = 2sqrt(x) and sieves the rest of the dense part
+static double lucy_y(double x, double y){
+	return y < 2*sqrt(x) ? y : 2*sqrt(x);
+}
+
+// D(x, y): Lucy's algorithm sieves the dense entries above p^2 for every prime p <= sqrt(y), plus the segmented sieve past lucy_y,
+// the mu sieve costs about y log(log(y)), convdiv sieves h(i) into every multiple of i, and the other convolutions use a linear sieve
+static double dense_shape(nut_DiriOp op, double x, double y){
+	double yl = lucy_y(x, y);
+	switch(op){
+		case NUT_DIRI_OP_PI: return yl*sqrt(yl)/log(yl + 2) + (y - yl);
+		case NUT_DIRI_OP_MERTENS: return y*log(log(y + 16));
+		case NUT_DIRI_OP_CONVDIV: return y*log(y + 2);
+		default: return y;
+	}
+}
+
+// S(x, y): the entry for x/i takes about sqrt(x/i) steps, which sums to about 2sqrt(x(x/y)) over i < x/y.
+// For Lucy's algorithm, only the primes up to sqrt(x/i) count, and the scratch table has y = lucy_y
+static double sparse_shape(nut_DiriOp op, double x, double y){
+	if(op == NUT_DIRI_OP_PI){
+		y = lucy_y(x, y);
+		return 2*sqrt(x*(x/y))/log(sqrt(y) + 2);
+	}
+	return 2*sqrt(x*(x/y));
+}
+
+double nut_DiriCostModel_predict(const nut_DiriCostModel *self, nut_DiriOp op, int64_t m, int64_t x, int64_t y){
+	return self->dense[op][!!m]*dense_shape(op, x, y) + self->sparse[op][!!m]*sparse_shape(op, x, y);
+}
+
+static double now(){
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+// time one operation on tables with bounds x and y, or return a negative number on allocation failure
+static double time_op(nut_DiriOp op, int64_t m, int64_t x, int64_t y){
+	nut_Diri out [[gnu::cleanup(nut_Diri_destroy)]] = {};
+	nut_Diri f_tbl [[gnu::cleanup(nut_Diri_destroy)]] = {};
+	nut_Diri g_tbl [[gnu::cleanup(nut_Diri_destroy)]] = {};
+	if(!nut_Diri_init(&out, x, y) || !nut_Diri_init(&f_tbl, x, y) || !nut_Diri_init(&g_tbl, x, y)){
+		return -1;
+	}
+	// the dense part of the convolutions assumes multiplicative inputs, so use N and u
+	nut_Diri_compute_N(&f_tbl, m);
+	nut_Diri_compute_u(&g_tbl, m);
+	double start = now();
+	bool ok;
+	switch(op){
+		case NUT_DIRI_OP_CONV: ok = nut_Diri_compute_conv(&out, m, &f_tbl, &g_tbl); break;
+		case NUT_DIRI_OP_CONV_U: ok = nut_Diri_compute_conv_u(&out, m, &f_tbl); break;
+		case NUT_DIRI_OP_CONVDIV: ok = nut_Diri_convdiv(&out, m, &f_tbl, &g_tbl); break;
+		case NUT_DIRI_OP_PI: ok = nut_Diri_compute_pi(&out); break;
+		default: ok = nut_Diri_compute_mertens_parallel(&out, m, 1);
+	}
+	return ok ? now() - start : -1;
+}
+
+bool nut_DiriCostModel_calibrate(nut_DiriCostModel *self, int64_t x){
+	*self = nut_diri_default_cost_model;
+	if(!x){
+		x = 10000000000;
+	}
+	int64_t y1 = nut_u64_nth_root(x, 2);
+	for(uint64_t op = 0; op < NUT_DIRI_NUM_OPS; ++op){
+		// Lucy's algorithm only runs up to 2sqrt(x), so it is timed there, where the segmented sieve doesn't run at all
+		int64_t y2 = op == NUT_DIRI_OP_PI ? 2*y1 : (int64_t)(nut_u64_nth_root(x, 3)*nut_u64_nth_root(x, 3));
+		for(uint64_t mod = 0; mod < 2; ++mod){
+			int64_t m = mod ? calibration_modulus : 0;
+			if(op == NUT_DIRI_OP_PI && mod){
+				self->dense[op][1] = self->dense[op][0];
+				self->sparse[op][1] = self->sparse[op][0];
+				continue;
+			}
+			double t1 = time_op(op, m, x, y1), t2 = time_op(op, m, x, y2);
+			if(t1 < 0 || t2 < 0){
+				return false;
+			}
+			// solve t = a D(y) + b S(x, y) at both points
+			double d1 = dense_shape(op, x, y1), s1 = sparse_shape(op, x, y1);
+			double d2 = dense_shape(op, x, y2), s2 = sparse_shape(op, x, y2);
+			double det = d1*s2 - d2*s1;
+			double a = (t1*s2 - t2*s1)/det, b = (d1*t2 - d2*t1)/det;
+			if(a > 0 && b > 0){
+				self->dense[op][mod] = a;
+				self->sparse[op][mod] = b;
+			}
+		}
+	}
+	return true;
+}
+
+bool nut_DiriCostModel_save(const nut_DiriCostModel *restrict self, const char *restrict path){
+	FILE *file = fopen(path, "w");
+	if(!file){
+		return false;
+	}
+	bool res = fprintf(file, "nut_DiriCostModel 1\n") > 0;
+	for(uint64_t op = 0; res && op < NUT_DIRI_NUM_OPS; ++op){
+		res = fprintf(file, "%s %.17g %.17g %.17g %.17g\n", nut_diri_op_names[op],
+			self->dense[op][0], self->sparse[op][0], self->dense[op][1], self->sparse[op][1]) > 0;
+	}
+	return !fclose(file) && res;
+}
+
+bool nut_DiriCostModel_load(nut_DiriCostModel *restrict self, const char *restrict path){
+	FILE *file = fopen(path, "r");
+	if(!file){
+		return false;
+	}
+	int version;
+	bool res = fscanf(file, "nut_DiriCostModel %d", &version) == 1 && version == 1;
+	for(uint64_t op = 0; res && op < NUT_DIRI_NUM_OPS; ++op){
+		char name[16];
+		res = fscanf(file, "%15s %lg %lg %lg %lg", name,
+			&self->dense[op][0], &self->sparse[op][0], &self->dense[op][1], &self->sparse[op][1]) == 5 && !strcmp(name, nut_diri_op_names[op]);
+	}
+	fclose(file);
+	return res;
+}
+
+static double predict_mix(const nut_DiriCostModel *model, const nut_DiriOpMix *mix, int64_t x, int64_t y){
+	double res = 0;
+	for(uint64_t op = 0; op < NUT_DIRI_NUM_OPS; ++op){
+		if(mix->weight[op]){
+			res += mix->weight[op]*nut_DiriCostModel_predict(model, op, mix->m, x, y);
+		}
+	}
+	return res;
+}
+
+static bool fits(int64_t x, int64_t y, size_t mem_budget){
+	return !mem_budget || (uint64_t)(y + x/y + 1) <= mem_budget/sizeof(int64_t);
+}
+
+int64_t nut_Diri_auto_y(int64_t x, const nut_DiriOpMix *mix, size_t mem_budget, const nut_DiriCostModel *model){
+	if(!model){
+		model = &nut_diri_default_cost_model;
+	}
+	int64_t lo = nut_u64_nth_root(x, 2), hi = x;
+	if(lo < 1){
+		lo = 1;
+	}
+	if(!fits(x, lo, mem_budget)){
+		return 0;
+	}
+	// the table size only grows with y above sqrt(x), so find the largest y that fits by bisection
+	if(!fits(x, hi, mem_budget)){
+		int64_t a = lo, b = hi;
+		while(b - a > 1){
+			int64_t mid = a + (b - a)/2;
+			*(fits(x, mid, mem_budget) ? &a : &b) = mid;
+		}
+		hi = a;
+	}
+	// the predicted time is convex in log(y), so scan a coarse grid and then narrow down around the best point
+	static const int grid = 64;
+	double log_lo = log((double)lo), log_hi = log((double)hi);
+	int best = 0;
+	double best_cost = INFINITY;
+	for(int k = 0; k <= grid; ++k){
+		int64_t y = k == grid ? hi : (int64_t)exp(log_lo + (log_hi - log_lo)*k/grid);
+		double cost = predict_mix(model, mix, x, y < lo ? lo : y);
+		if(cost < best_cost){
+			best_cost = cost;
+			best = k;
+		}
+	}
+	double a = log_lo + (log_hi - log_lo)*(best ? best - 1 : 0)/grid, b = log_lo + (log_hi - log_lo)*(best < grid ? best + 1 : grid)/grid;
+	for(int iter = 0; iter < 40; ++iter){
+		double c = a + (b - a)/3, d = b - (b - a)/3;
+		if(predict_mix(model, mix, x, (int64_t)exp(c)) < predict_mix(model, mix, x, (int64_t)exp(d))){
+			b = d;
+		}else{
+			a = c;
+		}
+	}
+	int64_t y = exp((a + b)/2);
+	return y < lo ? lo : y > hi ? hi : y;
+}
+
+bool nut_Diri_init_auto(nut_Diri *self, int64_t x, const nut_DiriOpMix *mix, size_t mem_budget, const nut_DiriCostModel *model){
+	int64_t y = nut_Diri_auto_y(x, mix, mem_budget, model);
+	return y && nut_Diri_init(self, x, y);
+}
@@ -0,0 +1,140 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <nut/debug.h>
+#include <nut/modular_math.h>
+#include <nut/factorization.h>
+#include <nut/dirichlet.h>
+#include <nut/mod_kernels.h>
+#include <nut/parallel.h>
+#include <nut/dirichlet_crt.h>
+
+// the largest primes the modular kernels can use
+const int64_t nut_Diri_crt_moduli[NUT_DIRI_CRT_MAX_MODULI] = {3037000493, 3037000453, 3037000429, 3037000427};
+
+static_assert(3037000493 <= NUT_MOD_KERNELS_MAX_MODULUS, "CRT moduli must work with the modular kernels");
+
+typedef struct{
+	nut_Diri_mod_fn fn;
+	void *data;
+	nut_Diri *tbls;
+	uint64_t thread_idx, num_threads, num_moduli;
+	bool ok;
+} CrtArgs;
+
+static void *crt_worker(void *_args){
+	CrtArgs *a = _args;
+	a->ok = true;
+	for(uint64_t j = a->thread_idx; a->ok && j < a->num_moduli; j += a->num_threads){
+		a->ok = a->fn(a->tbls + j, nut_Diri_crt_moduli[j], a->data);
+	}
+	return NULL;
+}
+
+bool nut_Diri128_init(nut_Diri128 *self, int64_t x, int64_t y){
+	int64_t ymin = nut_u64_nth_root(x, 2);
+	if(y < ymin){
+		y = ymin;
+	}
+	int64_t yinv = x/y + 1;
+	if(!(self->buf = malloc((y + yinv)*sizeof(int128_t)))){
+		return false;
+	}
+	self->x = x;
+	self->y = y;
+	self->yinv = yinv;
+	return true;
+}
+
+void nut_Diri128_destroy(nut_Diri128 *self){
+	free(self->buf);
+	*self = (nut_Diri128){};
+}
+
+uint64_t nut_Diri_crt_num_moduli(double log2_bound){
+	// the product of the moduli has to be more than twice the bound, so that the symmetric range covers [-bound, bound]
+	double log2_prod = 0;
+	for(uint64_t k = 0; k < NUT_DIRI_CRT_MAX_MODULI; ++k){
+		log2_prod += log2((double)nut_Diri_crt_moduli[k]);
+		if(log2_prod > log2_bound + 1){
+			return k + 1;
+		}
+	}
+	return 0;
+}
+
+double nut_Diri_log2_bound_Nk(int64_t x, uint64_t k){
+	return (k + 1)*log2((double)x);
+}
+
+double nut_Diri_log2_bound_dk(int64_t x, uint64_t k){
+	return log2((double)x) + (k ? k - 1. : 0.)*log2(1 + log((double)x));
+}
+
+bool nut_Diri128_compute_exact(nut_Diri128 *self, double log2_bound, nut_Diri_mod_fn fn, void *data, uint64_t num_threads){
+	uint64_t num_moduli = nut_Diri_crt_num_moduli(log2_bound);
+	if(!num_moduli){
+		return false;
+	}
+	nut_Diri *tbls [[gnu::cleanup(cleanup_free)]] = calloc(num_moduli, sizeof(nut_Diri));
+	if(!tbls){
+		return false;
+	}
+	bool ok = true;
+	for(uint64_t j = 0; ok && j < num_moduli; ++j){
+		ok = nut_Diri_init(tbls + j, self->x, self->y);
+	}
+	if(!num_threads){
+		num_threads = nut_parallel_default_threads();
+	}
+	if(num_threads > num_moduli){
+		num_threads = num_moduli;
+	}
+	CrtArgs *args [[gnu::cleanup(cleanup_free)]] = ok ? malloc(num_threads*sizeof(CrtArgs)) : NULL;
+	if(args){
+		for(uint64_t t = 0; t < num_threads; ++t){
+			args[t] = (CrtArgs){.fn = fn, .data = data, .tbls = tbls, .thread_idx = t, .num_threads = num_threads, .num_moduli = num_moduli};
+		}
+		nut_parallel_run(num_threads, crt_worker, args, sizeof(CrtArgs));
+		for(uint64_t t = 0; t < num_threads; ++t){
+			ok = ok && args[t].ok;
+		}
+	}
+	ok = ok && args;
+	if(ok){
+		// Garner's algorithm: the value is c_0 + c_1 p_0 + c_2 p_0 p_1 + ..., with each c_j in [0, p_j) found mod p_j.
+		// prefix[j][i] is p_0 ... p_(i-1) mod p_j, and inv[j] is the inverse of p_0 ... p_(j-1) mod p_j
+		uint64_t prefix[NUT_DIRI_CRT_MAX_MODULI][NUT_DIRI_CRT_MAX_MODULI], inv[NUT_DIRI_CRT_MAX_MODULI];
+		uint128_t prod = 1;
+		for(uint64_t j = 0; j < num_moduli; ++j){
+			uint64_t p = nut_Diri_crt_moduli[j];
+			prefix[j][0] = 1;
+			for(uint64_t i = 1; i <= j; ++i){
+				prefix[j][i] = prefix[j][i - 1]*nut_Diri_crt_moduli[i - 1]%p;
+			}
+			inv[j] = j ? nut_i64_modinv(prefix[j][j], p) : 1;
+			prod *= p;
+		}
+		uint128_t half = prod/2;
+		for(int64_t n = 0; n < self->y + self->yinv; ++n){
+			uint64_t c[NUT_DIRI_CRT_MAX_MODULI];
+			for(uint64_t j = 0; j < num_moduli; ++j){
+				uint64_t p = nut_Diri_crt_moduli[j], acc = 0;
+				for(uint64_t i = 0; i < j; ++i){
+					acc = (acc + c[i]*prefix[j][i])%p;
+				}
+				c[j] = (nut_i64_mod(tbls[j].buf[n], p) + p - acc)%p*inv[j]%p;
+			}
+			uint128_t v = c[num_moduli - 1];
+			for(uint64_t j = num_moduli - 1; j-- > 0;){
+				v = v*nut_Diri_crt_moduli[j] + c[j];
+			}
+			self->buf[n] = v > half ? -(int128_t)(prod - v) : (int128_t)v;
+		}
+	}
+	for(uint64_t j = 0; j < num_moduli; ++j){
+		nut_Diri_destroy(tbls + j);
+	}
+	return ok;
+}
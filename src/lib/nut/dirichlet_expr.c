@@ -0,0 +1,372 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <nut/debug.h>
+#include <nut/dirichlet.h>
+#include <nut/dirichlet_cost.h>
+#include <nut/dirichlet_expr.h>
+
+// Temporary tables are allocated the first time they are needed and reused after they are given back.
+// They live in a linked list so that pointers to them stay valid as the pool grows
+typedef struct DiriPoolEntry DiriPoolEntry;
+struct DiriPoolEntry{
+	nut_Diri tbl;
+	bool used;
+	DiriPoolEntry *next;
+};
+
+typedef struct{
+	int64_t x, y;
+	DiriPoolEntry *head;
+} DiriPool;
+
+// One step of a product: a factor to multiply in, and the predicted time of doing so.
+// The kinds are in order of preference for starting a product: leaf tables are free, and u and N have closed forms
+typedef enum{
+	PASS_TBL,
+	PASS_U,
+	PASS_N,
+	PASS_NK,
+} DiriPassKind;
+
+typedef struct{
+	DiriPassKind kind;
+	const nut_Diri *tbl;
+	uint64_t k;
+	double cost;
+} DiriPass;
+
+// An expression flattened into a product of distinct leaves raised to integer powers
+typedef struct{
+	uint64_t num_tbls, num_Nks;
+	const nut_Diri **tbls;
+	int64_t *tbl_pows;
+	uint64_t *Nk_ks;
+	int64_t *Nk_pows;
+	int64_t u_pow, N_pow;
+} DiriFactors;
+
+// State for multiplying a sequence of factors into out, where every pass writes to either out or tmp
+typedef struct{
+	int64_t m;
+	/// Factorizations for the dense sieves, or NULL if none could be built, to use the kernels without one
+	const nut_EulerCtx *ctx;
+	DiriPool *pool;
+	nut_Diri *out, *tmp;
+	const nut_Diri *cur;
+	int64_t writes_left;
+} DiriChain;
+
+static nut_Diri *pool_take(DiriPool *pool){
+	for(DiriPoolEntry *entry = pool->head; entry; entry = entry->next){
+		if(!entry->used){
+			entry->used = true;
+			return &entry->tbl;
+		}
+	}
+	DiriPoolEntry *entry = malloc(sizeof(DiriPoolEntry));
+	if(!entry){
+		return NULL;
+	}else if(!nut_Diri_init(&entry->tbl, pool->x, pool->y)){
+		free(entry);
+		return NULL;
+	}
+	entry->used = true;
+	entry->next = pool->head;
+	pool->head = entry;
+	return &entry->tbl;
+}
+
+static void pool_give(DiriPool *pool, const nut_Diri *tbl){
+	for(DiriPoolEntry *entry = pool->head; entry; entry = entry->next){
+		if(&entry->tbl == tbl){
+			entry->used = false;
+		}
+	}
+}
+
+static void pool_destroy(DiriPool *pool){
+	for(DiriPoolEntry *entry = pool->head, *next; entry; entry = next){
+		next = entry->next;
+		nut_Diri_destroy(&entry->tbl);
+		free(entry);
+	}
+	pool->head = NULL;
+}
+
+static uint64_t count_leaves(const nut_DiriExpr *expr){
+	if(expr->kind == NUT_DIRI_EXPR_CONV || expr->kind == NUT_DIRI_EXPR_CONVDIV){
+		return count_leaves(expr->a) + count_leaves(expr->b);
+	}
+	return 1;
+}
+
+static bool collect_factors(DiriFactors *factors, const nut_Diri *self, const nut_DiriExpr *expr, int64_t sign){
+	switch(expr->kind){
+		case NUT_DIRI_EXPR_TABLE: {
+			const nut_Diri *tbl = expr->tbl;
+			if(tbl->x != self->x || tbl->y != self->y || tbl == self){
+				return false;
+			}
+			uint64_t i = 0;
+			while(i < factors->num_tbls && factors->tbls[i] != tbl){
+				++i;
+			}
+			if(i == factors->num_tbls){
+				factors->tbls[factors->num_tbls] = tbl;
+				factors->tbl_pows[factors->num_tbls++] = 0;
+			}
+			factors->tbl_pows[i] += sign;
+			return true;
+		}
+		case NUT_DIRI_EXPR_I: return true;
+		case NUT_DIRI_EXPR_U: factors->u_pow += sign; return true;
+		case NUT_DIRI_EXPR_N: factors->N_pow += sign; return true;
+		case NUT_DIRI_EXPR_MU: factors->u_pow -= sign; return true;
+		case NUT_DIRI_EXPR_NK: {
+			if(expr->k <= 1){
+				*(expr->k ? &factors->N_pow : &factors->u_pow) += sign;
+				return true;
+			}
+			uint64_t i = 0;
+			while(i < factors->num_Nks && factors->Nk_ks[i] != expr->k){
+				++i;
+			}
+			if(i == factors->num_Nks){
+				factors->Nk_ks[factors->num_Nks] = expr->k;
+				factors->Nk_pows[factors->num_Nks++] = 0;
+			}
+			factors->Nk_pows[i] += sign;
+			return true;
+		}
+		case NUT_DIRI_EXPR_CONV:
+			return collect_factors(factors, self, expr->a, sign) && collect_factors(factors, self, expr->b, sign);
+		case NUT_DIRI_EXPR_CONVDIV:
+			return collect_factors(factors, self, expr->a, sign) && collect_factors(factors, self, expr->b, -sign);
+	}
+	return false;
+}
+
+// The output of each pass alternates between out and tmp, starting with whichever one makes the last pass write to out
+static nut_Diri *chain_dst(DiriChain *chain){
+	return --chain->writes_left & 1 ? chain->tmp : chain->out;
+}
+
+static bool chain_conv(DiriChain *chain, const nut_Diri *tbl){
+	if(!chain->cur){
+		chain->cur = tbl;
+		return true;
+	}
+	nut_Diri *dst = chain_dst(chain);
+	if(!(chain->ctx ? nut_Diri_compute_conv_ctx(dst, chain->m, chain->cur, tbl, chain->ctx) : nut_Diri_compute_conv(dst, chain->m, chain->cur, tbl))){
+		return false;
+	}
+	chain->cur = dst;
+	return true;
+}
+
+static bool chain_conv_Nk(DiriChain *chain, uint64_t k){
+	if(!chain->cur){
+		// the first factor has to be materialized anyway, so compute it directly into its place
+		nut_Diri *dst = chain_dst(chain);
+		chain->cur = dst;
+		return nut_Diri_compute_Nk(dst, k, chain->m);
+	}
+	nut_Diri *Nk_tbl = pool_take(chain->pool);
+	bool ok = Nk_tbl && nut_Diri_compute_Nk(Nk_tbl, k, chain->m) && chain_conv(chain, Nk_tbl);
+	pool_give(chain->pool, Nk_tbl);
+	return ok;
+}
+
+// u and N are never materialized unless they are the very first factor, since convolving with them uses their closed form sums
+static bool chain_conv_u_N(DiriChain *chain, bool is_N){
+	nut_Diri *dst = chain_dst(chain);
+	if(!chain->cur){
+		if(is_N){
+			nut_Diri_compute_N(dst, chain->m);
+		}else{
+			nut_Diri_compute_u(dst, chain->m);
+		}
+	}else if(is_N){
+		if(!(chain->ctx ? nut_Diri_compute_conv_N_ctx(dst, chain->m, chain->cur, chain->ctx) : nut_Diri_compute_conv_N(dst, chain->m, chain->cur))){
+			return false;
+		}
+	}else if(!(chain->ctx ? nut_Diri_compute_conv_u_ctx(dst, chain->m, chain->cur, chain->ctx) : nut_Diri_compute_conv_u(dst, chain->m, chain->cur))){
+		return false;
+	}
+	chain->cur = dst;
+	return true;
+}
+
+static double pass_cost(DiriPassKind kind, int64_t m, int64_t x, int64_t y){
+	const nut_DiriCostModel *model = &nut_diri_default_cost_model;
+	switch(kind){
+		case PASS_TBL: return nut_DiriCostModel_predict(model, NUT_DIRI_OP_CONV, m, x, y);
+		// N^k has to be materialized first, which is about as much work as a pass with a closed form
+		case PASS_NK: return nut_DiriCostModel_predict(model, NUT_DIRI_OP_CONV, m, x, y) + nut_DiriCostModel_predict(model, NUT_DIRI_OP_CONV_U, m, x, y);
+		default: return nut_DiriCostModel_predict(model, NUT_DIRI_OP_CONV_U, m, x, y);
+	}
+}
+
+// number of convolutions nut_Diri_compute_dk does for k >= 2: one per squaring and one per extra set bit
+static int64_t dk_convs(int64_t k){
+	return 63 - __builtin_clzll(k) + __builtin_popcountll(k) - 1;
+}
+
+static bool run_pass(DiriChain *chain, const DiriPass *pass){
+	switch(pass->kind){
+		case PASS_TBL: return chain_conv(chain, pass->tbl);
+		case PASS_NK: return chain_conv_Nk(chain, pass->k);
+		case PASS_N: return chain_conv_u_N(chain, true);
+		default: return chain_conv_u_N(chain, false);
+	}
+}
+
+// Multiply out the factors whose power has the given sign.
+// Returns the table holding the product, which is either out or, if the product is a single leaf table, that table.
+// See the file description for how the passes are planned
+static const nut_Diri *eval_product(DiriPool *pool, nut_Diri *out, int64_t m, const DiriFactors *factors, int64_t sign, const nut_EulerCtx *ctx){
+	int64_t x = out->x, y = out->y;
+	int64_t u_pow = factors->u_pow*sign, N_pow = factors->N_pow*sign, tbl_factors = 0, num_factors = 0;
+	u_pow = u_pow > 0 ? u_pow : 0;
+	N_pow = N_pow > 0 ? N_pow : 0;
+	for(uint64_t i = 0; i < factors->num_tbls; ++i){
+		if(factors->tbl_pows[i]*sign > 0){
+			tbl_factors += factors->tbl_pows[i]*sign;
+		}
+	}
+	num_factors = tbl_factors + N_pow;
+	for(uint64_t i = 0; i < factors->num_Nks; ++i){
+		if(factors->Nk_pows[i]*sign > 0){
+			num_factors += factors->Nk_pows[i]*sign;
+		}
+	}
+	if(!num_factors && !u_pow){
+		nut_Diri_compute_I(out);
+		return out;
+	}
+	// u^k can be done as k passes with conv_u, or by binary exponentiation and then one more general pass to fold it in,
+	// unless it is the whole product or there is nothing else to start the chain with
+	bool use_dk = false;
+	if(u_pow >= 2){
+		double seq_cost = u_pow*pass_cost(PASS_U, m, x, y);
+		double dk_cost = (dk_convs(u_pow) + (tbl_factors > 0))*pass_cost(PASS_TBL, m, x, y);
+		use_dk = dk_cost < seq_cost;
+	}
+	if(use_dk && !num_factors){
+		nut_Diri *f_tbl = pool_take(pool), *g_tbl = pool_take(pool);
+		bool ok = f_tbl && g_tbl && nut_Diri_compute_dk_ctx(out, u_pow, m, f_tbl, g_tbl, ctx);
+		pool_give(pool, f_tbl);
+		pool_give(pool, g_tbl);
+		return ok ? out : NULL;
+	}
+	int64_t num_passes = num_factors + (use_dk ? 0 : u_pow);
+	DiriPass *passes [[gnu::cleanup(cleanup_free)]] = malloc(num_passes*sizeof(DiriPass));
+	if(!passes){
+		return NULL;
+	}
+	int64_t n = 0;
+	for(uint64_t i = 0; i < factors->num_tbls; ++i){
+		for(int64_t j = 0; j < factors->tbl_pows[i]*sign; ++j){
+			passes[n++] = (DiriPass){.kind = PASS_TBL, .tbl = factors->tbls[i]};
+		}
+	}
+	for(uint64_t i = 0; i < factors->num_Nks; ++i){
+		for(int64_t j = 0; j < factors->Nk_pows[i]*sign; ++j){
+			passes[n++] = (DiriPass){.kind = PASS_NK, .k = factors->Nk_ks[i]};
+		}
+	}
+	for(int64_t j = 0; j < N_pow; ++j){
+		passes[n++] = (DiriPass){.kind = PASS_N};
+	}
+	for(int64_t j = 0; !use_dk && j < u_pow; ++j){
+		passes[n++] = (DiriPass){.kind = PASS_U};
+	}
+	for(int64_t i = 0; i < n; ++i){
+		passes[i].cost = pass_cost(passes[i].kind, m, x, y);
+	}
+	// The chain starts from u^k if it was done by binary exponentiation, otherwise from a leaf table, which is free,
+	// or else from u or N, which are cheap to materialize.  The rest run cheapest first, by insertion sort since there are few of them
+	if(!use_dk){
+		int64_t first = 0;
+		for(int64_t i = 1; i < n; ++i){
+			if(passes[i].kind < passes[first].kind){
+				first = i;
+			}
+		}
+		DiriPass tmp = passes[0];
+		passes[0] = passes[first];
+		passes[first] = tmp;
+	}
+	for(int64_t i = use_dk ? 1 : 2; i < n; ++i){
+		DiriPass pass = passes[i];
+		int64_t j = i;
+		for(; j > (use_dk ? 0 : 1) && passes[j - 1].cost > pass.cost; --j){
+			passes[j] = passes[j - 1];
+		}
+		passes[j] = pass;
+	}
+	// every pass writes, except starting from a leaf table or u^k
+	DiriChain chain = {.m = m, .ctx = ctx, .pool = pool, .out = out, .writes_left = use_dk || passes[0].kind == PASS_TBL ? n - 1 + use_dk : n};
+	nut_Diri *dk_tbl = NULL;
+	bool ok = true;
+	if(use_dk){
+		nut_Diri *f_tbl = pool_take(pool), *g_tbl = pool_take(pool);
+		dk_tbl = pool_take(pool);
+		ok = f_tbl && g_tbl && dk_tbl && nut_Diri_compute_dk_ctx(dk_tbl, u_pow, m, f_tbl, g_tbl, ctx);
+		pool_give(pool, f_tbl);
+		pool_give(pool, g_tbl);
+		chain.cur = dk_tbl;
+	}
+	if(ok && chain.writes_left >= 2 && !(chain.tmp = pool_take(pool))){
+		ok = false;
+	}
+	for(int64_t i = 0; ok && i < n; ++i){
+		ok = run_pass(&chain, passes + i);
+	}
+	pool_give(pool, chain.tmp);
+	pool_give(pool, dk_tbl);
+	return ok ? chain.cur : NULL;
+}
+
+bool nut_DiriExpr_eval(nut_Diri *restrict self, int64_t m, const nut_DiriExpr *expr){
+	uint64_t num_leaves = count_leaves(expr);
+	void *factor_buf [[gnu::cleanup(cleanup_free)]] = malloc(num_leaves*(sizeof(const nut_Diri*) + 3*sizeof(int64_t)));
+	if(!factor_buf){
+		return false;
+	}
+	DiriFactors factors = {
+		.tbls = factor_buf,
+		.tbl_pows = (int64_t*)((const nut_Diri**)factor_buf + num_leaves),
+	};
+	factors.Nk_ks = (uint64_t*)(factors.tbl_pows + num_leaves);
+	factors.Nk_pows = (int64_t*)(factors.Nk_ks + num_leaves);
+	if(!collect_factors(&factors, self, expr, 1)){
+		return false;
+	}
+	bool has_denominator = factors.u_pow < 0 || factors.N_pow < 0;
+	for(uint64_t i = 0; i < factors.num_tbls; ++i){
+		has_denominator = has_denominator || factors.tbl_pows[i] < 0;
+	}
+	for(uint64_t i = 0; i < factors.num_Nks; ++i){
+		has_denominator = has_denominator || factors.Nk_pows[i] < 0;
+	}
+	// there is no ctx past NUT_EULER_CTX_MAX_N (or if it can't be allocated), and then every convolution just sieves on its own
+	nut_EulerCtx ctx_buf [[gnu::cleanup(nut_EulerCtx_destroy)]] = {};
+	const nut_EulerCtx *ctx = nut_EulerCtx_init(&ctx_buf, self->y) ? &ctx_buf : NULL;
+	DiriPool pool [[gnu::cleanup(pool_destroy)]] = {.x = self->x, .y = self->y};
+	if(!has_denominator){
+		const nut_Diri *res = eval_product(&pool, self, m, &factors, 1, ctx);
+		if(res && res != self){
+			nut_Diri_copy(self, res);
+		}
+		return res != NULL;
+	}
+	nut_Diri *num_buf = pool_take(&pool), *den_buf = pool_take(&pool);
+	if(!num_buf || !den_buf){
+		return false;
+	}
+	const nut_Diri *num = eval_product(&pool, num_buf, m, &factors, 1, ctx);
+	const nut_Diri *den = num ? eval_product(&pool, den_buf, m, &factors, -1, ctx) : NULL;
+	return den && nut_Diri_convdiv(self, m, num, den);
+}
@@ -0,0 +1,217 @@
+#include <inttypes.h>
+#include <stdlib.h>
+
+#include <nut/debug.h>
+#include <nut/modular_math.h>
+#include <nut/factorization.h>
+#include <nut/dlog.h>
+
+static inline uint64_t dlog_to(const nut_DlogCtx *self, uint64_t a){
+	return self->odd ? nut_Montgomery_to(&self->mont, a) : a%self->n;
+}
+
+static inline uint64_t dlog_mul(const nut_DlogCtx *self, uint64_t a, uint64_t b){
+	return self->odd ? nut_Montgomery_mul(&self->mont, a, b) : (uint128_t)a*b%self->n;
+}
+
+static inline uint64_t dlog_pow(const nut_DlogCtx *self, uint64_t b, uint64_t e){
+	return self->odd ? nut_Montgomery_pow(&self->mont, b, e) : nut_u64_powmod(b, e, self->n);
+}
+
+static inline uint64_t dlog_hash(uint64_t value){
+	return (value*0x9E3779B97F4A7C15ull) >> 32;
+}
+
+static void table_insert(nut_DlogEntry *table, uint64_t mask, uint64_t value, uint64_t exponent){
+	uint64_t i = dlog_hash(value)&mask;
+	while(table[i].exponent){
+		i = (i + 1)&mask;
+	}
+	table[i] = (nut_DlogEntry){.value = value, .exponent = exponent + 1};
+}
+
+static bool table_find(const nut_DlogEntry *table, uint64_t mask, uint64_t value, uint64_t *exponent){
+	for(uint64_t i = dlog_hash(value)&mask; table[i].exponent; i = (i + 1)&mask){
+		if(table[i].value == value){
+			*exponent = table[i].exponent - 1;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool nut_DlogCtx_init(nut_DlogCtx *self, uint64_t g, uint64_t n){
+	*self = (nut_DlogCtx){.n = n, .g = g};
+	if(!n){
+		return false;
+	}
+	nut_Factors *factors [[gnu::cleanup(cleanup_free)]] = nut_make_Factors_w(NUT_MAX_PRIMES_64);
+	if(!factors || nut_u64_factor_heuristic(n, 25, nut_small_primes, &nut_default_factor_conf, factors) != 1){
+		return false;
+	}
+	uint64_t cn = nut_Factor_carmichael(factors);
+	if(nut_u64_factor_heuristic(cn, 25, nut_small_primes, &nut_default_factor_conf, factors) != 1){
+		return false;
+	}
+	nut_u64_orders_mod(n, cn, factors, 1, &g, &self->order);
+	if(!self->order){
+		return false;
+	}
+	if((self->odd = n&1)){
+		nut_Montgomery_init(&self->mont, n);
+	}else{
+		self->mont = (nut_Montgomery){.n = n, .one = 1%n};
+	}
+	uint64_t rest = self->order, arena_len = 0;
+	for(uint64_t i = 0; i < factors->num_primes; ++i){
+		uint64_t q = factors->factors[i].prime, e = 0;
+		while(rest%q == 0){
+			rest /= q;
+			++e;
+		}
+		if(!e){
+			continue;
+		}
+		nut_DlogSubgroup *s = self->subgroups + self->num_primes++;
+		*s = (nut_DlogSubgroup){.prime = q, .power = e};
+		if(q <= NUT_DLOG_BSGS_MAX){
+			s->baby_steps = nut_u64_nth_root(q - 1, 2) + 1;
+			uint64_t table_len = 1ull << (64 - __builtin_clzll(2*s->baby_steps - 1));
+			s->table_offset = arena_len;
+			s->table_mask = table_len - 1;
+			arena_len += table_len;
+		}
+	}
+	if(arena_len && !(self->arena = calloc(arena_len, sizeof(nut_DlogEntry)))){
+		return false;
+	}
+	uint64_t g_w = dlog_to(self, g);
+	for(uint64_t i = 0; i < self->num_primes; ++i){
+		nut_DlogSubgroup *s = self->subgroups + i;
+		uint64_t ppow = nut_u64_pow(s->prime, s->power);
+		s->g_q = dlog_pow(self, g_w, self->order/ppow);
+		s->g_q_inv = dlog_pow(self, s->g_q, ppow - 1);
+		s->gamma = dlog_pow(self, g_w, self->order/s->prime);
+		if(!s->baby_steps){
+			continue;
+		}
+		nut_DlogEntry *table = self->arena + s->table_offset;
+		uint64_t y = self->mont.one;
+		for(uint64_t j = 0; j < s->baby_steps; ++j){
+			table_insert(table, s->table_mask, y, j);
+			y = dlog_mul(self, y, s->gamma);
+		}
+		s->giant = dlog_pow(self, s->gamma, s->prime - s->baby_steps);
+	}
+	return true;
+}
+
+void nut_DlogCtx_destroy(nut_DlogCtx *self){
+	free(self->arena);
+	*self = (nut_DlogCtx){};
+}
+
+static bool bsgs_log(const nut_DlogCtx *restrict self, const nut_DlogSubgroup *restrict s, uint64_t t, uint64_t *restrict d){
+	const nut_DlogEntry *table = self->arena + s->table_offset;
+	for(uint64_t i = 0, y = t; i < s->baby_steps; ++i, y = dlog_mul(self, y, s->giant)){
+		uint64_t j;
+		if(table_find(table, s->table_mask, y, &j)){
+			*d = i*s->baby_steps + j;
+			return true;
+		}
+	}
+	return false;
+}
+
+// y = gamma^a t^b, and the next point depends on a hash of y, which is effectively random.
+// Using y mod 3 directly is not enough: when 3 divides n, every element of the subgroup is 1 mod 3, so y mod 3 never changes
+static inline void rho_step(const nut_DlogCtx *restrict self, const nut_DlogSubgroup *restrict s, uint64_t t, uint64_t *restrict y, uint64_t *restrict a, uint64_t *restrict b){
+	uint64_t q = s->prime;
+	switch(dlog_hash(*y)%3){
+		case 0:
+			*y = dlog_mul(self, *y, s->gamma);
+			*a = *a + 1 == q ? 0 : *a + 1;
+			break;
+		case 1:
+			*y = dlog_mul(self, *y, *y);
+			*a = ((uint128_t)*a << 1)%q;
+			*b = ((uint128_t)*b << 1)%q;
+			break;
+		default:
+			*y = dlog_mul(self, *y, t);
+			*b = *b + 1 == q ? 0 : *b + 1;
+	}
+}
+
+static bool rho_log(const nut_DlogCtx *restrict self, const nut_DlogSubgroup *restrict s, uint64_t t, uint64_t *restrict d){
+	uint64_t q = s->prime;
+	if(dlog_pow(self, t, q) != self->mont.one){
+		return false;
+	}
+	// if the group mod n is not cyclic, t can have order q without being a power of gamma, and then no attempt will verify
+	for(uint64_t attempt = 0; attempt < 8; ++attempt){
+		uint64_t a = nut_u64_prand(0, q), b = nut_u64_prand(0, q);
+		uint64_t y = dlog_mul(self, dlog_pow(self, s->gamma, a), dlog_pow(self, t, b));
+		uint64_t y2 = y, a2 = a, b2 = b;
+		do{
+			rho_step(self, s, t, &y, &a, &b);
+			rho_step(self, s, t, &y2, &a2, &b2);
+			rho_step(self, s, t, &y2, &a2, &b2);
+		}while(y != y2);
+		// gamma^a t^b = gamma^a2 t^b2, so log(t) = (a2 - a)/(b - b2)
+		uint64_t db = b >= b2 ? b - b2 : b + (q - b2);
+		if(!db){
+			continue;
+		}
+		uint64_t da = a2 >= a ? a2 - a : a2 + (q - a);
+		*d = (uint128_t)da*nut_u64_powmod(db, q - 2, q)%q;
+		if(dlog_pow(self, s->gamma, *d) == t){
+			return true;
+		}
+	}
+	return false;
+}
+
+bool nut_DlogCtx_log(const nut_DlogCtx *restrict self, uint64_t h, uint64_t *restrict x){
+	uint64_t h_w = dlog_to(self, h);
+	uint64_t res = 0, mod = 1;
+	for(uint64_t i = 0; i < self->num_primes; ++i){
+		const nut_DlogSubgroup *s = self->subgroups + i;
+		uint64_t q = s->prime, ppow = nut_u64_pow(q, s->power);
+		// find x mod q^e one base q digit at a time, dividing out g_q^(digits found so far) as we go
+		uint64_t cur = dlog_pow(self, h_w, self->order/ppow), x_q = 0, qk = 1;
+		for(uint64_t k = 0; k < s->power; ++k, qk *= q){
+			uint64_t t = dlog_pow(self, cur, ppow/qk/q), d;
+			if(!(s->baby_steps ? bsgs_log(self, s, t, &d) : rho_log(self, s, t, &d))){
+				return false;
+			}
+			cur = dlog_mul(self, cur, dlog_pow(self, s->g_q_inv, d*qk));
+			x_q += d*qk;
+		}
+		if(mod == 1){
+			res = x_q;
+		}else{
+			// mod*ppow divides the order of g, so it fits, and then mod < 2^63 and ppow < 2^63
+			uint64_t r = res%ppow, diff = x_q >= r ? x_q - r : x_q + (ppow - r);
+			uint64_t k = (uint128_t)diff*nut_i64_modinv(mod%ppow, ppow)%ppow;
+			res += mod*k;
+		}
+		mod *= ppow;
+	}
+	if(dlog_pow(self, dlog_to(self, self->g), res) != h_w){
+		return false;
+	}
+	*x = res;
+	return true;
+}
+
+bool nut_u64_dlog(uint64_t g, uint64_t h, uint64_t n, uint64_t *x){
+	nut_DlogCtx ctx;
+	if(!nut_DlogCtx_init(&ctx, g, n)){
+		nut_DlogCtx_destroy(&ctx);
+		return false;
+	}
+	bool res = nut_DlogCtx_log(&ctx, h, x);
+	nut_DlogCtx_destroy(&ctx);
+	return res;
+}
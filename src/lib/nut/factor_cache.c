@@ -0,0 +1,158 @@
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <nut/debug.h>
+#include <nut/modular_math.h>
+#include <nut/factorization.h>
+#include <nut/factor_cache.h>
+
+static_assert(sizeof(nut_FactorCacheEntry) == 64, "factor cache entries should fill exactly one cache line");
+
+#define NUT_FACTOR_CACHE_REF 0x80
+#define NUT_FACTOR_CACHE_LEN 0x0F
+
+static inline uint64_t hash_n(uint64_t n){
+	// fibonacci hashing: the high bits pick the shard and the low bits of the rest pick the bucket
+	return n*0x9E3779B97F4A7C15ull;
+}
+
+static inline uint64_t round_pow2(uint64_t n){
+	return n <= 1 ? 1 : 1ull << (64 - __builtin_clzll(n - 1));
+}
+
+bool nut_FactorCache_init(nut_FactorCache *self, size_t max_bytes, uint64_t num_shards){
+	num_shards = round_pow2(num_shards);
+	uint64_t num_buckets = max_bytes/(num_shards*NUT_FACTOR_CACHE_WAYS*sizeof(nut_FactorCacheEntry));
+	num_buckets = num_buckets ? 1ull << (63 - __builtin_clzll(num_buckets)) : 1;
+	*self = (nut_FactorCache){.num_shards = num_shards, .num_buckets = num_buckets};
+	if(!(self->shards = calloc(num_shards, sizeof(nut_FactorCacheShard)))){
+		return false;
+	}
+	for(uint64_t i = 0; i < num_shards; ++i){
+		nut_FactorCacheShard *shard = self->shards + i;
+		shard->entries = aligned_alloc(64, num_buckets*NUT_FACTOR_CACHE_WAYS*sizeof(nut_FactorCacheEntry));
+		shard->hands = calloc(num_buckets, sizeof(uint8_t));
+		if(!shard->entries || !shard->hands || pthread_mutex_init(&shard->lock, NULL)){
+			free(shard->entries);
+			free(shard->hands);
+			self->num_shards = i;
+			nut_FactorCache_destroy(self);
+			return false;
+		}
+		memset(shard->entries, 0, num_buckets*NUT_FACTOR_CACHE_WAYS*sizeof(nut_FactorCacheEntry));
+	}
+	return true;
+}
+
+void nut_FactorCache_destroy(nut_FactorCache *self){
+	for(uint64_t i = 0; i < self->num_shards; ++i){
+		nut_FactorCacheShard *shard = self->shards + i;
+		pthread_mutex_destroy(&shard->lock);
+		free(shard->entries);
+		free(shard->hands);
+	}
+	free(self->shards);
+	*self = (nut_FactorCache){};
+}
+
+static inline nut_FactorCacheShard *get_shard(const nut_FactorCache *self, uint64_t h){
+	return self->shards + (h >> 32)%self->num_shards;
+}
+
+static inline uint64_t get_bucket(const nut_FactorCache *self, uint64_t h){
+	return (h & (self->num_buckets - 1))*NUT_FACTOR_CACHE_WAYS;
+}
+
+bool nut_FactorCache_lookup(nut_FactorCache *restrict self, uint64_t n, nut_Factors *restrict factors){
+	uint64_t h = hash_n(n);
+	nut_FactorCacheShard *shard = get_shard(self, h);
+	nut_FactorCacheEntry *bucket = shard->entries + get_bucket(self, h);
+	pthread_mutex_lock(&shard->lock);
+	for(uint64_t i = 0; i < NUT_FACTOR_CACHE_WAYS; ++i){
+		nut_FactorCacheEntry *entry = bucket + i;
+		if(entry->n != n){
+			continue;
+		}
+		entry->info |= NUT_FACTOR_CACHE_REF;
+		++shard->hits;
+		uint64_t len = entry->info & NUT_FACTOR_CACHE_LEN, rest = n;
+		for(uint64_t j = 0; j < len; ++j){
+			factors->factors[j].prime = entry->primes[j];
+			factors->factors[j].power = entry->powers[j];
+			for(uint64_t k = 0; k < entry->powers[j]; ++k){
+				rest /= entry->primes[j];
+			}
+		}
+		pthread_mutex_unlock(&shard->lock);
+		factors->num_primes = len;
+		if(rest != 1){
+			nut_Factor_append(factors, rest, 1);
+		}
+		return true;
+	}
+	++shard->misses;
+	pthread_mutex_unlock(&shard->lock);
+	return false;
+}
+
+void nut_FactorCache_insert(nut_FactorCache *restrict self, uint64_t n, const nut_Factors *restrict factors){
+	if(!n){
+		return;
+	}
+	nut_FactorCacheEntry new_entry = {.n = n};
+	uint64_t len = 0;
+	for(uint64_t i = 0; i < factors->num_primes; ++i){
+		if(factors->factors[i].prime >> 32){
+			continue;
+		}else if(len == NUT_FACTOR_CACHE_MAX_PRIMES){
+			return;
+		}
+		new_entry.primes[len] = factors->factors[i].prime;
+		new_entry.powers[len++] = factors->factors[i].power;
+	}
+	new_entry.info = len;
+	uint64_t h = hash_n(n);
+	nut_FactorCacheShard *shard = get_shard(self, h);
+	uint64_t b = get_bucket(self, h);
+	nut_FactorCacheEntry *bucket = shard->entries + b;
+	pthread_mutex_lock(&shard->lock);
+	for(uint64_t i = 0; i < NUT_FACTOR_CACHE_WAYS; ++i){
+		if(bucket[i].n == n){
+			pthread_mutex_unlock(&shard->lock);
+			return;
+		}
+	}
+	// sweep the hand, clearing reference bits, until we find an empty or unreferenced entry
+	// (this terminates within two passes)
+	uint64_t i = shard->hands[b/NUT_FACTOR_CACHE_WAYS];
+	while(bucket[i].n && (bucket[i].info & NUT_FACTOR_CACHE_REF)){
+		bucket[i].info &= ~NUT_FACTOR_CACHE_REF;
+		i = (i + 1)%NUT_FACTOR_CACHE_WAYS;
+	}
+	bucket[i] = new_entry;
+	shard->hands[b/NUT_FACTOR_CACHE_WAYS] = (i + 1)%NUT_FACTOR_CACHE_WAYS;
+	pthread_mutex_unlock(&shard->lock);
+}
+
+void nut_FactorCache_stats(nut_FactorCache *restrict self, uint64_t *restrict hits, uint64_t *restrict misses){
+	*hits = *misses = 0;
+	for(uint64_t i = 0; i < self->num_shards; ++i){
+		nut_FactorCacheShard *shard = self->shards + i;
+		pthread_mutex_lock(&shard->lock);
+		*hits += shard->hits;
+		*misses += shard->misses;
+		pthread_mutex_unlock(&shard->lock);
+	}
+}
+
+uint64_t nut_u64_factor_heuristic_cached(nut_FactorCache *restrict cache, uint64_t n, uint64_t num_primes, const uint64_t primes[restrict static num_primes], const nut_FactorConf *restrict conf, nut_Factors *restrict factors){
+	if(nut_FactorCache_lookup(cache, n, factors)){
+		return 1;
+	}
+	uint64_t m = nut_u64_factor_heuristic(n, num_primes, primes, conf, factors);
+	if(m == 1){
+		nut_FactorCache_insert(cache, n, factors);
+	}
+	return m;
+}
@@ -1,10 +1,13 @@
 #include <stddef.h>
 #include <inttypes.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 
 #include <nut/modular_math.h>
 #include <nut/factorization.h>
+#include <nut/qsieve.h>
 #include <nut/debug.h>
 
 nut_Factors *nut_make_Factors_w(uint64_t max_primes){
@@ -171,6 +174,188 @@ uint64_t nut_u64_order_mod(uint64_t a, uint64_t n, uint64_t cn, nut_Factors *cn_
 	return cn;
 }
 
+/// Arithmetic mod n for the batch order functions: Montgomery form if n is odd, plain 128 bit remainders if not
+typedef struct{
+	nut_Montgomery mont;
+	bool odd;
+} OrderCtx;
+
+static inline void order_ctx_init(OrderCtx *ctx, uint64_t n){
+	if((ctx->odd = n&1)){
+		nut_Montgomery_init(&ctx->mont, n);
+	}else{
+		ctx->mont = (nut_Montgomery){.n = n, .one = 1%n};
+	}
+}
+
+static inline uint64_t order_ctx_to(const OrderCtx *ctx, uint64_t a){
+	return ctx->odd ? nut_Montgomery_to(&ctx->mont, a) : a%ctx->mont.n;
+}
+
+static inline uint64_t order_ctx_pow(const OrderCtx *ctx, uint64_t b, uint64_t e){
+	return ctx->odd ? nut_Montgomery_pow(&ctx->mont, b, e) : nut_u64_powmod(b, e, ctx->mont.n);
+}
+
+// Set out[i] = x^(prod(ppows[lo:hi])/ppows[i]) for lo <= i < hi.
+// Splitting the prime powers in half and raising x to the product of each half before recursing into the other
+// takes O(log(cn) log(omega)) multiplications, instead of O(log(cn) omega) for separate exponentiations.
+static void cofactor_powers(const OrderCtx *ctx, uint64_t x, const uint64_t ppows[], uint64_t lo, uint64_t hi, uint64_t out[]){
+	if(hi - lo == 1){
+		out[lo] = x;
+		return;
+	}
+	uint64_t mid = lo + (hi - lo)/2, e_lo = 1, e_hi = 1;
+	for(uint64_t i = lo; i < mid; ++i){
+		e_lo *= ppows[i];
+	}
+	for(uint64_t i = mid; i < hi; ++i){
+		e_hi *= ppows[i];
+	}
+	cofactor_powers(ctx, order_ctx_pow(ctx, x, e_hi), ppows, lo, mid, out);
+	cofactor_powers(ctx, order_ctx_pow(ctx, x, e_lo), ppows, mid, hi, out);
+}
+
+void nut_u64_orders_mod(uint64_t n, uint64_t cn, const nut_Factors *restrict cn_factors, uint64_t count, const uint64_t as[restrict static count], uint64_t out[restrict static count]){
+	OrderCtx ctx;
+	order_ctx_init(&ctx, n);
+	uint64_t num_primes = cn_factors->num_primes;
+	uint64_t ppows[NUT_MAX_PRIMES_64], leaves[NUT_MAX_PRIMES_64];
+	for(uint64_t i = 0; i < num_primes; ++i){
+		ppows[i] = nut_u64_pow(cn_factors->factors[i].prime, cn_factors->factors[i].power);
+	}
+	for(uint64_t k = 0; k < count; ++k){
+		uint64_t x = order_ctx_to(&ctx, as[k]);
+		if(!num_primes){
+			out[k] = x == ctx.mont.one;
+			continue;
+		}
+		cofactor_powers(&ctx, x, ppows, 0, num_primes, leaves);
+		uint64_t order = 1;
+		for(uint64_t i = 0; i < num_primes; ++i){
+			// leaves[i] has order q^j for some j <= e, which is the q-part of the order of a
+			uint64_t q = cn_factors->factors[i].prime, y = leaves[i], j = 0;
+			for(; y != ctx.mont.one && j < cn_factors->factors[i].power; ++j){
+				y = order_ctx_pow(&ctx, y, q);
+				order *= q;
+			}
+			if(y != ctx.mont.one){
+				order = 0;
+				break;
+			}
+		}
+		out[k] = order;
+	}
+}
+
+// Find phi(n) and its factorization if n has a primitive root, that is, n is 2, 4, p^k, or 2p^k for an odd prime p.
+// Also sets *p to the odd prime, or 1 if there is none.
+static bool primitive_root_group(uint64_t n, uint64_t *restrict p, uint64_t *restrict phi, nut_Factors *restrict phi_factors){
+	phi_factors->num_primes = 0;
+	*p = 1;
+	if(n <= 4){
+		*phi = n == 1 ? 1 : n/2;
+		if(n == 4){
+			nut_Factor_append(phi_factors, 2, 1);
+		}
+		return n;
+	}
+	uint64_t m = n&1 ? n : n/2;
+	if(!(m&1)){
+		return false;
+	}
+	uint64_t base = m, exponent = 1;
+	nut_u64_is_perfect_power(m, 63, &base, &exponent);
+	if(!nut_u64_is_prime_dmr(base)){
+		return false;
+	}
+	*p = base;
+	*phi = m/base*(base - 1);
+	if(nut_u64_factor_heuristic(base - 1, 25, nut_small_primes, &nut_default_factor_conf, phi_factors) != 1){
+		return false;
+	}
+	if(exponent > 1){
+		nut_Factor_append(phi_factors, base, exponent - 1);
+	}
+	return true;
+}
+
+static uint64_t primitive_root_search(uint64_t n, uint64_t p, const nut_Factors *phi_factors){
+	OrderCtx ctx;
+	order_ctx_init(&ctx, n);
+	uint64_t num_primes = phi_factors->num_primes;
+	uint64_t ppows[NUT_MAX_PRIMES_64], leaves[NUT_MAX_PRIMES_64];
+	for(uint64_t i = 0; i < num_primes; ++i){
+		ppows[i] = nut_u64_pow(phi_factors->factors[i].prime, phi_factors->factors[i].power);
+	}
+	for(uint64_t g = 2;; ++g){
+		if(!(n&1) && !(g&1)){
+			continue;
+		}else if(g%p == 0){
+			continue;
+		}
+		cofactor_powers(&ctx, order_ctx_to(&ctx, g), ppows, 0, num_primes, leaves);
+		bool is_generator = true;
+		// g is a generator iff g^(phi/q) != 1 for every prime q, and the leaves are g^(phi/q^e)
+		for(uint64_t i = 0; i < num_primes; ++i){
+			uint64_t q = phi_factors->factors[i].prime;
+			if(order_ctx_pow(&ctx, leaves[i], nut_u64_pow(q, phi_factors->factors[i].power - 1)) == ctx.mont.one){
+				is_generator = false;
+				break;
+			}
+		}
+		if(is_generator){
+			return g;
+		}
+	}
+}
+
+uint64_t nut_u64_primitive_root(uint64_t n){
+	nut_Factors *phi_factors [[gnu::cleanup(cleanup_free)]] = nut_make_Factors_w(NUT_MAX_PRIMES_64);
+	uint64_t p, phi;
+	if(!phi_factors || !primitive_root_group(n, &p, &phi, phi_factors)){
+		return 0;
+	}else if(n <= 4){
+		return n - 1;
+	}
+	return primitive_root_search(n, p, phi_factors);
+}
+
+static int cmp_u64(const void *_a, const void *_b){
+	uint64_t a = *(const uint64_t*)_a, b = *(const uint64_t*)_b;
+	return a < b ? -1 : a > b;
+}
+
+uint64_t *nut_u64_primitive_roots(uint64_t n, uint64_t *restrict count){
+	*count = 0;
+	nut_Factors *phi_factors [[gnu::cleanup(cleanup_free)]] = nut_make_Factors_w(NUT_MAX_PRIMES_64);
+	uint64_t p, phi;
+	if(!phi_factors || !primitive_root_group(n, &p, &phi, phi_factors)){
+		return NULL;
+	}
+	uint64_t g = n <= 4 ? n - 1 : primitive_root_search(n, p, phi_factors);
+	uint64_t *roots = malloc(nut_Factor_phi(phi_factors)*sizeof(uint64_t));
+	uint8_t *coprime [[gnu::cleanup(cleanup_free)]] = malloc(phi + 1);
+	if(!roots || !coprime){
+		free(roots);
+		return NULL;
+	}
+	// the generators are exactly g^k for k coprime to phi
+	memset(coprime, 1, phi + 1);
+	for(uint64_t i = 0; i < phi_factors->num_primes; ++i){
+		uint64_t q = phi_factors->factors[i].prime;
+		for(uint64_t k = q; k <= phi; k += q){
+			coprime[k] = 0;
+		}
+	}
+	for(uint64_t k = 1, x = g; k <= phi; ++k, x = (uint128_t)x*g%n){
+		if(coprime[k]){
+			roots[(*count)++] = x;
+		}
+	}
+	qsort(roots, *count, sizeof(uint64_t), cmp_u64);
+	return roots;
+}
+
 int nut_Factor_forall_divs_tmptmp(const nut_Factors *restrict factors, int (*f)(const nut_Factors*, uint64_t, void*), void *restrict data){
 	nut_Factors *dfactors [[gnu::cleanup(cleanup_free)]] = nut_Factors_copy(factors);
 	nut_Factors *pfactors [[gnu::cleanup(cleanup_free)]] = nut_Factors_copy(factors);
@@ -248,6 +433,69 @@ int nut_Factor_forall_divs_le(const nut_Factors *restrict factors, uint64_t d_ma
 	}
 }
 
+// For odd p, x is divisible by p iff x*p^-1 mod 2^64 is at most UINT64_MAX/p
+static inline bool is_divisible(uint64_t x, uint64_t p, uint64_t pinv, uint64_t pmax){
+	return p == 2 ? !(x & 1) : x*pinv <= pmax;
+}
+
+uint64_t nut_Factor_divisors(const nut_Factors *restrict factors, uint64_t out[restrict], bool sorted){
+	uint64_t len = 1;
+	out[0] = 1;
+	for(uint64_t i = 0; i < factors->num_primes; ++i){
+		uint64_t p = factors->factors[i].prime, e = factors->factors[i].power;
+		if(!sorted){
+			// append p times the last len divisors, e times
+			for(uint64_t end = len, k = 0; k < e; ++k, end += len){
+				for(uint64_t j = 0; j < len; ++j){
+					out[end + j] = out[end - len + j]*p;
+				}
+			}
+			len *= e + 1;
+			continue;
+		}
+		uint64_t pinv = p;
+		for(uint64_t k = 0; k < 5; ++k){
+			pinv *= 2 - p*pinv;
+		}
+		uint64_t pmax = UINT64_MAX/p;
+		// out[0, m) holds the divisors with at most p^(k-1), sorted.  The divisors with at most p^k are
+		// the ones in out[0, m) not divisible by p, merged with p times out[0, m).  Merging from the back is safe because
+		// the write position never passes an element that still has to be read: everything in out[0, m) up to an unread
+		// element is also a divisor with at most p^k that hasn't been written yet.
+		for(uint64_t k = 1, m = len; k <= e; ++k, m += len){
+			int64_t ia = m - 1, il = m - 1, w = m + len - 1;
+			while(il >= 0 && is_divisible(out[il], p, pinv, pmax)){
+				--il;
+			}
+			while(w >= 0){
+				if(il < 0 || (ia >= 0 && out[ia]*p > out[il])){
+					out[w--] = out[ia--]*p;
+				}else{
+					out[w--] = out[il--];
+					while(il >= 0 && is_divisible(out[il], p, pinv, pmax)){
+						--il;
+					}
+				}
+			}
+		}
+		len *= e + 1;
+	}
+	return len;
+}
+
+void nut_DivIt_init(nut_DivIt *restrict self, const nut_Factors *restrict factors, uint64_t d_max){
+	self->num_primes = factors->num_primes;
+	self->d = 0;
+	self->d_max = d_max;
+	self->done = !d_max;
+	for(uint64_t i = 0; i < factors->num_primes; ++i){
+		self->primes[i] = factors->factors[i].prime;
+		self->max_powers[i] = factors->factors[i].power;
+		self->powers[i] = 0;
+		self->ppows[i] = 1;
+	}
+}
+
 void nut_Factor_append(nut_Factors *factors, uint64_t m, uint64_t k){
 	for(uint64_t i = 0;; ++i){
 		if(i == factors->num_primes){
@@ -333,92 +581,222 @@ int nut_Factor_fprint(FILE *restrict file, const nut_Factors *restrict factors){
 	return res;
 }
 
+// Strong probable prime test to base a, where n - 1 = 2^s*d.  one and minus_one are 1 and -1 in Montgomery form
+static inline bool is_sprp(const nut_Montgomery *mont, uint64_t a, uint64_t d, uint64_t s, uint64_t minus_one){
+	uint64_t x = nut_Montgomery_pow(mont, nut_Montgomery_to(mont, a), d);
+	if(x == mont->one || x == minus_one){
+		return true;
+	}
+	for(uint64_t r = 1; r < s; ++r){
+		x = nut_Montgomery_mul(mont, x, x);
+		if(x == minus_one){
+			return true;
+		}else if(x == mont->one){
+			return false;
+		}
+	}
+	return false;
+}
+
+// Deterministic Miller-Rabin for odd n > 1.  Callers should remove small prime factors first, since that is much cheaper.
+// Montgomery multiplication means the large bases need no special handling, so the 7 base set works for all of 2^64.
+static bool is_prime_mr(uint64_t n){
+	static const uint64_t DMR_BASES[7] = {2, 325, 9375, 28178, 450775, 9780504, 1795265022};
+	nut_Montgomery mont;
+	nut_Montgomery_init(&mont, n);
+	uint64_t s = __builtin_ctzll(n - 1), d = (n - 1) >> s;
+	uint64_t minus_one = n - mont.one;
+	for(uint64_t i = 0; i < 7; ++i){
+		uint64_t a = DMR_BASES[i]%n;
+		if(a && !is_sprp(&mont, a, d, s, minus_one)){
+			return false;
+		}
+	}
+	return true;
+}
+
 bool nut_u64_is_prime_dmr(uint64_t n){
-	//static const uint64_t DMR_PRIMES[7] = {2, 325, 9375, 28178, 450775, 9780504, 1795265022};//sufficient for 64 bit numbers
-	//had to disable 7 base check because the last base is too large to be squared under 64 bit multiplication
-	static const uint64_t DMR_PRIMES[12] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};//sufficient for 64 bit numbers
-	//static const uint64_t DMR_PRIMES_C = 7;
-	static const uint64_t DMR_PRIMES_C = 12;
-	uint64_t s, d;//s, d | 2^s*d = n - 1
-	if(n%2 == 0){
-		return n == 2;
-	}
-	--n;
-	s = __builtin_ctzll(n);
-	d = n>>s;
-	++n;
-	for(uint64_t i = 0, a, x; i < DMR_PRIMES_C; ++i){
-		a = DMR_PRIMES[i];
-		if(a >= n){
-			break;
+	if(n < 2){
+		return false;
+	}
+	for(uint64_t i = 0; i < 12; ++i){
+		uint64_t p = nut_small_primes[i];
+		if(n%p == 0){
+			return n == p;
+		}
+	}
+	if(n < 41*41){
+		return true;
+	}
+	return is_prime_mr(n);
+}
+
+/// Odd primes below 2^16, used to sieve windows of candidates before running Miller-Rabin
+static uint16_t window_primes[6541];
+static pthread_once_t window_primes_once = PTHREAD_ONCE_INIT;
+
+static void init_window_primes(void){
+	static uint8_t is_composite[1 << 15];
+	uint64_t num_primes = 0;
+	// is_composite[i] represents 2*i + 1
+	for(uint64_t i = 1; i < (1 << 15); ++i){
+		if(is_composite[i]){
+			continue;
 		}
-		x = nut_u64_powmod(a, d, n);
-		if(x == 1 || x == n - 1){
-			goto CONTINUE_WITNESSLOOP;
+		uint64_t p = 2*i + 1;
+		window_primes[num_primes++] = p;
+		for(uint64_t j = p*p/2; j < (1 << 15); j += p){
+			is_composite[j] = 1;
 		}
-		for(a = 0; a < s - 1; ++a){
-			x = nut_u64_powmod(x, 2, n);
-			if(x == 1){
-				return 0;
-			}
-			if(x == n - 1){
-				goto CONTINUE_WITNESSLOOP;
-			}
+	}
+}
+
+/// Window length (in odd numbers) and number of sieving primes for next/prev prime searches.
+/// Near 2^64, a prime gap is about 44, so one window almost always suffices.  Placing each sieving prime in the window
+/// costs a 64 bit division, and Miller-Rabin rejects most composites with a single Montgomery exponentiation, so only the
+/// odd primes below 256 are worth sieving by: this leaves about a third of the candidates a mod 30 wheel would.
+#define NEXT_PRIME_WINDOW 128
+#define NEXT_PRIME_SIEVE_PRIMES 53
+
+/// Window length (in odd numbers) for { @link nut_u64_primes_in}, which sieves by all of window_primes
+#define PRIMES_IN_WINDOW 32768
+
+// Clear is_candidate[i] for base + 2i divisible by one of the first num_sieve primes in window_primes (other than the prime itself).
+// offsets[j] must be the index of the first multiple of window_primes[j] in the window, and is advanced to the first multiple
+// in the following window.
+static void sieve_window(uint8_t *restrict is_candidate, uint64_t base, uint64_t len, uint64_t num_sieve, uint32_t *restrict offsets){
+	memset(is_candidate, 1, len);
+	for(uint64_t j = 0; j < num_sieve; ++j){
+		uint64_t p = window_primes[j], i = offsets[j];
+		if(base + 2*i == p){
+			i += p;
 		}
-		return false;
-		CONTINUE_WITNESSLOOP:;
+		for(; i < len; i += p){
+			is_candidate[i] = 0;
+		}
+		offsets[j] = i - len;
+	}
+}
+
+// Compute the index of the first multiple of each sieving prime in the odd numbers base, base + 2, ...
+static void init_offsets(uint64_t base, uint64_t num_sieve, uint32_t *restrict offsets){
+	for(uint64_t j = 0; j < num_sieve; ++j){
+		uint64_t p = window_primes[j], r = base%p;
+		// base + 2i = 0 mod p, so i = -base/2 mod p
+		offsets[j] = r ? (p - r)*((p + 1)/2)%p : 0;
 	}
-	return true;
 }
 
 uint64_t nut_u64_next_prime_ge(uint64_t n){
-	if(n <= 97){
-		for(uint64_t i = 0; i < 25; ++i){
-			uint64_t p = nut_small_primes[i];
-			if(p >= n){
-				return p;
+	if(n <= 2){
+		return 2;
+	}
+	pthread_once(&window_primes_once, init_window_primes);
+	uint8_t is_candidate[NEXT_PRIME_WINDOW];
+	uint32_t offsets[NEXT_PRIME_SIEVE_PRIMES];
+	uint64_t base = n | 1;
+	init_offsets(base, NEXT_PRIME_SIEVE_PRIMES, offsets);
+	while(1){
+		uint64_t len = NEXT_PRIME_WINDOW;
+		if((UINT64_MAX - base)/2 < len){
+			len = (UINT64_MAX - base)/2 + 1;
+		}
+		sieve_window(is_candidate, base, len, NEXT_PRIME_SIEVE_PRIMES, offsets);
+		for(uint64_t i = 0; i < len; ++i){
+			if(is_candidate[i] && is_prime_mr(base + 2*i)){
+				return base + 2*i;
 			}
 		}
+		base += 2*len;
 	}
-	uint64_t res = n%30;
-	if(res <= 13){
-		if(res <= 7){
-			if(res <= 1){
-				n += 1 - res;
-			}else{
-				n += 7 - res;
+}
+
+uint64_t nut_u64_prev_prime_le(uint64_t n){
+	if(n < 2){
+		return 0;
+	}else if(n < 3){
+		return 2;
+	}
+	pthread_once(&window_primes_once, init_window_primes);
+	uint8_t is_candidate[NEXT_PRIME_WINDOW];
+	uint32_t offsets[NEXT_PRIME_SIEVE_PRIMES];
+	uint64_t top = (n - 1) | 1;
+	while(1){
+		// the window is base, ..., top, and base >= 3 so 2 never needs to be sieved
+		uint64_t len = NEXT_PRIME_WINDOW;
+		if((top - 3)/2 + 1 < len){
+			len = (top - 3)/2 + 1;
+		}
+		uint64_t base = top - 2*(len - 1);
+		init_offsets(base, NEXT_PRIME_SIEVE_PRIMES, offsets);
+		sieve_window(is_candidate, base, len, NEXT_PRIME_SIEVE_PRIMES, offsets);
+		for(uint64_t i = len; i-- > 0;){
+			if(is_candidate[i] && is_prime_mr(base + 2*i)){
+				return base + 2*i;
 			}
-		}else if(res <= 11){
-			n += 11 - res;
-		}else{
-			n += 13 - res;
 		}
-	}else if(res <= 19){
-		if(res <= 17){
-			n += 17 - res;
-		}else{
-			n += 19 - res;
+		if(base == 3){
+			return 2;
 		}
-	}else if(res <= 23){
-		n += 23 - res;
-	}else{
-		n += 29 - res;
-	}
-	res = n%30;
-	while(!nut_u64_is_prime_dmr(n)){
-		switch(res){
-			case 1: n += 6; res = 7; break;
-			case 7: n += 4; res = 11; break;
-			case 11: n += 2; res = 13; break;
-			case 13: n += 4; res = 17; break;
-			case 17: n += 2; res = 19; break;
-			case 19: n += 4; res = 23; break;
-			case 23: n += 6; res = 29; break;
-			case 29: n += 2; res = 1; break;
-			default: __builtin_unreachable();
+		top = base - 2;
+	}
+}
+
+uint64_t *nut_u64_primes_in(uint64_t a, uint64_t b, uint64_t *restrict num_primes){
+	*num_primes = 0;
+	uint64_t cap = 0;
+	uint64_t *primes = NULL;
+	if(b < a || b < 2){
+		return malloc(sizeof(uint64_t));
+	}
+	pthread_once(&window_primes_once, init_window_primes);
+	// only sieve by primes up to sqrt(b), and if these are all the primes up to sqrt(b), survivors are definitely prime
+	uint64_t rmax = nut_u64_nth_root(b, 2), num_sieve = 0;
+	while(num_sieve < 6541 && window_primes[num_sieve] <= rmax){
+		++num_sieve;
+	}
+	bool need_mr = num_sieve == 6541 && rmax > 65535;
+	uint8_t *is_candidate [[gnu::cleanup(cleanup_free)]] = malloc(PRIMES_IN_WINDOW);
+	uint32_t *offsets [[gnu::cleanup(cleanup_free)]] = malloc(6541*sizeof(uint32_t));
+	if(!is_candidate || !offsets){
+		return NULL;
+	}
+	if(a <= 2){
+		if(!(primes = malloc((cap = 64)*sizeof(uint64_t)))){
+			return NULL;
 		}
+		primes[(*num_primes)++] = 2;
+		a = 3;
+	}
+	uint64_t base = a | 1;
+	init_offsets(base, num_sieve, offsets);
+	while(base <= b){
+		uint64_t len = (b - base)/2 + 1;
+		if(len > PRIMES_IN_WINDOW){
+			len = PRIMES_IN_WINDOW;
+		}
+		sieve_window(is_candidate, base, len, num_sieve, offsets);
+		for(uint64_t i = 0; i < len; ++i){
+			uint64_t m = base + 2*i;
+			if(!is_candidate[i] || m == 1 || (need_mr && !is_prime_mr(m))){
+				continue;
+			}
+			if(*num_primes == cap){
+				uint64_t *tmp = realloc(primes, (cap = cap ? 2*cap : 64)*sizeof(uint64_t));
+				if(!tmp){
+					free(primes);
+					return NULL;
+				}
+				primes = tmp;
+			}
+			primes[(*num_primes)++] = m;
+		}
+		if(b - base < 2*len){
+			break;
+		}
+		base += 2*len;
 	}
-	return n;
+	return primes ? primes : malloc(sizeof(uint64_t));
 }
 
 /*
@@ -453,7 +831,8 @@ const nut_FactorConf nut_default_factor_conf = {
 	.pollard_max= 100000,    //maximum number to use Pollard's Rho algorithm for
 	.pollard_stride= 10,     //number of gcd operations to coalesce, decreases time for a single iteration at the cost of potentially doing twice this many extra iterations
 	.lenstra_max= UINT64_MAX,//maximum number to use Lenstra's Elliptic Curve algorithm for
-	.lenstra_bfac= 10        //roughly speaking, the number of iterations to try before picking a new random point and curve
+	.lenstra_bfac= 10,       //roughly speaking, the number of iterations to try before picking a new random point and curve
+	.qsieve_max= UINT64_MAX  //maximum number to use the self initializing quadratic sieve for, only reached if lenstra_max is lowered
 };
 
 NUT_ATTR_NO_SAN("vla-bound")
@@ -504,29 +883,6 @@ uint64_t nut_u64_factor_heuristic(uint64_t n, uint64_t num_primes, const uint64_
 				uint64_t x = nut_u64_prand(0, n);
 				m = nut_u64_factor1_pollard_rho_brent(n, x, conf->pollard_stride);
 			}while(m == n);
-			uint64_t k = 1;
-			n /= m;
-			while(n%m == 0){
-				k += 1;
-				n /= m;
-			}
-			if(m < smoothness || nut_u64_is_prime_dmr(m)){
-				nut_Factor_append(factors, m, k*exponent);
-			}else{
-				factors2->num_primes = 0;
-				m = nut_u64_factor_heuristic(m, 0, primes, conf, factors2);
-				if(m != 1){
-					return m;//TODO: abort
-				}
-				nut_Factor_combine(factors, factors2, k*exponent);
-			}
-			if(n == 1){
-				return 1;
-			}
-			if(n < smoothness || nut_u64_is_prime_dmr(n)){
-				nut_Factor_append(factors, n, exponent);
-				return 1;
-			}
 		}else if(n <= conf->lenstra_max){
 			do{
 				uint64_t x = nut_u64_prand(0, n);
@@ -534,32 +890,37 @@ uint64_t nut_u64_factor_heuristic(uint64_t n, uint64_t num_primes, const uint64_
 				uint64_t a = nut_u64_prand(0, n);
 				m = nut_u64_factor1_lenstra(n, x, y, a, conf->lenstra_bfac);
 			}while(m == n);
-			uint64_t k = 1;
-			n /= m;
-			while(n%m == 0){
-				k += 1;
-				n /= m;
-			}
-			if(m < smoothness || nut_u64_is_prime_dmr(m)){
-				nut_Factor_append(factors, m, k*exponent);
-			}else{
-				factors2->num_primes = 0;
-				m = nut_u64_factor_heuristic(m, 0, primes, conf, factors2);
-				if(m != 1){
-					return m;//TODO: abort
-				}
-				nut_Factor_combine(factors, factors2, k*exponent);
-			}
-			if(n == 1){
-				return 1;
+		}else if(n <= conf->qsieve_max){
+			m = nut_u128_factor1_siqs(n, 1);
+			if(m == 1){
+				return n;
 			}
-			if(n < smoothness || nut_u64_is_prime_dmr(n)){
-				nut_Factor_append(factors, n, exponent);
-				return 1;
-			}
-		}else{//TODO: implement quadratic sieve and number field sieve
+		}else{//TODO: implement number field sieve
 			return n;
 		}
+		uint64_t k = 1;
+		n /= m;
+		while(n%m == 0){
+			k += 1;
+			n /= m;
+		}
+		if(m < smoothness || nut_u64_is_prime_dmr(m)){
+			nut_Factor_append(factors, m, k*exponent);
+		}else{
+			factors2->num_primes = 0;
+			m = nut_u64_factor_heuristic(m, 0, primes, conf, factors2);
+			if(m != 1){
+				return m;//TODO: abort
+			}
+			nut_Factor_combine(factors, factors2, k*exponent);
+		}
+		if(n == 1){
+			return 1;
+		}
+		if(n < smoothness || nut_u64_is_prime_dmr(n)){
+			nut_Factor_append(factors, n, exponent);
+			return 1;
+		}
 	}
 }
 
@@ -0,0 +1,161 @@
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#if __has_include(<sys/mman.h>)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define NUT_FACTORIZER_MMAP 1
+#endif
+
+#include <nut/debug.h>
+#include <nut/modular_math.h>
+#include <nut/factorization.h>
+#include <nut/sieves.h>
+#include <nut/factorizer.h>
+
+/// Header of a saved smallest factor table.  The table itself starts at offset NUT_FACTORIZER_DATA_OFFSET
+typedef struct{
+	char magic[8];
+	uint64_t version;
+	uint64_t table_max;
+	uint64_t table_len;
+} nut_FactorizerHeader;
+
+static const char nut_factorizer_magic[8] = "NUTSPF6";
+#define NUT_FACTORIZER_VERSION 1
+#define NUT_FACTORIZER_DATA_OFFSET 64
+
+/// Number of entries in the table returned by nut_sieve_smallest_factors_wheel6(max)
+static uint64_t wheel6_len(uint64_t max){
+	uint64_t r = max%6;
+	switch(r){
+		case 0: max -= 1; r = 5; break;
+		case 2 ... 4: max -= (r-1); r = 1;
+	}
+	return 2*(max/6) + (r == 5) + 1;
+}
+
+static bool init_common(nut_Factorizer *restrict self, uint64_t trial_max, const nut_FactorConf *restrict conf){
+	self->conf = *conf;
+	self->primes = nut_sieve_primes(trial_max < 100 ? 100 : trial_max, &self->num_primes);
+	return self->primes;
+}
+
+bool nut_Factorizer_init(nut_Factorizer *restrict self, uint64_t table_max, uint64_t trial_max, const nut_FactorConf *restrict conf){
+	*self = (nut_Factorizer){.table_max = table_max};
+	if(table_max){
+		if(!(self->smallest_factors = nut_sieve_smallest_factors_wheel6(table_max))){
+			return false;
+		}
+		self->table_len = wheel6_len(table_max);
+	}
+	if(!init_common(self, trial_max, conf)){
+		free(self->smallest_factors);
+		return false;
+	}
+	return true;
+}
+
+bool nut_Factorizer_init_mmap(nut_Factorizer *restrict self, const char *restrict path, uint64_t trial_max, const nut_FactorConf *restrict conf){
+	*self = (nut_Factorizer){};
+	FILE *file = fopen(path, "rb");
+	if(!file){
+		return false;
+	}
+	nut_FactorizerHeader header;
+	// bound table_len before finding the size of the table, so a corrupt table_max can't make the size wrap around
+	if(fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, nut_factorizer_magic, 8) ||
+		header.version != NUT_FACTORIZER_VERSION || header.table_len != wheel6_len(header.table_max) ||
+		header.table_len > (SIZE_MAX - NUT_FACTORIZER_DATA_OFFSET)/sizeof(uint32_t)){
+		fclose(file);
+		return false;
+	}
+	size_t data_len = header.table_len*sizeof(uint32_t);
+#ifdef NUT_FACTORIZER_MMAP
+	struct stat info;
+	if(fstat(fileno(file), &info) || (uint64_t)info.st_size < NUT_FACTORIZER_DATA_OFFSET + data_len){
+		fclose(file);
+		return false;
+	}
+	size_t mapping_len = NUT_FACTORIZER_DATA_OFFSET + data_len;
+	void *mapping = mmap(NULL, mapping_len, PROT_READ, MAP_SHARED, fileno(file), 0);
+	fclose(file);
+	if(mapping == MAP_FAILED){
+		return false;
+	}
+	self->mapping = mapping;
+	self->mapping_len = mapping_len;
+	self->smallest_factors = (uint32_t*)((char*)mapping + NUT_FACTORIZER_DATA_OFFSET);
+#else
+	self->smallest_factors = malloc(data_len);
+	if(!self->smallest_factors || fseek(file, NUT_FACTORIZER_DATA_OFFSET, SEEK_SET) ||
+		fread(self->smallest_factors, sizeof(uint32_t), header.table_len, file) != header.table_len){
+		free(self->smallest_factors);
+		fclose(file);
+		return false;
+	}
+	fclose(file);
+#endif
+	self->table_max = header.table_max;
+	self->table_len = header.table_len;
+	if(!init_common(self, trial_max, conf)){
+		nut_Factorizer_destroy(self);
+		return false;
+	}
+	return true;
+}
+
+bool nut_Factorizer_save(const nut_Factorizer *restrict self, const char *restrict path){
+	if(!self->smallest_factors){
+		return false;
+	}
+	FILE *file = fopen(path, "wb");
+	if(!file){
+		return false;
+	}
+	char buf[NUT_FACTORIZER_DATA_OFFSET] = {};
+	nut_FactorizerHeader header = {.version = NUT_FACTORIZER_VERSION, .table_max = self->table_max, .table_len = self->table_len};
+	memcpy(header.magic, nut_factorizer_magic, 8);
+	memcpy(buf, &header, sizeof(header));
+	bool res = fwrite(buf, 1, sizeof(buf), file) == sizeof(buf) &&
+		fwrite(self->smallest_factors, sizeof(uint32_t), self->table_len, file) == self->table_len;
+	return !fclose(file) && res;
+}
+
+void nut_Factorizer_destroy(nut_Factorizer *self){
+#ifdef NUT_FACTORIZER_MMAP
+	if(self->mapping){
+		munmap(self->mapping, self->mapping_len);
+	}else
+#endif
+	free(self->smallest_factors);
+	free(self->primes);
+	*self = (nut_Factorizer){};
+}
+
+uint64_t nut_Factorizer_factor(const nut_Factorizer *restrict self, uint64_t n, nut_Factors *restrict factors){
+	if(n <= self->table_max){
+		nut_fill_factors_from_smallest_wheel6(factors, n, self->smallest_factors);
+		return 1;
+	}
+	n = nut_u64_factor_trial_div(n, self->num_primes, self->primes, factors);
+	if(n == 1){
+		return 1;
+	}
+	// room for the header and NUT_MAX_PRIMES_64 (prime, power) pairs, so repeated queries don't allocate
+	uint64_t rest_buf[1 + 2*NUT_MAX_PRIMES_64] = {};
+	nut_Factors *rest = (nut_Factors*)rest_buf;
+	if(n <= self->table_max){
+		nut_fill_factors_from_smallest_wheel6(rest, n, self->smallest_factors);
+		n = 1;
+	}else{
+		//no prime factors up to primes[num_primes - 1] >= 97 remain, so pollard won't see multiples of 4 or 25
+		n = nut_u64_factor_heuristic(n, 0, self->primes, &self->conf, rest);
+	}
+	nut_Factor_combine(factors, rest, 1);
+	return n;
+}
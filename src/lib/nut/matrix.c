@@ -259,16 +259,21 @@ bool nut_u64_ModMatrix_invert_ltr(nut_u64_ModMatrix *restrict self, nut_u64_ModM
 	if(self->rows != self->cols || self->rows != out->rows || self->cols != out->rows){
 		return 0;
 	}
+	// invert all of the diagonal entries at once, which also checks that they are all units
+	uint64_t *diag [[gnu::cleanup(cleanup_free)]] = malloc(2*self->rows*sizeof(uint64_t));
+	if(!diag && self->rows){
+		return false;
+	}
+	uint64_t *diag_invs = diag + self->rows;
 	for(uint64_t i = 0; i < self->rows; ++i){
-		if(!self->buf[self->cols*i + i]){
-			return false;
-		}
+		diag[i] = self->buf[self->cols*i + i];
+	}
+	if(!nut_u64_modinv_batch(self->modulus, self->rows, diag, diag_invs)){
+		return false;
 	}
 	nut_u64_ModMatrix_fill_I(out);
 	for(uint64_t i = 0; i < self->rows; ++i){
-		uint64_t a = self->buf[self->cols*i + i];
-		int64_t _ainv = nut_i64_modinv(a, self->modulus);
-		nut_u64_ModMatrix_scale_row(out, i, 0, (uint64_t)_ainv);
+		nut_u64_ModMatrix_scale_row(out, i, 0, diag_invs[i]);
 		for(uint64_t j = i + 1; j < self->rows; ++j){
 			uint64_t b = self->buf[self->cols*j + i];
 			if(b){
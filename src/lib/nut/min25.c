@@ -0,0 +1,238 @@
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <nut/debug.h>
+#include <nut/modular_math.h>
+#include <nut/factorization.h>
+#include <nut/sieves.h>
+#include <nut/dirichlet.h>
+#include <nut/parallel.h>
+#include <nut/min25.h>
+
+typedef struct{
+	int64_t x, m;
+	// G(v) = sum(f(p), p <= v), with prefix sums in the dense part too
+	const nut_Diri *g_tbl;
+	// all primes up to sqrt(x), followed by the next prime after that
+	const uint64_t *primes;
+	uint64_t num_primes;
+	// g_primes[j] = sum of f over the first j primes, f_primes[j] = f(primes[j])
+	const int64_t *g_primes, *f_primes;
+	int64_t (*f_fn)(uint64_t p, uint64_t pp, uint64_t e, uint64_t m);
+	const int64_t *f_vals;
+} Min25Ctx;
+
+typedef struct{
+	const Min25Ctx *ctx;
+	uint64_t thread_idx, num_threads;
+	int64_t sum;
+} Min25Args;
+
+static inline int64_t add_mod(int64_t a, int64_t b, int64_t m){
+	if(!m){
+		return (uint64_t)a + (uint64_t)b;
+	}
+	int64_t r = a + b;
+	return r >= m ? r - m : r;
+}
+
+static inline int64_t sub_mod(int64_t a, int64_t b, int64_t m){
+	if(!m){
+		return (uint64_t)a - (uint64_t)b;
+	}
+	int64_t r = a - b;
+	return r < 0 ? r + m : r;
+}
+
+static inline int64_t mul_mod(int64_t a, int64_t b, int64_t m){
+	return m ? (int128_t)a*b%m : (int64_t)((uint64_t)a*(uint64_t)b);
+}
+
+static inline int64_t min25_G(const Min25Ctx *ctx, int64_t v){
+	const nut_Diri *g = ctx->g_tbl;
+	return v <= g->y ? g->buf[v] : g->buf[g->y + ctx->x/v];
+}
+
+static inline int64_t min25_f(const Min25Ctx *ctx, uint64_t p, uint64_t pp, uint64_t e){
+	return ctx->f_fn ? ctx->f_fn(p, pp, e, ctx->m) : ctx->f_vals[e];
+}
+
+static int64_t min25_S(const Min25Ctx *ctx, int64_t v, uint64_t j);
+
+// the terms of S(v, i) for composites whose smallest prime factor is exactly primes[i]
+static int64_t min25_prime_terms(const Min25Ctx *ctx, int64_t v, uint64_t i){
+	int64_t p = ctx->primes[i], m = ctx->m, res = 0;
+	int64_t f_pe = ctx->f_primes[i];
+	for(int64_t pe = p, e = 1; pe <= v/p; pe *= p, ++e){
+		int64_t f_next = min25_f(ctx, p, pe*p, e + 1);
+		res = add_mod(res, add_mod(mul_mod(f_pe, min25_S(ctx, v/pe, i + 1), m), f_next, m), m);
+		f_pe = f_next;
+	}
+	return res;
+}
+
+static int64_t min25_S(const Min25Ctx *ctx, int64_t v, uint64_t j){
+	if(v < (int64_t)ctx->primes[j]){
+		return 0;
+	}
+	int64_t res = sub_mod(min25_G(ctx, v), ctx->g_primes[j], ctx->m);
+	for(uint64_t i = j; i < ctx->num_primes && (int64_t)(ctx->primes[i]*ctx->primes[i]) <= v; ++i){
+		res = add_mod(res, min25_prime_terms(ctx, v, i), ctx->m);
+	}
+	return res;
+}
+
+static void *min25_worker(void *_args){
+	Min25Args *args = _args;
+	const Min25Ctx *ctx = args->ctx;
+	// the smallest primes have by far the most work, so deal them out round robin
+	for(uint64_t i = args->thread_idx; i < ctx->num_primes; i += args->num_threads){
+		args->sum = add_mod(args->sum, min25_prime_terms(ctx, ctx->x, i), ctx->m);
+	}
+	return NULL;
+}
+
+// Lucy style: for each prime p from largest to smallest, add the composites with smallest prime factor p to every entry.
+// r_tbl holds S(v, j) - (G(v) - G(p_j - 1)), the composite part, and v is visited in decreasing order so the entries at v/p^e
+// still hold their values for j + 1
+static void min25_fill_table(const Min25Ctx *ctx, nut_Diri *r_tbl){
+	int64_t m = ctx->m, x = ctx->x, f_pows[64];
+	memset(r_tbl->buf, 0, (r_tbl->y + r_tbl->yinv)*sizeof(int64_t));
+	for(uint64_t i = ctx->num_primes; i-- > 0;){
+		int64_t p = ctx->primes[i], g_next = ctx->g_primes[i + 1];
+		uint64_t max_e = 1;
+		f_pows[1] = ctx->f_primes[i];
+		for(int64_t pe = p; pe <= x/p; pe *= p){
+			++max_e;
+			f_pows[max_e] = min25_f(ctx, p, pe*p, max_e);
+		}
+		for(int64_t idx = r_tbl->y + 1, v; idx < r_tbl->y + r_tbl->yinv && (v = x/(idx - r_tbl->y)) >= p*p; ++idx){
+			int64_t acc = r_tbl->buf[idx];
+			for(int64_t pe = p, e = 1; pe <= v/p; pe *= p, ++e){
+				int64_t w = v/pe;
+				int64_t r_w = w <= r_tbl->y ? r_tbl->buf[w] : r_tbl->buf[r_tbl->y + x/w];
+				int64_t s_w = add_mod(r_w, sub_mod(min25_G(ctx, w), g_next, m), m);
+				acc = add_mod(acc, add_mod(mul_mod(f_pows[e], s_w, m), f_pows[e + 1], m), m);
+			}
+			r_tbl->buf[idx] = acc;
+		}
+		for(int64_t v = r_tbl->y; v >= p*p; --v){
+			int64_t acc = r_tbl->buf[v];
+			for(int64_t pe = p, e = 1; pe <= v/p; pe *= p, ++e){
+				int64_t w = v/pe;
+				int64_t s_w = add_mod(r_tbl->buf[w], sub_mod(min25_G(ctx, w), g_next, m), m);
+				acc = add_mod(acc, add_mod(mul_mod(f_pows[e], s_w, m), f_pows[e + 1], m), m);
+			}
+			r_tbl->buf[v] = acc;
+		}
+	}
+	// F(v) = 1 + G(v) + composite part, then turn the dense prefix sums back into values of f
+	int64_t one = m == 1 ? 0 : 1;
+	for(int64_t idx = 1; idx < r_tbl->y + r_tbl->yinv; ++idx){
+		int64_t v = idx <= r_tbl->y ? idx : x/(idx - r_tbl->y);
+		r_tbl->buf[idx] = add_mod(r_tbl->buf[idx], add_mod(min25_G(ctx, v), one, m), m);
+	}
+	for(int64_t v = r_tbl->y; v > 1; --v){
+		r_tbl->buf[v] = sub_mod(r_tbl->buf[v], r_tbl->buf[v - 1], m);
+	}
+	r_tbl->buf[0] = 0;
+}
+
+static bool min25_sum(int64_t x, int64_t m, uint64_t kmax, const int64_t *restrict prime_poly_coeffs, Min25Ctx *ctx, nut_Diri *restrict out_table, int64_t *restrict out, uint64_t num_threads){
+	// the table is indexed with x, so a table for any other x would be read and written out of bounds
+	if(out_table && out_table->x != x){
+		return false;
+	}else if(x < 1){
+		*out = 0;
+		return true;
+	}
+	int64_t y = out_table ? out_table->y : 0;
+	nut_Diri *tbls [[gnu::cleanup(cleanup_free)]] = calloc(kmax + 1, sizeof(nut_Diri));
+	if(!tbls){
+		return false;
+	}
+	bool ok = true;
+	for(uint64_t k = 0; ok && k <= kmax; ++k){
+		ok = nut_Diri_init(tbls + k, x, y);
+	}
+	ok = ok && nut_Diri_compute_prime_sums(tbls, kmax, m);
+	// combine the power sums into G in the first table
+	for(int64_t idx = 0; ok && idx < tbls->y + tbls->yinv; ++idx){
+		int64_t acc = 0;
+		for(uint64_t k = 0; k <= kmax; ++k){
+			acc = add_mod(acc, mul_mod(prime_poly_coeffs[k], tbls[k].buf[idx], m), m);
+		}
+		tbls->buf[idx] = acc;
+	}
+	for(uint64_t k = 1; k <= kmax; ++k){
+		nut_Diri_destroy(tbls + k);
+	}
+	uint64_t sqrt_x = nut_u64_nth_root(x, 2), num_primes;
+	uint64_t *primes [[gnu::cleanup(cleanup_free)]] = ok ? nut_sieve_primes(sqrt_x, &num_primes) : NULL;
+	uint64_t *tmp = primes ? realloc(primes, (num_primes + 1)*sizeof(uint64_t)) : NULL;
+	int64_t *g_primes [[gnu::cleanup(cleanup_free)]] = tmp ? malloc((2*num_primes + 2)*sizeof(int64_t)) : NULL;
+	if(tmp){
+		primes = tmp;
+	}
+	if(!g_primes){
+		nut_Diri_destroy(tbls);
+		return false;
+	}
+	primes[num_primes] = nut_u64_next_prime_ge(sqrt_x + 1);
+	int64_t *f_primes = g_primes + num_primes + 1;
+	g_primes[0] = 0;
+	for(uint64_t j = 0; j < num_primes; ++j){
+		g_primes[j + 1] = tbls->buf[primes[j]];
+		f_primes[j] = sub_mod(g_primes[j + 1], g_primes[j], m);
+	}
+	ctx->x = x;
+	ctx->m = m;
+	ctx->g_tbl = tbls;
+	ctx->primes = primes;
+	ctx->num_primes = num_primes;
+	ctx->g_primes = g_primes;
+	ctx->f_primes = f_primes;
+	if(out_table){
+		min25_fill_table(ctx, out_table);
+		*out = out_table->buf[out_table->y + 1];
+		nut_Diri_destroy(tbls);
+		return true;
+	}
+	if(!num_threads){
+		num_threads = nut_parallel_default_threads();
+	}
+	if(num_threads > num_primes){
+		num_threads = num_primes ? num_primes : 1;
+	}
+	Min25Args *args [[gnu::cleanup(cleanup_free)]] = malloc(num_threads*sizeof(Min25Args));
+	if(!args){
+		nut_Diri_destroy(tbls);
+		return false;
+	}
+	for(uint64_t t = 0; t < num_threads; ++t){
+		args[t] = (Min25Args){.ctx = ctx, .thread_idx = t, .num_threads = num_threads};
+	}
+	nut_parallel_run(num_threads, min25_worker, args, sizeof(Min25Args));
+	int64_t res = add_mod(min25_G(ctx, x), m == 1 ? 0 : 1, m);
+	for(uint64_t t = 0; t < num_threads; ++t){
+		res = add_mod(res, args[t].sum, m);
+	}
+	*out = res;
+	nut_Diri_destroy(tbls);
+	return true;
+}
+
+bool nut_min25_sum_fn(int64_t x, int64_t m, uint64_t kmax, const int64_t prime_poly_coeffs[restrict static kmax + 1],
+	int64_t (*f_fn)(uint64_t p, uint64_t pp, uint64_t e, uint64_t m), nut_Diri *restrict out_table, int64_t *restrict out, uint64_t num_threads
+){
+	Min25Ctx ctx = {.f_fn = f_fn};
+	return min25_sum(x, m, kmax, prime_poly_coeffs, &ctx, out_table, out, num_threads);
+}
+
+bool nut_min25_sum_vals(int64_t x, int64_t m, uint64_t kmax, const int64_t prime_poly_coeffs[restrict static kmax + 1],
+	const int64_t *restrict f_vals, nut_Diri *restrict out_table, int64_t *restrict out, uint64_t num_threads
+){
+	Min25Ctx ctx = {.f_vals = f_vals};
+	return min25_sum(x, m, kmax, prime_poly_coeffs, &ctx, out_table, out, num_threads);
+}
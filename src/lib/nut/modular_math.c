@@ -147,8 +147,44 @@ uint64_t nut_u64_rand(uint64_t a, uint64_t b){
 }
 #endif
 
+// xoshiro256** state, seeded from nut_u64_rand the first time each thread calls nut_u64_prand
+static __thread uint64_t nut_prand_state[4];
+static __thread bool nut_prand_seeded = false;
+
+static inline uint64_t rotl64(uint64_t x, uint64_t k){
+	return (x << k) | (x >> (64 - k));
+}
+
+static uint64_t prand_next(){
+	uint64_t *s = nut_prand_state;
+	if(!nut_prand_seeded){
+		// the state must not be all 0, so the last word is drawn from [1, 2**64)
+		for(uint64_t i = 0; i < 3; ++i){
+			s[i] = nut_u64_rand(0, UINT64_MAX);
+		}
+		s[3] = nut_u64_rand(1, UINT64_MAX);
+		nut_prand_seeded = true;
+	}
+	uint64_t res = rotl64(s[1]*5, 7)*9, t = s[1] << 17;
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = rotl64(s[3], 45);
+	return res;
+}
+
 uint64_t nut_u64_prand(uint64_t a, uint64_t b){
-	return nut_u64_rand(a, b);//TODO: test if this is a bottleneck, we don't need calls to this function to be secure
+	// Lemire's multiply and reject: the high word of r*l is uniform on [0, l) once the low words below 2**64 % l are rejected
+	uint64_t l = b - a;
+	uint128_t r = (uint128_t)prand_next()*l;
+	if((uint64_t)r < l){
+		for(uint64_t t = -l%l; (uint64_t)r < t;){
+			r = (uint128_t)prand_next()*l;
+		}
+	}
+	return (uint64_t)(r >> 64) + a;
 }
 
 int64_t nut_i64_egcd(int64_t a, int64_t b, int64_t *restrict _t, int64_t *restrict _s){
@@ -236,6 +272,80 @@ int128_t nut_i128_crt(int64_t a, int64_t p, int64_t b, int64_t q){
 	return x < 0 ? x + p*q : x;
 }
 
+// Extended Euclidean algorithm for the full uint64_t range, using 128 bit coefficients
+static bool u64_modinv(uint64_t a, uint64_t n, uint64_t *inv){
+	uint64_t r0 = n, r1 = a%n;
+	int128_t t0 = 0, t1 = 1;
+	while(r1){
+		uint64_t q = r0/r1, r = r0 - q*r1;
+		int128_t t = t0 - (int128_t)q*t1;
+		r0 = r1;
+		r1 = r;
+		t0 = t1;
+		t1 = t;
+	}
+	if(r0 != 1){
+		return false;
+	}
+	*inv = t0 < 0 ? (uint64_t)(t0 + n) : (uint64_t)t0;
+	return true;
+}
+
+bool nut_u64_modinv_batch(uint64_t n, uint64_t count, const uint64_t in[restrict static count], uint64_t out[restrict static count]){
+	if(!count){
+		return true;
+	}
+	out[0] = in[0]%n;
+	for(uint64_t i = 1; i < count; ++i){
+		out[i] = (uint128_t)out[i - 1]*in[i]%n;
+	}
+	uint64_t inv;
+	if(!u64_modinv(out[count - 1], n, &inv)){
+		return false;
+	}
+	// inv is the inverse of in[0]*...*in[i], so multiplying by the previous prefix product leaves the inverse of in[i]
+	for(uint64_t i = count - 1; i; --i){
+		out[i] = (uint128_t)inv*out[i - 1]%n;
+		inv = (uint128_t)inv*in[i]%n;
+	}
+	out[0] = inv;
+	return true;
+}
+
+bool nut_u64_crt_multi(uint64_t k, const uint64_t a[restrict static k], const uint64_t m[restrict static k], uint64_t out[restrict static k]){
+	if(!k){
+		return true;
+	}
+	// out[i] temporarily holds the ith mixed radix digit v_i, so x = v_0 + m_0(v_1 + m_1(v_2 + ...))
+	for(uint64_t i = 0; i < k; ++i){
+		uint64_t mi = m[i], prod = 1%mi, x = 0;
+		// evaluate v_0 + m_0 v_1 + ... + m_0...m_{i-2} v_{i-1} mod m_i, and m_0...m_{i-1} mod m_i alongside
+		for(uint64_t j = 0; j < i; ++j){
+			x = (x + (uint128_t)prod*out[j])%mi;
+			prod = (uint128_t)prod*m[j]%mi;
+		}
+		uint64_t prod_inv;
+		if(!u64_modinv(prod, mi, &prod_inv)){
+			return false;
+		}
+		uint64_t ai = a[i]%mi, diff = ai >= x ? ai - x : ai + (mi - x);
+		out[i] = (uint128_t)diff*prod_inv%mi;
+	}
+	// Horner's rule from the top digit down.  After processing digit i, x occupies words i through k - 1 of out,
+	// shifted up by i words, because x < m_i...m_{k-1} < 2^(64(k - i)).  Word i - 1 still holds digit v_{i-1}.
+	for(uint64_t i = k - 1; i-- > 0;){
+		uint64_t v = out[i];
+		uint128_t carry = v;
+		for(uint64_t j = i + 1; j < k; ++j){
+			carry += (uint128_t)out[j]*m[i];
+			out[j - 1] = carry;
+			carry >>= 64;
+		}
+		out[k - 1] = carry;
+	}
+	return true;
+}
+
 int64_t nut_i64_lcm(int64_t a, int64_t b){
 	return a*b/nut_i64_egcd(a, b, NULL, NULL);
 }
@@ -446,4 +556,24 @@ uint64_t nut_u64_fastmod(uint64_t n, uint64_t d, uint128_t c){
 	return ((uint128_t)cn_hi*d) >> 64;
 }
 
+void nut_Montgomery_init(nut_Montgomery *self, uint64_t n){
+	assert(n&1);
+	self->n = n;
+	self->ninv = nut_u64_modinv_2t(n, 64);
+	self->one = (uint64_t)(((uint128_t)1 << 64)%n);
+	self->r2 = (uint128_t)self->one*self->one%n;
+}
 
+uint64_t nut_Montgomery_pow(const nut_Montgomery *self, uint64_t b, uint64_t e){
+	uint64_t r = self->one;
+	while(e){
+		if(e&1){
+			r = nut_Montgomery_mul(self, r, b);
+		}
+		if(!(e >>= 1)){
+			break;
+		}
+		b = nut_Montgomery_mul(self, b, b);
+	}
+	return r;
+}
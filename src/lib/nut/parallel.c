@@ -0,0 +1,31 @@
+#include <inttypes.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include <nut/debug.h>
+#include <nut/parallel.h>
+
+uint64_t nut_parallel_default_threads(){
+	long res = sysconf(_SC_NPROCESSORS_ONLN);
+	return res > 0 ? res : 1;
+}
+
+void nut_parallel_run(uint64_t num_tasks, void *(*fn)(void*), void *args, size_t arg_size){
+	if(!num_tasks){
+		return;
+	}
+	pthread_t *threads [[gnu::cleanup(cleanup_free)]] = malloc((num_tasks - 1)*sizeof(pthread_t));
+	bool *started [[gnu::cleanup(cleanup_free)]] = calloc(num_tasks, sizeof(bool));
+	for(uint64_t i = 1; threads && started && i < num_tasks; ++i){
+		started[i] = !pthread_create(threads + i - 1, NULL, fn, (char*)args + i*arg_size);
+	}
+	fn(args);
+	for(uint64_t i = 1; i < num_tasks; ++i){
+		if(started && started[i]){
+			pthread_join(threads[i - 1], NULL);
+		}else{
+			fn((char*)args + i*arg_size);
+		}
+	}
+}
@@ -4,6 +4,11 @@
 #include <nut/modular_math.h>
 #include <nut/factorization.h>
 #include <nut/polynomial.h>
+#include <nut/mod_kernels.h>
+
+// specialized copies of the hot loops for the most common moduli, see mod_kernels.h
+NUT_DEFINE_MOD_KERNELS(p1e9_7, 1000000007)
+NUT_DEFINE_MOD_KERNELS(p998244353, 998244353)
 
 bool nut_Poly_init(nut_Poly *f, uint64_t reserve){
 	reserve = reserve ?: 4;
@@ -215,23 +220,11 @@ bool nut_Poly_scale_modn(nut_Poly *g, const nut_Poly *f, int64_t a, int64_t n){
 }
 
 bool nut_Poly_mul_modn(nut_Poly *restrict h, const nut_Poly *f, const nut_Poly *g, int64_t n){
-	if(f->len == 1){
-		return nut_Poly_scale_modn(h, g, f->coeffs[0], n);
-	}else if(g->len == 1){
-		return nut_Poly_scale_modn(h, f, g->coeffs[0], n);
-	}
-	if(!nut_Poly_ensure_cap(h, f->len + g->len - 1)){
-		return false;
+	switch(n){
+		case 1000000007: return p1e9_7_Poly_mul(h, f, g);
+		case 998244353: return p998244353_Poly_mul(h, f, g);
+		default: return nut_Poly_mul_modn_kernel(h, f, g, n);
 	}
-	for(uint64_t k = 0; k < f->len + g->len - 1; ++k){
-		h->coeffs[k] = 0;
-		for(uint64_t i = k >= g->len ? k - g->len + 1 : 0; i < f->len && i <= k; ++i){
-			h->coeffs[k] = nut_i64_mod(h->coeffs[k] + f->coeffs[i]*g->coeffs[k - i], n);
-		}
-	}
-	h->len = f->len + g->len - 1;
-	nut_Poly_normalize(h);
-	return true;
 }
 
 bool nut_Poly_pow_modn(nut_Poly *restrict g, const nut_Poly *f, uint64_t e, int64_t n, uint64_t cn, nut_Poly tmps[restrict static 2]){
@@ -0,0 +1,433 @@
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <nut/debug.h>
+#include <nut/modular_math.h>
+#include <nut/factorization.h>
+#include <nut/sieves.h>
+#include <nut/parallel.h>
+#include <nut/primecount.h>
+
+// P2 primes are generated in descending blocks of this length with nut_u64_primes_in
+#define P2_BLOCK_LEN (UINT64_C(1) << 18)
+
+typedef struct{
+	uint64_t x, y, z, a, sqrt_x, num_threads;
+	// length of the sieve segments, and the number of primes p with p^2 <= y
+	uint64_t seg_len, a_sqrt_y;
+	const uint64_t *primes;
+	// mu(m)*lpf(m) for m <= y, with lpf(1) taken to be INT32_MAX, so m is usable in a leaf with prime p iff |lpf_mu[m]| > p
+	const int32_t *lpf_mu;
+	// pi(v) for v <= y
+	const uint32_t *pi_small;
+	// for the leaves with prime primes[b], m must be > m_lo[b], and m <= m_hard[b] is hard while m > m_hard[b] is easy.
+	// If primes[b]^2 > y, m must be prime and we iterate over primes instead of all integers
+	const uint64_t *m_lo, *m_hard;
+} PiCtx;
+
+typedef struct{
+	const PiCtx *ctx;
+	uint64_t chunk_lo, chunk_hi;
+	uint64_t thread_idx;
+	// phi(v, b) - phi(chunk_lo - 1, b) for v at the end of the chunk, and the total of -mu(m) over hard leaves seen at each level
+	uint64_t *counts;
+	int64_t *weights;
+	int128_t easy_sum, hard_sum;
+	uint128_t p2_sum;
+	uint64_t p2_num;
+	bool ok;
+} PiArgs;
+
+typedef struct{
+	uint64_t lo, len, count;
+	uint8_t *flags;
+	uint32_t *tree;
+} PiSegment;
+
+typedef struct{
+	uint64_t *buf;
+	uint64_t len, lo, min;
+} PrimeCursor;
+
+static inline bool uses_prime_m(const PiCtx *ctx, uint64_t p){
+	return p*p > ctx->y;
+}
+
+static void segment_reset(PiSegment *seg, uint64_t lo, uint64_t len){
+	seg->lo = lo;
+	seg->len = seg->count = len;
+	memset(seg->flags, 1, len);
+	for(uint64_t k = 1; k <= len; ++k){
+		seg->tree[k] = k & -k;
+	}
+}
+
+static inline void segment_remove(PiSegment *seg, uint64_t i){
+	if(!seg->flags[i]){
+		return;
+	}
+	seg->flags[i] = 0;
+	--seg->count;
+	for(uint64_t k = i + 1; k <= seg->len; k += k & -k){
+		--seg->tree[k];
+	}
+}
+
+// number of unsieved entries at positions [0, i] of the segment
+static inline uint64_t segment_prefix(const PiSegment *seg, uint64_t i){
+	uint64_t res = 0;
+	for(uint64_t k = i + 1; k; k &= k - 1){
+		res += seg->tree[k];
+	}
+	return res;
+}
+
+static void segment_sieve(PiSegment *seg, uint64_t p){
+	uint64_t lo = seg->lo, hi = lo + seg->len;
+	if(lo <= p && p < hi){
+		segment_remove(seg, p - lo);
+	}
+	if(p*p >= hi){
+		// every other multiple of p below hi has a smaller prime factor
+		return;
+	}
+	uint64_t j = p*p >= lo ? p*p : (lo + p - 1)/p*p;
+	for(; j < hi; j += p){
+		segment_remove(seg, j - lo);
+	}
+}
+
+// get the largest remaining prime in [min, lo + len), or 0 if there are none
+static uint64_t cursor_peek(PrimeCursor *self, bool *ok){
+	while(!self->len){
+		if(self->lo <= self->min){
+			return 0;
+		}
+		uint64_t lo = self->lo - self->min > P2_BLOCK_LEN ? self->lo - P2_BLOCK_LEN : self->min;
+		free(self->buf);
+		if(!(self->buf = nut_u64_primes_in(lo, self->lo - 1, &self->len))){
+			*ok = false;
+			self->lo = self->min;
+			return 0;
+		}
+		self->lo = lo;
+	}
+	return self->buf[self->len - 1];
+}
+
+// index of the first prime > v, or a if there is none
+static uint64_t primes_upper_bound(const PiCtx *ctx, uint64_t v){
+	uint64_t lo = 0, hi = ctx->a;
+	while(lo < hi){
+		uint64_t mid = lo + (hi - lo)/2;
+		if(ctx->primes[mid] <= v){
+			lo = mid + 1;
+		}else{
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+// phi(v, b) for easy leaves, where v <= y and v < p_(b+1)^2, so everything counted besides 1 is a prime above p_b
+static inline uint64_t easy_phi(const PiCtx *ctx, uint64_t v, uint64_t b){
+	uint64_t pi_v = ctx->pi_small[v];
+	return pi_v > b ? 1 + pi_v - b : 1;
+}
+
+static int128_t sum_easy_leaves(const PiCtx *ctx, uint64_t b){
+	uint64_t p = ctx->primes[b], x = ctx->x, y = ctx->y;
+	int128_t res = 0;
+	if(uses_prime_m(ctx, p)){
+		// mu(q) = -1, so every leaf counts positively.  Leaves with q > x/p^2 have v < p, so phi(v, b) = 1 and they are counted all at once.
+		// Below that, phi(v, b) = 1 + pi(v) - b, and every prime q' from q up to x/(p p_k), where p_k is the largest prime <= v,
+		// gives the same pi(v') = pi(v), so each run of equal values is counted at once too
+		uint64_t j = primes_upper_bound(ctx, ctx->m_hard[b] > ctx->m_lo[b] ? ctx->m_hard[b] : ctx->m_lo[b]);
+		uint64_t w = x/(p*p);
+		uint64_t j_trivial = ctx->pi_small[w < y ? w : y];
+		if(j_trivial < j){
+			j_trivial = j;
+		}
+		res += ctx->a - j_trivial;
+		while(j < j_trivial){
+			uint64_t pi_v = ctx->pi_small[x/(p*ctx->primes[j])];
+			w = x/(p*ctx->primes[pi_v - 1]);
+			uint64_t j_next = ctx->pi_small[w < y ? w : y];
+			if(j_next > j_trivial){
+				j_next = j_trivial;
+			}
+			res += (int128_t)(j_next - j)*(1 + pi_v - b);
+			j = j_next;
+		}
+		return res;
+	}
+	for(uint64_t m = (ctx->m_hard[b] > ctx->m_lo[b] ? ctx->m_hard[b] : ctx->m_lo[b]) + 1; m <= y; ++m){
+		int32_t e = ctx->lpf_mu[m];
+		if(e > (int64_t)p){
+			res -= easy_phi(ctx, x/(p*m), b);
+		}else if(e < -(int64_t)p){
+			res += easy_phi(ctx, x/(p*m), b);
+		}
+	}
+	return res;
+}
+
+static void *pi_worker(void *_args){
+	PiArgs *args = _args;
+	const PiCtx *ctx = args->ctx;
+	uint64_t x = ctx->x, a = ctx->a, seg_len = ctx->seg_len;
+	for(uint64_t b = args->thread_idx; b < a; b += ctx->num_threads){
+		args->easy_sum += sum_easy_leaves(ctx, b);
+	}
+	PiSegment seg = {
+		.flags = malloc(seg_len*sizeof(uint8_t)),
+		.tree = malloc((seg_len + 1)*sizeof(uint32_t))
+	};
+	// cursors[b] is the next m (or 1 + the index of the next prime m) to check for leaves with prime primes[b],
+	// counting down so that x/(primes[b]*m) counts up
+	uint64_t *cursors [[gnu::cleanup(cleanup_free)]] = malloc(a*sizeof(uint64_t));
+	if(!seg.flags || !seg.tree || !cursors){
+		free(seg.flags);
+		free(seg.tree);
+		return NULL;
+	}
+	for(uint64_t b = 0; b < a; ++b){
+		uint64_t p = ctx->primes[b], m = x/p/args->chunk_lo;
+		if(m > ctx->m_hard[b]){
+			m = ctx->m_hard[b];
+		}
+		cursors[b] = uses_prime_m(ctx, p) ? primes_upper_bound(ctx, m) : m;
+	}
+	uint64_t p2_hi = x/args->chunk_lo < ctx->sqrt_x ? x/args->chunk_lo : ctx->sqrt_x;
+	uint64_t p2_lo = x/args->chunk_hi + 1 > ctx->y + 1 ? x/args->chunk_hi + 1 : ctx->y + 1;
+	PrimeCursor p2_primes = {.lo = p2_hi + 1, .min = p2_lo > p2_hi ? p2_hi + 1 : p2_lo};
+	// Once the segment is above y, a prime p with p^2 >= hi has no multiples in it without a smaller prime factor, so sieving it changes nothing
+	// and every level from b_sq (the first such prime) up to a sees the same segment.  Instead of adding the segment count to all of those levels,
+	// levels b >= lazy store counts[b] relative to lazy_acc, the total count of all segments so far, and are fixed up when b_sq passes them.
+	// Leaves with prime primes[b] have v <= x/(primes[b](m_lo[b] + 1)), which decreases with b once primes[b]^2 > y, so levels b >= b_end
+	// have no leaves left and only need to be sieved.  Together, each segment only touches about pi(sqrt(hi)) + pi(sqrt(x/lo)) levels instead of a
+	uint64_t lazy = a, lazy_acc = 0, b_sq = 0, b_end = a;
+	args->ok = true;
+	for(uint64_t lo = args->chunk_lo; lo < args->chunk_hi; lo += seg_len){
+		uint64_t hi = args->chunk_hi - lo > seg_len ? lo + seg_len : args->chunk_hi;
+		segment_reset(&seg, lo, hi - lo);
+		for(; b_sq < a && ctx->primes[b_sq]*ctx->primes[b_sq] < hi; ++b_sq);
+		for(; b_end > ctx->a_sqrt_y; --b_end){
+			uint64_t p = ctx->primes[b_end - 1];
+			if(x/(p*(ctx->m_lo[b_end - 1] + 1)) >= lo){
+				break;
+			}
+		}
+		if(lo > ctx->y){
+			if(lazy == a){
+				for(uint64_t b = b_sq; b < a; ++b){
+					args->counts[b] -= lazy_acc;
+				}
+				lazy = b_sq;
+			}
+			for(; lazy < b_sq; ++lazy){
+				args->counts[lazy] += lazy_acc;
+			}
+		}
+		uint64_t b_stop = lazy > b_end ? lazy : b_end;
+		for(uint64_t b = 0;; ++b){
+			if(b && b <= lazy){
+				segment_sieve(&seg, ctx->primes[b - 1]);
+			}
+			if(b == b_stop){
+				break;
+			}
+			if(b < b_end){
+				uint64_t p = ctx->primes[b], m_lo = ctx->m_lo[b];
+				uint64_t base = args->counts[b] + (b >= lazy ? lazy_acc : 0);
+				if(uses_prime_m(ctx, p)){
+					uint64_t j = cursors[b];
+					for(; j && ctx->primes[j - 1] > m_lo; --j){
+						uint64_t v = x/(p*ctx->primes[j - 1]);
+						if(v >= hi){
+							break;
+						}
+						args->hard_sum += base + segment_prefix(&seg, v - lo);
+						++args->weights[b];
+					}
+					cursors[b] = j;
+				}else{
+					uint64_t m = cursors[b];
+					for(; m > m_lo; --m){
+						int32_t e = ctx->lpf_mu[m];
+						if(e <= (int64_t)p && e >= -(int64_t)p){
+							continue;
+						}
+						uint64_t v = x/(p*m);
+						if(v >= hi){
+							break;
+						}
+						int64_t phi_v = base + segment_prefix(&seg, v - lo);
+						if(e > 0){
+							args->hard_sum -= phi_v;
+							--args->weights[b];
+						}else{
+							args->hard_sum += phi_v;
+							++args->weights[b];
+						}
+					}
+					cursors[b] = m;
+				}
+			}
+			if(b < lazy){
+				args->counts[b] += seg.count;
+			}
+		}
+		// all a primes have been sieved out, so for v >= y, pi(v) = phi(v, a) + a - 1 and we can count the P2 terms in this segment.
+		// Level a is always lazy
+		for(uint64_t q; (q = cursor_peek(&p2_primes, &args->ok)) && x/q < hi; --p2_primes.len){
+			args->p2_sum += args->counts[a] + lazy_acc + segment_prefix(&seg, x/q - lo);
+			++args->p2_num;
+		}
+		lazy_acc += seg.count;
+	}
+	for(uint64_t b = lazy; b <= a; ++b){
+		args->counts[b] += lazy_acc;
+	}
+	free(p2_primes.buf);
+	free(seg.flags);
+	free(seg.tree);
+	return NULL;
+}
+
+// Segments are at least NUT_PI_SEGMENT_LEN long, and grow like sqrt(z) so the number of segments (and the work per segment) grows slowly
+static uint64_t pi_segment_len(uint64_t z){
+	uint64_t len = NUT_PI_SEGMENT_LEN, target = nut_u64_nth_root(z, 2);
+	while(len < target && len < NUT_PI_SEGMENT_MAX_LEN){
+		len <<= 1;
+	}
+	return len;
+}
+
+uint64_t nut_u64_pi_cutoff(uint64_t x){
+	uint64_t cbrt_x = nut_u64_nth_root(x, 3), sqrt_x = nut_u64_nth_root(x, 2);
+	double log_x = log((double)x + 1);
+	double alpha = log_x*log_x/100;
+	uint64_t y = alpha > 1 ? (uint64_t)(alpha*(double)cbrt_x) : cbrt_x;
+	if(y > sqrt_x){
+		y = sqrt_x;
+	}
+	if(y < cbrt_x){
+		y = cbrt_x;
+	}
+	return y < INT32_MAX ? y : INT32_MAX - 1;
+}
+
+bool nut_u64_pi(uint64_t x, uint64_t num_threads, uint64_t *out){
+	if(x < NUT_PI_SIEVE_MAX){
+		uint64_t *primes = nut_sieve_primes(x, out);
+		if(!primes){
+			return false;
+		}
+		free(primes);
+		return true;
+	}
+	if(!num_threads){
+		num_threads = nut_parallel_default_threads();
+	}
+	uint64_t y = nut_u64_pi_cutoff(x), z = x/y, a;
+	uint64_t *primes [[gnu::cleanup(cleanup_free)]] = nut_sieve_primes(y, &a);
+	uint8_t *mobius [[gnu::cleanup(cleanup_free)]] = nut_sieve_mobius(y);
+	int32_t *lpf_mu [[gnu::cleanup(cleanup_free)]] = calloc(y + 1, sizeof(int32_t));
+	uint32_t *pi_small [[gnu::cleanup(cleanup_free)]] = malloc((y + 1)*sizeof(uint32_t));
+	uint64_t *m_bounds [[gnu::cleanup(cleanup_free)]] = malloc(2*a*sizeof(uint64_t));
+	if(!primes || !mobius || !lpf_mu || !pi_small || !m_bounds){
+		return false;
+	}
+	for(uint64_t i = 0; i < a; ++i){
+		uint64_t p = primes[i];
+		for(uint64_t m = p; m <= y; m += p){
+			if(!lpf_mu[m]){
+				lpf_mu[m] = p;
+			}
+		}
+	}
+	lpf_mu[1] = INT32_MAX;
+	int128_t s1 = 0;
+	for(uint64_t m = 1, j = 0; m <= y; ++m){
+		switch(nut_Bitfield2_arr_get(mobius, m)){
+			case 0: lpf_mu[m] = 0; break;
+			case 1: s1 += x/m; break;
+			default: lpf_mu[m] = -lpf_mu[m]; s1 -= x/m;
+		}
+		if(j < a && primes[j] == m){
+			++j;
+		}
+		pi_small[m] = j;
+	}
+	pi_small[0] = 0;
+	uint64_t *m_lo = m_bounds, *m_hard = m_bounds + a;
+	for(uint64_t b = 0; b < a; ++b){
+		uint64_t p = primes[b], l = p*p - 1 < y ? p*p - 1 : y;
+		m_lo[b] = y/p;
+		if(p*p > y && m_lo[b] < p){
+			m_lo[b] = p;
+		}
+		m_hard[b] = x/(p*(l + 1));
+		if(m_hard[b] > y){
+			m_hard[b] = y;
+		}
+	}
+	uint64_t seg_len = pi_segment_len(z);
+	uint64_t max_threads = z/seg_len + 1;
+	if(num_threads > max_threads){
+		num_threads = max_threads;
+	}
+	PiCtx ctx = {
+		.x = x, .y = y, .z = z, .a = a, .sqrt_x = nut_u64_nth_root(x, 2), .num_threads = num_threads,
+		.seg_len = seg_len, .a_sqrt_y = pi_small[nut_u64_nth_root(y, 2)],
+		.primes = primes, .lpf_mu = lpf_mu, .pi_small = pi_small, .m_lo = m_lo, .m_hard = m_hard
+	};
+	PiArgs *args [[gnu::cleanup(cleanup_free)]] = calloc(num_threads, sizeof(PiArgs));
+	uint64_t *counts [[gnu::cleanup(cleanup_free)]] = calloc(num_threads*(a + 1), sizeof(uint64_t));
+	int64_t *weights [[gnu::cleanup(cleanup_free)]] = calloc(num_threads*a, sizeof(int64_t));
+	if(!args || !counts || !weights){
+		return false;
+	}
+	// the sieve interval is [1, z].  Segments are aligned to the chunk start, so chunks are rounded to whole segments
+	uint64_t num_segments = (z + seg_len - 1)/seg_len;
+	for(uint64_t t = 0; t < num_threads; ++t){
+		uint64_t seg_lo = num_segments*t/num_threads, seg_hi = num_segments*(t + 1)/num_threads;
+		args[t] = (PiArgs){
+			.ctx = &ctx, .thread_idx = t,
+			.chunk_lo = seg_lo*seg_len + 1,
+			.chunk_hi = t + 1 == num_threads ? z + 1 : seg_hi*seg_len + 1,
+			.counts = counts + t*(a + 1), .weights = weights + t*a
+		};
+	}
+	nut_parallel_run(num_threads, pi_worker, args, sizeof(PiArgs));
+	// phi_base[b] = phi(chunk_lo - 1, b) for the current chunk
+	uint64_t *phi_base [[gnu::cleanup(cleanup_free)]] = calloc(a + 1, sizeof(uint64_t));
+	if(!phi_base){
+		return false;
+	}
+	int128_t s2 = 0;
+	uint128_t p2 = 0;
+	uint64_t p2_num = 0;
+	for(uint64_t t = 0; t < num_threads; ++t){
+		const PiArgs *arg = args + t;
+		if(!arg->ok){
+			return false;
+		}
+		s2 += arg->easy_sum + arg->hard_sum;
+		for(uint64_t b = 0; b < a; ++b){
+			s2 += (int128_t)arg->weights[b]*phi_base[b];
+			phi_base[b] += arg->counts[b];
+		}
+		p2 += arg->p2_sum + (uint128_t)arg->p2_num*(phi_base[a] + a - 1);
+		phi_base[a] += arg->counts[a];
+		p2_num += arg->p2_num;
+	}
+	// the sum of pi(x/q) over primes q in (y, sqrt(x)] counts pairs of primes, but P2 only wants pairs p <= q, so subtract
+	// the pi(q) - 1 pairs with p < q for every q: (a + (a + 1) + ... + (a + p2_num - 1))
+	p2 -= (uint128_t)p2_num*a + (uint128_t)p2_num*(p2_num - 1)/2;
+	*out = s1 + s2 + a - 1 - (int128_t)p2;
+	return true;
+}
@@ -0,0 +1,843 @@
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+#include <nut/modular_math.h>
+#include <nut/factorization.h>
+#include <nut/sieves.h>
+#include <nut/qsieve.h>
+
+/// Bytes in one sieve block, chosen to fit in L1d
+#define SIQS_BLOCK 32768
+/// Primes below this are not sieved, only trial divided, since they cost the most to sieve and contribute the least
+#define SIQS_SMALL_PRIME 32
+/// Most factor base primes a polynomial leading coefficient can be a product of
+#define SIQS_MAX_S 20
+/// Relations beyond the factor base size to collect, each one gives another dependency with at least 1/2 chance to split n
+#define SIQS_EXTRA_RELS 64
+
+typedef struct{
+	uint32_t bits;
+	uint32_t fb_size;
+	uint32_t num_blocks;
+	uint32_t lp_mult;
+} siqs_Params;
+
+/// Tuning by bit length of kn.  Values in between are interpolated, the sieve interval is num_blocks*SIQS_BLOCK
+static const siqs_Params siqs_param_tbl[] = {
+	{ 40,   40, 1,  20},
+	{ 50,   60, 1,  30},
+	{ 60,   90, 1,  40},
+	{ 70,  130, 1,  50},
+	{ 80,  180, 1,  60},
+	{ 90,  260, 2,  70},
+	{100,  380, 2,  80},
+	{110,  600, 4,  90},
+	{120,  900, 6, 100},
+	{130, 1300, 8, 120}
+};
+
+typedef struct{
+	uint128_t u;
+	uint64_t lp;
+	uint32_t off, len;
+} siqs_Rel;
+
+/// Open addressing hash map from nonzero uint64 keys to uint64 values
+typedef struct{
+	uint64_t *keys, *vals;
+	uint64_t cap, len;
+} siqs_Map;
+
+typedef struct{
+	uint128_t n, kn;
+	uint64_t k;
+	uint32_t fb_size, sieve_start;
+	uint32_t *primes, *sqrts;
+	uint8_t *logp;
+	uint32_t s, a_lo, a_hi;
+	double a_target;
+	uint64_t M;
+	uint32_t num_blocks;
+	uint64_t lp_max;
+	uint8_t sieve_init;
+	pthread_mutex_t lock;
+	siqs_Rel *rels, *partials;
+	uint64_t num_rels, rels_cap, num_partials, partials_cap;
+	uint32_t *pool;
+	uint64_t pool_len, pool_cap;
+	siqs_Map lps, used_as;
+	uint64_t rels_needed;
+	bool done, failed;
+} siqs_State;
+
+typedef struct{
+	siqs_State *st;
+	uint32_t *ainv, *r1, *r2, *pos1, *pos2, *bainv2;
+	uint8_t *sieve;
+	uint32_t fac[256];
+} siqs_Worker;
+
+static inline uint128_t addmod128(uint128_t a, uint128_t b, uint128_t n){
+	return a >= n - b ? a - (n - b) : a + b;
+}
+
+static uint128_t mulmod128(uint128_t a, uint128_t b, uint128_t n){
+	a %= n;
+	b %= n;
+	if(!(n >> 64)){
+		return (uint128_t)(uint64_t)a*(uint64_t)b%n;
+	}
+	uint128_t r = 0;
+	for(int64_t i = 127; i >= 0; --i){
+		r = addmod128(r, r, n);
+		if((b >> i)&1){
+			r = addmod128(r, a, n);
+		}
+	}
+	return r;
+}
+
+static uint128_t powmod128(uint128_t b, uint64_t e, uint128_t n){
+	uint128_t r = 1;
+	for(b %= n; e; e >>= 1){
+		if(e&1){
+			r = mulmod128(r, b, n);
+		}
+		b = mulmod128(b, b, n);
+	}
+	return r;
+}
+
+static uint128_t gcd128(uint128_t a, uint128_t b){
+	while(b){
+		uint128_t t = a%b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+static uint128_t isqrt128(uint128_t n){
+	if(n < 2){
+		return n;
+	}
+	uint128_t x = (uint128_t)sqrt((double)n) + 1;
+	while(1){
+		uint128_t y = (x + n/x) >> 1;
+		if(y >= x){
+			break;
+		}
+		x = y;
+	}
+	while(x > n/x){
+		--x;
+	}
+	while(x + 1 <= n/(x + 1)){
+		++x;
+	}
+	return x;
+}
+
+static inline uint32_t mod128_u32(uint128_t v, uint32_t p){
+	return v >> 64 ? (uint32_t)(v%p) : (uint32_t)((uint64_t)v%p);
+}
+
+static bool siqs_Map_init(siqs_Map *self, uint64_t cap){
+	self->cap = cap;
+	self->len = 0;
+	self->keys = calloc(cap, sizeof(uint64_t));
+	self->vals = malloc(cap*sizeof(uint64_t));
+	if(!self->keys || !self->vals){
+		free(self->keys);
+		free(self->vals);
+		return false;
+	}
+	return true;
+}
+
+static void siqs_Map_destroy(siqs_Map *self){
+	free(self->keys);
+	free(self->vals);
+}
+
+/// Find the slot for key, which either holds key already or is empty
+static inline uint64_t siqs_Map_slot(const siqs_Map *self, uint64_t key){
+	uint64_t i = (key*0x9E3779B97F4A7C15ull) >> 17;
+	for(i &= self->cap - 1; self->keys[i] && self->keys[i] != key; i = (i + 1)&(self->cap - 1));
+	return i;
+}
+
+/// Insert key with value val if it is not present.
+/// @return pointer to the value for key if it was already present, NULL if it was inserted,
+/// and (uint64_t*)1 on allocation failure
+static uint64_t *siqs_Map_insert(siqs_Map *self, uint64_t key, uint64_t val){
+	uint64_t i = siqs_Map_slot(self, key);
+	if(self->keys[i]){
+		return self->vals + i;
+	}
+	if(2*(self->len + 1) > self->cap){
+		siqs_Map tmp;
+		if(!siqs_Map_init(&tmp, self->cap*2)){
+			return (uint64_t*)1;
+		}
+		for(uint64_t j = 0; j < self->cap; ++j){
+			if(self->keys[j]){
+				uint64_t k = siqs_Map_slot(&tmp, self->keys[j]);
+				tmp.keys[k] = self->keys[j];
+				tmp.vals[k] = self->vals[j];
+			}
+		}
+		tmp.len = self->len;
+		siqs_Map_destroy(self);
+		*self = tmp;
+		i = siqs_Map_slot(self, key);
+	}
+	self->keys[i] = key;
+	self->vals[i] = val;
+	++self->len;
+	return NULL;
+}
+
+static void siqs_params(uint32_t bits, siqs_Params *out){
+	const uint64_t len = sizeof(siqs_param_tbl)/sizeof(siqs_param_tbl[0]);
+	if(bits <= siqs_param_tbl[0].bits){
+		*out = siqs_param_tbl[0];
+		return;
+	}
+	for(uint64_t i = 1; i < len; ++i){
+		const siqs_Params *a = siqs_param_tbl + i - 1, *b = siqs_param_tbl + i;
+		if(bits <= b->bits){
+			uint32_t d = b->bits - a->bits, t = bits - a->bits;
+			out->bits = bits;
+			out->fb_size = a->fb_size + (b->fb_size - a->fb_size)*t/d;
+			out->num_blocks = t*2 < d ? a->num_blocks : b->num_blocks;
+			out->lp_mult = a->lp_mult + (b->lp_mult - a->lp_mult)*t/d;
+			return;
+		}
+	}
+	*out = siqs_param_tbl[len - 1];
+}
+
+/// Pick the Knuth-Schroeppel multiplier k maximizing the expected contribution of small primes to Q(x)
+static uint64_t siqs_choose_multiplier(uint128_t n, uint64_t num_primes, const uint64_t primes[static num_primes]){
+	static const uint8_t ks[] = {1, 3, 5, 7, 11, 13, 15, 17, 19, 21, 23, 29, 31, 33, 35, 37, 39, 41, 43, 47, 51, 53, 55, 57, 59, 61, 65, 67, 69, 71, 73};
+	double best_score = -INFINITY;
+	uint64_t best_k = 1;
+	for(uint64_t i = 0; i < sizeof(ks); ++i){
+		uint64_t k = ks[i];
+		if(n > ~(uint128_t)0/k){
+			break;
+		}
+		uint128_t kn = n*k;
+		double score = -0.5*log(k);
+		switch((uint64_t)kn&7){
+			case 1: score += 2*log(2); break;
+			case 5: score += log(2); break;
+			default: score += 0.5*log(2);
+		}
+		for(uint64_t j = 1; j < num_primes && primes[j] < 1000; ++j){
+			uint64_t p = primes[j];
+			uint64_t r = mod128_u32(kn, p);
+			if(!r){
+				score += log(p)/p;
+			}else if(nut_i64_jacobi(r, p) == 1){
+				score += 2*log(p)/(p - 1);
+			}
+		}
+		if(score > best_score){
+			best_score = score;
+			best_k = k;
+		}
+	}
+	return best_k;
+}
+
+/// Fill in the factor base for st->kn, or find a small factor of st->n
+/// @return 1 on success, 0 on allocation failure, or a nontrivial factor of n
+static uint128_t siqs_make_fb(siqs_State *st, uint32_t fb_size){
+	st->fb_size = fb_size;
+	st->primes = malloc(fb_size*sizeof(uint32_t));
+	st->sqrts = malloc(fb_size*sizeof(uint32_t));
+	st->logp = malloc(fb_size*sizeof(uint8_t));
+	if(!st->primes || !st->sqrts || !st->logp){
+		return 0;
+	}
+	st->primes[0] = 1;//stands in for -1
+	st->primes[1] = 2;
+	st->sqrts[0] = st->sqrts[1] = UINT32_MAX;
+	st->logp[0] = 0;
+	st->logp[1] = 1;
+	uint32_t i = 2;
+	for(uint64_t bound = 4*fb_size*(uint64_t)log(fb_size + 2) + 1000; i < fb_size; bound *= 2){
+		uint64_t num_primes;
+		uint64_t *primes = nut_sieve_primes(bound, &num_primes);
+		if(!primes){
+			return 0;
+		}
+		i = 2;
+		for(uint64_t j = 1; j < num_primes && i < fb_size; ++j){
+			uint32_t p = primes[j];
+			if(!mod128_u32(st->n, p)){
+				free(primes);
+				return p;
+			}
+			uint32_t r = mod128_u32(st->kn, p);
+			if(r && nut_i64_jacobi(r, p) != 1){
+				continue;
+			}
+			st->primes[i] = p;
+			st->sqrts[i] = r ? nut_i64_sqrt_mod(r, p) : UINT32_MAX;
+			st->logp[i] = (uint8_t)lround(log2(p));
+			++i;
+		}
+		free(primes);
+	}
+	for(st->sieve_start = 2; st->sieve_start < fb_size && st->primes[st->sieve_start] < SIQS_SMALL_PRIME; ++st->sieve_start);
+	return 1;
+}
+
+/// Decide how many primes s go into each A and which factor base primes they are drawn from
+static bool siqs_setup_a(siqs_State *st){
+	uint32_t first = st->sieve_start;
+	if(first + 8 >= st->fb_size){
+		return false;
+	}
+	double lt = log(st->a_target);
+	double lmin = log(st->primes[first]);
+	int64_t s = lround(lt/log(2000));
+	if(s < 2){
+		s = 2;
+	}
+	while(s > 1 && lt/s < lmin){
+		--s;
+	}
+	if(s > SIQS_MAX_S){
+		s = SIQS_MAX_S;
+	}
+	st->s = s;
+	double avg = exp(lt/s);
+	uint32_t lo = first, hi;
+	while(lo + 1 < st->fb_size && st->primes[lo] < avg/1.5){
+		++lo;
+	}
+	for(hi = lo; hi < st->fb_size && st->primes[hi] <= avg*1.5; ++hi);
+	while(hi - lo < st->s + 8){
+		if(hi < st->fb_size){
+			++hi;
+		}else if(lo > first){
+			--lo;
+		}else{
+			break;
+		}
+	}
+	st->a_lo = lo;
+	st->a_hi = hi;
+	return hi - lo > st->s;
+}
+
+/// Pick a new A which has not been used before and is close to the target size
+/// @return true on success, false if we could not find an unused A
+static bool siqs_choose_a(siqs_State *st, uint32_t qi[static SIQS_MAX_S], uint64_t *_A){
+	for(uint64_t tries = 0; tries < 1000; ++tries){
+		uint64_t A = 1;
+		uint32_t l = 0;
+		for(; l + 1 < st->s; ++l){
+			uint32_t idx;
+			bool dup;
+			do{
+				idx = nut_u64_prand(st->a_lo, st->a_hi);
+				dup = st->sqrts[idx] == UINT32_MAX;
+				for(uint32_t j = 0; j < l; ++j){
+					dup = dup || qi[j] == idx;
+				}
+			}while(dup);
+			qi[l] = idx;
+			A *= st->primes[idx];
+		}
+		uint32_t best = UINT32_MAX;
+		if(st->s == 1){
+			do{
+				best = nut_u64_prand(st->a_lo, st->a_hi);
+			}while(st->sqrts[best] == UINT32_MAX);
+		}else{
+			double want = st->a_target/A, best_err = INFINITY;
+			for(uint32_t i = st->sieve_start; i < st->fb_size; ++i){
+				double err = fabs(log(st->primes[i]/want));
+				if(err >= best_err){
+					if(st->primes[i] > want){
+						break;
+					}
+					continue;
+				}
+				bool dup = st->sqrts[i] == UINT32_MAX;
+				for(uint32_t j = 0; j < l; ++j){
+					dup = dup || qi[j] == i;
+				}
+				if(!dup){
+					best = i;
+					best_err = err;
+				}
+			}
+			if(best == UINT32_MAX){
+				continue;
+			}
+		}
+		qi[l] = best;
+		A *= st->primes[best];
+		pthread_mutex_lock(&st->lock);
+		uint64_t *res = siqs_Map_insert(&st->used_as, A, 0);
+		pthread_mutex_unlock(&st->lock);
+		if(res == (uint64_t*)1){
+			return false;
+		}else if(!res){
+			*_A = A;
+			return true;
+		}
+	}
+	return false;
+}
+
+/// Compute the B_l values for A, the roots of the first polynomial, and the root deltas for switching B.
+/// Roots are stored as offsets in the sieve interval [0, 2M) rather than as x values in [-M, M).
+/// @return the first B value
+static int128_t siqs_init_poly(const siqs_State *st, siqs_Worker *w, const uint32_t qi[static SIQS_MAX_S], uint64_t A, uint64_t Bl[static SIQS_MAX_S]){
+	int128_t B = 0;
+	for(uint32_t l = 0; l < st->s; ++l){
+		uint64_t q = st->primes[qi[l]];
+		uint64_t Aq = A/q;
+		uint64_t g = (uint64_t)st->sqrts[qi[l]]*nut_i64_mod(nut_i64_modinv(Aq%q, q), q)%q;
+		if(g > q/2){
+			g = q - g;
+		}
+		Bl[l] = Aq*g;
+		B += Bl[l];
+	}
+	for(uint32_t i = st->sieve_start; i < st->fb_size; ++i){
+		uint64_t p = st->primes[i];
+		uint64_t a = A%p;
+		if(!a || st->sqrts[i] == UINT32_MAX){
+			w->r1[i] = w->r2[i] = UINT32_MAX;
+			continue;
+		}
+		uint64_t ainv = nut_i64_mod(nut_i64_modinv(a, p), p);
+		uint64_t b = (uint64_t)(B%p);
+		uint64_t t = st->sqrts[i], m = st->M%p;
+		w->ainv[i] = ainv;
+		w->r1[i] = (ainv*((t + p - b)%p) + m)%p;
+		w->r2[i] = (ainv*((2*p - t - b)%p) + m)%p;
+		for(uint32_t l = 0; l + 1 < st->s; ++l){
+			w->bainv2[l*st->fb_size + i] = 2*(Bl[l]%p)*ainv%p;
+		}
+	}
+	return B;
+}
+
+static void siqs_add_rel(siqs_State *st, uint128_t u, uint64_t lp, const uint32_t fac[], uint32_t len){
+	pthread_mutex_lock(&st->lock);
+	if(st->done){
+		goto UNLOCK;
+	}
+	const siqs_Rel *other = NULL;
+	if(lp != 1){
+		uint64_t *res = siqs_Map_insert(&st->lps, lp, st->num_partials);
+		if(res == (uint64_t*)1){
+			st->failed = st->done = true;
+			goto UNLOCK;
+		}else if(res){
+			other = st->partials + *res;
+		}
+	}
+	uint32_t total_len = len + (other ? other->len : 0);
+	if(st->pool_len + total_len > st->pool_cap){
+		uint64_t new_cap = 2*st->pool_cap + total_len;
+		uint32_t *tmp = realloc(st->pool, new_cap*sizeof(uint32_t));
+		if(!tmp){
+			st->failed = st->done = true;
+			goto UNLOCK;
+		}
+		st->pool = tmp;
+		st->pool_cap = new_cap;
+	}
+	bool partial = lp != 1 && !other;
+	siqs_Rel **arr = partial ? &st->partials : &st->rels;
+	uint64_t *arr_len = partial ? &st->num_partials : &st->num_rels, *arr_cap = partial ? &st->partials_cap : &st->rels_cap;
+	if(*arr_len == *arr_cap){
+		uint64_t new_cap = 2**arr_cap + 64;
+		siqs_Rel *tmp = realloc(*arr, new_cap*sizeof(siqs_Rel));
+		if(!tmp){
+			st->failed = st->done = true;
+			goto UNLOCK;
+		}
+		*arr = tmp;
+		*arr_cap = new_cap;
+	}
+	siqs_Rel *rel = *arr + (*arr_len)++;
+	rel->u = u;
+	rel->lp = lp;
+	rel->off = st->pool_len;
+	rel->len = total_len;
+	memcpy(st->pool + st->pool_len, fac, len*sizeof(uint32_t));
+	st->pool_len += len;
+	if(other){
+		//(u1*u2)^2 = (stuff)*lp^2, so the combined relation contributes one factor of lp to the square root
+		rel->u = mulmod128(u, other->u, st->n);
+		memcpy(st->pool + st->pool_len, st->pool + other->off, other->len*sizeof(uint32_t));
+		st->pool_len += other->len;
+	}
+	if(st->num_rels >= st->rels_needed){
+		st->done = true;
+	}
+	UNLOCK:;
+	pthread_mutex_unlock(&st->lock);
+}
+
+/// Trial divide Q(x) for the sieve offset j and record the relation if it is smooth enough
+static void siqs_check(siqs_State *st, siqs_Worker *w, uint64_t A, int128_t B, int128_t C, const uint32_t qi[static SIQS_MAX_S], uint64_t j){
+	int64_t x = (int64_t)j - (int64_t)st->M;
+	int128_t q = ((int128_t)A*x + 2*B)*x + C;
+	uint32_t len = 0;
+	if(!q){
+		return;
+	}else if(q < 0){
+		w->fac[len++] = 0;
+		q = -q;
+	}
+	uint128_t v = q;
+	while(!(v&1)){
+		w->fac[len++] = 1;
+		v >>= 1;
+	}
+	for(uint32_t l = 0; l < st->s; ++l){
+		w->fac[len++] = qi[l];
+	}
+	for(uint32_t i = 2; i < st->fb_size; ++i){
+		uint32_t p = st->primes[i];
+		if(i >= st->sieve_start && w->r1[i] != UINT32_MAX){
+			uint32_t jm = j%p;
+			if(jm != w->r1[i] && jm != w->r2[i]){
+				continue;
+			}
+		}else if(mod128_u32(v, p)){
+			continue;
+		}
+		do{
+			if(len == sizeof(w->fac)/sizeof(w->fac[0])){
+				return;
+			}
+			w->fac[len++] = i;
+			v /= p;
+		}while(!mod128_u32(v, p));
+		if(v == 1){
+			break;
+		}
+	}
+	if(v > st->lp_max){
+		return;
+	}
+	int128_t u = (int128_t)A*x + B;
+	if(u < 0){
+		u = -u;
+	}
+	siqs_add_rel(st, (uint128_t)u%st->n, (uint64_t)v, w->fac, len);
+}
+
+static void siqs_sieve_poly(siqs_State *st, siqs_Worker *w, uint64_t A, int128_t B, int128_t C, const uint32_t qi[static SIQS_MAX_S]){
+	for(uint32_t i = st->sieve_start; i < st->fb_size; ++i){
+		w->pos1[i] = w->r1[i];
+		w->pos2[i] = w->r2[i];
+	}
+	for(uint32_t blk = 0; blk < st->num_blocks; ++blk){
+		uint8_t *sieve = w->sieve;
+		memset(sieve, st->sieve_init, SIQS_BLOCK);
+		for(uint32_t i = st->sieve_start; i < st->fb_size; ++i){
+			uint32_t a = w->pos1[i], b = w->pos2[i];
+			if(a == UINT32_MAX){
+				continue;
+			}
+			uint32_t p = st->primes[i];
+			uint8_t lg = st->logp[i];
+			for(; a < SIQS_BLOCK; a += p){
+				sieve[a] += lg;
+			}
+			for(; b < SIQS_BLOCK; b += p){
+				sieve[b] += lg;
+			}
+			w->pos1[i] = a - SIQS_BLOCK;
+			w->pos2[i] = b - SIQS_BLOCK;
+		}
+		const uint64_t *words = (const uint64_t*)sieve;
+		for(uint32_t k = 0; k < SIQS_BLOCK/8; ++k){
+			uint64_t hits = words[k]&0x8080808080808080ull;
+			while(hits){
+				uint32_t b = __builtin_ctzll(hits)/8;
+				hits &= hits - 1;
+				siqs_check(st, w, A, B, C, qi, (uint64_t)blk*SIQS_BLOCK + 8*k + b);
+			}
+		}
+	}
+}
+
+static void *siqs_worker(void *_w){
+	siqs_Worker *w = _w;
+	siqs_State *st = w->st;
+	uint32_t qi[SIQS_MAX_S];
+	uint64_t Bl[SIQS_MAX_S];
+	while(!__atomic_load_n(&st->done, __ATOMIC_RELAXED)){
+		uint64_t A;
+		if(!siqs_choose_a(st, qi, &A)){
+			pthread_mutex_lock(&st->lock);
+			st->failed = st->done = true;
+			pthread_mutex_unlock(&st->lock);
+			break;
+		}
+		int128_t B = siqs_init_poly(st, w, qi, A, Bl);
+		for(uint64_t j = 1;; ++j){
+			int128_t C = -(int128_t)((st->kn - (uint128_t)(B*B))/A);
+			siqs_sieve_poly(st, w, A, B, C, qi);
+			if(j >= 1ull << (st->s - 1) || __atomic_load_n(&st->done, __ATOMIC_RELAXED)){
+				break;
+			}
+			//gray code: flip the sign of B_v, where v is the lowest set bit of j
+			uint32_t v = __builtin_ctzll(j);
+			bool neg = ((j ^ (j >> 1)) >> v)&1;
+			const uint32_t *delta = w->bainv2 + v*st->fb_size;
+			if(neg){
+				B -= 2*(int128_t)Bl[v];
+			}else{
+				B += 2*(int128_t)Bl[v];
+			}
+			for(uint32_t i = st->sieve_start; i < st->fb_size; ++i){
+				if(w->r1[i] == UINT32_MAX){
+					continue;
+				}
+				uint32_t p = st->primes[i], d = neg ? delta[i] : p - delta[i];
+				uint32_t a = w->r1[i] + d, b = w->r2[i] + d;
+				w->r1[i] = a >= p ? a - p : a;
+				w->r2[i] = b >= p ? b - p : b;
+			}
+		}
+	}
+	return NULL;
+}
+
+static bool siqs_Worker_init(siqs_Worker *w, siqs_State *st){
+	uint32_t F = st->fb_size;
+	w->st = st;
+	w->ainv = malloc(F*sizeof(uint32_t));
+	w->r1 = malloc(F*sizeof(uint32_t));
+	w->r2 = malloc(F*sizeof(uint32_t));
+	w->pos1 = malloc(F*sizeof(uint32_t));
+	w->pos2 = malloc(F*sizeof(uint32_t));
+	w->bainv2 = malloc(((st->s > 1 ? st->s - 1 : 0)*F + 1)*sizeof(uint32_t));
+	w->sieve = aligned_alloc(64, SIQS_BLOCK);
+	return w->ainv && w->r1 && w->r2 && w->pos1 && w->pos2 && w->bainv2 && w->sieve;
+}
+
+static void siqs_Worker_destroy(siqs_Worker *w){
+	free(w->ainv);
+	free(w->r1);
+	free(w->r2);
+	free(w->pos1);
+	free(w->pos2);
+	free(w->bainv2);
+	free(w->sieve);
+}
+
+/// Find dependencies among the first rels_needed relations and try them until one splits n
+static uint128_t siqs_linalg(siqs_State *st){
+	uint64_t R = st->rels_needed, F = st->fb_size;
+	uint64_t fw = (F + 63)/64, hw = (R + 63)/64, rw = fw + hw;
+	uint64_t *mat = calloc(R*rw, sizeof(uint64_t));
+	uint8_t *pivoted = calloc(R, sizeof(uint8_t));
+	uint32_t *exps = malloc(F*sizeof(uint32_t));
+	uint128_t res = 1;
+	if(!mat || !pivoted || !exps){
+		goto CLEANUP;
+	}
+	for(uint64_t r = 0; r < R; ++r){
+		uint64_t *row = mat + r*rw;
+		const siqs_Rel *rel = st->rels + r;
+		for(uint32_t j = 0; j < rel->len; ++j){
+			uint32_t i = st->pool[rel->off + j];
+			row[i/64] ^= 1ull << (i%64);
+		}
+		row[fw + r/64] |= 1ull << (r%64);
+	}
+	for(uint64_t c = 0; c < F; ++c){
+		uint64_t piv = R;
+		for(uint64_t r = 0; r < R; ++r){
+			if(!pivoted[r] && (mat[r*rw + c/64] >> (c%64))&1){
+				piv = r;
+				break;
+			}
+		}
+		if(piv == R){
+			continue;
+		}
+		pivoted[piv] = 1;
+		const uint64_t *prow = mat + piv*rw;
+		for(uint64_t r = piv + 1; r < R; ++r){
+			uint64_t *row = mat + r*rw;
+			if(!pivoted[r] && (row[c/64] >> (c%64))&1){
+				for(uint64_t k = c/64; k < rw; ++k){
+					row[k] ^= prow[k];
+				}
+			}
+		}
+	}
+	for(uint64_t r = 0; r < R && res == 1; ++r){
+		if(pivoted[r]){
+			continue;
+		}
+		const uint64_t *hist = mat + r*rw + fw;
+		uint128_t X = 1, Y = 1;
+		memset(exps, 0, F*sizeof(uint32_t));
+		for(uint64_t t = 0; t < R; ++t){
+			if(!((hist[t/64] >> (t%64))&1)){
+				continue;
+			}
+			const siqs_Rel *rel = st->rels + t;
+			X = mulmod128(X, rel->u, st->n);
+			if(rel->lp != 1){
+				Y = mulmod128(Y, rel->lp, st->n);
+			}
+			for(uint32_t j = 0; j < rel->len; ++j){
+				++exps[st->pool[rel->off + j]];
+			}
+		}
+		bool ok = true;
+		for(uint64_t i = 1; i < F; ++i){
+			ok = ok && !(exps[i]&1);
+			if(exps[i]){
+				Y = mulmod128(Y, powmod128(st->primes[i], exps[i]/2, st->n), st->n);
+			}
+		}
+		if(!ok){
+			continue;
+		}
+		uint128_t g = gcd128(X >= Y ? X - Y : Y - X, st->n);
+		if(g != 1 && g != st->n){
+			res = g;
+		}
+	}
+	CLEANUP:;
+	free(mat);
+	free(pivoted);
+	free(exps);
+	return res;
+}
+
+uint128_t nut_u128_factor1_siqs(uint128_t n, uint64_t num_threads){
+	if(n < 4){
+		return 1;
+	}else if(!(n&1)){
+		return 2;
+	}
+	uint128_t r = isqrt128(n);
+	if(r*r == n){
+		return r;
+	}
+	uint64_t num_small_primes;
+	uint64_t *small_primes = nut_sieve_primes(1000, &num_small_primes);
+	if(!small_primes){
+		return 1;
+	}
+	siqs_State st = {.n = n};
+	st.k = siqs_choose_multiplier(n, num_small_primes, small_primes);
+	free(small_primes);
+	st.kn = n*st.k;
+	uint32_t bits = 128 - (st.kn >> 64 ? __builtin_clzll(st.kn >> 64) : 64 + __builtin_clzll(st.kn));
+	siqs_Params params;
+	siqs_params(bits, &params);
+	uint128_t res = siqs_make_fb(&st, params.fb_size);
+	if(res != 1){
+		res = res ?: 1;
+		goto CLEANUP_FB;
+	}
+	st.num_blocks = params.num_blocks;
+	st.M = (uint64_t)st.num_blocks*SIQS_BLOCK/2;
+	st.a_target = sqrt(2*(double)st.kn)/st.M;
+	uint64_t pmax = st.primes[st.fb_size - 1];
+	st.lp_max = pmax*params.lp_mult;
+	if(st.lp_max >= pmax*pmax){
+		st.lp_max = pmax*pmax - 1;
+	}
+	double small_corr = 1;
+	for(uint32_t i = 2; i < st.sieve_start; ++i){
+		small_corr += 2*log2(st.primes[i])/(st.primes[i] - 1);
+	}
+	double thresh = log2(st.M) + 0.5*log2((double)st.kn) - 0.5 - log2(st.lp_max) - small_corr;
+	if(thresh < 8){
+		thresh = 8;
+	}else if(thresh > 127){
+		thresh = 127;
+	}
+	st.sieve_init = 128 - (uint8_t)lround(thresh);
+	if(!siqs_setup_a(&st)){
+		goto CLEANUP_FB;
+	}
+	st.rels_needed = st.fb_size + SIQS_EXTRA_RELS;
+	if(!siqs_Map_init(&st.lps, 1024)){
+		goto CLEANUP_FB;
+	}
+	if(!siqs_Map_init(&st.used_as, 256)){
+		goto CLEANUP_LPS;
+	}
+	if(pthread_mutex_init(&st.lock, NULL)){
+		goto CLEANUP_AS;
+	}
+	if(!num_threads){
+		num_threads = 1;
+	}
+	siqs_Worker *workers = calloc(num_threads, sizeof(siqs_Worker));
+	pthread_t *threads = calloc(num_threads, sizeof(pthread_t));
+	bool *started = calloc(num_threads, sizeof(bool));
+	if(!workers || !threads || !started){
+		goto CLEANUP_WORKERS;
+	}
+	uint64_t num_workers = 0;
+	for(; num_workers < num_threads; ++num_workers){
+		if(!siqs_Worker_init(workers + num_workers, &st)){
+			siqs_Worker_destroy(workers + num_workers);
+			break;
+		}
+	}
+	if(!num_workers){
+		goto CLEANUP_WORKERS;
+	}
+	for(uint64_t i = 1; i < num_workers; ++i){
+		started[i] = !pthread_create(threads + i, NULL, siqs_worker, workers + i);
+	}
+	siqs_worker(workers);
+	for(uint64_t i = 1; i < num_workers; ++i){
+		if(started[i]){
+			pthread_join(threads[i], NULL);
+		}
+	}
+	if(!st.failed && st.num_rels >= st.rels_needed){
+		res = siqs_linalg(&st);
+	}
+	for(uint64_t i = 0; i < num_workers; ++i){
+		siqs_Worker_destroy(workers + i);
+	}
+	CLEANUP_WORKERS:;
+	free(workers);
+	free(threads);
+	free(started);
+	pthread_mutex_destroy(&st.lock);
+	CLEANUP_AS:;
+	siqs_Map_destroy(&st.used_as);
+	CLEANUP_LPS:;
+	siqs_Map_destroy(&st.lps);
+	CLEANUP_FB:;
+	free(st.rels);
+	free(st.partials);
+	free(st.pool);
+	free(st.primes);
+	free(st.sqrts);
+	free(st.logp);
+	return res;
+}
@@ -218,17 +218,19 @@ uint32_t *nut_sieve_smallest_factors_wheel6(uint64_t max){
 				}
 			}
 		}
-		idx += 1;
-		if(qn){
+		if(!buf[2*qn]){
+			buf[2*qn] = 1;
 		}
-		buf[2*qn] = 1;
 		if(buf[2*qn + 1]){
+			idx += 1;
 			continue;
 		}
 		p += 4;
 		if(p > rmax){
+			// leave 6*qn + 5 for the final pass, it may be prime
 			break;
 		}
+		idx += 1;
 		for(uint64_t qk = qn; qk <= (max/p - 1)/6; ++qk){
 			if(qk > qn){
 				uint64_t idx = 2*(p*qk + qn) + 1;
@@ -411,17 +413,14 @@ bool nut_u64_make_factorial_tbl(uint64_t k, uint64_t modulus, uint64_t bits, uin
 	for(uint64_t i = 1; i < bits + k; ++i){
 		factorials[i] = factorials[i - 1]*i%modulus;
 	}
-	memcpy(inv_factorials, factorials, 2*sizeof(uint64_t));
-	for(uint64_t i = 2; i <= max_denom; ++i){
-		int64_t inv;
-		if(nut_i64_egcd(factorials[i], modulus, &inv, NULL) != 1){
-			return false;
-		}else if(inv < 0){
-			inv_factorials[i] = inv + (int64_t)modulus;
-		}else{
-			inv_factorials[i] = inv;
-		}
+	// only the largest factorial needs to be inverted, the rest follow from 1/(i-1)! = i/i!
+	if(!nut_u64_modinv_batch(modulus, 1, factorials + max_denom, inv_factorials + max_denom)){
+		return false;
+	}
+	for(uint64_t i = max_denom; i > 1; --i){
+		inv_factorials[i - 1] = (uint128_t)inv_factorials[i]*i%modulus;
 	}
+	inv_factorials[0] = 1;
 	return true;
 }
 
@@ -0,0 +1,91 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <nut/modular_math.h>
+#include <nut/factorization.h>
+#include <nut/dirichlet.h>
+#include <nut/debug.h>
+
+// only the bounds of the table matter, so the buffer is never allocated
+static bool test_index(int64_t x, int64_t y, uint64_t samples){
+	nut_Diri tbl = {.x = x, .y = y};
+	if(tbl.y < (int64_t)nut_u64_nth_root(x, 2)){
+		tbl.y = nut_u64_nth_root(x, 2);
+	}
+	tbl.yinv = x/tbl.y + 1;
+	nut_DiriIndex idx [[gnu::cleanup(nut_DiriIndex_destroy)]] = {};
+	if(!nut_DiriIndex_init(&idx, &tbl)){
+		check_alloc("quotient index", NULL);
+	}
+	bool passed = idx.n_max == (int64_t)nut_u64_nth_root(x, 2);
+	for(int64_t i = 1; passed && i < tbl.yinv; ++i){
+		passed = idx.v[i] == x/i;
+		passed = passed && (x/i > tbl.y) == (i < idx.k_dense);
+	}
+	for(uint64_t s = 0; passed && s < samples; ++s){
+		int64_t v = nut_u64_prand(0, x + 1), n = nut_u64_prand(1, idx.n_max + 1);
+		// also hit the edges, where v is a multiple of n or one less than one
+		int64_t w = v/n*n, w1 = w ? w - 1 : 0;
+		passed = nut_DiriIndex_quot(&idx, v, n) == v/n && nut_DiriIndex_quot(&idx, w, n) == w/n && nut_DiriIndex_quot(&idx, w1, n) == w1/n;
+		passed = passed && nut_DiriIndex_quot(&idx, x, n) == x/n;
+	}
+	if(!passed){
+		fprintf(stderr, "\e[1;31mQuotient index is wrong for x = %"PRIi64", y = %"PRIi64"\e[0m\n", x, y);
+	}
+	return passed;
+}
+
+static bool test_quotient_it(int64_t x, int64_t i_max, int64_t stride){
+	nut_QuotientIt it;
+	bool passed = true;
+	for(nut_QuotientIt_init(&it, x, 1, true); passed && it.i <= i_max; nut_QuotientIt_advance(&it, stride)){
+		passed = it.v == x/it.i && it.vr == (int64_t)nut_u64_nth_root(it.v, 2) && it.vc == (int64_t)nut_u64_nth_root(it.v, 3);
+	}
+	for(nut_QuotientIt_init(&it, x, i_max, true); passed && it.i >= 1; nut_QuotientIt_advance(&it, -stride)){
+		passed = it.v == x/it.i && it.vr == (int64_t)nut_u64_nth_root(it.v, 2) && it.vc == (int64_t)nut_u64_nth_root(it.v, 3);
+	}
+	if(!passed){
+		fprintf(stderr, "\e[1;31mQuotient iterator is wrong for x = %"PRIi64" at i = %"PRIi64"\e[0m\n", x, it.i);
+	}
+	return passed;
+}
+
+static bool test_roots_from(uint64_t samples){
+	bool passed = true;
+	for(uint64_t s = 0; passed && s < samples; ++s){
+		uint64_t a = nut_u64_prand(0, UINT64_MAX) >> nut_u64_prand(1, 64);
+		uint64_t r = nut_u64_nth_root(a, 2), c = nut_u64_nth_root(a, 3);
+		// guesses near the root, and far from it in both directions
+		uint64_t r_guess = (s&3) == 0 ? r + 1 : (s&3) == 1 ? (r > 0 ? r - 1 : 0) : (s&3) == 2 ? r/3 + 1 : r < UINT32_MAX/2 ? r*2 + 5 : UINT32_MAX;
+		uint64_t c_guess = (s&3) == 0 ? c + 1 : (s&3) == 1 ? (c > 0 ? c - 1 : 0) : (s&3) == 2 ? c/3 + 1 : c < (1u << 20) ? c*2 + 5 : 1u << 21;
+		passed = nut_u64_sqrt_from(a, r_guess) == r && nut_u64_cbrt_from(a, c_guess) == c;
+		passed = passed && nut_u64_sqrt_from(a, r) == r && nut_u64_cbrt_from(a, c) == c;
+	}
+	if(!passed){
+		fprintf(stderr, "\e[1;31mRoots from a guess are wrong\e[0m\n");
+	}
+	return passed;
+}
+
+int main(){
+	static const int64_t xs[] = {1, 2, 10, 1000, 123456789, 10000000000, INT64_C(1) << 40, (INT64_C(1) << 44) - 1};
+	uint64_t passed = 0, trials = 0;
+	for(uint64_t i = 0; i < sizeof(xs)/sizeof(*xs); ++i, trials += 2){
+		int64_t x = xs[i];
+		passed += test_index(x, 0, 100000);
+		passed += test_index(x, nut_u64_nth_root(x, 3)*nut_u64_nth_root(x, 3), 100000);
+	}
+	print_summary("quotient index", passed, trials);
+	passed = trials = 0;
+	passed += test_roots_from(1000000);
+	++trials;
+	static const int64_t strides[] = {1, 2, 3, 7};
+	for(uint64_t i = 0; i < sizeof(xs)/sizeof(*xs); ++i, trials += 4){
+		int64_t x = xs[i], i_max = nut_u64_nth_root(x, 2);
+		for(uint64_t j = 0; j < 4; ++j){
+			passed += test_quotient_it(x, i_max < 100000 ? i_max : 100000, strides[j]);
+		}
+	}
+	print_summary("quotient iterator", passed, trials);
+}
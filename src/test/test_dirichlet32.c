@@ -0,0 +1,95 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <nut/modular_math.h>
+#include <nut/factorization.h>
+#include <nut/dirichlet.h>
+#include <nut/dirichlet32.h>
+#include <nut/debug.h>
+
+static void init_diri(nut_Diri *self, nut_Diri32 *compact, int64_t x, int64_t m){
+	if(!nut_Diri_init(self, x, nut_u64_nth_root(x, 3)*nut_u64_nth_root(x, 3)) || !nut_Diri32_init(compact, x, self->y)){
+		check_alloc("diri table", NULL);
+	}
+	for(int64_t i = 0; i < self->y + self->yinv; ++i){
+		self->buf[i] = nut_u64_prand(0, m);
+	}
+	self->buf[1] = 1;
+	nut_Diri32_from_Diri(compact, m, self);
+}
+
+static bool diri_eq(const nut_Diri *a, const nut_Diri32 *b){
+	for(int64_t i = 1; i < a->y + a->yinv; ++i){
+		if(a->buf[i] != b->buf[i]){
+			return false;
+		}
+	}
+	return true;
+}
+
+static uint64_t test_conv(int64_t x, int64_t m, const nut_EulerCtx *ctx){
+	nut_Diri f [[gnu::cleanup(nut_Diri_destroy)]], g [[gnu::cleanup(nut_Diri_destroy)]], h [[gnu::cleanup(nut_Diri_destroy)]];
+	nut_Diri32 f32 [[gnu::cleanup(nut_Diri32_destroy)]], g32 [[gnu::cleanup(nut_Diri32_destroy)]], h32 [[gnu::cleanup(nut_Diri32_destroy)]];
+	init_diri(&f, &f32, x, m);
+	init_diri(&g, &g32, x, m);
+	init_diri(&h, &h32, x, m);
+	uint64_t passed = 0;
+	passed += nut_Diri_compute_conv_u(&h, m, &f) && nut_Diri32_compute_conv_u(&h32, m, &f32, ctx) && diri_eq(&h, &h32);
+	passed += nut_Diri_compute_conv_N(&h, m, &f) && nut_Diri32_compute_conv_N(&h32, m, &f32, ctx) && diri_eq(&h, &h32);
+	passed += nut_Diri_compute_conv(&h, m, &f, &g) && nut_Diri32_compute_conv(&h32, m, &f32, &g32, ctx) && diri_eq(&h, &h32);
+	passed += nut_Diri_convdiv(&h, m, &f, &g) && nut_Diri32_convdiv(&h32, m, &f32, &g32) && diri_eq(&h, &h32);
+	if(passed != 4){
+		fprintf(stderr, "\e[1;31mCompact table differs from nut_Diri for x = %"PRIi64", m = %"PRIi64"\e[0m\n", x, m);
+	}
+	return passed;
+}
+
+static bool test_basic(int64_t x, int64_t m){
+	nut_Diri d [[gnu::cleanup(nut_Diri_destroy)]], u [[gnu::cleanup(nut_Diri_destroy)]];
+	nut_Diri32 d32 [[gnu::cleanup(nut_Diri32_destroy)]], u32 [[gnu::cleanup(nut_Diri32_destroy)]], w32 [[gnu::cleanup(nut_Diri32_destroy)]];
+	init_diri(&d, &d32, x, m);
+	init_diri(&u, &u32, x, m);
+	if(!nut_Diri32_init(&w32, x, d.y)){
+		check_alloc("diri table", NULL);
+	}
+	bool passed = true;
+	nut_Diri_compute_u(&u, m);
+	nut_Diri32_compute_u(&u32, m);
+	passed = passed && diri_eq(&u, &u32);
+	nut_Diri_compute_N(&u, m);
+	nut_Diri32_compute_N(&u32, m);
+	passed = passed && diri_eq(&u, &u32);
+	// d = u <*> u, and d </> u = u
+	nut_Diri32_compute_u(&u32, m);
+	passed = passed && nut_Diri32_compute_conv_u(&d32, m, &u32, NULL);
+	passed = passed && nut_Diri32_get_sparse(&d32, 1) == nut_dirichlet_D(x, m);
+	passed = passed && nut_Diri32_convdiv(&w32, m, &d32, &u32) && !memcmp(w32.buf + 1, u32.buf + 1, (u32.y + u32.yinv - 1)*sizeof(uint32_t));
+	// round trip through a wide table
+	passed = passed && nut_Diri32_to_Diri(&d, &d32) && diri_eq(&d, &d32);
+	passed = passed && !nut_Diri32_compute_conv_u(&d32, NUT_DIRI32_MAX_MODULUS + 1, &u32, NULL);
+	if(!passed){
+		fprintf(stderr, "\e[1;31mBasic compact table functions failed for x = %"PRIi64", m = %"PRIi64"\e[0m\n", x, m);
+	}
+	return passed;
+}
+
+int main(){
+	static const int64_t moduli[] = {1000000007, 998244353, 2147483647, INT64_C(1) << 31, 1000003};
+	int64_t x = 100000000;
+	nut_EulerCtx ctx [[gnu::cleanup(nut_EulerCtx_destroy)]] = {};
+	if(!nut_EulerCtx_init(&ctx, nut_u64_nth_root(x, 3)*nut_u64_nth_root(x, 3))){
+		check_alloc("euler ctx", NULL);
+	}
+	uint64_t passed = 0, trials = 0;
+	for(uint64_t i = 0; i < 5; ++i, trials += 4){
+		passed += test_conv(x, moduli[i], i%2 ? NULL : &ctx);
+	}
+	print_summary("compact dirichlet convolutions", passed, trials);
+	passed = trials = 0;
+	for(uint64_t i = 0; i < 5; ++i, ++trials){
+		passed += test_basic(10000000, moduli[i]);
+	}
+	print_summary("compact dirichlet tables", passed, trials);
+}
@@ -0,0 +1,82 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <nut/modular_math.h>
+#include <nut/factorization.h>
+#include <nut/dirichlet.h>
+#include <nut/dirichlet_cost.h>
+#include <nut/debug.h>
+
+static double predict_mix(const nut_DiriOpMix *mix, int64_t x, int64_t y){
+	double res = 0;
+	for(uint64_t op = 0; op < NUT_DIRI_NUM_OPS; ++op){
+		res += mix->weight[op]*nut_DiriCostModel_predict(&nut_diri_default_cost_model, op, mix->m, x, y);
+	}
+	return res;
+}
+
+static bool fits(int64_t x, int64_t y, size_t mem_budget){
+	return !mem_budget || (uint64_t)(y + x/y + 1)*sizeof(int64_t) <= mem_budget;
+}
+
+// the chosen y should be in range and beat its neighbors and the usual choices of sqrt(x) and x^(2/3), when they fit
+static bool check_choice(int64_t x, const nut_DiriOpMix *mix, size_t mem_budget){
+	int64_t y = nut_Diri_auto_y(x, mix, mem_budget, NULL);
+	int64_t ymin = nut_u64_nth_root(x, 2), y23 = nut_u64_nth_root(x, 3)*nut_u64_nth_root(x, 3);
+	if(!y){
+		return !fits(x, ymin, mem_budget);
+	}
+	double cost = predict_mix(mix, x, y)*(1 - 1e-9);
+	bool ok = y >= ymin && y <= x && fits(x, y, mem_budget) && cost <= predict_mix(mix, x, ymin);
+	static const int64_t scales[][2] = {{11, 10}, {10, 11}};
+	for(uint64_t i = 0; i < 2; ++i){
+		int64_t y1 = y*scales[i][0]/scales[i][1];
+		ok = ok && (y1 < ymin || !fits(x, y1, mem_budget) || cost <= predict_mix(mix, x, y1));
+	}
+	ok = ok && (!fits(x, y23, mem_budget) || cost <= predict_mix(mix, x, y23));
+	if(!ok){
+		fprintf(stderr, "\e[1;31mBad choice y = %"PRIi64" for x = %"PRIi64"\e[0m\n", y, x);
+	}
+	return ok;
+}
+
+int main(){
+	uint64_t passed = 0, trials = 0;
+	nut_DiriOpMix conv = {.weight = {[NUT_DIRI_OP_CONV_U] = 3, [NUT_DIRI_OP_CONV] = 1}, .m = 1000000007};
+	nut_DiriOpMix pi = {.weight = {[NUT_DIRI_OP_PI] = 1}};
+	nut_DiriOpMix mixed = {.weight = {[NUT_DIRI_OP_PI] = 1, [NUT_DIRI_OP_CONVDIV] = 2, [NUT_DIRI_OP_MERTENS] = 1}};
+	for(int64_t x = 1000; x <= 1000000000000000; x *= 1000){
+		passed += check_choice(x, &conv, 0) + check_choice(x, &pi, 0) + check_choice(x, &mixed, 0);
+		passed += check_choice(x, &conv, 1 << 20) + check_choice(x, &mixed, 1 << 24);
+		trials += 5;
+	}
+	// pi wants a much smaller y than the convolutions
+	passed += nut_Diri_auto_y(1000000000000, &pi, 0, NULL) < nut_Diri_auto_y(1000000000000, &conv, 0, NULL);
+	// a budget too small even for sqrt(x) fails
+	nut_Diri tbl [[gnu::cleanup(nut_Diri_destroy)]] = {};
+	passed += !nut_Diri_auto_y(1000000000000, &conv, 1000, NULL) && !nut_Diri_init_auto(&tbl, 1000000000000, &conv, 1000, NULL);
+	passed += nut_Diri_init_auto(&tbl, 1000000000, &conv, 0, NULL) && tbl.y == nut_Diri_auto_y(1000000000, &conv, 0, NULL);
+	trials += 3;
+	print_summary("dense cutoffs from the cost model", passed, trials);
+
+	passed = trials = 0;
+	static const char *path = "/tmp/nut_test_dirichlet_cost.txt";
+	nut_DiriCostModel model, loaded;
+	bool ok = nut_DiriCostModel_calibrate(&model, 10000000);
+	for(uint64_t op = 0; ok && op < NUT_DIRI_NUM_OPS; ++op){
+		ok = model.dense[op][0] > 0 && model.dense[op][1] > 0 && model.sparse[op][0] > 0 && model.sparse[op][1] > 0;
+	}
+	passed += ok;
+	passed += nut_DiriCostModel_save(&model, path) && nut_DiriCostModel_load(&loaded, path) && !memcmp(&model, &loaded, sizeof(model));
+	FILE *file = fopen(path, "w");
+	if(file){
+		fprintf(file, "nut_DiriCostModel 1\nconv 1 2 3\n");
+		fclose(file);
+	}
+	passed += !nut_DiriCostModel_load(&loaded, path) && !nut_DiriCostModel_load(&loaded, "/tmp/nut_test_dirichlet_cost.missing");
+	trials += 3;
+	remove(path);
+	print_summary("calibrated cost models", passed, trials);
+}
@@ -0,0 +1,94 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <nut/modular_math.h>
+#include <nut/factorization.h>
+#include <nut/dirichlet.h>
+#include <nut/dirichlet_crt.h>
+#include <nut/debug.h>
+
+static bool compute_N3(nut_Diri *restrict out, int64_t m, void *data){
+	return nut_Diri_compute_Nk(out, 3, m);
+}
+
+typedef struct{
+	uint64_t k;
+} DkData;
+
+static bool compute_dk(nut_Diri *restrict out, int64_t m, void *_data){
+	const DkData *data = _data;
+	nut_Diri f_tbl [[gnu::cleanup(nut_Diri_destroy)]] = {};
+	nut_Diri g_tbl [[gnu::cleanup(nut_Diri_destroy)]] = {};
+	return nut_Diri_init(&f_tbl, out->x, out->y) && nut_Diri_init(&g_tbl, out->x, out->y) &&
+		nut_Diri_compute_dk(out, data->k, m, &f_tbl, &g_tbl);
+}
+
+// Mertens function, as I/u, which has negative entries
+static bool compute_mertens(nut_Diri *restrict out, int64_t m, void *data){
+	nut_Diri I_tbl [[gnu::cleanup(nut_Diri_destroy)]] = {};
+	nut_Diri u_tbl [[gnu::cleanup(nut_Diri_destroy)]] = {};
+	if(!nut_Diri_init(&I_tbl, out->x, out->y) || !nut_Diri_init(&u_tbl, out->x, out->y)){
+		return false;
+	}
+	nut_Diri_compute_I(&I_tbl);
+	nut_Diri_compute_u(&u_tbl, m);
+	return nut_Diri_convdiv(out, m, &I_tbl, &u_tbl);
+}
+
+// sum(n^3, n <= v) = (v(v + 1)/2)^2 is well past 2^64, so check it against the closed form in 128 bits
+static bool test_N3(int64_t x, uint64_t num_threads){
+	nut_Diri128 tbl [[gnu::cleanup(nut_Diri128_destroy)]] = {};
+	if(!nut_Diri128_init(&tbl, x, 0)){
+		check_alloc("128 bit table", NULL);
+	}
+	bool passed = nut_Diri128_compute_exact(&tbl, nut_Diri_log2_bound_Nk(x, 3), compute_N3, NULL, num_threads);
+	for(int64_t n = 1; passed && n <= tbl.y; ++n){
+		passed = nut_Diri128_get_dense(&tbl, n) == (int128_t)n*n*n;
+	}
+	for(int64_t i = 1; passed && i < tbl.yinv; ++i){
+		int128_t v = x/i, t = v*(v + 1)/2;
+		passed = nut_Diri128_get_sparse(&tbl, i) == t*t;
+	}
+	if(!passed){
+		fprintf(stderr, "\e[1;31mExact sums of n^3 are wrong for x = %"PRIi64"\e[0m\n", x);
+	}
+	return passed;
+}
+
+// when nothing overflows, the exact table has to match the one computed with m = 0
+static bool test_against_m0(int64_t x, nut_Diri_mod_fn fn, void *data, double log2_bound){
+	nut_Diri128 tbl [[gnu::cleanup(nut_Diri128_destroy)]] = {};
+	nut_Diri ref [[gnu::cleanup(nut_Diri_destroy)]] = {};
+	if(!nut_Diri128_init(&tbl, x, 0) || !nut_Diri_init(&ref, x, 0)){
+		check_alloc("tables", NULL);
+	}
+	bool passed = fn(&ref, 0, data) && nut_Diri128_compute_exact(&tbl, log2_bound, fn, data, 0);
+	for(int64_t n = 1; passed && n < tbl.y + tbl.yinv; ++n){
+		passed = tbl.buf[n] == ref.buf[n];
+	}
+	if(!passed){
+		fprintf(stderr, "\e[1;31mExact table differs from the m = 0 table for x = %"PRIi64"\e[0m\n", x);
+	}
+	return passed;
+}
+
+int main(){
+	uint64_t passed = 0, trials = 0;
+	passed += nut_Diri_crt_num_moduli(40) == 2 && nut_Diri_crt_num_moduli(62) == 3 && nut_Diri_crt_num_moduli(120) == 4;
+	passed += nut_Diri_crt_num_moduli(130) == 0;
+	trials += 2;
+	print_summary("crt moduli estimates", passed, trials);
+	passed = trials = 0;
+	for(uint64_t t = 1; t <= 4; ++t, ++trials){
+		passed += test_N3(10000000, t);
+	}
+	print_summary("exact sums of n^3", passed, trials);
+	passed = trials = 0;
+	DkData data = {.k = 4};
+	passed += test_against_m0(100000000, compute_dk, &data, nut_Diri_log2_bound_dk(100000000, 4));
+	passed += test_against_m0(100000000, compute_mertens, NULL, log2(100000000));
+	trials += 2;
+	print_summary("exact tables against m = 0", passed, trials);
+}
@@ -0,0 +1,109 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <nut/modular_math.h>
+#include <nut/factorization.h>
+#include <nut/dirichlet.h>
+#include <nut/dirichlet_expr.h>
+#include <nut/debug.h>
+
+static void init_diri(nut_Diri *self, int64_t x){
+	if(!nut_Diri_init(self, x, nut_u64_nth_root(x, 3)*nut_u64_nth_root(x, 3))){
+		check_alloc("diri table", NULL);
+	}
+}
+
+static bool diri_eq(const nut_Diri *a, const nut_Diri *b){
+	return !memcmp(a->buf + 1, b->buf + 1, (a->y + a->yinv - 1)*sizeof(int64_t));
+}
+
+static uint64_t test_exprs(int64_t x, int64_t m){
+	nut_Diri f_tbl [[gnu::cleanup(nut_Diri_destroy)]];
+	nut_Diri g_tbl [[gnu::cleanup(nut_Diri_destroy)]];
+	nut_Diri h_tbl [[gnu::cleanup(nut_Diri_destroy)]];
+	nut_Diri t_tbl [[gnu::cleanup(nut_Diri_destroy)]];
+	nut_Diri e_tbl [[gnu::cleanup(nut_Diri_destroy)]];
+	nut_Diri out [[gnu::cleanup(nut_Diri_destroy)]];
+	init_diri(&f_tbl, x);
+	init_diri(&g_tbl, x);
+	init_diri(&h_tbl, x);
+	init_diri(&t_tbl, x);
+	init_diri(&e_tbl, x);
+	init_diri(&out, x);
+	// the dense part of a convolution assumes its inputs are multiplicative, so use sigma = u <*> N and N^3 instead of random tables
+	nut_Diri_compute_N(&t_tbl, m);
+	if(!nut_Diri_compute_conv_u(&f_tbl, m, &t_tbl) || !nut_Diri_compute_Nk(&g_tbl, 3, m)){
+		check_alloc("diri table", NULL);
+	}
+	nut_DiriExpr f = nut_DiriExpr_table(&f_tbl), g = nut_DiriExpr_table(&g_tbl);
+	nut_DiriExpr u = nut_DiriExpr_u(), N = nut_DiriExpr_N(), mu = nut_DiriExpr_mu(), N2 = nut_DiriExpr_Nk(2), I = nut_DiriExpr_I();
+	uint64_t passed = 0;
+
+	// f <*> g <*> mu
+	nut_DiriExpr fg = nut_DiriExpr_conv(&f, &g), fg_mu = nut_DiriExpr_conv(&fg, &mu);
+	passed += nut_Diri_compute_conv(&t_tbl, m, &f_tbl, &g_tbl) && (nut_Diri_compute_u(&h_tbl, m), nut_Diri_convdiv(&e_tbl, m, &t_tbl, &h_tbl)) &&
+		nut_DiriExpr_eval(&out, m, &fg_mu) && diri_eq(&out, &e_tbl);
+
+	// d3 <*> N <*> f
+	nut_DiriExpr uu = nut_DiriExpr_conv(&u, &u), uuu = nut_DiriExpr_conv(&uu, &u), uuuN = nut_DiriExpr_conv(&N, &uuu), d3_N_f = nut_DiriExpr_conv(&uuuN, &f);
+	passed += nut_Diri_compute_conv_u(&t_tbl, m, &f_tbl) && nut_Diri_compute_conv_u(&h_tbl, m, &t_tbl) && nut_Diri_compute_conv_u(&t_tbl, m, &h_tbl) &&
+		nut_Diri_compute_conv_N(&e_tbl, m, &t_tbl) && nut_DiriExpr_eval(&out, m, &d3_N_f) && diri_eq(&out, &e_tbl);
+
+	// d5, which uses binary exponentiation
+	nut_DiriExpr u4 = nut_DiriExpr_conv(&uu, &uu), u5 = nut_DiriExpr_conv(&u4, &u);
+	passed += nut_Diri_compute_dk(&e_tbl, 5, m, &t_tbl, &h_tbl) && nut_DiriExpr_eval(&out, m, &u5) && diri_eq(&out, &e_tbl);
+	// d8 <*> N, where d8 by binary exponentiation starts the chain and N is folded in after
+	nut_DiriExpr u8 = nut_DiriExpr_conv(&u4, &u4), u8_N = nut_DiriExpr_conv(&u8, &N);
+	passed += nut_Diri_compute_dk(&t_tbl, 8, m, &e_tbl, &h_tbl) && nut_Diri_compute_conv_N(&e_tbl, m, &t_tbl) &&
+		nut_DiriExpr_eval(&out, m, &u8_N) && diri_eq(&out, &e_tbl);
+
+	// N^2 <*> mu, with the mu given as a division by u
+	nut_DiriExpr N2_mu = nut_DiriExpr_convdiv(&N2, &u);
+	passed += nut_Diri_compute_Nk(&t_tbl, 2, m) && (nut_Diri_compute_u(&h_tbl, m), nut_Diri_convdiv(&e_tbl, m, &t_tbl, &h_tbl)) &&
+		nut_DiriExpr_eval(&out, m, &N2_mu) && diri_eq(&out, &e_tbl);
+
+	// (f <*> u)/(g <*> u) = f/g, since the u's cancel
+	nut_DiriExpr fu = nut_DiriExpr_conv(&f, &u), gu = nut_DiriExpr_conv(&g, &u), fu_gu = nut_DiriExpr_convdiv(&fu, &gu);
+	passed += nut_Diri_convdiv(&e_tbl, m, &f_tbl, &g_tbl) && nut_DiriExpr_eval(&out, m, &fu_gu) && diri_eq(&out, &e_tbl);
+
+	// f/(g/N) = f <*> N/g, and f <*> mu <*> u = f
+	nut_DiriExpr g_N = nut_DiriExpr_convdiv(&g, &N), f_g_N = nut_DiriExpr_convdiv(&f, &g_N);
+	passed += nut_Diri_compute_conv_N(&t_tbl, m, &f_tbl) && nut_Diri_convdiv(&e_tbl, m, &t_tbl, &g_tbl) &&
+		nut_DiriExpr_eval(&out, m, &f_g_N) && diri_eq(&out, &e_tbl);
+	nut_DiriExpr f_mu = nut_DiriExpr_conv(&f, &mu), f_mu_u = nut_DiriExpr_conv(&f_mu, &u);
+	passed += nut_DiriExpr_eval(&out, m, &f_mu_u) && diri_eq(&out, &f_tbl);
+
+	// a deep chain with cancellations on both sides, (f <*> g <*> f <*> u <*> N^2 <*> u <*> u <*> N <*> g)/g/u/g/g = f^2 <*> u^2 <*> N <*> N^2/g
+	const nut_DiriExpr *deep_leaves[] = {&g, &f, &u, &N2, &u, &u, &N, &g, &g, &u, &g, &g};
+	nut_DiriExpr deep[13] = {f};
+	for(uint64_t i = 0; i < 12; ++i){
+		deep[i + 1] = i < 8 ? nut_DiriExpr_conv(deep + i, deep_leaves[i]) : nut_DiriExpr_convdiv(deep + i, deep_leaves[i]);
+	}
+	passed += nut_Diri_compute_conv(&t_tbl, m, &f_tbl, &f_tbl) && nut_Diri_compute_conv_u(&h_tbl, m, &t_tbl) &&
+		nut_Diri_compute_conv_u(&t_tbl, m, &h_tbl) && nut_Diri_compute_conv_N(&h_tbl, m, &t_tbl) && nut_Diri_compute_Nk(&e_tbl, 2, m) &&
+		nut_Diri_compute_conv(&t_tbl, m, &h_tbl, &e_tbl) && nut_Diri_convdiv(&e_tbl, m, &t_tbl, &g_tbl) &&
+		nut_DiriExpr_eval(&out, m, deep + 12) && diri_eq(&out, &e_tbl);
+
+	// I on its own, and tables with the wrong bounds or aliasing the output are rejected
+	nut_Diri_compute_I(&e_tbl);
+	passed += nut_DiriExpr_eval(&out, m, &I) && diri_eq(&out, &e_tbl);
+	nut_Diri small [[gnu::cleanup(nut_Diri_destroy)]];
+	init_diri(&small, x/2);
+	nut_DiriExpr s = nut_DiriExpr_table(&small), fs = nut_DiriExpr_conv(&f, &s), o = nut_DiriExpr_table(&out), fo = nut_DiriExpr_conv(&f, &o);
+	passed += !nut_DiriExpr_eval(&out, m, &fs) && !nut_DiriExpr_eval(&out, m, &fo);
+	if(passed != 11){
+		fprintf(stderr, "\e[1;31mDirichlet expressions are wrong for x = %"PRIi64", m = %"PRIi64" (%"PRIu64"/11)\e[0m\n", x, m, passed);
+	}
+	return passed;
+}
+
+int main(){
+	static const int64_t moduli[] = {1000000007, 998244353, 1000003};
+	uint64_t passed = 0, trials = 0;
+	for(uint64_t i = 0; i < 3; ++i, trials += 11){
+		passed += test_exprs(10000000, moduli[i]);
+	}
+	print_summary("dirichlet expressions", passed, trials);
+}
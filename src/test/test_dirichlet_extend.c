@@ -0,0 +1,88 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <nut/modular_math.h>
+#include <nut/factorization.h>
+#include <nut/dirichlet.h>
+#include <nut/debug.h>
+
+static const int64_t M = 1000000007;
+
+typedef enum{
+	OP_CONV_U,
+	OP_CONV_N,
+	OP_CONV,
+	OP_PI
+} Op;
+
+static const char *op_names[] = {"f <*> u", "f <*> N", "f <*> g", "pi"};
+
+static int64_t cutoff(int64_t x){
+	return nut_u64_nth_root(x, 3)*nut_u64_nth_root(x, 3);
+}
+
+// compute op from scratch, or from old if it is not NULL.  The inputs are N and u, since the dense sieves assume multiplicative functions
+static bool compute(Op op, nut_Diri *self, int64_t m, const nut_Diri *old, uint64_t num_threads){
+	nut_Diri f_tbl [[gnu::cleanup(nut_Diri_destroy)]] = {};
+	nut_Diri g_tbl [[gnu::cleanup(nut_Diri_destroy)]] = {};
+	if(!nut_Diri_init(&f_tbl, self->x, self->y) || !nut_Diri_init(&g_tbl, self->x, self->y)){
+		check_alloc("diri tables", NULL);
+	}
+	nut_Diri_compute_N(&f_tbl, m);
+	nut_Diri_compute_u(&g_tbl, m);
+	switch(op){
+		case OP_CONV_U: return old ? nut_Diri_compute_conv_u_extend(self, m, &f_tbl, old, num_threads) : nut_Diri_compute_conv_u_parallel(self, m, &f_tbl, num_threads);
+		case OP_CONV_N: return old ? nut_Diri_compute_conv_N_extend(self, m, &g_tbl, old, num_threads) : nut_Diri_compute_conv_N_parallel(self, m, &g_tbl, num_threads);
+		case OP_CONV: return old ? nut_Diri_compute_conv_extend(self, m, &f_tbl, &g_tbl, old, num_threads) : nut_Diri_compute_conv_parallel(self, m, &f_tbl, &g_tbl, num_threads);
+		default: return old ? nut_Diri_compute_pi_extend(self, old) : nut_Diri_compute_pi(self);
+	}
+}
+
+// extend a table step by step and compare it with one computed from scratch
+static bool test_extend(Op op, int64_t x, const int64_t steps[][2], uint64_t num_steps, int64_t m, uint64_t num_threads){
+	nut_Diri old [[gnu::cleanup(nut_Diri_destroy)]] = {};
+	if(!nut_Diri_init(&old, x, cutoff(x))){
+		check_alloc("diri tables", NULL);
+	}
+	bool ok = compute(op, &old, m, NULL, num_threads);
+	for(uint64_t s = 0; ok && s < num_steps; ++s){
+		nut_Diri got [[gnu::cleanup(nut_Diri_destroy)]] = {};
+		nut_Diri expected [[gnu::cleanup(nut_Diri_destroy)]] = {};
+		int64_t x1 = steps[s][0], y1 = steps[s][1] ?: cutoff(x1);
+		if(!nut_Diri_init(&got, x1, y1) || !nut_Diri_init(&expected, x1, y1)){
+			check_alloc("diri tables", NULL);
+		}
+		ok = compute(op, &got, m, &old, num_threads) && compute(op, &expected, m, NULL, num_threads);
+		for(int64_t i = 0; ok && i < got.y + got.yinv; ++i){
+			if(got.buf[i] != expected.buf[i]){
+				fprintf(stderr, "\e[1;31mEntry %"PRIi64" was %"PRIi64" instead of %"PRIi64" for x = %"PRIi64"\e[0m\n", i, got.buf[i], expected.buf[i], x1);
+				ok = false;
+			}
+		}
+		nut_Diri tmp = old;
+		old = got;
+		got = tmp;
+	}
+	// tables can't shrink
+	nut_Diri small [[gnu::cleanup(nut_Diri_destroy)]] = {};
+	if(!nut_Diri_init(&small, x/2, 0)){
+		check_alloc("diri tables", NULL);
+	}
+	ok = ok && !compute(op, &small, m, &old, num_threads);
+	fprintf(stderr, "%s (extended %s tables from x = %"PRIi64", m = %"PRIi64", %"PRIu64" threads)\e[0m\n", ok ? "\e[1;32mPASSED" : "\e[1;31mFAILED", op_names[op], x, m, num_threads);
+	return ok;
+}
+
+int main(){
+	// a y of 0 means x^(2/3).  The uneven steps repeat an x, use a y below x^(2/3), and have few quotients in common with the last step
+	static const int64_t doubling[][2] = {{20'000'000, 0}, {40'000'000, 0}, {80'000'000, 0}};
+	static const int64_t uneven[][2] = {{15'000'007, 0}, {15'000'007, 0}, {98'765'432, 70'000}, {98'765'433, 0}};
+	for(Op op = OP_CONV_U; op <= OP_PI; ++op){
+		test_extend(op, 10'000'000, doubling, 3, 0, 2);
+		test_extend(op, 10'000'000, uneven, 4, op == OP_PI ? 0 : M, 3);
+	}
+	// pi tables with y below 2sqrt(x) only run Lucy's algorithm, so nothing from old is reused
+	static const int64_t small_y[][2] = {{40'000'000, 12'000}};
+	test_extend(OP_PI, 1'000'000, small_y, 1, 0, 1);
+}
@@ -0,0 +1,76 @@
+#define _POSIX_C_SOURCE 202305L
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <nut/modular_math.h>
+#include <nut/factorization.h>
+#include <nut/dirichlet.h>
+#include <nut/debug.h>
+
+static bool diri_eq(const nut_Diri *a, const nut_Diri *b){
+	return a->x == b->x && a->y == b->y && a->yinv == b->yinv && !memcmp(a->buf, b->buf, (a->y + a->yinv)*sizeof(int64_t));
+}
+
+// flip one bit of a saved table's values, past the header
+static bool corrupt(const char *path, int64_t offset){
+	FILE *file = fopen(path, "r+b");
+	if(!file){
+		return false;
+	}
+	int c;
+	bool res = !fseek(file, NUT_DIRI_DATA_OFFSET + offset, SEEK_SET) && (c = fgetc(file)) != EOF &&
+		!fseek(file, NUT_DIRI_DATA_OFFSET + offset, SEEK_SET) && fputc(c ^ 1, file) != EOF;
+	return !fclose(file) && res;
+}
+
+// overwrite one 8 byte field of a saved table's header
+static bool patch_header(const char *path, int64_t offset, int64_t value){
+	FILE *file = fopen(path, "r+b");
+	if(!file){
+		return false;
+	}
+	bool res = !fseek(file, offset, SEEK_SET) && fwrite(&value, sizeof(value), 1, file) == 1;
+	return !fclose(file) && res;
+}
+
+int main(){
+	char path[] = "/tmp/nut_test_dirichlet_mmap_XXXXXX", missing[sizeof(path) + 8];
+	int fd = mkstemp(path);
+	if(fd == -1){
+		check_alloc("temporary file", NULL);
+	}
+	close(fd);
+	snprintf(missing, sizeof(missing), "%s.missing", path);
+	static const uint64_t tag = 0x6970; // "pi"
+	const int64_t x = 100000000;
+	nut_Diri pi_tbl [[gnu::cleanup(nut_Diri_destroy)]] = {};
+	nut_Diri mapped [[gnu::cleanup(nut_Diri_destroy)]] = {};
+	nut_Diri a [[gnu::cleanup(nut_Diri_destroy)]] = {};
+	nut_Diri b [[gnu::cleanup(nut_Diri_destroy)]] = {};
+	if(!nut_Diri_init(&pi_tbl, x, nut_u64_nth_root(x, 3)*nut_u64_nth_root(x, 3)) || !nut_Diri_compute_pi(&pi_tbl) ||
+		!nut_Diri_init(&a, x, pi_tbl.y) || !nut_Diri_init(&b, x, pi_tbl.y)){
+		check_alloc("diri tables", NULL);
+	}
+	uint64_t passed = 0, trials = 0;
+	passed += nut_Diri_save(&pi_tbl, path, 0, tag) && nut_Diri_mmap(&mapped, path, 0, tag, true) && diri_eq(&mapped, &pi_tbl);
+	++trials;
+	// a mapped table works as an input
+	passed += nut_Diri_compute_conv_u(&a, 0, &pi_tbl) && nut_Diri_compute_conv_u(&b, 0, &mapped) && diri_eq(&a, &b);
+	++trials;
+	nut_Diri_destroy(&mapped);
+	// the wrong modulus or tag, a missing file, or a corrupted file are rejected, but corruption is only noticed when verifying
+	passed += !nut_Diri_mmap(&mapped, path, 1000000007, tag, false) && !nut_Diri_mmap(&mapped, path, 0, tag + 1, false);
+	passed += !nut_Diri_mmap(&mapped, missing, 0, tag, false);
+	passed += corrupt(path, 8*(pi_tbl.y + 5)) && !nut_Diri_mmap(&mapped, path, 0, tag, true);
+	passed += nut_Diri_mmap(&mapped, path, 0, tag, false) && mapped.buf[pi_tbl.y + 5] != pi_tbl.buf[pi_tbl.y + 5];
+	nut_Diri_destroy(&mapped);
+	// a header claiming a huge y, whose size would overflow, is rejected instead of mapping past the end of the file.
+	// y is the 8 byte field at offset 24 and yinv at offset 32, and x/y + 1 = 1 keeps yinv consistent
+	passed += patch_header(path, 24, INT64_C(1) << 62) && patch_header(path, 32, 1) && !nut_Diri_mmap(&mapped, path, 0, tag, false);
+	trials += 5;
+	remove(path);
+	print_summary("saved and mapped diri tables", passed, trials);
+}
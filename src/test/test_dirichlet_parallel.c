@@ -0,0 +1,137 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <nut/modular_math.h>
+#include <nut/factorization.h>
+#include <nut/dirichlet.h>
+#include <nut/parallel.h>
+#include <nut/debug.h>
+
+static void init_diri(nut_Diri *self, int64_t x, int64_t m){
+	if(!nut_Diri_init(self, x, nut_u64_nth_root(x, 3)*nut_u64_nth_root(x, 3))){
+		check_alloc("diri table", NULL);
+	}
+	if(!m){
+		nut_Diri_compute_u(self, 0);
+		return;
+	}
+	for(int64_t i = 0; i < self->y + self->yinv; ++i){
+		self->buf[i] = nut_u64_prand(0, m);
+	}
+	self->buf[1] = 1;
+}
+
+static bool diri_eq(const nut_Diri *a, const nut_Diri *b){
+	return !memcmp(a->buf, b->buf, (a->y + a->yinv)*sizeof(int64_t));
+}
+
+static uint64_t test_conv(int64_t x, int64_t m, uint64_t num_threads){
+	nut_Diri f [[gnu::cleanup(nut_Diri_destroy)]];
+	nut_Diri g [[gnu::cleanup(nut_Diri_destroy)]];
+	nut_Diri h [[gnu::cleanup(nut_Diri_destroy)]];
+	nut_Diri e [[gnu::cleanup(nut_Diri_destroy)]];
+	init_diri(&f, x, m);
+	init_diri(&g, x, m);
+	init_diri(&h, x, m);
+	init_diri(&e, x, m);
+	if(!m){
+		// u <*> N doesn't overflow for the sizes tested, unlike random tables without a modulus
+		nut_Diri_compute_N(&g, 0);
+	}
+	uint64_t passed = 0;
+	passed += nut_Diri_compute_conv_u(&e, m, &f) && nut_Diri_compute_conv_u_parallel(&h, m, &f, num_threads) && diri_eq(&h, &e);
+	passed += nut_Diri_compute_conv_N(&e, m, &f) && nut_Diri_compute_conv_N_parallel(&h, m, &f, num_threads) && diri_eq(&h, &e);
+	passed += nut_Diri_compute_conv(&e, m, &f, &g) && nut_Diri_compute_conv_parallel(&h, m, &f, &g, num_threads) && diri_eq(&h, &e);
+	if(passed != 3){
+		fprintf(stderr, "\e[1;31mParallel convolution differs from serial for x = %"PRIi64", m = %"PRIi64", %"PRIu64" threads\e[0m\n", x, m, num_threads);
+	}
+	return passed;
+}
+
+static bool test_euler_sieve(int64_t n, int64_t m, uint64_t num_threads){
+	int64_t *f_vals [[gnu::cleanup(cleanup_free)]] = malloc((n + 1)*sizeof(int64_t));
+	int64_t *g_vals [[gnu::cleanup(cleanup_free)]] = malloc((n + 1)*sizeof(int64_t));
+	int64_t *serial [[gnu::cleanup(cleanup_free)]] = malloc((n + 1)*sizeof(int64_t));
+	int64_t *parallel [[gnu::cleanup(cleanup_free)]] = malloc((n + 1)*sizeof(int64_t));
+	check_alloc("f values", f_vals);
+	check_alloc("g values", g_vals);
+	check_alloc("serial values", serial);
+	check_alloc("parallel values", parallel);
+	for(int64_t i = 0; i <= n; ++i){
+		f_vals[i] = (i*i + 7*i)%m;
+		g_vals[i] = (3*i + 1)%m;
+	}
+	bool passed = true;
+	passed = passed && nut_euler_sieve_conv_u(n, m, f_vals, serial) && nut_euler_sieve_conv_u_parallel(n, m, f_vals, parallel, num_threads);
+	passed = passed && !memcmp(serial + 1, parallel + 1, n*sizeof(int64_t));
+	passed = passed && nut_euler_sieve_conv_N(n, m, f_vals, serial) && nut_euler_sieve_conv_N_parallel(n, m, f_vals, parallel, num_threads);
+	passed = passed && !memcmp(serial + 1, parallel + 1, n*sizeof(int64_t));
+	passed = passed && nut_euler_sieve_conv(n, m, f_vals, g_vals, serial) && nut_euler_sieve_conv_parallel(n, m, f_vals, g_vals, parallel, num_threads);
+	passed = passed && !memcmp(serial + 1, parallel + 1, n*sizeof(int64_t));
+	if(!passed){
+		fprintf(stderr, "\e[1;31mParallel Euler sieve differs from serial for n = %"PRIi64", m = %"PRIi64", %"PRIu64" threads\e[0m\n", n, m, num_threads);
+	}
+	return passed;
+}
+
+static bool test_windows(int64_t n, int64_t m, uint64_t num_threads){
+	int64_t *f_vals [[gnu::cleanup(cleanup_free)]] = malloc((n + 1)*sizeof(int64_t));
+	int64_t *g_vals [[gnu::cleanup(cleanup_free)]] = malloc((n + 1)*sizeof(int64_t));
+	int64_t *serial [[gnu::cleanup(cleanup_free)]] = malloc((n + 1)*sizeof(int64_t));
+	int64_t *window [[gnu::cleanup(cleanup_free)]] = malloc((n + 1)*sizeof(int64_t));
+	check_alloc("f values", f_vals);
+	check_alloc("g values", g_vals);
+	check_alloc("serial values", serial);
+	check_alloc("window values", window);
+	for(int64_t i = 0; i <= n; ++i){
+		f_vals[i] = (5*i*i + 2)%m;
+		g_vals[i] = (i + 11)%m;
+	}
+	// windows at the start, straddling a square, tiny, and at the end
+	const int64_t bounds[][2] = {{1, 2}, {1, 1000}, {961, 1090}, {n/3, n/3 + 1}, {n/2 - 70001, n/2 + 70001}, {n - 12345, n + 1}};
+	bool passed = true;
+	for(uint64_t k = 0; passed && k < sizeof(bounds)/sizeof(bounds[0]); ++k){
+		int64_t lo = bounds[k][0], hi = bounds[k][1];
+		passed = passed && nut_euler_sieve_conv_u(n, m, f_vals, serial) && nut_euler_sieve_conv_u_window(lo, hi, m, f_vals, window, num_threads);
+		passed = passed && !memcmp(serial + lo, window, (hi - lo)*sizeof(int64_t));
+		passed = passed && nut_euler_sieve_conv_N(n, m, f_vals, serial) && nut_euler_sieve_conv_N_window(lo, hi, m, f_vals, window, num_threads);
+		passed = passed && !memcmp(serial + lo, window, (hi - lo)*sizeof(int64_t));
+		passed = passed && nut_euler_sieve_conv(n, m, f_vals, g_vals, serial) && nut_euler_sieve_conv_window(lo, hi, m, f_vals, g_vals, window, num_threads);
+		passed = passed && !memcmp(serial + lo, window, (hi - lo)*sizeof(int64_t));
+	}
+	passed = passed && !nut_euler_sieve_conv_u_window(0, 10, m, f_vals, window, num_threads);
+	if(!passed){
+		fprintf(stderr, "\e[1;31mWindowed Euler sieve differs from serial for n = %"PRIi64", m = %"PRIi64", %"PRIu64" threads\e[0m\n", n, m, num_threads);
+	}
+	return passed;
+}
+
+int main(){
+	static const int64_t moduli[] = {0, 1000000007, 998244353, 1000003};
+	static const uint64_t thread_counts[] = {1, 3, 8};
+	uint64_t passed = 0, trials = 0;
+	for(uint64_t i = 0; i < 4; ++i){
+		for(uint64_t j = 0; j < 3; ++j, trials += 3){
+			passed += test_conv(i == 1 ? 1000000000 : 100000000, moduli[i], thread_counts[j]);
+		}
+	}
+	print_summary("parallel dirichlet convolutions", passed, trials);
+	passed = trials = 0;
+	for(uint64_t i = 1; i < 4; ++i){
+		for(uint64_t j = 0; j < 3; ++j, ++trials){
+			passed += test_euler_sieve(500000, moduli[i], thread_counts[j]);
+		}
+	}
+	passed += test_euler_sieve(1000, 1000000007, 0);
+	++trials;
+	print_summary("parallel euler sieves", passed, trials);
+	passed = trials = 0;
+	for(uint64_t i = 1; i < 4; ++i){
+		for(uint64_t j = 0; j < 3; ++j, ++trials){
+			passed += test_windows(300000, moduli[i], thread_counts[j]);
+		}
+	}
+	print_summary("windowed euler sieves", passed, trials);
+}
@@ -6,12 +6,11 @@
 
 static const uint64_t N = 1'000'000;
 
-int main(){
+// y = 0 only runs Lucy's algorithm, and y = 10000 is above 2sqrt(N), so the dense part past 2000 is sieved separately
+static void check_pi(int64_t y, const uint64_t *pi_packed, const uint8_t *is_composite){
 	nut_Diri pi_tbl [[gnu::cleanup(nut_Diri_destroy)]];
-	nut_Diri_init(&pi_tbl, N, 0);
+	nut_Diri_init(&pi_tbl, N, y);
 	nut_Diri_compute_pi(&pi_tbl);
-	uint8_t *is_composite [[gnu::cleanup(cleanup_free)]] = nut_sieve_is_composite(N);
-	uint64_t *pi_packed [[gnu::cleanup(cleanup_free)]] = nut_compute_pi_range(N, is_composite);
 
 	for(int64_t i = 1; i <= pi_tbl.y; ++i){
 		if((int64_t)nut_compute_pi_from_tables(i, pi_packed, is_composite) != nut_Diri_get_dense(&pi_tbl, i)){
@@ -25,3 +24,9 @@ int main(){
 	}
 }
 
+int main(){
+	uint8_t *is_composite [[gnu::cleanup(cleanup_free)]] = nut_sieve_is_composite(N);
+	uint64_t *pi_packed [[gnu::cleanup(cleanup_free)]] = nut_compute_pi_range(N, is_composite);
+	check_pi(0, pi_packed, is_composite);
+	check_pi(10'000, pi_packed, is_composite);
+}
@@ -0,0 +1,98 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <nut/modular_math.h>
+#include <nut/dirichlet.h>
+#include <nut/sieves.h>
+#include <nut/debug.h>
+
+#define MAX_TABLES 30
+
+static const int64_t X = 20'000'000;
+
+// Walk all the points of the tables in increasing order, keeping running sums over the primes up to each point.
+// For the point v, expected[t] gets the sum for table t, which is sum(p^t) if q is 0 or the count of primes = t mod q otherwise
+static uint64_t check_tables(const nut_Diri *tbls, uint64_t num_tbls, int64_t m, uint64_t q, const uint64_t *primes, uint64_t num_primes){
+	int64_t sums[MAX_TABLES] = {};
+	uint64_t j = 0, errors = 0;
+	const nut_Diri *self = tbls;
+	for(int64_t idx = 1; idx < self->y + self->yinv; ++idx){
+		bool dense = idx <= self->y;
+		int64_t v = dense ? idx : self->x/(self->y + self->yinv - idx);
+		for(; j < num_primes && (int64_t)primes[j] <= v; ++j){
+			if(q){
+				++sums[primes[j]%q];
+				continue;
+			}
+			for(uint64_t k = 0, pk = 1; k < num_tbls; ++k, pk = m ? pk*primes[j]%m : pk*primes[j]){
+				sums[k] = m ? (int64_t)((sums[k] + pk)%m) : sums[k] + (int64_t)pk;
+			}
+		}
+		for(uint64_t t = 0; t < num_tbls; ++t){
+			int64_t got = dense ? nut_Diri_get_dense(tbls + t, v) : nut_Diri_get_sparse(tbls + t, self->y + self->yinv - idx);
+			if(got != sums[t]){
+				if(!errors++){
+					fprintf(stderr, "\e[1;31mTable %"PRIu64" (m = %"PRIi64", q = %"PRIu64") was %"PRIi64" instead of %"PRIi64" at %"PRIi64"\e[0m\n", t, m, q, got, sums[t], v);
+				}
+			}
+		}
+	}
+	return errors;
+}
+
+static bool test_prime_sums(uint64_t kmax, int64_t m, const uint64_t *primes, uint64_t num_primes){
+	nut_Diri tbls[MAX_TABLES];
+	for(uint64_t k = 0; k <= kmax; ++k){
+		if(!nut_Diri_init(tbls + k, X, 0)){
+			check_alloc("prime sum table", NULL);
+		}
+	}
+	bool ok = nut_Diri_compute_prime_sums(tbls, kmax, m) && !check_tables(tbls, kmax + 1, m, 0, primes, num_primes);
+	for(uint64_t k = 0; k <= kmax; ++k){
+		nut_Diri_destroy(tbls + k);
+	}
+	fprintf(stderr, "%s (prime power sums up to k = %"PRIu64" mod %"PRIi64")\e[0m\n", ok ? "\e[1;32mPASSED" : "\e[1;31mFAILED", kmax, m);
+	return ok;
+}
+
+static bool test_pi_mod_q(uint64_t q, const uint64_t *primes, uint64_t num_primes){
+	nut_Diri tbls[MAX_TABLES];
+	for(uint64_t r = 0; r < q; ++r){
+		if(!nut_Diri_init(tbls + r, X, 0)){
+			check_alloc("prime count table", NULL);
+		}
+	}
+	bool ok = nut_Diri_compute_pi_mod_q(tbls, q) && !check_tables(tbls, q, 0, q, primes, num_primes);
+	nut_Diri pi_tbl [[gnu::cleanup(nut_Diri_destroy)]];
+	if(!nut_Diri_init(&pi_tbl, X, 0) || !nut_Diri_compute_pi(&pi_tbl)){
+		check_alloc("pi table", NULL);
+	}
+	// the classes should add up to pi
+	for(int64_t i = 1; ok && i < pi_tbl.yinv; ++i){
+		int64_t total = 0;
+		for(uint64_t r = 0; r < q; ++r){
+			total += nut_Diri_get_sparse(tbls + r, i);
+		}
+		ok = total == nut_Diri_get_sparse(&pi_tbl, i);
+	}
+	for(uint64_t r = 0; r < q; ++r){
+		nut_Diri_destroy(tbls + r);
+	}
+	fprintf(stderr, "%s (prime counts mod %"PRIu64")\e[0m\n", ok ? "\e[1;32mPASSED" : "\e[1;31mFAILED", q);
+	return ok;
+}
+
+int main(){
+	uint64_t num_primes;
+	uint64_t *primes [[gnu::cleanup(cleanup_free)]] = nut_sieve_primes(X, &num_primes);
+	check_alloc("primes", primes);
+	test_prime_sums(0, 0, primes, num_primes);
+	test_prime_sums(1, 0, primes, num_primes);
+	test_prime_sums(4, 1000000007, primes, num_primes);
+	test_prime_sums(3, 998244353, primes, num_primes);
+	test_pi_mod_q(1, primes, num_primes);
+	test_pi_mod_q(4, primes, num_primes);
+	test_pi_mod_q(12, primes, num_primes);
+	test_pi_mod_q(30, primes, num_primes);
+}
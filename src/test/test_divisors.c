@@ -0,0 +1,91 @@
+#include <stdio.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <nut/debug.h>
+#include <nut/factorization.h>
+
+static int cmp_u64(const void *_a, const void *_b){
+	uint64_t a = *(const uint64_t*)_a, b = *(const uint64_t*)_b;
+	return a < b ? -1 : a > b;
+}
+
+typedef struct{
+	uint64_t *divs;
+	uint64_t len;
+} CollectArgs;
+
+static int collect_div(const nut_Factors *dfactors, uint64_t d, void *_args){
+	CollectArgs *args = _args;
+	args->divs[args->len++] = d;
+	return 0;
+}
+
+static bool check_n(uint64_t n, uint64_t d_max, nut_Factors *factors, uint64_t *expected, uint64_t *divs){
+	if(nut_u64_factor_heuristic(n, 25, nut_small_primes, &nut_default_factor_conf, factors) != 1){
+		fprintf(stderr, "\e[1;31mFailed to factor %"PRIu64"!\e[0m\n", n);
+		return false;
+	}
+	CollectArgs args = {expected, 0};
+	nut_Factor_forall_divs_tmptmp(factors, collect_div, &args);
+	uint64_t d_count = args.len;
+	qsort(expected, d_count, sizeof(uint64_t), cmp_u64);
+	if(nut_Factor_divisors(factors, divs, true) != d_count || memcmp(divs, expected, d_count*sizeof(uint64_t))){
+		fprintf(stderr, "\e[1;31mSorted divisors of %"PRIu64" are wrong!\e[0m\n", n);
+		return false;
+	}
+	if(nut_Factor_divisors(factors, divs, false) != d_count){
+		fprintf(stderr, "\e[1;31mWrong number of unsorted divisors of %"PRIu64"!\e[0m\n", n);
+		return false;
+	}
+	qsort(divs, d_count, sizeof(uint64_t), cmp_u64);
+	if(memcmp(divs, expected, d_count*sizeof(uint64_t))){
+		fprintf(stderr, "\e[1;31mUnsorted divisors of %"PRIu64" are wrong!\e[0m\n", n);
+		return false;
+	}
+	nut_DivIt it;
+	nut_DivIt_init(&it, factors, d_max);
+	uint64_t len = 0;
+	for(uint64_t d; nut_DivIt_next(&it, &d);){
+		uint64_t prod = 1;
+		for(uint64_t i = 0; i < it.num_primes; ++i){
+			prod *= it.ppows[i];
+		}
+		if(d > d_max || n%d || prod != d){
+			fprintf(stderr, "\e[1;31mIterator gave bad divisor %"PRIu64" of %"PRIu64"!\e[0m\n", d, n);
+			return false;
+		}
+		divs[len++] = d;
+	}
+	qsort(divs, len, sizeof(uint64_t), cmp_u64);
+	uint64_t expected_len = 0;
+	while(expected_len < d_count && expected[expected_len] <= d_max){
+		++expected_len;
+	}
+	if(len != expected_len || memcmp(divs, expected, len*sizeof(uint64_t))){
+		fprintf(stderr, "\e[1;31mIterator divisors of %"PRIu64" up to %"PRIu64" are wrong!\e[0m\n", n, d_max);
+		return false;
+	}
+	return true;
+}
+
+int main(){
+	nut_Factors *factors [[gnu::cleanup(cleanup_free)]] = nut_make_Factors_w(NUT_MAX_PRIMES_64);
+	// 897612484786617600 has 103680 divisors, the most of any uint64_t
+	uint64_t *expected [[gnu::cleanup(cleanup_free)]] = malloc(103680*sizeof(uint64_t));
+	uint64_t *divs [[gnu::cleanup(cleanup_free)]] = malloc(103680*sizeof(uint64_t));
+	check_alloc("factors", factors);
+	check_alloc("expected", expected);
+	check_alloc("divs", divs);
+	uint64_t special[] = {1, 2, 1ull << 39, 3486784401, 963761198400, 897612484786617600};
+	uint64_t trials = 0, passed = 0;
+	for(uint64_t i = 0; i < sizeof(special)/sizeof(*special); ++i, ++trials){
+		passed += check_n(special[i], i&1 ? special[i] : nut_u64_rand(1, special[i] + 1), factors, expected, divs);
+	}
+	for(uint64_t i = 0; i < 2000; ++i, ++trials){
+		uint64_t n = nut_u64_rand(1, 1000000000000ull);
+		passed += check_n(n, i&1 ? UINT64_MAX : nut_u64_rand(1, n + 1), factors, expected, divs);
+	}
+	print_summary("divisor generation", passed, trials);
+}
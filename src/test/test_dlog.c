@@ -0,0 +1,101 @@
+#include <stdio.h>
+#include <inttypes.h>
+#include <stdlib.h>
+
+#include <nut/debug.h>
+#include <nut/modular_math.h>
+#include <nut/factorization.h>
+#include <nut/dlog.h>
+
+static bool check_dlog(uint64_t g, uint64_t x, uint64_t n){
+	uint64_t h = nut_u64_powmod(g, x, n), y;
+	if(!nut_u64_dlog(g, h, n, &y)){
+		fprintf(stderr, "\e[1;31mFailed to find log of %"PRIu64" base %"PRIu64" mod %"PRIu64"\e[0m\n", h, g, n);
+		return false;
+	}else if(nut_u64_powmod(g, y, n) != h){
+		fprintf(stderr, "\e[1;31mWrong log of %"PRIu64" base %"PRIu64" mod %"PRIu64"\e[0m\n", h, g, n);
+		return false;
+	}
+	return true;
+}
+
+static uint64_t random_unit(uint64_t n){
+	while(1){
+		uint64_t g = nut_u64_rand(1, n);
+		if(nut_i64_egcd(g, n, NULL, NULL) == 1){
+			return g;
+		}
+	}
+}
+
+int main(){
+	uint64_t trials = 0, passed = 0;
+	// small moduli of every kind, including ones without primitive roots, checked against brute force
+	for(uint64_t n = 2; n <= 200; ++n){
+		for(uint64_t g = 1; g < n; ++g){
+			if(nut_i64_egcd(g, n, NULL, NULL) != 1){
+				continue;
+			}
+			nut_DlogCtx ctx;
+			if(!nut_DlogCtx_init(&ctx, g, n)){
+				fprintf(stderr, "\e[1;31mFailed to set up logs base %"PRIu64" mod %"PRIu64"\e[0m\n", g, n);
+				continue;
+			}
+			bool ok = true;
+			for(uint64_t h = 0; h < n; ++h){
+				uint64_t expected = 0, y, x = 1%n;
+				for(; expected < ctx.order && x != h; ++expected){
+					x = x*g%n;
+				}
+				bool found = nut_DlogCtx_log(&ctx, h, &y);
+				if(found != (expected < ctx.order) || (found && y != expected)){
+					fprintf(stderr, "\e[1;31mWrong log of %"PRIu64" base %"PRIu64" mod %"PRIu64"\e[0m\n", h, g, n);
+					ok = false;
+					break;
+				}
+			}
+			nut_DlogCtx_destroy(&ctx);
+			++trials;
+			passed += ok;
+		}
+	}
+	print_summary("logs for small moduli", passed, trials);
+	trials = passed = 0;
+	for(uint64_t i = 0; i < 300; ++i, ++trials){
+		uint64_t n;
+		switch(i%3){
+			case 0: n = nut_u64_next_prime_ge(nut_u64_rand(1ull << 20, 1ull << 40)); break;
+			case 1: n = nut_u64_rand(1ull << 20, 1ull << 40); break;
+			default: n = nut_u64_rand(1ull << 20, 1ull << 40) | 1;
+		}
+		uint64_t g = random_unit(n);
+		passed += check_dlog(g, nut_u64_rand(0, n), n);
+	}
+	print_summary("logs for random moduli", passed, trials);
+	trials = passed = 0;
+	// safe primes p = 2q + 1 with q above NUT_DLOG_BSGS_MAX, so Pollard rho is used
+	for(uint64_t i = 0; i < 3; ++i, ++trials){
+		uint64_t q = nut_u64_rand(NUT_DLOG_BSGS_MAX, NUT_DLOG_BSGS_MAX*2);
+		while(!nut_u64_is_prime_dmr(q = nut_u64_next_prime_ge(q + 1)) || !nut_u64_is_prime_dmr(2*q + 1));
+		uint64_t p = 2*q + 1, g = random_unit(p);
+		nut_DlogCtx ctx;
+		if(!nut_DlogCtx_init(&ctx, g, p)){
+			fprintf(stderr, "\e[1;31mFailed to set up logs base %"PRIu64" mod %"PRIu64"\e[0m\n", g, p);
+			continue;
+		}
+		bool ok = true;
+		for(uint64_t j = 0; ok && j < 4; ++j){
+			uint64_t x = nut_u64_rand(0, ctx.order), y;
+			if(!nut_DlogCtx_log(&ctx, nut_u64_powmod(g, x, p), &y) || y != x){
+				fprintf(stderr, "\e[1;31mWrong log base %"PRIu64" mod %"PRIu64"\e[0m\n", g, p);
+				ok = false;
+			}
+		}
+		nut_DlogCtx_destroy(&ctx);
+		passed += ok;
+	}
+	// 3*171087244103, where every element of the rho subgroup is 1 mod 3
+	passed += check_dlog(82184838961, 123456789, 513261732309);
+	++trials;
+	print_summary("logs using Pollard rho", passed, trials);
+}
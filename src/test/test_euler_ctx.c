@@ -0,0 +1,168 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <nut/modular_math.h>
+#include <nut/factorization.h>
+#include <nut/dirichlet.h>
+#include <nut/debug.h>
+
+static void init_diri(nut_Diri *self, int64_t x, int64_t m){
+	if(!nut_Diri_init(self, x, nut_u64_nth_root(x, 3)*nut_u64_nth_root(x, 3))){
+		check_alloc("diri table", NULL);
+	}
+	if(!m){
+		nut_Diri_compute_u(self, 0);
+		return;
+	}
+	for(int64_t i = 0; i < self->y + self->yinv; ++i){
+		self->buf[i] = nut_u64_prand(0, m);
+	}
+	self->buf[1] = 1;
+}
+
+static bool diri_eq(const nut_Diri *a, const nut_Diri *b){
+	return !memcmp(a->buf + 1, b->buf + 1, (a->y + a->yinv - 1)*sizeof(int64_t));
+}
+
+static bool test_ctx_tables(int64_t n){
+	nut_EulerCtx ctx [[gnu::cleanup(nut_EulerCtx_destroy)]] = {};
+	if(!nut_EulerCtx_init(&ctx, n)){
+		check_alloc("euler ctx", NULL);
+	}
+	uint64_t num_primes = 0;
+	bool passed = true;
+	for(int64_t i = 2; passed && i <= n; ++i){
+		int64_t p = 2;
+		while(i%p){
+			++p;
+		}
+		int64_t ppow = p;
+		while(i%(ppow*p) == 0){
+			ppow *= p;
+		}
+		if(p == i && (num_primes >= ctx.num_primes || ctx.primes[num_primes++] != p)){
+			passed = false;
+		}
+		uint32_t expected = ppow == i ? NUT_EULER_CTX_PRIME_POWER | p : ppow;
+		passed = passed && ctx.smallest_ppow[i] == expected;
+	}
+	passed = passed && num_primes == ctx.num_primes;
+	if(!passed){
+		fprintf(stderr, "\e[1;31mEuler ctx tables are wrong for n = %"PRIi64"\e[0m\n", n);
+	}
+	return passed;
+}
+
+static bool test_euler_sieve(int64_t n, int64_t m, const nut_EulerCtx *ctx){
+	int64_t *f_vals [[gnu::cleanup(cleanup_free)]] = malloc((n + 1)*sizeof(int64_t));
+	int64_t *g_vals [[gnu::cleanup(cleanup_free)]] = malloc((n + 1)*sizeof(int64_t));
+	int64_t *plain [[gnu::cleanup(cleanup_free)]] = malloc((n + 1)*sizeof(int64_t));
+	int64_t *with_ctx [[gnu::cleanup(cleanup_free)]] = malloc((n + 1)*sizeof(int64_t));
+	check_alloc("f values", f_vals);
+	check_alloc("g values", g_vals);
+	check_alloc("plain values", plain);
+	check_alloc("ctx values", with_ctx);
+	for(int64_t i = 0; i <= n; ++i){
+		// without a modulus, use u and N so nothing overflows
+		f_vals[i] = m ? (i*i + 7*i)%m : 1;
+		g_vals[i] = m ? (3*i + 1)%m : i;
+	}
+	bool passed = true;
+	passed = passed && nut_euler_sieve_conv_u(n, m, f_vals, plain) && nut_euler_sieve_conv_u_ctx(ctx, n, m, f_vals, with_ctx);
+	passed = passed && !memcmp(plain + 1, with_ctx + 1, n*sizeof(int64_t));
+	passed = passed && nut_euler_sieve_conv_N(n, m, f_vals, plain) && nut_euler_sieve_conv_N_ctx(ctx, n, m, f_vals, with_ctx);
+	passed = passed && !memcmp(plain + 1, with_ctx + 1, n*sizeof(int64_t));
+	passed = passed && nut_euler_sieve_conv(n, m, f_vals, g_vals, plain) && nut_euler_sieve_conv_ctx(ctx, n, m, f_vals, g_vals, with_ctx);
+	passed = passed && !memcmp(plain + 1, with_ctx + 1, n*sizeof(int64_t));
+	if(!passed){
+		fprintf(stderr, "\e[1;31mEuler sieve with ctx differs from without for n = %"PRIi64", m = %"PRIi64"\e[0m\n", n, m);
+	}
+	return passed;
+}
+
+static uint64_t test_conv(int64_t x, int64_t m){
+	nut_Diri f [[gnu::cleanup(nut_Diri_destroy)]];
+	nut_Diri g [[gnu::cleanup(nut_Diri_destroy)]];
+	nut_Diri h [[gnu::cleanup(nut_Diri_destroy)]];
+	nut_Diri e [[gnu::cleanup(nut_Diri_destroy)]];
+	init_diri(&f, x, m);
+	init_diri(&g, x, m);
+	init_diri(&h, x, m);
+	init_diri(&e, x, m);
+	nut_EulerCtx ctx [[gnu::cleanup(nut_EulerCtx_destroy)]] = {};
+	if(!nut_EulerCtx_init(&ctx, h.y)){
+		check_alloc("euler ctx", NULL);
+	}
+	if(!m){
+		nut_Diri_compute_N(&g, 0);
+	}
+	uint64_t passed = 0;
+	passed += nut_Diri_compute_conv_u(&e, m, &f) && nut_Diri_compute_conv_u_ctx(&h, m, &f, &ctx) && diri_eq(&h, &e);
+	passed += nut_Diri_compute_conv_N(&e, m, &f) && nut_Diri_compute_conv_N_ctx(&h, m, &f, &ctx) && diri_eq(&h, &e);
+	passed += nut_Diri_compute_conv(&e, m, &f, &g) && nut_Diri_compute_conv_ctx(&h, m, &f, &g, &ctx) && diri_eq(&h, &e);
+	// a ctx that doesn't cover the dense part must be rejected
+	nut_EulerCtx small_ctx [[gnu::cleanup(nut_EulerCtx_destroy)]] = {};
+	if(!nut_EulerCtx_init(&small_ctx, 1000)){
+		check_alloc("euler ctx", NULL);
+	}
+	passed += !nut_Diri_compute_conv_ctx(&h, m, &f, &g, &small_ctx);
+	if(passed != 4){
+		fprintf(stderr, "\e[1;31mDirichlet convolution with ctx differs from without for x = %"PRIi64", m = %"PRIi64"\e[0m\n", x, m);
+	}
+	return passed;
+}
+
+// d5 = d2 <*> d3, and the convolutions with and without the ctx agree, so compare against that
+static bool test_dk(int64_t x, int64_t m){
+	nut_Diri d2 [[gnu::cleanup(nut_Diri_destroy)]];
+	nut_Diri d3 [[gnu::cleanup(nut_Diri_destroy)]];
+	nut_Diri d5 [[gnu::cleanup(nut_Diri_destroy)]];
+	nut_Diri dk [[gnu::cleanup(nut_Diri_destroy)]];
+	nut_Diri f [[gnu::cleanup(nut_Diri_destroy)]];
+	nut_Diri g [[gnu::cleanup(nut_Diri_destroy)]];
+	init_diri(&d2, x, 0);
+	init_diri(&d3, x, 0);
+	init_diri(&d5, x, 0);
+	init_diri(&dk, x, 0);
+	init_diri(&f, x, 0);
+	init_diri(&g, x, 0);
+	nut_Diri_compute_u(&f, m);
+	bool passed = nut_Diri_compute_conv_u(&d2, m, &f) && nut_Diri_compute_conv_u(&d3, m, &d2);
+	passed = passed && nut_Diri_compute_conv(&d5, m, &d2, &d3);
+	passed = passed && nut_Diri_compute_dk(&dk, 5, m, &f, &g) && diri_eq(&dk, &d5);
+	// without a ctx, which is what nut_Diri_compute_dk falls back to when y is too large for one, every convolution sieves separately
+	memset(dk.buf, 0, (dk.y + dk.yinv)*sizeof(int64_t));
+	passed = passed && nut_Diri_compute_dk_ctx(&dk, 5, m, &f, &g, NULL) && diri_eq(&dk, &d5);
+	if(!passed){
+		fprintf(stderr, "\e[1;31mnut_Diri_compute_dk is wrong for x = %"PRIi64", m = %"PRIi64"\e[0m\n", x, m);
+	}
+	return passed;
+}
+
+int main(){
+	static const int64_t moduli[] = {0, 1000000007, 998244353, 1000003};
+	uint64_t passed = 0, trials = 0;
+	passed += test_ctx_tables(100000);
+	// a ctx can't be built past NUT_EULER_CTX_MAX_N, so nut_Diri_compute_dk must not rely on one there
+	nut_EulerCtx big_ctx [[gnu::cleanup(nut_EulerCtx_destroy)]] = {};
+	passed += !nut_EulerCtx_init(&big_ctx, NUT_EULER_CTX_MAX_N + 1);
+	trials += 2;
+	nut_EulerCtx ctx [[gnu::cleanup(nut_EulerCtx_destroy)]] = {};
+	if(!nut_EulerCtx_init(&ctx, 1000000)){
+		check_alloc("euler ctx", NULL);
+	}
+	for(uint64_t i = 0; i < 4; ++i, ++trials){
+		passed += test_euler_sieve(500000, moduli[i], &ctx);
+	}
+	print_summary("euler sieves with ctx", passed, trials);
+	passed = trials = 0;
+	for(uint64_t i = 0; i < 4; ++i, trials += 4){
+		passed += test_conv(100000000, moduli[i]);
+	}
+	for(uint64_t i = 0; i < 4; ++i, ++trials){
+		passed += test_dk(10000000, moduli[i]);
+	}
+	print_summary("dirichlet convolutions with ctx", passed, trials);
+}
@@ -0,0 +1,105 @@
+#include <stdio.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <nut/debug.h>
+#include <nut/factorization.h>
+#include <nut/factor_cache.h>
+
+#define NUM_THREADS 2
+#define POOL_SIZE 400
+#define QUERIES 5000
+
+typedef struct{
+	nut_FactorCache *cache;
+	const uint64_t *pool;
+	nut_Factors *const *expected;
+	uint64_t passed;
+} TestArgs;
+
+static bool factors_eq(const nut_Factors *a, const nut_Factors *b){
+	if(a->num_primes != b->num_primes){
+		return false;
+	}
+	for(uint64_t i = 0; i < a->num_primes; ++i){
+		if(a->factors[i].prime != b->factors[i].prime || a->factors[i].power != b->factors[i].power){
+			return false;
+		}
+	}
+	return true;
+}
+
+static void *run_queries(void *_args){
+	TestArgs *args = _args;
+	nut_Factors *factors [[gnu::cleanup(cleanup_free)]] = nut_make_Factors_w(NUT_MAX_PRIMES_64);
+	check_alloc("factors", factors);
+	for(uint64_t i = 0; i < QUERIES; ++i){
+		uint64_t j = nut_u64_rand(0, POOL_SIZE);
+		uint64_t n = args->pool[j];
+		if(nut_u64_factor_heuristic_cached(args->cache, n, 25, nut_small_primes, &nut_default_factor_conf, factors) != 1){
+			fprintf(stderr, "\e[1;31mFailed to factor %"PRIu64"!\e[0m\n", n);
+		}else if(!factors_eq(factors, args->expected[j])){
+			fprintf(stderr, "\e[1;31mCached factorization of %"PRIu64" is wrong!\e[0m\n", n);
+		}else{
+			++args->passed;
+		}
+	}
+	return NULL;
+}
+
+static void test_cache(size_t max_bytes, uint64_t num_shards, const uint64_t *pool, nut_Factors *const *expected, bool expect_hits){
+	nut_FactorCache cache;
+	if(!nut_FactorCache_init(&cache, max_bytes, num_shards)){
+		fprintf(stderr, "\e[1;31mFailed to allocate factor cache!\e[0m\n");
+		exit(0);
+	}
+	TestArgs args[NUM_THREADS];
+	pthread_t threads[NUM_THREADS];
+	uint64_t passed = 0, hits, misses;
+	fprintf(stderr, "\e[1;34mFactoring with a %zu byte cache in %"PRIu64" shards on %d threads...\e[0m\n", max_bytes, cache.num_shards, NUM_THREADS);
+	for(uint64_t i = 0; i < NUM_THREADS; ++i){
+		args[i] = (TestArgs){.cache = &cache, .pool = pool, .expected = expected};
+		if(pthread_create(threads + i, NULL, run_queries, args + i)){
+			fprintf(stderr, "\e[1;31mFailed to start thread!\e[0m\n");
+			exit(0);
+		}
+	}
+	for(uint64_t i = 0; i < NUM_THREADS; ++i){
+		pthread_join(threads[i], NULL);
+		passed += args[i].passed;
+	}
+	nut_FactorCache_stats(&cache, &hits, &misses);
+	nut_FactorCache_destroy(&cache);
+	fprintf(stderr, "%s (%"PRIu64"/%d queries correct)\e[0m\n", passed == NUM_THREADS*QUERIES ? "\e[1;32mPASSED" : "\e[1;31mFAILED", passed, NUM_THREADS*QUERIES);
+	bool counts_ok = hits + misses == NUM_THREADS*QUERIES && (!expect_hits || misses < 2*POOL_SIZE);
+	fprintf(stderr, "%s (%"PRIu64" hits, %"PRIu64" misses)\e[0m\n", counts_ok ? "\e[1;32mPASSED" : "\e[1;31mFAILED", hits, misses);
+}
+
+int main(){
+	uint64_t pool[POOL_SIZE];
+	nut_Factors *expected[POOL_SIZE];
+	for(uint64_t i = 0; i < POOL_SIZE; ++i){
+		switch(i%4){
+			case 0: pool[i] = nut_u64_rand(1, 1ull << 20); break;
+			case 1: pool[i] = nut_u64_rand(1, 1ull << 36); break;
+			// products of the first 11 primes, which completely fill an entry
+			case 2: pool[i] = 2ull*3*5*7*11*13*17*19*23*29*31*nut_u64_rand(1, 32); break;
+			// often have a prime factor over 2^32, which is not stored explicitly
+			default: pool[i] = nut_u64_rand(1ull << 32, 1ull << 33)*nut_u64_rand(1, 1ull << 8);
+		}
+		expected[i] = nut_make_Factors_w(NUT_MAX_PRIMES_64);
+		check_alloc("expected factors", expected[i]);
+		if(nut_u64_factor_heuristic(pool[i], 25, nut_small_primes, &nut_default_factor_conf, expected[i]) != 1){
+			fprintf(stderr, "\e[1;31mFailed to factor %"PRIu64"!\e[0m\n", pool[i]);
+		}
+	}
+	// big enough to hold the whole pool, so nearly everything after the first pass should hit
+	test_cache(1 << 17, 8, pool, expected, true);
+	// one bucket per shard, so entries are constantly evicted
+	test_cache(0, 4, pool, expected, false);
+	for(uint64_t i = 0; i < POOL_SIZE; ++i){
+		free(expected[i]);
+	}
+}
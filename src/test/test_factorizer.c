@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include <nut/debug.h>
+#include <nut/factorization.h>
+#include <nut/factorizer.h>
+
+#define NUM_THREADS 2
+
+typedef struct{
+	const nut_Factorizer *fzr;
+	uint64_t range, trials, passed;
+} TestArgs;
+
+static bool check_factors(uint64_t n, const nut_Factors *factors){
+	if(nut_Factors_prod(factors) != n){
+		fprintf(stderr, "\e[1;31mProduct of factorization doesn't match for %"PRIu64"\e[0m\n", n);
+		return false;
+	}
+	for(uint64_t i = 0; i < factors->num_primes; ++i){
+		if(!nut_u64_is_prime_dmr(factors->factors[i].prime) || (i && factors->factors[i].prime <= factors->factors[i - 1].prime)){
+			fprintf(stderr, "\e[1;31mFactors are not distinct sorted primes for %"PRIu64"\e[0m\n", n);
+			return false;
+		}
+	}
+	return true;
+}
+
+static void *run_trials(void *_args){
+	TestArgs *args = _args;
+	nut_Factors *factors [[gnu::cleanup(cleanup_free)]] = nut_make_Factors_w(NUT_MAX_PRIMES_64);
+	check_alloc("factors", factors);
+	for(uint64_t i = 0; i < args->trials; ++i){
+		uint64_t n;
+		switch(i%3){
+			case 0: n = nut_u64_rand(1, args->range); break;
+			case 1: n = nut_u64_rand(1, 1ull << 20)*nut_u64_rand(1, args->range); break;
+			default: n = nut_u64_rand(1, 1ull << 40);
+		}
+		if(nut_Factorizer_factor(args->fzr, n, factors) != 1){
+			fprintf(stderr, "\e[1;31mFailed to factor %"PRIu64"!\e[0m\n", n);
+		}else if(check_factors(n, factors)){
+			++args->passed;
+		}
+	}
+	return NULL;
+}
+
+static void test_factorizer(const nut_Factorizer *fzr, uint64_t range, const char *what){
+	TestArgs args[NUM_THREADS];
+	pthread_t threads[NUM_THREADS];
+	uint64_t trials = 0, passed = 0;
+	fprintf(stderr, "\e[1;34mFactoring random numbers with %s on %d threads...\e[0m\n", what, NUM_THREADS);
+	for(uint64_t i = 0; i < NUM_THREADS; ++i){
+		args[i] = (TestArgs){.fzr = fzr, .range = range, .trials = 600};
+		if(pthread_create(threads + i, NULL, run_trials, args + i)){
+			fprintf(stderr, "\e[1;31mFailed to start thread!\e[0m\n");
+			exit(0);
+		}
+	}
+	for(uint64_t i = 0; i < NUM_THREADS; ++i){
+		pthread_join(threads[i], NULL);
+		trials += args[i].trials;
+		passed += args[i].passed;
+	}
+	fprintf(stderr, "%s (%"PRIu64"/%"PRIu64" trials passed)\e[0m\n", passed == trials ? "\e[1;32mPASSED" : "\e[1;31mFAILED", passed, trials);
+}
+
+// overwrite one 8 byte field of a saved table's header
+static bool patch_header(const char *path, long offset, uint64_t value){
+	FILE *file = fopen(path, "r+b");
+	if(!file){
+		return false;
+	}
+	bool res = !fseek(file, offset, SEEK_SET) && fwrite(&value, sizeof(value), 1, file) == 1;
+	return !fclose(file) && res;
+}
+
+int main(){
+	nut_Factorizer fzr, mapped;
+	if(!nut_Factorizer_init(&fzr, 10000000, 1000, &nut_default_factor_conf)){
+		fprintf(stderr, "\e[1;31mFailed to build factorizer!\e[0m\n");
+		exit(0);
+	}
+	test_factorizer(&fzr, fzr.table_max + 1, "built table");
+	const char *path = "/tmp/nut_test_factorizer.tbl";
+	if(!nut_Factorizer_save(&fzr, path) || !nut_Factorizer_init_mmap(&mapped, path, 1000, &nut_default_factor_conf)){
+		fprintf(stderr, "\e[1;31mFailed to save and map factorizer table!\e[0m\n");
+	}else{
+		if(mapped.table_max != fzr.table_max){
+			fprintf(stderr, "\e[1;31mMapped table has the wrong bound!\e[0m\n");
+		}
+		test_factorizer(&mapped, mapped.table_max + 1, "mapped table");
+		nut_Factorizer_destroy(&mapped);
+		// a header whose table_max is consistent with a table_len of 2^62 + 11, which is 44 bytes once multiplied by 4 and wrapped,
+		// must be rejected instead of mapping a tiny table.  table_max is the 8 byte field at offset 16 and table_len at offset 24
+		uint64_t q = (UINT64_C(1) << 61) + 5;
+		bool ok = patch_header(path, 16, 6*q + 1) && patch_header(path, 24, 2*q + 1) &&
+			!nut_Factorizer_init_mmap(&mapped, path, 1000, &nut_default_factor_conf);
+		fprintf(stderr, "%s (table file with an overflowing size)\e[0m\n", ok ? "\e[1;32mPASSED" : "\e[1;31mFAILED");
+	}
+	remove(path);
+	nut_Factorizer_destroy(&fzr);
+	if(!nut_Factorizer_init(&fzr, 0, 100, &nut_default_factor_conf)){
+		fprintf(stderr, "\e[1;31mFailed to build factorizer!\e[0m\n");
+		exit(0);
+	}
+	test_factorizer(&fzr, 10000001, "no table");
+	nut_Factorizer_destroy(&fzr);
+}
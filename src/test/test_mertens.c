@@ -0,0 +1,90 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <nut/modular_math.h>
+#include <nut/dirichlet.h>
+#include <nut/sieves.h>
+#include <nut/debug.h>
+
+static const int64_t M = 1000000007;
+
+// compare a table from nut_Diri_compute_mertens_parallel with one from the serial nut_Diri_compute_mertens
+static bool test_table(int64_t x, int64_t y, int64_t m, uint64_t num_threads){
+	nut_Diri expected [[gnu::cleanup(nut_Diri_destroy)]] = {};
+	nut_Diri got [[gnu::cleanup(nut_Diri_destroy)]] = {};
+	uint8_t *mobius [[gnu::cleanup(cleanup_free)]] = NULL;
+	if(!nut_Diri_init(&expected, x, y) || !nut_Diri_init(&got, x, y) || !(mobius = nut_sieve_mobius(expected.y))){
+		check_alloc("mertens tables", NULL);
+	}
+	nut_Diri_compute_mertens(&expected, m, mobius);
+	bool ok = nut_Diri_compute_mertens_parallel(&got, m, num_threads);
+	for(int64_t i = 0; ok && i < got.y + got.yinv; ++i){
+		if(got.buf[i] != expected.buf[i]){
+			fprintf(stderr, "\e[1;31mEntry %"PRIi64" was %"PRIi64" instead of %"PRIi64"\e[0m\n", i, got.buf[i], expected.buf[i]);
+			ok = false;
+		}
+	}
+	fprintf(stderr, "%s (Mertens table for x = %"PRIi64", y = %"PRIi64", m = %"PRIi64", %"PRIu64" threads)\e[0m\n", ok ? "\e[1;32mPASSED" : "\e[1;31mFAILED", x, got.y, m, num_threads);
+	return ok;
+}
+
+// extend a table step by step and compare it with one computed from scratch
+static bool test_extend(int64_t x, const int64_t *steps, uint64_t num_steps, int64_t m, uint64_t num_threads){
+	nut_Diri old [[gnu::cleanup(nut_Diri_destroy)]] = {};
+	if(!nut_Diri_init(&old, x, nut_mertens_cutoff(x))){
+		check_alloc("mertens tables", NULL);
+	}
+	bool ok = nut_Diri_compute_mertens_parallel(&old, m, num_threads);
+	for(uint64_t s = 0; ok && s < num_steps; ++s){
+		nut_Diri got [[gnu::cleanup(nut_Diri_destroy)]] = {};
+		nut_Diri expected [[gnu::cleanup(nut_Diri_destroy)]] = {};
+		int64_t x1 = steps[s], y1 = nut_mertens_cutoff(x1);
+		if(!nut_Diri_init(&got, x1, y1) || !nut_Diri_init(&expected, x1, y1)){
+			check_alloc("mertens tables", NULL);
+		}
+		ok = nut_Diri_compute_mertens_extend(&got, m, &old, num_threads) && nut_Diri_compute_mertens_parallel(&expected, m, num_threads);
+		for(int64_t i = 0; ok && i < got.y + got.yinv; ++i){
+			if(got.buf[i] != expected.buf[i]){
+				fprintf(stderr, "\e[1;31mEntry %"PRIi64" was %"PRIi64" instead of %"PRIi64" for x = %"PRIi64"\e[0m\n", i, got.buf[i], expected.buf[i], x1);
+				ok = false;
+			}
+		}
+		nut_Diri tmp = old;
+		old = got;
+		got = tmp;
+	}
+	// tables can't shrink
+	nut_Diri small [[gnu::cleanup(nut_Diri_destroy)]] = {};
+	if(!nut_Diri_init(&small, x/2, 0)){
+		check_alloc("mertens tables", NULL);
+	}
+	ok = ok && !nut_Diri_compute_mertens_extend(&small, m, &old, num_threads);
+	fprintf(stderr, "%s (extended Mertens tables from x = %"PRIi64", m = %"PRIi64", %"PRIu64" threads)\e[0m\n", ok ? "\e[1;32mPASSED" : "\e[1;31mFAILED", x, m, num_threads);
+	return ok;
+}
+
+int main(){
+	test_table(1'000'000, 0, 0, 1);
+	test_table(1'000'000'000, 0, M, 3);
+	test_table(1'000'000'000, 2'000'000, 0, 4);
+	test_table(123'456'789, nut_mertens_cutoff(123'456'789), 0, 2);
+	static const int64_t doubling[] = {200'000'000, 400'000'000, 800'000'000}, uneven[] = {150'000'007, 150'000'007, 987'654'321};
+	test_extend(100'000'000, doubling, 3, 0, 2);
+	test_extend(100'000'000, uneven, 3, M, 3);
+	// M(10^k) from the literature
+	static const int64_t known[][2] = {{10, -1}, {100, 1}, {1000, 2}, {10'000'000'000, -33722}, {100'000'000'000, -87856}};
+	uint64_t passed = 0, total = 0;
+	for(uint64_t i = 0; i < sizeof(known)/sizeof(known[0]); ++i){
+		for(int64_t m = 0; m <= M; m += M){
+			int64_t res;
+			bool ok = nut_mertens(known[i][0], m, 3, &res) && res == (m ? nut_i64_mod(known[i][1], m) : known[i][1]);
+			if(!ok){
+				fprintf(stderr, "\e[1;31mM(%"PRIi64") mod %"PRIi64" was %"PRIi64"\e[0m\n", known[i][0], m, res);
+			}
+			passed += ok;
+			++total;
+		}
+	}
+	fprintf(stderr, "%s (%"PRIu64"/%"PRIu64" values of M correct)\e[0m\n", passed == total ? "\e[1;32mPASSED" : "\e[1;31mFAILED", passed, total);
+}
@@ -0,0 +1,106 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <nut/modular_math.h>
+#include <nut/dirichlet.h>
+#include <nut/sieves.h>
+#include <nut/min25.h>
+#include <nut/debug.h>
+
+static const int64_t M = 1000000007;
+
+static int64_t phi_pp(uint64_t p, uint64_t pp, uint64_t e, uint64_t m){
+	return (pp - pp/p)%m;
+}
+
+static bool check(const char *name, int64_t x, int64_t got, int64_t expected){
+	if(got != expected){
+		fprintf(stderr, "\e[1;31m%s(%"PRIi64") was %"PRIi64" instead of %"PRIi64"\e[0m\n", name, x, got, expected);
+		return false;
+	}
+	return true;
+}
+
+// compare F(x/n) for every n in a min_25 table against prefix sums of a sieved table of f
+static bool check_table(const char *name, const nut_Diri *tbl, const int64_t *f_vals, int64_t m){
+	int64_t *prefix [[gnu::cleanup(cleanup_free)]] = malloc((tbl->x + 1)*sizeof(int64_t));
+	check_alloc("prefix sums", prefix);
+	prefix[0] = 0;
+	for(int64_t n = 1; n <= tbl->x; ++n){
+		prefix[n] = m ? (prefix[n - 1] + f_vals[n])%m : prefix[n - 1] + f_vals[n];
+	}
+	for(int64_t i = 1; i <= tbl->y; ++i){
+		if(!check(name, i, tbl->buf[i], f_vals[i])){
+			return false;
+		}
+	}
+	for(int64_t i = 1; i < tbl->yinv; ++i){
+		if(!check(name, tbl->x/i, nut_Diri_get_sparse(tbl, i), prefix[tbl->x/i])){
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(){
+	uint64_t passed = 0, total = 0;
+	// Euler's totient: f(p) = p - 1, f(p^e) = p^e - p^(e-1)
+	const int64_t phi_coeffs[] = {M - 1, 1};
+	const int64_t x_small = 2'000'000;
+	uint64_t *phi_vals_u [[gnu::cleanup(cleanup_free)]] = nut_sieve_phi(x_small);
+	int64_t *phi_vals [[gnu::cleanup(cleanup_free)]] = malloc((x_small + 1)*sizeof(int64_t));
+	check_alloc("totients", phi_vals_u);
+	check_alloc("totients", phi_vals);
+	phi_vals[0] = 0;
+	phi_vals[1] = 1;
+	int64_t phi_sum = 1;
+	for(int64_t n = 2; n <= x_small; ++n){
+		phi_vals[n] = phi_vals_u[n]%M;
+		phi_sum = (phi_sum + phi_vals[n])%M;
+	}
+	for(uint64_t num_threads = 1; num_threads <= 3; num_threads += 2){
+		int64_t res;
+		passed += NUT_MIN25_SUM(x_small, M, 1, phi_coeffs, phi_pp, NULL, &res, num_threads) && check("Phi", x_small, res, phi_sum);
+		++total;
+	}
+	nut_Diri phi_tbl [[gnu::cleanup(nut_Diri_destroy)]];
+	if(!nut_Diri_init(&phi_tbl, x_small, 0)){
+		check_alloc("totient table", NULL);
+	}
+	int64_t res;
+	passed += NUT_MIN25_SUM(x_small, M, 1, phi_coeffs, phi_pp, &phi_tbl, &res, 1) && check("Phi", x_small, res, phi_sum) && check_table("Phi", &phi_tbl, phi_vals, M);
+	++total;
+	// divisor count: f(p^e) = e + 1, compared with the Dirichlet hyperbola method, exactly and mod M
+	int64_t d_vals[64];
+	for(int64_t e = 0; e < 64; ++e){
+		d_vals[e] = e + 1;
+	}
+	const int64_t d_coeffs[] = {2};
+	for(int64_t x = 1; x <= 10'000'000'000; x = x*7 + 3){
+		for(int64_t m = 0; m <= M; m += M){
+			passed += NUT_MIN25_SUM(x, m, 0, d_coeffs, d_vals, NULL, &res, 3) && check("D", x, res, nut_dirichlet_D(x, m));
+			++total;
+		}
+	}
+	// mu, without a modulus, which has negative values: F is the Mertens function
+	const int64_t mu_coeffs[] = {-1};
+	const int64_t mu_vals[64] = {1, -1};
+	nut_Diri mertens_tbl [[gnu::cleanup(nut_Diri_destroy)]];
+	uint8_t *mobius [[gnu::cleanup(cleanup_free)]] = nut_sieve_mobius(x_small);
+	int64_t *mu_sieved [[gnu::cleanup(cleanup_free)]] = malloc((x_small + 1)*sizeof(int64_t));
+	check_alloc("mobius", mobius);
+	check_alloc("mobius", mu_sieved);
+	for(int64_t n = 0; n <= x_small; ++n){
+		int64_t v = nut_Bitfield2_arr_get(mobius, n);
+		mu_sieved[n] = v == 3 ? -1 : v;
+	}
+	if(!nut_Diri_init(&mertens_tbl, x_small, 4000)){
+		check_alloc("mertens table", NULL);
+	}
+	passed += NUT_MIN25_SUM(x_small, 0, 0, mu_coeffs, mu_vals, &mertens_tbl, &res, 1) && check_table("M", &mertens_tbl, mu_sieved, 0);
+	// a table for a different x is rejected
+	passed += !NUT_MIN25_SUM(2*x_small, 0, 0, mu_coeffs, mu_vals, &mertens_tbl, &res, 1);
+	total += 2;
+	fprintf(stderr, "%s (%"PRIu64"/%"PRIu64" sums correct)\e[0m\n", passed == total ? "\e[1;32mPASSED" : "\e[1;31mFAILED", passed, total);
+}
@@ -0,0 +1,97 @@
+#define _POSIX_C_SOURCE 202305L
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <nut/modular_math.h>
+#include <nut/dirichlet.h>
+#include <nut/polynomial.h>
+#include <nut/mod_kernels.h>
+#include <nut/debug.h>
+
+NUT_DEFINE_MOD_KERNELS(p1e6_3, 1000003)
+
+// the library dispatches 10^9+7 and 998244353 to specialized copies,
+// so comparing against the kernels called with a modulus the compiler can't see checks both paths
+static volatile int64_t runtime_modulus;
+
+static void rand_diri(nut_Diri *self, int64_t x, int64_t m){
+	if(!nut_Diri_init(self, x, nut_u64_nth_root(x, 3)*nut_u64_nth_root(x, 3))){
+		check_alloc("diri table", NULL);
+	}
+	for(int64_t i = 0; i < self->y + self->yinv; ++i){
+		self->buf[i] = nut_u64_prand(0, m);
+	}
+	self->buf[1] = 1;
+}
+
+static double elapsed(const struct timespec *start, const struct timespec *end){
+	return (double)(end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec)*1e-9;
+}
+
+static bool diri_eq(const nut_Diri *a, const nut_Diri *b){
+	return !memcmp(a->buf, b->buf, (a->y + a->yinv)*sizeof(int64_t));
+}
+
+static uint64_t test_diri(int64_t x, int64_t m, bool (*conv)(nut_Diri*, const nut_Diri*, const nut_Diri*), bool (*convdiv)(nut_Diri*, const nut_Diri*, const nut_Diri*)){
+	nut_Diri f, g, h, e;
+	rand_diri(&f, x, m);
+	rand_diri(&g, x, m);
+	rand_diri(&h, x, m);
+	rand_diri(&e, x, m);
+	uint64_t passed = 0;
+	struct timespec t0, t1, t2;
+	runtime_modulus = m;
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	bool ok = conv ? conv(&h, &f, &g) : nut_Diri_compute_conv(&h, m, &f, &g);
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	ok = nut_Diri_compute_conv_kernel(&e, runtime_modulus, &f, &g) && ok;
+	clock_gettime(CLOCK_MONOTONIC, &t2);
+	fprintf(stderr, "\e[1;34mconv mod %"PRIi64": %.3fs specialized, %.3fs generic\e[0m\n", m, elapsed(&t0, &t1), elapsed(&t1, &t2));
+	passed += ok && diri_eq(&h, &e);
+	ok = nut_Diri_compute_conv_u(&h, m, &f) && nut_Diri_compute_conv_u_kernel(&e, runtime_modulus, &f);
+	passed += ok && diri_eq(&h, &e);
+	ok = nut_Diri_compute_conv_N(&h, m, &f) && nut_Diri_compute_conv_N_kernel(&e, runtime_modulus, &f);
+	passed += ok && diri_eq(&h, &e);
+	ok = (convdiv ? convdiv(&h, &f, &g) : nut_Diri_convdiv(&h, m, &f, &g)) && nut_Diri_convdiv_kernel(&e, runtime_modulus, &f, &g);
+	passed += ok && diri_eq(&h, &e);
+	nut_Diri_destroy(&f);
+	nut_Diri_destroy(&g);
+	nut_Diri_destroy(&h);
+	nut_Diri_destroy(&e);
+	return passed;
+}
+
+static uint64_t test_poly(int64_t m, bool (*mul)(nut_Poly*, const nut_Poly*, const nut_Poly*)){
+	nut_Poly f, g, h, e;
+	uint64_t passed = 0;
+	if(!nut_Poly_init(&f, 0) || !nut_Poly_init(&g, 0) || !nut_Poly_init(&h, 0) || !nut_Poly_init(&e, 0)){
+		check_alloc("polynomials", NULL);
+	}
+	runtime_modulus = m;
+	for(uint64_t i = 0; i < 100; ++i){
+		if(!nut_Poly_rand_modn(&f, nut_u64_rand(1, 200), m) || !nut_Poly_rand_modn(&g, nut_u64_rand(1, 200), m)){
+			check_alloc("polynomials", NULL);
+		}
+		bool ok = mul ? mul(&h, &f, &g) : nut_Poly_mul_modn(&h, &f, &g, m);
+		ok = nut_Poly_mul_modn_kernel(&e, &f, &g, runtime_modulus) && ok;
+		passed += ok && !nut_Poly_cmp(&h, &e);
+	}
+	nut_Poly_destroy(&f);
+	nut_Poly_destroy(&g);
+	nut_Poly_destroy(&h);
+	nut_Poly_destroy(&e);
+	return passed;
+}
+
+int main(){
+	uint64_t passed = 0;
+	passed += test_diri(1000000000, 1000000007, NULL, NULL);
+	passed += test_diri(1000000000, 998244353, NULL, NULL);
+	passed += test_diri(100000000, 1000003, p1e6_3_Diri_compute_conv, p1e6_3_Diri_convdiv);
+	print_summary("specialized dirichlet convolutions", passed, 12);
+	passed = test_poly(1000000007, NULL) + test_poly(998244353, NULL) + test_poly(1000003, p1e6_3_Poly_mul);
+	print_summary("specialized polynomial products", passed, 300);
+}
@@ -0,0 +1,125 @@
+#include <stdio.h>
+#include <inttypes.h>
+#include <stdlib.h>
+
+#include <nut/debug.h>
+#include <nut/modular_math.h>
+#include <nut/factorization.h>
+
+#define MAX_K 16
+
+static uint64_t words_mod(uint64_t k, const uint64_t x[static k], uint64_t m){
+	uint64_t r = 0;
+	for(uint64_t i = k; i-- > 0;){
+		r = (((uint128_t)r << 64) | x[i])%m;
+	}
+	return r;
+}
+
+// compare multiword numbers, returning true if x < y
+static bool words_lt(uint64_t k, const uint64_t x[static k], const uint64_t y[static k]){
+	for(uint64_t i = k; i-- > 0;){
+		if(x[i] != y[i]){
+			return x[i] < y[i];
+		}
+	}
+	return false;
+}
+
+static bool test_batch(uint64_t n, uint64_t count){
+	uint64_t *in [[gnu::cleanup(cleanup_free)]] = malloc(count*sizeof(uint64_t));
+	uint64_t *out [[gnu::cleanup(cleanup_free)]] = malloc(count*sizeof(uint64_t));
+	check_alloc("inputs", in);
+	check_alloc("outputs", out);
+	for(uint64_t i = 0; i < count; ++i){
+		do{
+			in[i] = nut_u64_rand(0, UINT64_MAX);
+		}while(nut_u64_rand(0, 2) && in[i]%n == 0);
+	}
+	bool invertible = true;
+	for(uint64_t i = 0; i < count; ++i){
+		uint64_t a = in[i]%n, b = n;
+		while(a){
+			uint64_t t = b%a;
+			b = a;
+			a = t;
+		}
+		invertible = invertible && (b == 1 || n == 1);
+	}
+	if(nut_u64_modinv_batch(n, count, in, out) != invertible){
+		fprintf(stderr, "\e[1;31mBatch inverse mod %"PRIu64" should have %s\e[0m\n", n, invertible ? "succeeded" : "failed");
+		return false;
+	}
+	for(uint64_t i = 0; invertible && i < count; ++i){
+		if((uint128_t)in[i]%n*out[i]%n != 1%n || out[i] >= n){
+			fprintf(stderr, "\e[1;31mWrong inverse of %"PRIu64" mod %"PRIu64"\e[0m\n", in[i], n);
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool test_crt(uint64_t k, uint64_t bits){
+	uint64_t a[MAX_K], m[MAX_K], x[MAX_K], prod[MAX_K + 1] = {1};
+	for(uint64_t i = 0; i < k; ++i){
+		// distinct primes are pairwise coprime, and powers of 2 mixed in check even moduli
+		for(bool dup = true; dup;){
+			m[i] = i == 0 ? 1ull << nut_u64_rand(1, bits) : nut_u64_next_prime_ge(nut_u64_rand(3, 1ull << (bits - 1)));
+			dup = false;
+			for(uint64_t j = 0; j < i; ++j){
+				dup = dup || m[j] == m[i];
+			}
+		}
+		a[i] = nut_u64_rand(0, m[i]);
+		uint128_t carry = 0;
+		for(uint64_t j = 0; j <= i; ++j){
+			carry += (uint128_t)prod[j]*m[i];
+			prod[j] = carry;
+			carry >>= 64;
+		}
+		prod[i + 1] = carry;
+	}
+	if(!nut_u64_crt_multi(k, a, m, x)){
+		fprintf(stderr, "\e[1;31mCRT failed for %"PRIu64" coprime moduli\e[0m\n", k);
+		return false;
+	}
+	for(uint64_t i = 0; i < k; ++i){
+		if(words_mod(k, x, m[i]) != a[i]){
+			fprintf(stderr, "\e[1;31mCRT result has the wrong residue mod %"PRIu64"\e[0m\n", m[i]);
+			return false;
+		}
+	}
+	if(!words_lt(k, x, prod) && !prod[k]){
+		fprintf(stderr, "\e[1;31mCRT result is not reduced\e[0m\n");
+		return false;
+	}
+	return true;
+}
+
+int main(){
+	uint64_t passed = 0, trials = 0;
+	static const uint64_t moduli[] = {1, 2, 3, 4, 1000000007, 1ull << 40, 6*7*11*13, UINT64_MAX - 58, UINT64_MAX, (1ull << 63) + 1};
+	for(uint64_t i = 0; i < sizeof(moduli)/sizeof(*moduli); ++i){
+		for(uint64_t count = 0; count <= 300; count += 1 + count/4, ++trials){
+			passed += test_batch(moduli[i], count);
+		}
+	}
+	for(uint64_t i = 0; i < 500; ++i, ++trials){
+		passed += test_batch(nut_u64_rand(1, UINT64_MAX), nut_u64_rand(1, 20));
+	}
+	print_summary("batch modular inverses", passed, trials);
+	passed = trials = 0;
+	for(uint64_t k = 1; k <= MAX_K; ++k){
+		for(uint64_t bits = 8; bits <= 64; bits += 8, ++trials){
+			passed += test_crt(k, bits);
+		}
+	}
+	uint64_t a[2] = {4, 0}, m[2] = {6, 9}, x[2];
+	++trials;
+	if(nut_u64_crt_multi(2, a, m, x)){
+		fprintf(stderr, "\e[1;31mCRT succeeded for moduli which are not coprime\e[0m\n");
+	}else{
+		++passed;
+	}
+	print_summary("multi modulus CRT", passed, trials);
+}
@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <inttypes.h>
+#include <stdlib.h>
+
+#include <nut/debug.h>
+#include <nut/modular_math.h>
+#include <nut/factorization.h>
+#include <nut/sieves.h>
+
+// Composites which are strong pseudoprimes to many small prime bases
+static const uint64_t pseudoprimes[] = {
+	2047, 1373653, 25326001, 3215031751, 2152302898747, 3474749660383, 341550071728321,
+	3825123056546413051, 318665857834031151ull
+};
+
+int main(){
+	uint64_t max = 300000, num_primes, passed = 0, trials = 0;
+	uint64_t *primes [[gnu::cleanup(cleanup_free)]] = nut_sieve_primes(max, &num_primes);
+	check_alloc("primes", primes);
+	fprintf(stderr, "\e[1;34mChecking primality tests and next/previous primes up to %"PRIu64"...\e[0m\n", max);
+	bool ok = true;
+	for(uint64_t n = 0, i = 0; n <= max; ++n){
+		bool expected = i < num_primes && primes[i] == n;
+		uint64_t next = i < num_primes ? primes[i] : 0, prev = i + expected ? primes[i + expected - 1] : 0;
+		if(nut_u64_is_prime_dmr(n) != expected){
+			fprintf(stderr, "\e[1;31mPrimality of %"PRIu64" is wrong\e[0m\n", n);
+			ok = false;
+		}
+		if(next && nut_u64_next_prime_ge(n) != next){
+			fprintf(stderr, "\e[1;31mNext prime after %"PRIu64" is wrong\e[0m\n", n);
+			ok = false;
+		}
+		if(nut_u64_prev_prime_le(n) != prev){
+			fprintf(stderr, "\e[1;31mPrevious prime before %"PRIu64" is wrong\e[0m\n", n);
+			ok = false;
+		}
+		i += expected;
+		if(!ok){
+			break;
+		}
+	}
+	passed += ok;
+	++trials;
+	for(uint64_t i = 0; i < sizeof(pseudoprimes)/sizeof(*pseudoprimes); ++i, ++trials){
+		if(nut_u64_is_prime_dmr(pseudoprimes[i])){
+			fprintf(stderr, "\e[1;31mPseudoprime %"PRIu64" passed primality test\e[0m\n", pseudoprimes[i]);
+		}else{
+			++passed;
+		}
+	}
+	// compare against a plain wheel search near the top of the range, including the largest 64 bit prime
+	for(uint64_t i = 0; i < 300; ++i, ++trials){
+		uint64_t n = i ? nut_u64_rand(1ull << (i%61 + 2), 1ull << (i%61 + 3)) : UINT64_MAX - 200;
+		uint64_t next = n, prev = n;
+		while(!nut_u64_is_prime_dmr(next)){
+			++next;
+		}
+		while(!nut_u64_is_prime_dmr(prev)){
+			--prev;
+		}
+		if(nut_u64_next_prime_ge(n) != next || nut_u64_prev_prime_le(n) != prev){
+			fprintf(stderr, "\e[1;31mNext/previous prime around %"PRIu64" is wrong\e[0m\n", n);
+		}else{
+			++passed;
+		}
+	}
+	print_summary("next and previous primes", passed, trials);
+	passed = trials = 0;
+	uint64_t intervals[][2] = {
+		{0, 0}, {0, 2}, {2, 2}, {3, 100}, {90, 97}, {0, 1000000}, {999000, 1001000},
+		{(1ull << 32) - 100000, (1ull << 32) + 100000}, {(1ull << 62), (1ull << 62) + 100000}, {UINT64_MAX - 1000, UINT64_MAX}
+	};
+	for(uint64_t i = 0; i < sizeof(intervals)/sizeof(*intervals); ++i, ++trials){
+		uint64_t a = intervals[i][0], b = intervals[i][1], count;
+		uint64_t *found [[gnu::cleanup(cleanup_free)]] = nut_u64_primes_in(a, b, &count);
+		check_alloc("primes in interval", found);
+		uint64_t j = 0;
+		ok = true;
+		for(uint64_t n = a;; ++n){
+			if(nut_u64_is_prime_dmr(n)){
+				if(j == count || found[j] != n){
+					ok = false;
+					break;
+				}
+				++j;
+			}
+			if(n == b){
+				break;
+			}
+		}
+		if(!ok || j != count){
+			fprintf(stderr, "\e[1;31mPrimes in [%"PRIu64", %"PRIu64"] are wrong\e[0m\n", a, b);
+		}else{
+			++passed;
+		}
+	}
+	print_summary("primes in intervals", passed, trials);
+}
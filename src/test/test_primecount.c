@@ -0,0 +1,60 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <nut/dirichlet.h>
+#include <nut/sieves.h>
+#include <nut/primecount.h>
+#include <nut/debug.h>
+
+// pi(10^k) from the literature, beyond what the other methods here can check quickly
+static const uint64_t known_pi[][2] = {
+	{UINT64_C(1000000000), UINT64_C(50847534)},
+	{UINT64_C(10000000000), UINT64_C(455052511)},
+	{UINT64_C(100000000000), UINT64_C(4118054813)},
+	{UINT64_C(1000000000000), UINT64_C(37607912018)},
+};
+
+static bool check_pi(uint64_t x, uint64_t expected, uint64_t num_threads){
+	uint64_t res;
+	if(!nut_u64_pi(x, num_threads, &res)){
+		fprintf(stderr, "\e[1;31mFailed to compute pi(%"PRIu64")!\e[0m\n", x);
+		return false;
+	}else if(res != expected){
+		fprintf(stderr, "\e[1;31mpi(%"PRIu64") was %"PRIu64" instead of %"PRIu64" with %"PRIu64" threads\e[0m\n", x, res, expected, num_threads);
+		return false;
+	}
+	return true;
+}
+
+int main(){
+	uint64_t passed = 0, total = 0;
+	// compare against Lucy's algorithm at every sparse point of a table, which covers a wide spread of small and medium x
+	nut_Diri pi_tbl [[gnu::cleanup(nut_Diri_destroy)]];
+	if(!nut_Diri_init(&pi_tbl, 20'000'000'000, 0) || !nut_Diri_compute_pi(&pi_tbl)){
+		check_alloc("pi table", NULL);
+	}
+	for(int64_t i = 1; i < pi_tbl.yinv; i += i < 64 ? 1 : i/4){
+		uint64_t x = pi_tbl.x/i;
+		uint64_t num_threads = i%3 + 1;
+		passed += check_pi(x, nut_Diri_get_sparse(&pi_tbl, i), num_threads);
+		++total;
+	}
+	// small x is handled by direct sieving, but check the edges
+	for(uint64_t x = 0; x < 100; ++x){
+		uint64_t num_primes;
+		uint64_t *primes [[gnu::cleanup(cleanup_free)]] = nut_sieve_primes(x, &num_primes);
+		passed += check_pi(x, num_primes, 1);
+		++total;
+	}
+	for(uint64_t i = 0; i < sizeof(known_pi)/sizeof(known_pi[0]); ++i){
+		for(uint64_t num_threads = 1; num_threads <= 4; num_threads += 3){
+			passed += check_pi(known_pi[i][0], known_pi[i][1], num_threads);
+			++total;
+		}
+	}
+	// large enough that the per-segment work over all a = pi(y) sieving primes would dominate if every segment touched every level
+	passed += check_pi(UINT64_C(1000000000000000), UINT64_C(29844570422669), 0);
+	++total;
+	fprintf(stderr, "%s (%"PRIu64"/%"PRIu64" values of pi correct)\e[0m\n", passed == total ? "\e[1;32mPASSED" : "\e[1;31mFAILED", passed, total);
+}
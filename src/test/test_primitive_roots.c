@@ -0,0 +1,99 @@
+#include <stdio.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <nut/factorization.h>
+#include <nut/sieves.h>
+#include <nut/modular_math.h>
+#include <nut/debug.h>
+
+static uint64_t brute_order(uint64_t a, uint64_t n){
+	uint64_t x = a%n;
+	for(uint64_t k = 1; k <= n; ++k, x = x*a%n){
+		if(x == 1%n){
+			return k;
+		}
+	}
+	return 0;
+}
+
+int main(){
+	uint64_t max = 500;
+	nut_Factors *factors [[gnu::cleanup(cleanup_free)]] = nut_make_Factors_w(NUT_MAX_PRIMES_64);
+	uint32_t *smallest_factors [[gnu::cleanup(cleanup_free)]] = nut_sieve_smallest_factors_wheel6(max);
+	uint64_t *carmichael_vals [[gnu::cleanup(cleanup_free)]] = nut_sieve_carmichael(max);
+	uint64_t *phi_vals [[gnu::cleanup(cleanup_free)]] = nut_sieve_phi(max);
+	uint64_t *as [[gnu::cleanup(cleanup_free)]] = malloc(max*sizeof(uint64_t));
+	uint64_t *orders [[gnu::cleanup(cleanup_free)]] = malloc(max*sizeof(uint64_t));
+	check_alloc("factors", factors);
+	check_alloc("smallest factors", smallest_factors);
+	check_alloc("carmichael", carmichael_vals);
+	check_alloc("phi", phi_vals);
+	check_alloc("as", as);
+	check_alloc("orders", orders);
+	for(uint64_t a = 0; a < max; ++a){
+		as[a] = a;
+	}
+	uint64_t passed = 0;
+	fprintf(stderr, "\e[1;34mChecking orders and primitive roots mod all numbers from 2 to %"PRIu64"...\e[0m\n", max);
+	for(uint64_t n = 2; n <= max; ++n){
+		uint64_t cn = carmichael_vals[n], phi = phi_vals[n];
+		if(n <= 2){
+			cn = phi = 1;
+		}
+		nut_fill_factors_from_smallest_wheel6(factors, cn, smallest_factors);
+		nut_u64_orders_mod(n, cn, factors, n, as, orders);
+		bool ok = true;
+		uint64_t num_roots = 0, min_root = 0;
+		for(uint64_t a = 0; a < n; ++a){
+			uint64_t expected = nut_i64_egcd(a, n, NULL, NULL) == 1 ? brute_order(a, n) : 0;
+			if(orders[a] != expected){
+				fprintf(stderr, "\e[1;31mOrder of %"PRIu64" mod %"PRIu64" should be %"PRIu64" but got %"PRIu64"\e[0m\n", a, n, expected, orders[a]);
+				ok = false;
+				break;
+			}
+			if(expected == phi){
+				if(!num_roots++){
+					min_root = a;
+				}
+			}
+		}
+		uint64_t count;
+		uint64_t *roots [[gnu::cleanup(cleanup_free)]] = nut_u64_primitive_roots(n, &count);
+		if(nut_u64_primitive_root(n) != min_root || count != num_roots || (count && roots[0] != min_root)){
+			fprintf(stderr, "\e[1;31mWrong primitive roots mod %"PRIu64"\e[0m\n", n);
+			ok = false;
+		}
+		for(uint64_t i = 0; ok && i < count; ++i){
+			if(orders[roots[i]] != phi || (i && roots[i] <= roots[i - 1])){
+				fprintf(stderr, "\e[1;31mBad primitive root %"PRIu64" mod %"PRIu64"\e[0m\n", roots[i], n);
+				ok = false;
+			}
+		}
+		passed += ok;
+	}
+	print_summary("orders and primitive roots", passed, max - 1);
+	passed = 0;
+	uint64_t trials = 100;
+	fprintf(stderr, "\e[1;34mChecking primitive roots mod %"PRIu64" random large primes...\e[0m\n", trials);
+	for(uint64_t i = 0; i < trials; ++i){
+		uint64_t p = nut_u64_next_prime_ge(nut_u64_rand(1ull << 32, 1ull << 48));
+		uint64_t g = nut_u64_primitive_root(p);
+		if(nut_u64_factor_heuristic(p - 1, 25, nut_small_primes, &nut_default_factor_conf, factors) != 1){
+			fprintf(stderr, "\e[1;31mFailed to factor %"PRIu64"!\e[0m\n", p - 1);
+			continue;
+		}
+		uint64_t as2[3] = {g, g == 2 ? 1 : g - 1, p - 1}, orders2[3];
+		nut_u64_orders_mod(p, p - 1, factors, 3, as2, orders2);
+		bool ok = g && orders2[0] == p - 1 && orders2[1] != p - 1 && orders2[2] == 2;
+		for(uint64_t j = 0; ok && j < factors->num_primes; ++j){
+			ok = nut_u64_powmod(g, (p - 1)/factors->factors[j].prime, p) != 1;
+		}
+		if(!ok){
+			fprintf(stderr, "\e[1;31mBad primitive root %"PRIu64" mod %"PRIu64"\e[0m\n", g, p);
+		}
+		passed += ok;
+	}
+	print_summary("primitive roots of large primes", passed, trials);
+}
@@ -0,0 +1,55 @@
+#include <stdio.h>
+#include <inttypes.h>
+#include <stdlib.h>
+
+#include <nut/factorization.h>
+#include <nut/qsieve.h>
+
+static uint64_t rand_prime(uint64_t bits){
+	return nut_u64_next_prime_ge(nut_u64_rand(1ull << (bits - 1), (1ull << (bits - 1)) + (1ull << (bits - 2))));
+}
+
+int main(){
+	uint64_t trials = 0, passed = 0;
+	fprintf(stderr, "\e[1;34mSplitting random semiprimes from 60 to 126 bits with SIQS...\e[0m\n");
+	for(uint64_t bits = 30; bits <= 63; bits += 3){
+		for(uint64_t i = 0; i < 4; ++i, ++trials){
+			uint64_t p = rand_prime(bits), q = rand_prime(bits);
+			uint128_t n = (uint128_t)p*q;
+			uint128_t d = nut_u128_factor1_siqs(n, 1 + i%2);
+			if(p == q ? d != p : d != p && d != q){
+				fprintf(stderr, "\e[1;31mFailed to split %"PRIu64"*%"PRIu64"!\e[0m\n", p, q);
+				continue;
+			}
+			++passed;
+		}
+	}
+	fprintf(stderr, "%s (%"PRIu64"/%"PRIu64" trials passed)\e[0m\n", passed == trials ? "\e[1;32mPASSED" : "\e[1;31mFAILED", passed, trials);
+	nut_FactorConf conf = nut_default_factor_conf;
+	conf.lenstra_max = 1ull << 40;
+	nut_Factors *factors = nut_make_Factors_w(NUT_MAX_PRIMES_64);
+	trials = 100;
+	passed = 0;
+	fprintf(stderr, "\e[1;34mFactoring %"PRIu64" random numbers with SIQS for cofactors over 2^40...\e[0m\n", trials);
+	for(uint64_t i = 0; i < trials; ++i){
+		uint64_t n = i%2 ? rand_prime(25 + i%7)*rand_prime(33 - i%7)*(i%5 + 1) : nut_u64_rand(1ull << 50, 1ull << 63);
+		if(nut_u64_factor_heuristic(n, 25, nut_small_primes, &conf, factors) != 1){
+			fprintf(stderr, "\e[1;31mFailed to factor %"PRIu64"!\e[0m\n", n);
+			continue;
+		}else if(nut_Factors_prod(factors) != n){
+			fprintf(stderr, "\e[1;31mProduct of factorization doesn't match for %"PRIu64"\e[0m\n", n);
+			continue;
+		}
+		bool all_factors_prime = true;
+		for(uint64_t j = 0; j < factors->num_primes; ++j){
+			all_factors_prime = all_factors_prime && nut_u64_is_prime_dmr(factors->factors[j].prime);
+		}
+		if(!all_factors_prime){
+			fprintf(stderr, "\e[1;31mNot all factors are prime for %"PRIu64"\e[0m\n", n);
+			continue;
+		}
+		++passed;
+	}
+	free(factors);
+	fprintf(stderr, "%s (%"PRIu64"/%"PRIu64" trials passed)\e[0m\n", passed == trials ? "\e[1;32mPASSED" : "\e[1;31mFAILED", passed, trials);
+}